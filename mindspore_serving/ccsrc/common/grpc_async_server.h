@@ -24,6 +24,8 @@
 #include <utility>
 #include <string>
 #include <future>
+#include <functional>
+#include <vector>
 #include "common/serving_common.h"
 #include "common/ssl_config.h"
 #include "common/utils.h"
@@ -36,6 +38,16 @@ class GrpcAsyncServiceContextBase {
 
   virtual void NewAndHandleRequest() = 0;
 
+  // handle one event of the completion queue, the context of an unary call is deleted after the reply is sent
+  virtual void HandleEvent(bool rpc_ok) {
+    if (HasFinish() || !rpc_ok) {  // !rpc_ok: cancel get request when shutting down.
+      delete this;
+    } else {
+      NewAndHandleRequest();
+      SetFinish();  // will delete next time
+    }
+  }
+
   bool HasFinish() const { return finished_; }
   void SetFinish() { finished_ = true; }
 
@@ -43,6 +55,20 @@ class GrpcAsyncServiceContextBase {
   bool finished_ = false;
 };
 
+// tag of the read, write or finish events of a streaming call, the events are forwarded to the context of the call,
+// which owns the tag
+class GrpcAsyncStreamEvent : public GrpcAsyncServiceContextBase {
+ public:
+  explicit GrpcAsyncStreamEvent(std::function<void(bool)> handler) : handler_(std::move(handler)) {}
+  ~GrpcAsyncStreamEvent() = default;
+
+  void NewAndHandleRequest() override {}
+  void HandleEvent(bool rpc_ok) override { handler_(rpc_ok); }
+
+ private:
+  std::function<void(bool)> handler_;
+};
+
 template <class ServiceImpl, class AsyncService, class Derived>
 class GrpcAsyncServiceContext : public GrpcAsyncServiceContextBase {
  public:
@@ -78,13 +104,20 @@ class GrpcAsyncServer {
   GrpcAsyncServer() {}
   virtual ~GrpcAsyncServer() { Stop(); }
 
-  virtual void EnqueueRequests() = 0;
+  // enqueue the first request context of every rpc method to the completion queue
+  virtual void EnqueueRequests(grpc::ServerCompletionQueue *cq) = 0;
 
+  // every completion queue is drained by its own thread, a request context is always served by the completion queue
+  // where it is enqueued
   Status Start(const std::string &socket_address, const SSLConfig &ssl_config, int max_msg_mb_size,
-               const std::string &server_tag) {
+               const std::string &server_tag, uint32_t thread_num = 1) {
     if (in_running_) {
       return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: " << server_tag << " server is already running";
     }
+    if (thread_num == 0) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Serving Error: " << server_tag << " server thread number should be positive";
+    }
 
     grpc::ServerBuilder builder;
     if (max_msg_mb_size > 0) {
@@ -104,16 +137,22 @@ class GrpcAsyncServer {
     builder.AddListeningPort(socket_address, creds, &port_tcpip);
     status = RegisterService(&builder);
     if (status != SUCCESS) return status;
-    cq_ = builder.AddCompletionQueue();
+    for (uint32_t i = 0; i < thread_num; i++) {
+      cqs_.push_back(builder.AddCompletionQueue());
+    }
     server_ = builder.BuildAndStart();
     if (!server_) {
+      cqs_.clear();
       return INFER_STATUS_LOG_ERROR(FAILED) << "Serving Error: " << server_tag
                                             << " server start failed, create server failed, address " << socket_address;
     }
-    auto grpc_server_run = [this]() { HandleRequests(); };
-    grpc_thread_ = std::thread(grpc_server_run);
+    for (auto &cq : cqs_) {
+      auto grpc_server_run = [this, cq = cq.get()]() { HandleRequests(cq); };
+      grpc_threads_.emplace_back(grpc_server_run);
+    }
     in_running_ = true;
-    MSI_LOG(INFO) << server_tag << " server start success, listening on " << socket_address;
+    MSI_LOG(INFO) << server_tag << " server start success, listening on " << socket_address << ", thread number "
+                  << thread_num;
     std::cout << "Serving: " << server_tag << " server start success, listening on " << socket_address << std::endl;
     return SUCCESS;
   }
@@ -153,11 +192,11 @@ class GrpcAsyncServer {
     return grpc::SslServerCredentials(ssl_ops);
   }
 
-  Status HandleRequests() {
+  Status HandleRequests(grpc::ServerCompletionQueue *cq) {
     void *tag;
     bool ok = false;
-    EnqueueRequests();
-    while (cq_->Next(&tag, &ok)) {
+    EnqueueRequests(cq);
+    while (cq->Next(&tag, &ok)) {
       ProcessRequest(tag, ok);
     }
     return SUCCESS;
@@ -168,11 +207,15 @@ class GrpcAsyncServer {
       if (server_) {
         server_->Shutdown();
       }
-      // Always shutdown the completion queue after the server.
-      if (cq_) {
-        cq_->Shutdown();
+      // Always shutdown the completion queues after the server.
+      for (auto &cq : cqs_) {
+        cq->Shutdown();
+      }
+      for (auto &thread : grpc_threads_) {
+        thread.join();
       }
-      grpc_thread_.join();
+      grpc_threads_.clear();
+      cqs_.clear();
     }
     in_running_ = false;
   }
@@ -184,22 +227,17 @@ class GrpcAsyncServer {
 
   void ProcessRequest(void *tag, bool rpc_ok) {
     auto rq = static_cast<GrpcAsyncServiceContextBase *>(tag);
-    if (rq->HasFinish() || !rpc_ok) {  // !rpc_ok: cancel get request when shutting down.
-      delete rq;
-    } else {
-      rq->NewAndHandleRequest();
-      rq->SetFinish();  // will delete next time
-    }
+    rq->HandleEvent(rpc_ok);
   }
 
  protected:
-  std::unique_ptr<grpc::ServerCompletionQueue> cq_;
+  std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs_;
   std::unique_ptr<grpc::Server> server_;
 
   AsyncService svc_;
 
   bool in_running_ = false;
-  std::thread grpc_thread_;
+  std::vector<std::thread> grpc_threads_;
 };
 }  // namespace mindspore::serving
 
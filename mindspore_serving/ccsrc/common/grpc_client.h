@@ -25,6 +25,9 @@
 #include <thread>
 #include <string>
 #include <utility>
+#include <vector>
+#include <algorithm>
+#include <atomic>
 #include "common/serving_common.h"
 #include "proto/ms_service.pb.h"
 #include "proto/ms_service.grpc.pb.h"
@@ -40,55 +43,83 @@ using PredictOnFinish = std::function<void()>;
 
 using AsyncPredictCallback = std::function<void(Status status)>;
 
+constexpr uint32_t kDefaultClientThreadNum = 2;
+constexpr uint32_t kDefaultClientChannelNum = 2;
+
+// the rpcs are spread over a pool of completion queues, every completion queue is drained by its own thread, so that
+// the completion callbacks run in parallel
 template <typename Request, typename Reply, typename MSStub>
 class MSServiceClient {
  public:
   MSServiceClient() = default;
   ~MSServiceClient() {
     if (in_running_) {
-      cq_.Shutdown();
-      if (client_thread_.joinable()) {
-        try {
-          client_thread_.join();
-        } catch (const std::system_error &) {
-        } catch (...) {
+      for (auto &cq : cqs_) {
+        cq->Shutdown();
+      }
+      for (auto &client_thread : client_threads_) {
+        if (client_thread.joinable()) {
+          try {
+            client_thread.join();
+          } catch (const std::system_error &) {
+          } catch (...) {
+          }
         }
       }
     }
     in_running_ = false;
   }
 
-  void Start() {
-    client_thread_ = std::thread(&MSServiceClient::AsyncCompleteRpc, this);
+  void Start(uint32_t thread_num = kDefaultClientThreadNum) {
+    thread_num = std::max<uint32_t>(thread_num, 1);
+    for (uint32_t i = 0; i < thread_num; i++) {
+      cqs_.push_back(std::make_unique<grpc::CompletionQueue>());
+    }
+    for (auto &cq : cqs_) {
+      client_threads_.emplace_back(&MSServiceClient::AsyncCompleteRpc, this, cq.get());
+    }
     in_running_ = true;
   }
 
-  void AsyncCompleteRpc() {
+  void AsyncCompleteRpc(grpc::CompletionQueue *cq) {
     void *got_tag;
     bool ok = false;
 
-    while (cq_.Next(&got_tag, &ok)) {
+    while (cq->Next(&got_tag, &ok)) {
       AsyncClientCall *call = static_cast<AsyncClientCall *>(got_tag);
       if (call->status.ok()) {
         call->callback(SUCCESS);
       } else {
         MSI_LOG_ERROR << "RPC failed: " << call->status.error_code() << ", " << call->status.error_message()
                       << ", target address: " << call->target_address;
-        call->callback(Status(WORKER_UNAVAILABLE, call->status.error_message()));
+        call->callback(Status(GetRpcErrorCode(call->status), call->status.error_message()));
       }
       delete call;
     }
   }
 
+  // a failed rpc makes the worker unavailable, except an rpc rejected for its argument, which fails the batch and is
+  // counted as a failure of the worker
+  static StatusCode GetRpcErrorCode(const grpc::Status &status) {
+    if (status.error_code() == grpc::StatusCode::INVALID_ARGUMENT) {
+      return SYSTEM_ERROR;
+    }
+    return WORKER_UNAVAILABLE;
+  }
+
   void PredictAsync(const Request &request, Reply *reply, MSStub *stub, const AsyncPredictCallback &callback,
                     const std::string &target_address) {
-    AsyncClientCall *call = new AsyncClientCall;
-    call->reply = reply;
-    call->callback = callback;
-    call->target_address = target_address;
-    call->response_reader = stub->PrepareAsyncPredict(&call->context, request, &cq_);
-    call->response_reader->StartCall();
-    call->response_reader->Finish(call->reply, &call->status, call);
+    AsyncClientCall *call = NewCall(reply, callback, target_address);
+    call->response_reader = stub->PrepareAsyncPredict(&call->context, request, NextCompletionQueue());
+    StartCall(call);
+  }
+
+  // only for the stubs with PredictPassthrough
+  void PredictPassthroughAsync(const Request &request, Reply *reply, MSStub *stub,
+                               const AsyncPredictCallback &callback, const std::string &target_address) {
+    AsyncClientCall *call = NewCall(reply, callback, target_address);
+    call->response_reader = stub->PrepareAsyncPredictPassthrough(&call->context, request, NextCompletionQueue());
+    StartCall(call);
   }
 
  private:
@@ -101,12 +132,31 @@ class MSServiceClient {
     std::shared_ptr<grpc::ClientAsyncResponseReader<Reply>> response_reader;
   };
 
-  grpc::CompletionQueue cq_;
-  std::thread client_thread_;
+  AsyncClientCall *NewCall(Reply *reply, const AsyncPredictCallback &callback, const std::string &target_address) {
+    AsyncClientCall *call = new AsyncClientCall;
+    call->reply = reply;
+    call->callback = callback;
+    call->target_address = target_address;
+    return call;
+  }
+
+  grpc::CompletionQueue *NextCompletionQueue() {
+    return cqs_[next_cq_index_.fetch_add(1, std::memory_order_relaxed) % cqs_.size()].get();
+  }
+
+  static void StartCall(AsyncClientCall *call) {
+    call->response_reader->StartCall();
+    call->response_reader->Finish(call->reply, &call->status, call);
+  }
+
+  std::vector<std::unique_ptr<grpc::CompletionQueue>> cqs_;
+  std::vector<std::thread> client_threads_;
+  std::atomic<uint64_t> next_cq_index_{0};
   bool in_running_ = false;
 };
 
-using MSPredictClient = MSServiceClient<proto::PredictRequest, proto::PredictReply, proto::MSWorker::Stub>;
+using MSPredictClient =
+  MSServiceClient<proto::PassthroughPredictRequest, proto::PassthroughPredictReply, proto::MSWorker::Stub>;
 using MSDistributedClient =
   MSServiceClient<proto::DistributedPredictRequest, proto::DistributedPredictReply, proto::MSAgent::Stub>;
 extern std::unique_ptr<MSPredictClient> client_;
@@ -15,10 +15,11 @@
  */
 
 #include "common/grpc_server.h"
+#include <algorithm>
 
 namespace mindspore::serving {
 Status GrpcServer::Start(const std::shared_ptr<grpc::Service> &service, const std::string &server_address,
-                         int max_msg_mb_size, const std::string &server_tag) {
+                         int max_msg_mb_size, const std::string &server_tag, uint32_t thread_num) {
   service_ = service;
   if (in_running_) {
     return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: " << server_tag << " server is already running";
@@ -32,6 +33,10 @@ Status GrpcServer::Start(const std::shared_ptr<grpc::Service> &service, const st
     (void)serverBuilder.SetMaxSendMessageSize(max_msg_mb_size * mbytes_to_bytes);
     (void)serverBuilder.SetMaxReceiveMessageSize(max_msg_mb_size * mbytes_to_bytes);
   }
+  if (thread_num > 1) {
+    (void)serverBuilder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS,
+                                            static_cast<int>(thread_num));
+  }
   (void)serverBuilder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
   (void)serverBuilder.RegisterService(service.get());
   server_ = serverBuilder.BuildAndStart();
@@ -67,4 +72,18 @@ std::shared_ptr<grpc::Channel> GrpcServer::CreateChannel(const std::string &targ
     grpc::CreateCustomChannel(target_str, grpc::InsecureChannelCredentials(), channel_args);
   return channel;
 }
+
+std::vector<std::shared_ptr<grpc::Channel>> GrpcServer::CreateChannels(const std::string &target_str,
+                                                                       uint32_t channel_num) {
+  grpc::ChannelArguments channel_args;
+  constexpr int mbytes_to_bytes = static_cast<int>(1u << 20);
+  channel_args.SetInt(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH, gRpcMaxMBMsgSize * mbytes_to_bytes);
+  // channels with the same arguments share the subchannels of the global pool, and then the same connection
+  channel_args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  for (uint32_t i = 0; i < std::max<uint32_t>(channel_num, 1); i++) {
+    channels.push_back(grpc::CreateCustomChannel(target_str, grpc::InsecureChannelCredentials(), channel_args));
+  }
+  return channels;
+}
 }  // namespace mindspore::serving
@@ -24,6 +24,7 @@
 #include <utility>
 #include <string>
 #include <future>
+#include <vector>
 #include "common/serving_common.h"
 
 namespace mindspore::serving {
@@ -35,10 +36,15 @@ class GrpcServer {
   GrpcServer() = default;
   ~GrpcServer() noexcept { Stop(); }
 
+  // thread_num is the number of completion queues of the synchronous server, each polled by its own threads
   Status Start(const std::shared_ptr<grpc::Service> &service, const std::string &server_address, int max_msg_size,
-               const std::string &server_tag);
+               const std::string &server_tag, uint32_t thread_num = 1);
   void Stop();
   static std::shared_ptr<grpc::Channel> CreateChannel(const std::string &target_str);
+  // every channel owns its connection to the target, so that the rpcs spread over the channels are not multiplexed
+  // into one connection
+  static std::vector<std::shared_ptr<grpc::Channel>> CreateChannels(const std::string &target_str,
+                                                                    uint32_t channel_num);
 
  private:
   std::unique_ptr<grpc::Server> server_;
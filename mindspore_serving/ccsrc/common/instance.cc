@@ -0,0 +1,58 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/instance.h"
+
+namespace mindspore::serving {
+namespace {
+constexpr size_t kMaxFreeInstanceCount = 1024;  // of one shard
+constexpr size_t kMaxFreeStageStateCount = 256;
+}  // namespace
+
+void InstanceStageState::Reset() {
+  wait_count.clear();
+  finished = false;
+}
+
+void Instance::Reset() {
+  data.clear();
+  method_def = nullptr;
+  stage_index = 0;
+  stage_max = 0;
+  for (auto &item : stage_data_list) {
+    item.clear();
+  }
+  user_id = 0;
+  priority = 0;
+  deadline = std::chrono::steady_clock::time_point::max();
+  session = nullptr;
+  error_msg = SUCCESS;
+  enqueue_time = {};
+  stage_state = nullptr;
+  request_instance = nullptr;
+}
+
+// never destroyed, instances may be released by threads still running at exit
+ObjectPool<Instance> &GetInstancePool() {
+  static auto pool = new ObjectPool<Instance>(kMaxFreeInstanceCount);
+  return *pool;
+}
+
+ObjectPool<InstanceStageState> &GetInstanceStageStatePool() {
+  static auto pool = new ObjectPool<InstanceStageState>(kMaxFreeStageStateCount);
+  return *pool;
+}
+}  // namespace mindspore::serving
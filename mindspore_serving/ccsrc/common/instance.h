@@ -17,26 +17,57 @@
 #ifndef MINDSPORE_SERVING_INSTANCE_H
 #define MINDSPORE_SERVING_INSTANCE_H
 
-#include <map>
 #include <memory>
+#include <chrono>
+#include <mutex>
+#include <vector>
 #include "common/serving_common.h"
 #include "common/servable.h"
 #include "common/instance_data.h"
+#include "common/object_pool.h"
 
 namespace mindspore::serving {
+// stages of one request instance when stages of the method run concurrently
+struct InstanceStageState {
+  std::mutex lock;
+  std::vector<size_t> wait_count;  // count of unfinished depend stages, indexed by stage index
+  bool finished = false;           // replied, results of the other running stages are dropped
+
+  void Reset();
+};
+
+struct Instance;
+using InstancePtr = std::shared_ptr<Instance>;
+struct InferSession;
+
 struct Instance {
   InstanceData data;  // for inputs of function, predict, output
 
   const MethodSignature *method_def = nullptr;
   uint64_t stage_index = 0;
   uint64_t stage_max = 0;
-  std::map<size_t, InstanceData> stage_data_list;  // input: 0, stage: 1-n
+  std::vector<InstanceData> stage_data_list;  // indexed by stage index, input: 0, stage: 1-n
 
   uint64_t user_id = 0;
+  uint32_t priority = 0;  // priority of the request, the instances of higher priority are popped first in each stage
+  // deadline of the request, the instance is dropped instead of run by the stages after it
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+  std::shared_ptr<InferSession> session;  // request the instance belongs to, replied without any global lock
   Status error_msg = SUCCESS;
+  std::chrono::steady_clock::time_point enqueue_time;  // time pushed into the task queue of current stage
+
+  // not null when stages of the method run concurrently
+  std::shared_ptr<InstanceStageState> stage_state;
+  // instance of one running stage that is not run alone, refers to the request instance
+  InstancePtr request_instance;
+
+  // clear for reuse, keeping the memory of data and stage_data_list
+  void Reset();
 };
 
-using InstancePtr = std::shared_ptr<Instance>;
+// instances and stage states are recycled when released, the worker allocates none of them once warmed up
+ObjectPool<Instance> &GetInstancePool();
+ObjectPool<InstanceStageState> &GetInstanceStageStatePool();
 }  // namespace mindspore::serving
 
 #endif  // MINDSPORE_SERVING_INSTANCE_H
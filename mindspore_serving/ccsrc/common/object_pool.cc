@@ -0,0 +1,96 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/object_pool.h"
+#include <new>
+
+namespace mindspore::serving {
+ObjectPoolBase::ObjectPoolBase(size_t max_free_count) : max_free_count_(max_free_count) {}
+
+ObjectPoolBase::~ObjectPoolBase() {
+  for (auto &shard : shards_) {
+    for (auto block : shard.blocks) {
+      ::operator delete(block);
+    }
+    shard.blocks.clear();
+  }
+}
+
+ObjectPoolStats ObjectPoolBase::GetStats() const {
+  ObjectPoolStats stats;
+  stats.acquire_count = acquire_count_;
+  stats.reuse_count = reuse_count_;
+  stats.alloc_count = alloc_count_;
+  stats.drop_count = drop_count_;
+  return stats;
+}
+
+void *ObjectPoolBase::PopFree(std::vector<void *> Shard::*free_list, std::atomic<uint64_t> *pop_index) {
+  auto start = (*pop_index)++;
+  for (size_t i = 0; i < kShardCount; i++) {
+    auto &shard = shards_[(start + i) % kShardCount];
+    std::unique_lock<std::mutex> lock(shard.lock);
+    auto &items = shard.*free_list;
+    if (!items.empty()) {
+      auto item = items.back();
+      items.pop_back();
+      return item;
+    }
+  }
+  return nullptr;
+}
+
+bool ObjectPoolBase::PushFree(std::vector<void *> Shard::*free_list, std::atomic<uint64_t> *push_index,
+                              void *item) {
+  auto &shard = shards_[(*push_index)++ % kShardCount];
+  std::unique_lock<std::mutex> lock(shard.lock);
+  auto &items = shard.*free_list;
+  if (items.size() >= max_free_count_) {
+    return false;
+  }
+  items.push_back(item);
+  return true;
+}
+
+void *ObjectPoolBase::PopObject() { return PopFree(&Shard::objects, &object_pop_index_); }
+
+bool ObjectPoolBase::PushObject(void *object) {
+  if (PushFree(&Shard::objects, &object_push_index_, object)) {
+    return true;
+  }
+  drop_count_++;
+  return false;
+}
+
+void *ObjectPoolBase::AllocBlock(size_t size) {
+  size_t block_size = 0;
+  if (block_size_.compare_exchange_strong(block_size, size) || block_size == size) {
+    auto block = PopFree(&Shard::blocks, &block_pop_index_);
+    if (block != nullptr) {
+      return block;
+    }
+  }
+  alloc_count_++;
+  return ::operator new(size);
+}
+
+void ObjectPoolBase::FreeBlock(void *block, size_t size) noexcept {
+  if (size == block_size_ && PushFree(&Shard::blocks, &block_push_index_, block)) {
+    return;
+  }
+  ::operator delete(block);
+}
+}  // namespace mindspore::serving
@@ -0,0 +1,142 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_SERVING_OBJECT_POOL_H
+#define MINDSPORE_SERVING_OBJECT_POOL_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mindspore::serving {
+struct ObjectPoolStats {
+  uint64_t acquire_count = 0;  // objects acquired
+  uint64_t reuse_count = 0;    // objects acquired from the pool
+  uint64_t alloc_count = 0;    // heap allocations of objects and control blocks of their shared_ptr
+  uint64_t drop_count = 0;     // released objects freed because the pool is full
+};
+
+// free objects and free control blocks of shared_ptr, both kept in shards to spread the lock of the
+// threads acquiring and releasing objects at the same time
+class ObjectPoolBase {
+ public:
+  explicit ObjectPoolBase(size_t max_free_count);
+  virtual ~ObjectPoolBase();
+  ObjectPoolStats GetStats() const;
+  static constexpr size_t kShardCount = 8;
+
+  void *AllocBlock(size_t size);
+  void FreeBlock(void *block, size_t size) noexcept;
+
+ protected:
+  // nullptr if no free object
+  void *PopObject();
+  // false if the pool is full
+  bool PushObject(void *object);
+
+  struct Shard {
+    std::mutex lock;
+    std::vector<void *> objects;
+    std::vector<void *> blocks;
+  };
+  std::array<Shard, kShardCount> shards_;
+  size_t max_free_count_ = 0;  // free objects and free blocks of one shard
+  // control blocks of shared_ptr of one object type are of the same size
+  std::atomic<size_t> block_size_ = 0;
+  // shards the objects and blocks are pushed to and popped from in turn
+  std::atomic<uint64_t> object_push_index_ = 0;
+  std::atomic<uint64_t> object_pop_index_ = 0;
+  std::atomic<uint64_t> block_push_index_ = 0;
+  std::atomic<uint64_t> block_pop_index_ = 0;
+
+  std::atomic<uint64_t> acquire_count_ = 0;
+  std::atomic<uint64_t> reuse_count_ = 0;
+  std::atomic<uint64_t> alloc_count_ = 0;
+  std::atomic<uint64_t> drop_count_ = 0;
+
+ private:
+  void *PopFree(std::vector<void *> Shard::*free_list, std::atomic<uint64_t> *pop_index);
+  bool PushFree(std::vector<void *> Shard::*free_list, std::atomic<uint64_t> *push_index, void *item);
+};
+
+template <typename U>
+class PoolBlockAllocator {
+ public:
+  using value_type = U;
+  explicit PoolBlockAllocator(ObjectPoolBase *pool) noexcept : pool_(pool) {}
+  template <typename V>
+  PoolBlockAllocator(const PoolBlockAllocator<V> &other) noexcept : pool_(other.pool()) {}  // NOLINT(runtime/explicit)
+
+  U *allocate(size_t n) { return static_cast<U *>(pool_->AllocBlock(n * sizeof(U))); }
+  void deallocate(U *block, size_t n) noexcept { pool_->FreeBlock(block, n * sizeof(U)); }
+  ObjectPoolBase *pool() const noexcept { return pool_; }
+
+  template <typename V>
+  bool operator==(const PoolBlockAllocator<V> &other) const noexcept {
+    return pool_ == other.pool();
+  }
+  template <typename V>
+  bool operator!=(const PoolBlockAllocator<V> &other) const noexcept {
+    return pool_ != other.pool();
+  }
+
+ private:
+  ObjectPoolBase *pool_;
+};
+
+// objects are reset by T::Reset and returned to the pool when the last shared_ptr is released, the members keep
+// their memory, so that acquiring objects of the same shape does not allocate once the pool is warmed up
+template <typename T>
+class ObjectPool : public ObjectPoolBase {
+ public:
+  explicit ObjectPool(size_t max_free_count) : ObjectPoolBase(max_free_count) {}
+  ~ObjectPool() override {
+    for (auto &shard : shards_) {
+      for (auto object : shard.objects) {
+        delete static_cast<T *>(object);
+      }
+      shard.objects.clear();
+    }
+  }
+
+  std::shared_ptr<T> Acquire() {
+    acquire_count_++;
+    auto object = static_cast<T *>(PopObject());
+    if (object != nullptr) {
+      reuse_count_++;
+    } else {
+      object = new T();
+      alloc_count_++;
+    }
+    return std::shared_ptr<T>(object, Recycler{this}, PoolBlockAllocator<T>(this));
+  }
+
+ private:
+  struct Recycler {
+    ObjectPool<T> *pool;
+    void operator()(T *object) const {
+      object->Reset();
+      if (!pool->PushObject(object)) {
+        delete object;
+      }
+    }
+  };
+};
+}  // namespace mindspore::serving
+
+#endif  // MINDSPORE_SERVING_OBJECT_POOL_H
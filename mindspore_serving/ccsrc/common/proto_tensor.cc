@@ -20,6 +20,9 @@
 #include <string>
 #include <algorithm>
 #include <map>
+#include <set>
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
 #include "common/buffer_tensor.h"
 #include "common/servable.h"
 #include "master/dispacther.h"
@@ -32,6 +35,61 @@ using std::vector;
 namespace mindspore::serving {
 const size_t kMaxShapeElementCount = INT32_MAX;
 
+namespace {
+std::chrono::steady_clock::time_point GetRequestDeadline(const proto::ServableSpec &servable_spec) {
+  if (servable_spec.timeout_us() == 0) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  auto now = std::chrono::steady_clock::now();
+  // a timeout beyond the max time point never expires
+  auto max_timeout_us =
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::time_point::max() - now).count();
+  if (servable_spec.timeout_us() > static_cast<uint64_t>(max_timeout_us)) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  return now + std::chrono::microseconds(servable_spec.timeout_us());
+}
+
+// get the item names of a serialized proto::Instance, walking the wire format without decoding the tensors
+bool GetInstanceItemNames(const std::string &instance, std::set<std::string> *names) {
+  using google::protobuf::internal::WireFormatLite;
+  constexpr int kItemsFieldNumber = 1;  // items of proto::Instance, and key of its map entry
+  auto is_items_field = [](uint32_t tag) {
+    return WireFormatLite::GetTagFieldNumber(tag) == kItemsFieldNumber &&
+           WireFormatLite::GetTagWireType(tag) == WireFormatLite::WIRETYPE_LENGTH_DELIMITED;
+  };
+  google::protobuf::io::CodedInputStream input(reinterpret_cast<const uint8_t *>(instance.data()),
+                                              static_cast<int>(instance.size()));
+  for (uint32_t tag = input.ReadTag(); tag != 0; tag = input.ReadTag()) {
+    if (!is_items_field(tag)) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return false;
+      }
+      continue;
+    }
+    uint32_t entry_size = 0;
+    if (!input.ReadVarint32(&entry_size)) {
+      return false;
+    }
+    auto limit = input.PushLimit(static_cast<int>(entry_size));
+    std::string name;
+    for (uint32_t entry_tag = input.ReadTag(); entry_tag != 0; entry_tag = input.ReadTag()) {
+      bool ok = is_items_field(entry_tag) ? WireFormatLite::ReadString(&input, &name)
+                                          : WireFormatLite::SkipField(&input, entry_tag);
+      if (!ok) {
+        return false;
+      }
+    }
+    if (!input.ConsumedEntireMessage()) {
+      return false;
+    }
+    input.PopLimit(limit);
+    (void)names->insert(name);
+  }
+  return input.ConsumedEntireMessage();
+}
+}  // namespace
+
 ProtoTensor::ProtoTensor(proto::Tensor *other) : tensor_(other) {}
 
 ProtoTensor::~ProtoTensor() {}
@@ -220,6 +278,31 @@ void GrpcTensorHelper::GetRequestSpec(const proto::PredictRequest &request, Requ
   request_spec->servable_name = request.servable_spec().name();
   request_spec->method_name = request.servable_spec().method_name();
   request_spec->version_number = request.servable_spec().version_number();
+  request_spec->priority = request.servable_spec().priority();
+  request_spec->deadline = GetRequestDeadline(request.servable_spec());
+}
+
+void GrpcTensorHelper::GetRequestSpec(const proto::PassthroughPredictRequest &request, RequestSpec *request_spec) {
+  MSI_EXCEPTION_IF_NULL(request_spec);
+  request_spec->servable_name = request.servable_spec().name();
+  request_spec->method_name = request.servable_spec().method_name();
+  request_spec->version_number = request.servable_spec().version_number();
+  request_spec->priority = request.servable_spec().priority();
+  request_spec->deadline = GetRequestDeadline(request.servable_spec());
+}
+
+void GrpcTensorHelper::SetRequestDeadline(std::chrono::steady_clock::time_point deadline,
+                                          proto::ServableSpec *servable_spec) {
+  MSI_EXCEPTION_IF_NULL(servable_spec);
+  if (deadline == std::chrono::steady_clock::time_point::max()) {
+    return;
+  }
+  auto time_left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+  // 0 means no limit, the deadline having passed is sent as 1us left
+  auto timeout_us = static_cast<uint64_t>(std::max<int64_t>(time_left.count(), 1));
+  if (servable_spec->timeout_us() == 0 || timeout_us < servable_spec->timeout_us()) {
+    servable_spec->set_timeout_us(timeout_us);
+  }
 }
 
 void GrpcTensorHelper::ConvertProtoWorkerSpec(const proto::RegisterRequest &proto_request, WorkerRegSpec *worker_spec) {
@@ -233,6 +316,7 @@ void GrpcTensorHelper::ConvertProtoWorkerSpec(const proto::RegisterRequest &prot
   servable_spec.servable_name = proto_spec.name();
   servable_spec.version_number = proto_spec.version_number();
   servable_spec.batch_size = proto_spec.batch_size();
+  servable_spec.capacity_weight = proto_spec.capacity_weight();
   servable_spec.own_device = proto_spec.own_device();
   for (const auto &proto_method : proto_spec.methods()) {
     ServableMethodInfo method_info;
@@ -256,6 +340,7 @@ void GrpcTensorHelper::ConvertWorkerSpec(const WorkerRegSpec &worker_spec, proto
   proto_spec->set_name(spec.servable_name);
   proto_spec->set_version_number(spec.version_number);
   proto_spec->set_batch_size(spec.batch_size);
+  proto_spec->set_capacity_weight(spec.capacity_weight);
   proto_spec->set_own_device(spec.own_device);
   for (auto &method : spec.methods) {
     auto proto_method = proto_spec->add_methods();
@@ -331,20 +416,56 @@ void GrpcTensorHelper::ConvertModelInfos(const std::map<std::string, ModelInfo>
 }
 
 Status GrpcTensorHelper::CreateInstanceFromRequest(const MethodSignature &method, const proto::PredictRequest &request,
-                                                   vector<InstanceData> *results) {
+                                                   vector<InstanceData> *results, vector<Status> *errors) {
   MSI_EXCEPTION_IF_NULL(results);
+  MSI_EXCEPTION_IF_NULL(errors);
   results->clear();
+  errors->clear();
 
-  Status status;
   if (request.instances_size() == 0) {
     return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
            << "Instances count of request cannot be 0, servable: " << method.servable_name
            << ", method: " << method.method_name;
   }
-  status = CreateInstanceFromRequestInstances(request, method, results);
-  if (status != SUCCESS) {
-    MSI_LOG_ERROR << "Create instances from request instances failed";
-    return status;
+  for (auto &proto_instance : request.instances()) {
+    InstanceData instance_data;
+    auto status = CreateInstanceFromRequestInstance(proto_instance, method, &instance_data);
+    results->push_back(std::move(instance_data));
+    errors->push_back(status);
+  }
+  return SUCCESS;
+}
+
+Status GrpcTensorHelper::CreateInstanceFromRequest(const MethodSignature &method,
+                                                   const proto::PassthroughPredictRequest &request,
+                                                   proto::PredictRequest *parsed_request,
+                                                   vector<InstanceData> *results, vector<Status> *errors) {
+  MSI_EXCEPTION_IF_NULL(parsed_request);
+  MSI_EXCEPTION_IF_NULL(results);
+  MSI_EXCEPTION_IF_NULL(errors);
+  results->clear();
+  errors->clear();
+
+  if (request.instances_size() == 0) {
+    return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+           << "Instances count of request cannot be 0, servable: " << method.servable_name
+           << ", method: " << method.method_name;
+  }
+  *parsed_request->mutable_servable_spec() = request.servable_spec();
+  for (int i = 0; i < request.instances_size(); i++) {
+    auto proto_instance = parsed_request->add_instances();
+    InstanceData instance_data;
+    Status status;
+    if (!proto_instance->ParseFromString(request.instances(i))) {
+      proto_instance->Clear();
+      status = INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+               << "Parse instance " << i << " of request failed, servable " << method.servable_name << ", method "
+               << method.method_name;
+    } else {
+      status = CreateInstanceFromRequestInstance(*proto_instance, method, &instance_data);
+    }
+    results->push_back(std::move(instance_data));
+    errors->push_back(status);
   }
   return SUCCESS;
 }
@@ -357,10 +478,19 @@ void GrpcTensorHelper::CreateReplyFromInstances(const proto::PredictRequest &req
   }
 }
 
+Status GrpcTensorHelper::GetInstanceCheckError(const std::vector<proto::ErrorMsg> &errors) {
+  for (auto &error : errors) {
+    if (error.error_code() == INVALID_INSTANCE) {
+      return Status(INVALID_INPUTS, error.error_msg());
+    }
+  }
+  return SUCCESS;
+}
+
 Status GrpcTensorHelper::CreateInstanceFromPredictReply(const RequestSpec &request_spec,
-                                                        const proto::PredictReply &reply,
+                                                        const proto::PassthroughPredictReply &reply,
                                                         std::vector<proto::ErrorMsg> *error,
-                                                        std::vector<const proto::Instance *> *results) {
+                                                        std::vector<const std::string *> *results) {
   MSI_EXCEPTION_IF_NULL(error);
   MSI_EXCEPTION_IF_NULL(results);
   results->clear();
@@ -378,17 +508,9 @@ Status GrpcTensorHelper::CreateInstanceFromPredictReply(const RequestSpec &reque
   return SUCCESS;
 }
 
-Status GrpcTensorHelper::CreatePredictReplyFromInstances(const proto::PredictRequest &request,
-                                                         const std::vector<proto::ErrorMsg> &errors,
-                                                         const std::vector<const proto::Instance *> &instances,
-                                                         proto::PredictReply *reply) {
-  MSI_EXCEPTION_IF_NULL(reply);
-  for (auto &instance : instances) {
-    auto proto_instance = reply->add_instances();
-    if (instance) {
-      *proto_instance->mutable_items() = instance->items();
-    }
-  }
+namespace {
+template <class Reply>
+void AddReplyErrorMsg(const std::vector<proto::ErrorMsg> &errors, Reply *reply) {
   bool all_ok = true;
   bool all_same = true;
   for (auto &error : errors) {
@@ -413,17 +535,64 @@ Status GrpcTensorHelper::CreatePredictReplyFromInstances(const proto::PredictReq
       }
     }
   }
+}
+
+template <class Reply>
+void AddReplyErrorMsg(const Status &error_msg, Reply *reply) {
+  if (error_msg == SUCCESS) {
+    return;
+  }
+  reply->clear_error_msg();
+  reply->clear_instances();
+  auto proto_error_msg = reply->add_error_msg();
+  proto_error_msg->set_error_code(error_msg.StatusCode());
+  std::string error_msg_str = error_msg.StatusMessage();
+  if (error_msg_str.empty()) {
+    proto_error_msg->set_error_msg("Predict failed");
+  } else {
+    proto_error_msg->set_error_msg(error_msg_str);
+  }
+}
+}  // namespace
+
+Status GrpcTensorHelper::CreatePredictReplyFromInstances(const std::vector<proto::ErrorMsg> &errors,
+                                                         const std::vector<const std::string *> &instances,
+                                                         proto::PredictReply *reply) {
+  MSI_EXCEPTION_IF_NULL(reply);
+  for (auto &instance : instances) {
+    auto proto_instance = reply->add_instances();
+    if (instance && !proto_instance->ParseFromString(*instance)) {
+      return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Parse reply instance failed";
+    }
+  }
+  AddReplyErrorMsg(errors, reply);
+  return SUCCESS;
+}
+
+Status GrpcTensorHelper::CreatePredictReplyFromInstances(const std::vector<proto::ErrorMsg> &errors,
+                                                         const std::vector<const std::string *> &instances,
+                                                         proto::PassthroughPredictReply *reply) {
+  MSI_EXCEPTION_IF_NULL(reply);
+  for (auto &instance : instances) {
+    auto proto_instance = reply->add_instances();
+    if (instance) {
+      *proto_instance = *instance;
+    }
+  }
+  AddReplyErrorMsg(errors, reply);
   return SUCCESS;
 }
 
 Status GrpcTensorHelper::CreatePredictRequestFromInstances(const RequestSpec &request_spec,
-                                                           const std::vector<const proto::Instance *> &instances,
-                                                           proto::PredictRequest *request) {
+                                                           const std::vector<const std::string *> &instances,
+                                                           proto::PassthroughPredictRequest *request) {
   MSI_EXCEPTION_IF_NULL(request);
   auto proto_spec = request->mutable_servable_spec();
   proto_spec->set_name(request_spec.servable_name);
   proto_spec->set_method_name(request_spec.method_name);
   proto_spec->set_version_number(request_spec.version_number);
+  proto_spec->set_priority(request_spec.priority);
+  SetRequestDeadline(request_spec.deadline, proto_spec);
   for (auto &instance : instances) {
     auto proto_instance = request->add_instances();
     *proto_instance = *instance;
@@ -512,66 +681,62 @@ Status GrpcTensorHelper::CreateReplyFromInstancesInner(const proto::PredictReque
   return SUCCESS;
 }
 
-Status GrpcTensorHelper::CreateInstanceFromRequestInstances(const proto::PredictRequest &request,
-                                                            const MethodSignature &method,
-                                                            std::vector<InstanceData> *results) {
-  MSI_EXCEPTION_IF_NULL(results);
-  auto servable_name = request.servable_spec().name();
-  auto method_name = request.servable_spec().method_name();
+Status GrpcTensorHelper::CreateInstanceFromRequestInstance(const proto::Instance &proto_instance,
+                                                           const MethodSignature &method,
+                                                           InstanceData *instance_data) {
+  MSI_EXCEPTION_IF_NULL(instance_data);
+  auto &servable_name = method.servable_name;
+  auto &method_name = method.method_name;
   Status status;
   auto &input_names = method.inputs;
   auto &output_names = method.outputs;
-  for (auto &proto_instance : request.instances()) {
-    InstanceData instance_data;
-    for (const auto &input_name : input_names) {
-      auto it = proto_instance.items().find(input_name);
-      if (it == proto_instance.items().end()) {
-        return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
-               << "Cannot find input " << input_name << " in instance input , servable " << servable_name << ", method "
-               << method_name;
-      }
-      auto &tensor_proto = it->second;
-      status = CheckRequestTensor(tensor_proto);
+  for (const auto &input_name : input_names) {
+    auto it = proto_instance.items().find(input_name);
+    if (it == proto_instance.items().end()) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Cannot find input " << input_name << " in instance input , servable " << servable_name << ", method "
+             << method_name;
+    }
+    auto &tensor_proto = it->second;
+    status = CheckRequestTensor(tensor_proto);
+    if (status != SUCCESS) {
+      auto status2 = INFER_STATUS(INVALID_INPUTS) << "Instances input " << input_name << " check failed";
+      MSI_LOG_ERROR << status2.StatusMessage();
+      return Status(INVALID_INPUTS, status2.StatusMessage() + ", detail: " + status.StatusMessage());
+    }
+    auto add_tensor = std::make_shared<ProtoTensor>(const_cast<proto::Tensor *>(&tensor_proto));
+    if (tensor_proto.has_shm_data()) {
+      status = add_tensor->AttachSharedMemory();
       if (status != SUCCESS) {
-        auto status2 = INFER_STATUS(INVALID_INPUTS) << "Instances input " << input_name << " check failed";
-        MSI_LOG_ERROR << status2.StatusMessage();
-        return Status(INVALID_INPUTS, status2.StatusMessage() + ", detail: " + status.StatusMessage());
+        auto &shm_data = tensor_proto.shm_data();
+        MSI_LOG_ERROR << "Attach input shared memory failed, memory key: " << shm_data.memory_key()
+                      << ", bytes size: " << shm_data.bytes_size() << ", data offset: " << shm_data.data_offset()
+                      << ", data size: " << shm_data.data_size() << ", input name: " << input_name;
+        return status;
       }
-      auto add_tensor = std::make_shared<ProtoTensor>(const_cast<proto::Tensor *>(&tensor_proto));
-      if (tensor_proto.has_shm_data()) {
-        status = add_tensor->AttachSharedMemory();
-        if (status != SUCCESS) {
-          auto &shm_data = tensor_proto.shm_data();
-          MSI_LOG_ERROR << "Attach input shared memory failed, memory key: " << shm_data.memory_key()
-                        << ", bytes size: " << shm_data.bytes_size() << ", data offset: " << shm_data.data_offset()
-                        << ", data size: " << shm_data.data_size() << ", input name: " << input_name;
-          return status;
-        }
-      }
-      instance_data.push_back(add_tensor);
     }
-    auto &output_buffers = proto_instance.output_buffers();
-    if (!output_buffers.empty()) {
-      for (auto &buffer : output_buffers) {
-        auto it = std::find(output_names.begin(), output_names.end(), buffer.first);
-        if (it == output_names.end()) {
-          return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
-                 << "The name " << buffer.first << " of the output buffers cannot be found in the output names "
-                 << output_names << " of the method, servable " << servable_name << ", method " << method_name;
-        }
-        auto &shm_data = buffer.second;
-        SharedMemoryAttachItem item;
-        status = SharedMemoryManager::Instance().Attach(shm_data.memory_key(), shm_data.bytes_size(),
-                                                        shm_data.data_offset(), shm_data.data_size(), &item);
-        if (status != SUCCESS) {
-          MSI_LOG_ERROR << "Attach output shared memory failed, memory key: " << shm_data.memory_key()
-                        << ", bytes size: " << shm_data.bytes_size() << ", data offset: " << shm_data.data_offset()
-                        << ", data size: " << shm_data.data_size() << ", output name: " << buffer.first;
-          return status;
-        }
+    instance_data->push_back(add_tensor);
+  }
+  auto &output_buffers = proto_instance.output_buffers();
+  if (!output_buffers.empty()) {
+    for (auto &buffer : output_buffers) {
+      auto it = std::find(output_names.begin(), output_names.end(), buffer.first);
+      if (it == output_names.end()) {
+        return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+               << "The name " << buffer.first << " of the output buffers cannot be found in the output names "
+               << output_names << " of the method, servable " << servable_name << ", method " << method_name;
+      }
+      auto &shm_data = buffer.second;
+      SharedMemoryAttachItem item;
+      status = SharedMemoryManager::Instance().Attach(shm_data.memory_key(), shm_data.bytes_size(),
+                                                      shm_data.data_offset(), shm_data.data_size(), &item);
+      if (status != SUCCESS) {
+        MSI_LOG_ERROR << "Attach output shared memory failed, memory key: " << shm_data.memory_key()
+                      << ", bytes size: " << shm_data.bytes_size() << ", data offset: " << shm_data.data_offset()
+                      << ", data size: " << shm_data.data_size() << ", output name: " << buffer.first;
+        return status;
       }
     }
-    results->push_back(instance_data);
   }
   return SUCCESS;
 }
@@ -600,6 +765,28 @@ Status GrpcTensorHelper::CheckRequestInstances(const proto::PredictRequest &requ
   return SUCCESS;
 }
 
+Status GrpcTensorHelper::CheckPassthroughInstances(const proto::PassthroughPredictRequest &request,
+                                                   const std::vector<std::string> &input_names) {
+  auto &servable_name = request.servable_spec().name();
+  auto &method_name = request.servable_spec().method_name();
+  for (int i = 0; i < request.instances_size(); i++) {
+    std::set<std::string> item_names;
+    if (!GetInstanceItemNames(request.instances(i), &item_names)) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Parse instance " << i << " of request failed, servable " << servable_name << ", method "
+             << method_name;
+    }
+    for (const auto &input_name : input_names) {
+      if (item_names.count(input_name) == 0) {
+        return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+               << "Cannot find input " << input_name << " in instance input , servable " << servable_name
+               << ", method " << method_name;
+      }
+    }
+  }
+  return SUCCESS;
+}
+
 void GrpcTensorHelper::CopyFromAgentSpec(const proto::AgentSpec &specs, WorkerAgentSpec *worker_specs) {
   worker_specs->rank_id = specs.rank_id();
   worker_specs->batch_size = specs.batch_size();
@@ -704,19 +891,12 @@ Status GrpcTensorHelper::CheckRequestTensor(const proto::Tensor &tensor) {
 
 void GrpcTensorHelper::CreateReplyFromErrorMsg(const Status &error_msg, proto::PredictReply *reply) {
   MSI_EXCEPTION_IF_NULL(reply);
-  if (error_msg == SUCCESS) {
-    return;
-  }
-  reply->clear_error_msg();
-  reply->clear_instances();
-  auto proto_error_msg = reply->add_error_msg();
-  proto_error_msg->set_error_code(error_msg.StatusCode());
-  std::string error_msg_str = error_msg.StatusMessage();
-  if (error_msg_str.empty()) {
-    proto_error_msg->set_error_msg("Predict failed");
-  } else {
-    proto_error_msg->set_error_msg(error_msg_str);
-  }
+  AddReplyErrorMsg(error_msg, reply);
+}
+
+void GrpcTensorHelper::CreateReplyFromErrorMsg(const Status &error_msg, proto::PassthroughPredictReply *reply) {
+  MSI_EXCEPTION_IF_NULL(reply);
+  AddReplyErrorMsg(error_msg, reply);
 }
 
 serving::LogStream &operator<<(serving::LogStream &stream, proto::DataType data_type) {
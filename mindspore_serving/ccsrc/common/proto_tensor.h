@@ -22,6 +22,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <chrono>
 #include "common/serving_common.h"
 #include "proto/ms_service.pb.h"
 #include "proto/ms_master.pb.h"
@@ -68,37 +69,58 @@ class ProtoTensor : public TensorBase {
 class MS_API GrpcTensorHelper {
  public:
   static void GetRequestSpec(const proto::PredictRequest &request, RequestSpec *request_spec);
+  static void GetRequestSpec(const proto::PassthroughPredictRequest &request, RequestSpec *request_spec);
+  // the deadline is sent as the time left, and taken if it is earlier than the one set
+  static void SetRequestDeadline(std::chrono::steady_clock::time_point deadline, proto::ServableSpec *servable_spec);
   static void ConvertProtoWorkerSpec(const proto::RegisterRequest &proto_request, WorkerRegSpec *worker_spec);
   static void ConvertWorkerSpec(const WorkerRegSpec &worker_spec, proto::RegisterRequest *proto_request);
   static void ConvertProtoModelInfos(const proto::ModelInfos &proto_model_infos,
                                      std::map<std::string, ModelInfo> *model_infos);
   static void ConvertModelInfos(const std::map<std::string, ModelInfo> &model_infos,
                                 proto::ModelInfos *proto_model_infos);
+  // the instances are checked one by one, an invalid instance gets its error in errors, without failing the other
+  // instances
   static Status CreateInstanceFromRequest(const MethodSignature &method, const proto::PredictRequest &request,
-                                          std::vector<InstanceData> *results);
+                                          std::vector<InstanceData> *results, std::vector<Status> *errors);
+  // the instances are parsed into parsed_request and checked one by one
+  static Status CreateInstanceFromRequest(const MethodSignature &method,
+                                          const proto::PassthroughPredictRequest &request,
+                                          proto::PredictRequest *parsed_request, std::vector<InstanceData> *results,
+                                          std::vector<Status> *errors);
   static void CreateReplyFromInstances(const proto::PredictRequest &request, const MethodSignature &method,
                                        const std::vector<InstancePtr> &instances, proto::PredictReply *reply);
   static void CreateReplyFromErrorMsg(const Status &error_msg, proto::PredictReply *reply);
+  static void CreateReplyFromErrorMsg(const Status &error_msg, proto::PassthroughPredictReply *reply);
   static void CopyFromAgentSpec(const proto::AgentSpec &request, WorkerAgentSpec *worker_specs);
   static void CopyFromWorkerAgentSpec(const std::vector<WorkerAgentSpec> &worker_specs,
                                       proto::AgentRegisterRequest *request);
+  // instances below are serialized proto::Instance, forwarded by the master without decoding
   static Status CreatePredictRequestFromInstances(const RequestSpec &request_spec,
-                                                  const std::vector<const proto::Instance *> &instances,
-                                                  proto::PredictRequest *request);
-  static Status CreatePredictReplyFromInstances(const proto::PredictRequest &request,
-                                                const std::vector<proto::ErrorMsg> &errors,
-                                                const std::vector<const proto::Instance *> &instances,
+                                                  const std::vector<const std::string *> &instances,
+                                                  proto::PassthroughPredictRequest *request);
+  // instance is nullptr if failed
+  static Status CreatePredictReplyFromInstances(const std::vector<proto::ErrorMsg> &errors,
+                                                const std::vector<const std::string *> &instances,
                                                 proto::PredictReply *reply);
-  static Status CreateInstanceFromPredictReply(const RequestSpec &request_spec, const proto::PredictReply &reply,
+  static Status CreatePredictReplyFromInstances(const std::vector<proto::ErrorMsg> &errors,
+                                                const std::vector<const std::string *> &instances,
+                                                proto::PassthroughPredictReply *reply);
+  // the first INVALID_INSTANCE error of the instances of a request, as the INVALID_INPUTS error of the request
+  static Status GetInstanceCheckError(const std::vector<proto::ErrorMsg> &errors);
+  static Status CreateInstanceFromPredictReply(const RequestSpec &request_spec,
+                                               const proto::PassthroughPredictReply &reply,
                                                std::vector<proto::ErrorMsg> *error,
-                                               std::vector<const proto::Instance *> *results);
+                                               std::vector<const std::string *> *results);
 
   static Status CheckRequestInstances(const proto::PredictRequest &request,
                                       const std::vector<std::string> &input_names);
+  // checks the input names of the serialized instances, without decoding their tensors
+  static Status CheckPassthroughInstances(const proto::PassthroughPredictRequest &request,
+                                          const std::vector<std::string> &input_names);
 
  private:
-  static Status CreateInstanceFromRequestInstances(const proto::PredictRequest &request, const MethodSignature &method,
-                                                   std::vector<InstanceData> *results);
+  static Status CreateInstanceFromRequestInstance(const proto::Instance &proto_instance, const MethodSignature &method,
+                                                  InstanceData *instance_data);
   static Status CheckRequestTensor(const proto::Tensor &tensor);
   static Status CreateReplyFromInstancesInner(const proto::PredictRequest &request, const MethodSignature &method,
                                               const std::vector<InstancePtr> &instances, proto::PredictReply *reply);
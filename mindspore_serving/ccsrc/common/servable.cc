@@ -114,6 +114,75 @@ void MethodSignature::SetReturn(const std::vector<std::pair<size_t, uint64_t>> &
 
 size_t MethodSignature::GetStageMax() const { return stage_index; }
 
+void MethodSignature::BuildStageGraph() {
+  auto stage_max = GetStageMax();
+  // stage inputs only refer to the method inputs and the previous stages, so stage index is a topological order
+  std::map<uint64_t, std::set<uint64_t>> ancestors;
+  for (auto &item : stage_map) {
+    auto &stage = item.second;
+    std::set<uint64_t> depends;
+    if (stage.stage_index == stage_max) {
+      for (auto &other : stage_map) {
+        if (other.first < stage_max) {
+          (void)depends.emplace(other.first);
+        }
+      }
+    } else {
+      for (auto &input : stage.stage_inputs) {
+        if (input.first >= kStageStartIndex) {
+          (void)depends.emplace(input.first);
+        }
+      }
+    }
+    stage.depend_stages.assign(depends.begin(), depends.end());
+    stage.next_stages.clear();
+    auto &stage_ancestors = ancestors[stage.stage_index];
+    for (auto depend : depends) {
+      stage_ancestors.insert(ancestors[depend].begin(), ancestors[depend].end());
+      (void)stage_ancestors.emplace(depend);
+    }
+  }
+  start_stages.clear();
+  for (auto &item : stage_map) {
+    auto &stage = item.second;
+    if (stage.depend_stages.empty()) {
+      start_stages.push_back(stage.stage_index);
+    }
+    for (auto depend : stage.depend_stages) {
+      stage_map[depend].next_stages.push_back(stage.stage_index);
+    }
+  }
+  parallel_stages = false;
+  for (auto &item : stage_map) {
+    auto &stage = item.second;
+    stage.run_alone = true;
+    for (auto &other : stage_map) {
+      if (other.first == stage.stage_index || other.first == stage_max || stage.stage_index == stage_max) {
+        continue;
+      }
+      auto &stage_ancestors = ancestors[stage.stage_index];
+      if (stage_ancestors.count(other.first) == 0 && ancestors[other.first].count(stage.stage_index) == 0) {
+        stage.run_alone = false;
+        parallel_stages = true;
+        break;
+      }
+    }
+  }
+  // fuse the chains of c++ function stages, and c++ function stages after model stages
+  for (auto &item : stage_map) {
+    auto &stage = item.second;
+    stage.run_inline = false;
+    if (parallel_stages || stage.stage_type != kMethodStageTypeCppFunction || stage.stage_index <= kStageStartIndex) {
+      continue;
+    }
+    auto prev_it = stage_map.find(stage.stage_index - 1);
+    if (prev_it != stage_map.end() && (prev_it->second.stage_type == kMethodStageTypeCppFunction ||
+                                       prev_it->second.stage_type == kMethodStageTypeModel)) {
+      stage.run_inline = true;
+    }
+  }
+}
+
 const MethodSignature *ServableSignature::GetMethodDeclare(const std::string &method_name) const {
   auto item =
     find_if(methods.begin(), methods.end(), [&](const MethodSignature &v) { return v.method_name == method_name; });
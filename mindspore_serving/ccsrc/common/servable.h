@@ -23,6 +23,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <chrono>
 #include "common/serving_common.h"
 #include "worker/inference/inference.h"
 
@@ -45,6 +46,12 @@ struct MethodStage {
   std::vector<std::pair<size_t, uint64_t>> stage_inputs;  // first: input- 0, stage- 1~n, second: output index
   // will be updated when model loaded
   uint64_t batch_size = 0;
+  // dependency graph of stages, built when the method is registered
+  std::vector<uint64_t> depend_stages;  // stages whose outputs are inputs of this stage, return depends on all stages
+  std::vector<uint64_t> next_stages;    // stages depending on this stage
+  bool run_alone = true;                // no other stage of one instance can run at the same time
+  // c++ function stage runs on the thread finishing the previous c++ function or model stage, without the task queue
+  bool run_inline = false;
 };
 
 static const uint64_t kStageStartIndex = 1;
@@ -63,6 +70,11 @@ struct MS_API MethodSignature {
   void SetReturn(const std::vector<std::pair<size_t, uint64_t>> &return_inputs);
   // the max stage is return, when reach max stage, all stage works done
   size_t GetStageMax() const;
+  // build depend_stages, next_stages, run_alone and run_inline of the stages from stage_inputs
+  void BuildStageGraph();
+
+  std::vector<uint64_t> start_stages;  // stages depending on the method inputs only
+  bool parallel_stages = false;        // whether some stages of one instance can run at the same time
 
  private:
   // stage index begin with 1, 0 reserve for input, include function, model, return stage
@@ -96,6 +108,7 @@ struct ServableRegSpec {
   std::string servable_name;
   uint64_t version_number = 0;
   uint64_t batch_size = 0;
+  uint64_t capacity_weight = 0;  // relative capacity among the workers, 0: proportional to the batch size
   bool own_device = true;
   std::vector<ServableMethodInfo> methods;
   std::map<std::string, ModelInfo> models;
@@ -112,6 +125,9 @@ struct RequestSpec {
   std::string servable_name;
   std::string method_name;
   uint64_t version_number = 0;  // not specified
+  uint32_t priority = 0;        // higher is served first
+  // the work of the request is dropped after the deadline
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
   std::string Repr() const;
 };
 
@@ -129,6 +145,10 @@ struct CommonModelMeta {
   std::vector<int> without_batch_dim_inputs;
   std::map<uint64_t, size_t> inputs_count;
   std::map<uint64_t, size_t> outputs_count;
+  // dynamic batching: hold a partial batch until preferred_batch_size instances are queued or the oldest instance
+  // has waited max_queue_delay_us, 0 means popping whatever is queued
+  uint64_t preferred_batch_size = 0;
+  uint64_t max_queue_delay_us = 0;
 };
 
 struct MS_API LocalModelMeta {
@@ -136,6 +156,12 @@ struct MS_API LocalModelMeta {
   ModelType model_format = ModelType::kUnknownType;  // OM, MindIR, MindIR_Lite
   ModelContext model_context;
   std::string config_file;
+  // model files of the same network exported with smaller batch sizes, the smallest one that fits is used to predict
+  std::vector<std::string> batch_bucket_files;
+  // model replicas loaded in one worker, each has its own predict thread and cores of thread_affinity_core_list
+  uint32_t replica_num = 1;
+  // input buffer sets of each replica, the next batch is assembled into another set while the current one executes
+  uint32_t input_buffer_num = 1;
   void SetModelFormat(const std::string &format);
 };
 
@@ -156,6 +182,7 @@ struct MS_API ServableSignature {
   std::string servable_name;
   std::vector<ModelMeta> model_metas;
   std::vector<MethodSignature> methods;
+  uint32_t cpp_stage_thread_num = 3;  // size of the thread pool running C++ stage functions
   const MethodSignature *GetMethodDeclare(const std::string &method_name) const;
   const ModelMeta *GetModelDeclare(const std::string &model_key) const;
 };
@@ -31,21 +31,37 @@ SharedMemoryAllocator::SharedMemoryAllocator() = default;
 SharedMemoryAllocator::~SharedMemoryAllocator() noexcept {
   std::unique_lock<std::mutex> lock(lock_);
   for (auto &item : memory_map_) {
-    auto &group = item.second;
-    for (auto &shm : group.shm_map) {
-      auto ret = munmap(shm.second.address, shm.second.bytes_size);
-      if (ret == -1) {
-        MSI_LOG_ERROR << "Failed to munmap, memory key: " << shm.second.memory_key;
-      }
-      ret = shm_unlink(shm.second.memory_key.c_str());
-      if (ret == -1) {
-        MSI_LOG_ERROR << "Failed to shm_unlink " << shm.second.memory_key << ", errno: " << errno;
-      }
-    }
+    FreeShmMemoryGroup(&item.second);
   }
   memory_map_.clear();
 }
 
+void SharedMemoryAllocator::FreeShmMemoryGroup(SharedMemoryGroup *shm_group) {
+  for (auto &shm : shm_group->shm_map) {
+    auto ret = munmap(shm.second.address, shm.second.bytes_size);
+    if (ret == -1) {
+      MSI_LOG_ERROR << "Failed to munmap, memory key: " << shm.second.memory_key;
+    }
+    ret = shm_unlink(shm.second.memory_key.c_str());
+    if (ret == -1) {
+      MSI_LOG_ERROR << "Failed to shm_unlink " << shm.second.memory_key << ", errno: " << errno;
+    }
+  }
+  shm_group->shm_map.clear();
+  shm_group->free_count = 0;
+}
+
+Status SharedMemoryAllocator::DeleteMemoryBuffer(const std::string &memory_key_prefix) {
+  std::unique_lock<std::mutex> lock(lock_);
+  auto it = memory_map_.find(memory_key_prefix);
+  if (it == memory_map_.end()) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Cannot find shared memory " << memory_key_prefix;
+  }
+  FreeShmMemoryGroup(&it->second);
+  (void)memory_map_.erase(it);
+  return SUCCESS;
+}
+
 Status SharedMemoryAllocator::AddShmMemoryBuffer(SharedMemoryGroup *shm_group) {
   auto item_size = shm_group->item_size;
   auto item_count = shm_group->item_count;
@@ -123,7 +139,7 @@ Status SharedMemoryAllocator::AllocMemoryItem(const std::string &memory_key_pref
     auto status = AddShmMemoryBuffer(&group);
     if (status != SUCCESS) {
       MSI_LOG_ERROR << "Alloc shared memory failed, memory key prefix: " << memory_key_prefix;
-      return SUCCESS;
+      return status;
     }
   }
   for (auto &item : group.shm_map) {
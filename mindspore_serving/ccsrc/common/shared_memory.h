@@ -61,11 +61,14 @@ class SharedMemoryAllocator {
   Status NewMemoryBuffer(const std::string &memory_key_prefix, uint64_t item_size, uint64_t init_item_count);
   Status AllocMemoryItem(const std::string &memory_key_prefix, SharedMemoryItem *shm_item);
   void ReleaseMemoryItem(const SharedMemoryItem &shm_item);
+  // unmap and unlink all shared memory of the prefix, processes that have attached the memory can still access it
+  Status DeleteMemoryBuffer(const std::string &memory_key_prefix);
 
  private:
   std::map<std::string, SharedMemoryGroup> memory_map_;
   std::mutex lock_;
   Status AddShmMemoryBuffer(SharedMemoryGroup *shm_group);
+  static void FreeShmMemoryGroup(SharedMemoryGroup *shm_group);
 };
 
 class ShmTensor : public BufferTensor {
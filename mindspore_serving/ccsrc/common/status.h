@@ -31,6 +31,9 @@ enum StatusCode {
   SYSTEM_ERROR,
   WORKER_UNAVAILABLE,
   SERVABLE_UNAVAILABLE,
+  DEADLINE_EXCEEDED,
+  // an instance failed the input check in the worker, the master fails its whole request with INVALID_INPUTS
+  INVALID_INSTANCE,
 };
 
 class Status {
@@ -15,9 +15,12 @@
  */
 #include "common/tensor.h"
 #include <securec.h>
+#include <cstring>
 #include <functional>
+#include <new>
 #include <utility>
 #include "common/log.h"
+#include "common/tensor_buffer_pool.h"
 
 namespace mindspore::serving {
 Tensor::Tensor() = default;
@@ -27,17 +30,94 @@ Tensor::Tensor(DataType type, const std::vector<int64_t> &shape, const void *dat
   (void)set_data(data, data_len);
 }
 
+Tensor::Tensor(const Tensor &other) : TensorBase(), type_(other.type_), shape_(other.shape_), bytes_(other.bytes_) {
+  (void)set_data(other.data(), other.data_size());
+}
+
+Tensor &Tensor::operator=(const Tensor &other) {
+  if (this == &other) {
+    return *this;
+  }
+  type_ = other.type_;
+  shape_ = other.shape_;
+  bytes_ = other.bytes_;
+  (void)set_data(other.data(), other.data_size());
+  return *this;
+}
+
+Tensor::Tensor(Tensor &&other) noexcept
+    : TensorBase(),
+      type_(other.type_),
+      shape_(std::move(other.shape_)),
+      data_(other.data_),
+      data_size_(other.data_size_),
+      data_capacity_(other.data_capacity_),
+      bytes_(std::move(other.bytes_)) {
+  other.data_ = nullptr;
+  other.data_size_ = 0;
+  other.data_capacity_ = 0;
+}
+
+Tensor &Tensor::operator=(Tensor &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  TensorBufferPool::Instance().Free(data_, data_capacity_);
+  type_ = other.type_;
+  shape_ = std::move(other.shape_);
+  bytes_ = std::move(other.bytes_);
+  data_ = other.data_;
+  data_size_ = other.data_size_;
+  data_capacity_ = other.data_capacity_;
+  other.data_ = nullptr;
+  other.data_size_ = 0;
+  other.data_capacity_ = 0;
+  return *this;
+}
+
+Tensor::~Tensor() { TensorBufferPool::Instance().Free(data_, data_capacity_); }
+
 const uint8_t *Tensor::data() const {
   if (data_size() == 0) {
     return nullptr;
   }
-  return data_.data();
+  return data_;
 }
 
-size_t Tensor::data_size() const { return data_.size(); }
+size_t Tensor::data_size() const { return data_size_; }
 
 bool Tensor::resize_data(size_t data_len) {
-  data_.resize(data_len);
+  auto data_size = data_size_;
+  if (!resize_data_no_fill(data_len)) {
+    return false;
+  }
+  // fill the new bytes with zero, the same as std::vector. the buffer is large enough, and memset_s fails above
+  // SECUREC_MEM_MAX_LEN
+  if (data_len > data_size) {
+    (void)memset(data_ + data_size, 0, data_len - data_size);
+  }
+  return true;
+}
+
+bool Tensor::resize_data_no_fill(size_t data_len) {
+  // keep the data
+  if (data_len > data_capacity_) {
+    size_t capacity = 0;
+    uint8_t *buffer = nullptr;
+    try {
+      buffer = TensorBufferPool::Instance().Alloc(data_len, &capacity);
+    } catch (const std::bad_alloc &) {
+      MSI_LOG_ERROR << "Resize tensor data failed, malloc " << data_len << " bytes failed";
+      return false;
+    }
+    if (data_size_ > 0) {
+      (void)memcpy(buffer, data_, data_size_);
+    }
+    TensorBufferPool::Instance().Free(data_, data_capacity_);
+    data_ = buffer;
+    data_capacity_ = capacity;
+  }
+  data_size_ = data_len;
   return true;
 }
 
@@ -45,7 +125,7 @@ uint8_t *Tensor::mutable_data() {
   if (data_size() == 0) {
     return nullptr;
   }
-  return data_.data();
+  return data_;
 }
 
 // For kMSI_String and kMSI_Bytes
@@ -25,7 +25,12 @@ class MS_API Tensor : public TensorBase {
  public:
   Tensor();
   Tensor(DataType type, const std::vector<int64_t> &shape, const void *data, size_t data_len);
-  ~Tensor() = default;
+  Tensor(const Tensor &other);
+  Tensor &operator=(const Tensor &other);
+  // the buffer is taken over without copying, and the moved-from tensor is left empty
+  Tensor(Tensor &&other) noexcept;
+  Tensor &operator=(Tensor &&other) noexcept;
+  ~Tensor() override;
 
   void set_data_type(DataType type) override { type_ = type; }
   DataType data_type() const override { return type_; }
@@ -37,6 +42,8 @@ class MS_API Tensor : public TensorBase {
   size_t data_size() const override;
 
   bool resize_data(size_t data_len) override;
+  // resize without filling the new bytes, for the buffers fully written by the caller
+  bool resize_data_no_fill(size_t data_len);
   uint8_t *mutable_data() override;
 
   // For kMSI_String and kMSI_Bytes
@@ -48,7 +55,10 @@ class MS_API Tensor : public TensorBase {
  private:
   DataType type_ = kMSI_Unknown;
   std::vector<int64_t> shape_;
-  std::vector<uint8_t> data_;
+  // buffer from TensorBufferPool, returned to the pool when the tensor is destroyed
+  uint8_t *data_ = nullptr;
+  size_t data_size_ = 0;
+  size_t data_capacity_ = 0;
   // For kMSI_String and kMSI_Bytes
   std::vector<std::vector<uint8_t>> bytes_;
 };
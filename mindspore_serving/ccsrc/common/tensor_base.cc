@@ -26,7 +26,10 @@ TensorBase::~TensorBase() = default;
 
 bool TensorBase::set_data(const void *data, size_t data_len) {
   if (data_size() != data_len) {
-    (void)resize_data(data_len);
+    if (!resize_data(data_len)) {
+      MSI_LOG_ERROR << "set data failed, resize data to data len " << data_len << " failed";
+      return false;
+    }
     if (data_len == 0) {
       MSI_LOG_INFO << "set data to data len 0";
       return true;
@@ -0,0 +1,160 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/tensor_buffer_pool.h"
+#include <new>
+
+namespace mindspore::serving {
+TensorBufferPool &TensorBufferPool::Instance() {
+  // never destroyed, tensors may be released by threads still running at exit
+  static auto pool = new TensorBufferPool();
+  return *pool;
+}
+
+TensorBufferPool::ThreadCache::~ThreadCache() {
+  auto &pool = TensorBufferPool::Instance();
+  for (size_t i = 0; i < kClassCount; i++) {
+    for (auto buffer : buffers[i]) {
+      pool.PushCentral(i, buffer);
+    }
+    buffers[i].clear();
+  }
+}
+
+TensorBufferPool::ThreadCache &TensorBufferPool::GetThreadCache() {
+  static thread_local ThreadCache thread_cache;
+  return thread_cache;
+}
+
+bool TensorBufferPool::GetClassIndex(size_t size, size_t *class_index) {
+  size_t shift = kMinClassShift;
+  while (shift <= kMaxClassShift && (static_cast<size_t>(1) << shift) < size) {
+    shift++;
+  }
+  if (shift > kMaxClassShift) {
+    return false;
+  }
+  *class_index = shift - kMinClassShift;
+  return true;
+}
+
+uint8_t *TensorBufferPool::PopCached(size_t class_index) {
+  auto &thread_buffers = GetThreadCache().buffers[class_index];
+  if (!thread_buffers.empty()) {
+    auto buffer = thread_buffers.back();
+    thread_buffers.pop_back();
+    return buffer;
+  }
+  auto &central = central_lists_[class_index];
+  std::unique_lock<std::mutex> lock(central.lock);
+  if (central.buffers.empty()) {
+    return nullptr;
+  }
+  auto buffer = central.buffers.back();
+  central.buffers.pop_back();
+  return buffer;
+}
+
+void TensorBufferPool::PushCentral(size_t class_index, uint8_t *buffer) {
+  auto &central = central_lists_[class_index];
+  std::unique_lock<std::mutex> lock(central.lock);
+  central.buffers.push_back(buffer);
+}
+
+uint8_t *TensorBufferPool::Alloc(size_t size, size_t *capacity) {
+  MSI_EXCEPTION_IF_NULL(capacity);
+  alloc_count_.fetch_add(1, std::memory_order_relaxed);
+  size_t class_index = 0;
+  if (!GetClassIndex(size, &class_index)) {
+    *capacity = size;
+    return static_cast<uint8_t *>(::operator new(size));
+  }
+  size_t class_size = static_cast<size_t>(1) << (class_index + kMinClassShift);
+  *capacity = class_size;
+  auto buffer = PopCached(class_index);
+  if (buffer != nullptr) {
+    hit_count_.fetch_add(1, std::memory_order_relaxed);
+    cached_bytes_.fetch_sub(class_size);
+    return buffer;
+  }
+  return static_cast<uint8_t *>(::operator new(class_size));
+}
+
+void TensorBufferPool::Free(uint8_t *buffer, size_t capacity) {
+  if (buffer == nullptr) {
+    return;
+  }
+  size_t class_index = 0;
+  // buffers larger than the max size class
+  if (!GetClassIndex(capacity, &class_index) || capacity != static_cast<size_t>(1) << (class_index + kMinClassShift)) {
+    ::operator delete(buffer);
+    return;
+  }
+  auto cached_bytes = cached_bytes_.fetch_add(capacity) + capacity;
+  if (cached_bytes > max_cached_bytes_) {
+    cached_bytes_.fetch_sub(capacity);
+    drop_count_.fetch_add(1, std::memory_order_relaxed);
+    ::operator delete(buffer);
+    return;
+  }
+  auto high_water = cached_high_water_bytes_.load();
+  while (cached_bytes > high_water && !cached_high_water_bytes_.compare_exchange_weak(high_water, cached_bytes)) {
+  }
+  if (class_index + kMinClassShift <= kMaxThreadCacheClassShift) {
+    auto &thread_buffers = GetThreadCache().buffers[class_index];
+    if (thread_buffers.size() < kThreadCacheCount) {
+      thread_buffers.push_back(buffer);
+      return;
+    }
+  }
+  PushCentral(class_index, buffer);
+}
+
+void TensorBufferPool::SetMaxCachedBytes(uint64_t max_cached_bytes) {
+  max_cached_bytes_ = max_cached_bytes;
+  MSI_LOG_INFO << "Max cached bytes of tensor buffer pool: " << max_cached_bytes;
+}
+
+TensorBufferPoolStats TensorBufferPool::GetStats() const {
+  TensorBufferPoolStats stats;
+  stats.alloc_count = alloc_count_;
+  stats.hit_count = hit_count_;
+  stats.drop_count = drop_count_;
+  stats.cached_bytes = cached_bytes_;
+  stats.cached_high_water_bytes = cached_high_water_bytes_;
+  stats.max_cached_bytes = max_cached_bytes_;
+  return stats;
+}
+
+void TensorBufferPool::Clear() {
+  for (size_t i = 0; i < kClassCount; i++) {
+    size_t class_size = static_cast<size_t>(1) << (i + kMinClassShift);
+    std::vector<uint8_t *> buffers;
+    auto &thread_buffers = GetThreadCache().buffers[i];
+    buffers.swap(thread_buffers);
+    {
+      auto &central = central_lists_[i];
+      std::unique_lock<std::mutex> lock(central.lock);
+      buffers.insert(buffers.end(), central.buffers.begin(), central.buffers.end());
+      central.buffers.clear();
+    }
+    for (auto buffer : buffers) {
+      ::operator delete(buffer);
+    }
+    cached_bytes_.fetch_sub(buffers.size() * class_size);
+  }
+}
+}  // namespace mindspore::serving
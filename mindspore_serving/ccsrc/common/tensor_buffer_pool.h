@@ -0,0 +1,86 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_SERVING_TENSOR_BUFFER_POOL_H
+#define MINDSPORE_SERVING_TENSOR_BUFFER_POOL_H
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "common/serving_common.h"
+
+namespace mindspore::serving {
+struct TensorBufferPoolStats {
+  uint64_t alloc_count = 0;              // buffers requested
+  uint64_t hit_count = 0;                // buffers reused from the pool
+  uint64_t drop_count = 0;               // released buffers freed because of the cap of cached bytes
+  uint64_t cached_bytes = 0;             // bytes of free buffers in the pool
+  uint64_t cached_high_water_bytes = 0;  // max of cached_bytes
+  uint64_t max_cached_bytes = 0;         // cap of cached_bytes
+};
+
+// data buffers of Tensor in size classes of power of two, released buffers are cached by the releasing thread
+// first and shared by all threads after that, buffers larger than the max size class are not cached
+class MS_API TensorBufferPool {
+ public:
+  static TensorBufferPool &Instance();
+
+  // capacity is the size of the buffer allocated, not less than size
+  uint8_t *Alloc(size_t size, size_t *capacity);
+  void Free(uint8_t *buffer, size_t capacity);
+
+  void SetMaxCachedBytes(uint64_t max_cached_bytes);
+  TensorBufferPoolStats GetStats() const;
+  // free all cached buffers, buffers cached by other threads are kept
+  void Clear();
+
+  static constexpr size_t kMinClassShift = 6;   // 64B
+  static constexpr size_t kMaxClassShift = 26;  // 64MB
+  static constexpr size_t kClassCount = kMaxClassShift - kMinClassShift + 1;
+  // buffers not larger than 1MB are cached by the threads, at most kThreadCacheCount buffers of one size class
+  static constexpr size_t kMaxThreadCacheClassShift = 20;
+  static constexpr size_t kThreadCacheCount = 4;
+  static constexpr uint64_t kDefaultMaxCachedBytes = 256ull << 20;  // 256MB
+
+ private:
+  struct CentralList {
+    std::mutex lock;
+    std::vector<uint8_t *> buffers;
+  };
+  struct ThreadCache {
+    std::array<std::vector<uint8_t *>, kClassCount> buffers;
+    ~ThreadCache();
+  };
+  std::array<CentralList, kClassCount> central_lists_;
+
+  std::atomic<uint64_t> max_cached_bytes_ = kDefaultMaxCachedBytes;
+  std::atomic<uint64_t> cached_bytes_ = 0;
+  std::atomic<uint64_t> cached_high_water_bytes_ = 0;
+  std::atomic<uint64_t> alloc_count_ = 0;
+  std::atomic<uint64_t> hit_count_ = 0;
+  std::atomic<uint64_t> drop_count_ = 0;
+
+  TensorBufferPool() = default;
+  ~TensorBufferPool() = default;
+  static ThreadCache &GetThreadCache();
+  static bool GetClassIndex(size_t size, size_t *class_index);
+  uint8_t *PopCached(size_t class_index);
+  void PushCentral(size_t class_index, uint8_t *buffer);
+};
+}  // namespace mindspore::serving
+
+#endif  // MINDSPORE_SERVING_TENSOR_BUFFER_POOL_H
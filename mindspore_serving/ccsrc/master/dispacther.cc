@@ -50,15 +50,18 @@ std::shared_ptr<ServableEndPoint> Dispatcher::GetWorkerEndpoint(const RequestSpe
 
 Status Dispatcher::JudgeInferNum() {
   auto max_enqueued_requests = MasterContext::Instance()->GetMaxEnqueuedRequests();
-  if (enqueued_requests_ >= max_enqueued_requests) {
+  // reserve the slot in one step, the requests dispatched by multiple threads at the same time cannot all pass the
+  // check before any of them is counted
+  if (enqueued_requests_.fetch_add(1) >= max_enqueued_requests) {
+    enqueued_requests_--;
     return INFER_STATUS_LOG_ERROR(FAILED)
            << "Serving Error: enqueued requests count exceeds the limit " << max_enqueued_requests;
   }
   return SUCCESS;
 }
 
-void Dispatcher::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                               const PredictOnFinish &on_finish) {
+template <class Request, class Reply>
+void Dispatcher::DispatchAsyncCommon(const Request &request, Reply *reply, const PredictOnFinish &on_finish) {
   MSI_EXCEPTION_IF_NULL(reply);
   (*reply->mutable_servable_spec()) = request.servable_spec();
   Status status = JudgeInferNum();
@@ -72,7 +75,6 @@ void Dispatcher::DispatchAsync(const proto::PredictRequest &request, proto::Pred
       on_finish();
       this->enqueued_requests_--;
     };
-    enqueued_requests_++;
     status = DispatchAsyncInner(request, reply, callback);
   } catch (const std::bad_alloc &ex) {
     MSI_LOG(ERROR) << "Serving Error: malloc memory failed";
@@ -90,8 +92,8 @@ void Dispatcher::DispatchAsync(const proto::PredictRequest &request, proto::Pred
   }
 }
 
-Status Dispatcher::DispatchAsyncInner(const proto::PredictRequest &request, proto::PredictReply *reply,
-                                      const PredictOnFinish &on_finish) {
+template <class Request, class Reply>
+Status Dispatcher::DispatchAsyncInner(const Request &request, Reply *reply, const PredictOnFinish &on_finish) {
   MSI_EXCEPTION_IF_NULL(reply);
   std::shared_lock<std::shared_mutex> lock(servable_shared_lock_);
   RequestSpec request_spec;
@@ -110,6 +112,16 @@ Status Dispatcher::DispatchAsyncInner(const proto::PredictRequest &request, prot
   return endpoint->DispatchAsync(request, reply, on_finish);
 }
 
+void Dispatcher::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+                               const PredictOnFinish &on_finish) {
+  DispatchAsyncCommon(request, reply, on_finish);
+}
+
+void Dispatcher::DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
+                               const PredictOnFinish &on_finish) {
+  DispatchAsyncCommon(request, reply, on_finish);
+}
+
 Status Dispatcher::UnregisterServableCommon(const std::string &worker_address) {
   std::unique_lock<std::shared_mutex> lock(servable_shared_lock_);
   std::shared_ptr<WorkerContext> worker_context = nullptr;
@@ -38,6 +38,8 @@ class Dispatcher {
   ~Dispatcher();
   void DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
                      const PredictOnFinish &on_finish);
+  void DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
+                     const PredictOnFinish &on_finish);
 
   Status RegisterServable(const proto::RegisterRequest &request, proto::RegisterReply *reply);
   Status NotifyWorkerExit(const proto::ExitRequest &request, proto::ExitReply *reply);
@@ -57,6 +59,7 @@ class Dispatcher {
   std::shared_mutex servable_shared_lock_;
   std::atomic_uint32_t enqueued_requests_ = 0;
 
+  // reserve a slot of enqueued requests, released when the request finishes or fails to dispatch
   Status JudgeInferNum();
   std::shared_ptr<ServableEndPoint> GetWorkerEndpoint(const RequestSpec &request_spec) const;
 
@@ -64,8 +67,10 @@ class Dispatcher {
 
   Status RegisterServableCommon(const WorkerRegSpec &worker_spec, CreateNotifyWorkerFunc func);
   Status UnregisterServableCommon(const std::string &worker_address);
-  Status DispatchAsyncInner(const proto::PredictRequest &request, proto::PredictReply *reply,
-                            const PredictOnFinish &on_finish);
+  template <class Request, class Reply>
+  void DispatchAsyncCommon(const Request &request, Reply *reply, const PredictOnFinish &on_finish);
+  template <class Request, class Reply>
+  Status DispatchAsyncInner(const Request &request, Reply *reply, const PredictOnFinish &on_finish);
   Status RegisterWorkerContext(std::shared_ptr<WorkerContext> worker_context);
 
   void UnregisterWorkerContext(WorkerContext *worker_context);
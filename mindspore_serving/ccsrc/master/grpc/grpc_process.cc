@@ -17,6 +17,7 @@
 #include "master/grpc/grpc_process.h"
 #include <string>
 #include "master/dispacther.h"
+#include "common/proto_tensor.h"
 
 namespace mindspore {
 namespace serving {
@@ -36,11 +37,26 @@ std::string GetProtorWorkerSpecRepr(const proto::WorkerRegSpec &worker_spec) {
 }
 }  // namespace
 
+void SetCallDeadline(const grpc::ServerContext &ctx, proto::ServableSpec *servable_spec) {
+  auto deadline = ctx.deadline();
+  if (deadline == std::chrono::system_clock::time_point::max()) {
+    return;
+  }
+  auto time_left =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(deadline - std::chrono::system_clock::now());
+  GrpcTensorHelper::SetRequestDeadline(std::chrono::steady_clock::now() + time_left, servable_spec);
+}
+
 void MSServiceImpl::PredictAsync(const proto::PredictRequest *request, proto::PredictReply *reply,
                                  PredictOnFinish on_finish) {
   dispatcher_->DispatchAsync(*request, reply, on_finish);
 }
 
+void MSServiceImpl::PredictAsync(const proto::PassthroughPredictRequest *request,
+                                 proto::PassthroughPredictReply *reply, PredictOnFinish on_finish) {
+  dispatcher_->DispatchAsync(*request, reply, on_finish);
+}
+
 grpc::Status MSMasterImpl::Register(const proto::RegisterRequest *request, proto::RegisterReply *reply) {
   MSI_EXCEPTION_IF_NULL(request);
   MSI_EXCEPTION_IF_NULL(reply);
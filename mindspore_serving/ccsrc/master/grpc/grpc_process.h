@@ -34,6 +34,9 @@
 
 namespace mindspore {
 namespace serving {
+// the deadline of the call is carried by the request, so that the work is dropped once the client gives up
+void SetCallDeadline(const grpc::ServerContext &ctx, proto::ServableSpec *servable_spec);
+
 // Service Implement
 class MSServiceImpl {
  public:
@@ -41,6 +44,8 @@ class MSServiceImpl {
   ~MSServiceImpl() = default;
 
   void PredictAsync(const proto::PredictRequest *request, proto::PredictReply *reply, PredictOnFinish on_finish);
+  void PredictAsync(const proto::PassthroughPredictRequest *request, proto::PassthroughPredictReply *reply,
+                    PredictOnFinish on_finish);
 
  private:
   std::shared_ptr<Dispatcher> dispatcher_;
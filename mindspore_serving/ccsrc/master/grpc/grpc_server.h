@@ -20,21 +20,52 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <deque>
+#include <mutex>
+#include <grpcpp/alarm.h>
 #include "common/serving_common.h"
 #include "proto/ms_worker.pb.h"
 #include "proto/ms_worker.grpc.pb.h"
 #include "common/grpc_async_server.h"
 #include "master/grpc/grpc_process.h"
+#include "master/master_context.h"
 
 namespace mindspore {
 namespace serving {
+// MSService that can also request Predict as PassthroughPredictRequest and PassthroughPredictReply, which have the
+// same wire format as PredictRequest and PredictReply
+class MSServiceAsyncService : public proto::MSService::AsyncService {
+ public:
+  void RequestPassthroughPredict(grpc::ServerContext *context, proto::PassthroughPredictRequest *request,
+                                 grpc::ServerAsyncResponseWriter<proto::PassthroughPredictReply> *response,
+                                 grpc::CompletionQueue *new_call_cq, grpc::ServerCompletionQueue *notification_cq,
+                                 void *tag) {
+    grpc::Service::RequestAsyncUnary(kPredictMethodIndex, context, request, response, new_call_cq, notification_cq,
+                                     tag);
+  }
+
+  using proto::MSService::AsyncService::RequestPredictStream;
+  // request PredictStream as PassthroughPredictStreamRequest and PassthroughPredictStreamReply
+  void RequestPredictStream(
+    grpc::ServerContext *context,
+    grpc::ServerAsyncReaderWriter<proto::PassthroughPredictStreamReply, proto::PassthroughPredictStreamRequest> *stream,
+    grpc::CompletionQueue *new_call_cq, grpc::ServerCompletionQueue *notification_cq, void *tag) {
+    grpc::Service::RequestAsyncBidiStreaming(kPredictStreamMethodIndex, context, stream, new_call_cq, notification_cq,
+                                             tag);
+  }
+
+ private:
+  // index of Predict and PredictStream in MSService
+  static constexpr int kPredictMethodIndex = 0;
+  static constexpr int kPredictStreamMethodIndex = 1;
+};
+
 template <class Derived>
-class ServiceGrpcContext : public GrpcAsyncServiceContext<MSServiceImpl, proto::MSService::AsyncService, Derived> {
+class ServiceGrpcContext : public GrpcAsyncServiceContext<MSServiceImpl, MSServiceAsyncService, Derived> {
  public:
-  ServiceGrpcContext(MSServiceImpl *service_impl, proto::MSService::AsyncService *async_service,
+  ServiceGrpcContext(MSServiceImpl *service_impl, MSServiceAsyncService *async_service,
                      grpc::ServerCompletionQueue *cq)
-      : GrpcAsyncServiceContext<MSServiceImpl, proto::MSService::AsyncService, Derived>(service_impl, async_service,
-                                                                                        cq) {}
+      : GrpcAsyncServiceContext<MSServiceImpl, MSServiceAsyncService, Derived>(service_impl, async_service, cq) {}
 
   virtual void StartEnqueueRequest() = 0;
   virtual void HandleRequest() = 0;
@@ -42,37 +73,213 @@ class ServiceGrpcContext : public GrpcAsyncServiceContext<MSServiceImpl, proto::
 
 class ServicePredictContext : public ServiceGrpcContext<ServicePredictContext> {
  public:
-  ServicePredictContext(MSServiceImpl *service_impl, proto::MSService::AsyncService *async_service,
+  ServicePredictContext(MSServiceImpl *service_impl, MSServiceAsyncService *async_service,
                         grpc::ServerCompletionQueue *cq)
       : ServiceGrpcContext<ServicePredictContext>(service_impl, async_service, cq), responder_(&ctx_) {}
 
   ~ServicePredictContext() = default;
 
-  void StartEnqueueRequest() override { async_service_->RequestPredict(&ctx_, &request_, &responder_, cq_, cq_, this); }
+  void StartEnqueueRequest() override { async_service_->RequestPredict(&ctx_, request_, &responder_, cq_, cq_, this); }
 
   void HandleRequest() override {
     MSI_TIME_STAMP_START(RequestHandle)
-    auto instance_size = request_.instances_size();
+    auto instance_size = request_->instances_size();
     PredictOnFinish on_finish = [this, time_start_RequestHandle, instance_size]() {
-      responder_.Finish(response_, grpc::Status::OK, this);
+      responder_.Finish(*response_, grpc::Status::OK, this);
       MSI_TIME_STAMP_END_EXTRA(RequestHandle, "Request count " + std::to_string(instance_size))
     };
-    service_impl_->PredictAsync(&request_, &response_, on_finish);
+    SetCallDeadline(ctx_, request_->mutable_servable_spec());
+    service_impl_->PredictAsync(request_, response_, on_finish);
   }
 
  private:
   grpc::ServerAsyncResponseWriter<proto::PredictReply> responder_;
-  proto::PredictRequest request_;
-  proto::PredictReply response_;
+  // request and reply of the call are allocated on the arena, and freed all at once with the context
+  google::protobuf::Arena arena_;
+  proto::PredictRequest *request_ = google::protobuf::Arena::CreateMessage<proto::PredictRequest>(&arena_);
+  proto::PredictReply *response_ = google::protobuf::Arena::CreateMessage<proto::PredictReply>(&arena_);
 };
 
-class ServiceGrpcServer : public GrpcAsyncServer<proto::MSService::AsyncService> {
+// the master only parses the servable spec of the request, and forwards the serialized instances to the workers
+class ServicePassthroughPredictContext : public ServiceGrpcContext<ServicePassthroughPredictContext> {
+ public:
+  ServicePassthroughPredictContext(MSServiceImpl *service_impl, MSServiceAsyncService *async_service,
+                                   grpc::ServerCompletionQueue *cq)
+      : ServiceGrpcContext<ServicePassthroughPredictContext>(service_impl, async_service, cq), responder_(&ctx_) {}
+
+  ~ServicePassthroughPredictContext() = default;
+
+  void StartEnqueueRequest() override {
+    async_service_->RequestPassthroughPredict(&ctx_, request_, &responder_, cq_, cq_, this);
+  }
+
+  void HandleRequest() override {
+    MSI_TIME_STAMP_START(RequestHandle)
+    auto instance_size = request_->instances_size();
+    PredictOnFinish on_finish = [this, time_start_RequestHandle, instance_size]() {
+      responder_.Finish(*response_, grpc::Status::OK, this);
+      MSI_TIME_STAMP_END_EXTRA(RequestHandle, "Request count " + std::to_string(instance_size))
+    };
+    SetCallDeadline(ctx_, request_->mutable_servable_spec());
+    service_impl_->PredictAsync(request_, response_, on_finish);
+  }
+
+ private:
+  grpc::ServerAsyncResponseWriter<proto::PassthroughPredictReply> responder_;
+  // request and reply of the call are allocated on the arena, and freed all at once with the context
+  google::protobuf::Arena arena_;
+  proto::PassthroughPredictRequest *request_ =
+    google::protobuf::Arena::CreateMessage<proto::PassthroughPredictRequest>(&arena_);
+  proto::PassthroughPredictReply *response_ =
+    google::protobuf::Arena::CreateMessage<proto::PassthroughPredictReply>(&arena_);
+};
+
+// the requests read from the stream are dispatched at once, and the replies are written in the order they complete.
+// the stream is finished when the client has done writing and all the replies have been written
+template <class ServiceImpl, class StreamRequest, class StreamReply>
+class PredictStreamContext
+    : public GrpcAsyncServiceContext<ServiceImpl, MSServiceAsyncService,
+                                     PredictStreamContext<ServiceImpl, StreamRequest, StreamReply>> {
+ public:
+  using Base = GrpcAsyncServiceContext<ServiceImpl, MSServiceAsyncService, PredictStreamContext>;
+  PredictStreamContext(ServiceImpl *service_impl, MSServiceAsyncService *async_service, grpc::ServerCompletionQueue *cq)
+      : Base(service_impl, async_service, cq),
+        stream_(&this->ctx_),
+        read_event_([this](bool rpc_ok) { OnRead(rpc_ok); }),
+        write_event_([this](bool rpc_ok) { OnWrite(rpc_ok); }),
+        finish_alarm_event_([this](bool) { stream_.Finish(grpc::Status::OK, &finish_event_); }),
+        finish_event_([this](bool) { delete this; }) {}
+
+  ~PredictStreamContext() = default;
+
+  void StartEnqueueRequest() override {
+    this->async_service_->RequestPredictStream(&this->ctx_, &stream_, this->cq_, this->cq_, this);
+  }
+
+  void HandleRequest() override { StartRead(); }
+
+ private:
+  struct StreamCall {
+    // request and reply of the call are allocated on the arena, and freed all at once with the call
+    google::protobuf::Arena arena;
+    StreamRequest *request = google::protobuf::Arena::CreateMessage<StreamRequest>(&arena);
+    StreamReply *reply = google::protobuf::Arena::CreateMessage<StreamReply>(&arena);
+  };
+  using StreamCallPtr = std::shared_ptr<StreamCall>;
+
+  grpc::ServerAsyncReaderWriter<StreamReply, StreamRequest> stream_;
+  GrpcAsyncStreamEvent read_event_;
+  GrpcAsyncStreamEvent write_event_;
+  GrpcAsyncStreamEvent finish_alarm_event_;
+  GrpcAsyncStreamEvent finish_event_;
+  // posts the finish of the stream from a client completion thread to the thread of the completion queue
+  grpc::Alarm finish_alarm_;
+  // read and dispatched only by the thread of the completion queue
+  StreamCallPtr read_call_;
+
+  std::mutex lock_;
+  bool read_done_ = false;
+  bool write_failed_ = false;
+  bool finishing_ = false;
+  uint64_t pending_num_ = 0;  // requests dispatched and not replied
+  std::deque<StreamCallPtr> write_queue_;
+  StreamCallPtr write_call_;  // the reply being written, at most one write is in flight
+
+  void StartRead() {
+    read_call_ = std::make_shared<StreamCall>();
+    stream_.Read(read_call_->request, &read_event_);
+  }
+
+  void OnRead(bool rpc_ok) {
+    if (!rpc_ok) {  // the client has done writing, or the stream is broken
+      std::unique_lock<std::mutex> lock(lock_);
+      read_done_ = true;
+      TryFinishLocked();
+      return;
+    }
+    auto call = std::move(read_call_);
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      pending_num_++;
+    }
+    StartRead();
+    call->reply->set_request_id(call->request->request_id());
+    PredictOnFinish on_finish = [this, call]() { OnReply(call); };
+    // the deadline of the stream applies to each request
+    SetCallDeadline(this->ctx_, call->request->mutable_request()->mutable_servable_spec());
+    this->service_impl_->PredictAsync(&call->request->request(), call->reply->mutable_reply(), on_finish);
+  }
+
+  void OnReply(const StreamCallPtr &call) {
+    std::unique_lock<std::mutex> lock(lock_);
+    pending_num_--;
+    if (write_failed_) {
+      // this runs on a client completion thread, while the context is deleted by the thread of the completion queue
+      // once the stream is finished, even before the lock is released here. so the finish is posted to that thread
+      if (CanFinishLocked()) {
+        finishing_ = true;
+        finish_alarm_.Set(this->cq_, gpr_now(GPR_CLOCK_MONOTONIC), &finish_alarm_event_);
+      }
+      return;
+    }
+    write_queue_.push_back(call);
+    if (write_call_ == nullptr) {
+      StartWriteLocked();
+    }
+  }
+
+  void StartWriteLocked() {
+    write_call_ = std::move(write_queue_.front());
+    write_queue_.pop_front();
+    stream_.Write(*write_call_->reply, &write_event_);
+  }
+
+  void OnWrite(bool rpc_ok) {
+    std::unique_lock<std::mutex> lock(lock_);
+    write_call_ = nullptr;
+    if (!rpc_ok) {  // the stream is broken, the left replies are dropped
+      write_failed_ = true;
+      write_queue_.clear();
+    }
+    if (!write_queue_.empty()) {
+      StartWriteLocked();
+      return;
+    }
+    TryFinishLocked();
+  }
+
+  bool CanFinishLocked() const { return read_done_ && pending_num_ == 0 && write_call_ == nullptr && !finishing_; }
+
+  // only called by the thread of the completion queue
+  void TryFinishLocked() {
+    if (!CanFinishLocked()) {
+      return;
+    }
+    finishing_ = true;
+    stream_.Finish(grpc::Status::OK, &finish_event_);
+  }
+};
+
+using ServicePredictStreamContext =
+  PredictStreamContext<MSServiceImpl, proto::PredictStreamRequest, proto::PredictStreamReply>;
+using ServicePassthroughPredictStreamContext =
+  PredictStreamContext<MSServiceImpl, proto::PassthroughPredictStreamRequest, proto::PassthroughPredictStreamReply>;
+
+class ServiceGrpcServer : public GrpcAsyncServer<MSServiceAsyncService> {
  public:
   explicit ServiceGrpcServer(std::shared_ptr<Dispatcher> dispatcher)
-      : GrpcAsyncServer<proto::MSService::AsyncService>(), service_impl_(MSServiceImpl(dispatcher)) {}
+      : GrpcAsyncServer<MSServiceAsyncService>(), service_impl_(MSServiceImpl(dispatcher)) {}
   ~ServiceGrpcServer() {}
 
-  void EnqueueRequests() override { ServicePredictContext::EnqueueRequest(&service_impl_, &svc_, cq_.get()); }
+  void EnqueueRequests(grpc::ServerCompletionQueue *cq) override {
+    if (MasterContext::Instance()->GetEnablePassthrough()) {
+      ServicePassthroughPredictContext::EnqueueRequest(&service_impl_, &svc_, cq);
+      ServicePassthroughPredictStreamContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    } else {
+      ServicePredictContext::EnqueueRequest(&service_impl_, &svc_, cq);
+      ServicePredictStreamContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    }
+  }
 
  protected:
   MSServiceImpl service_impl_;
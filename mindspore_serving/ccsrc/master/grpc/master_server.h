@@ -139,18 +139,21 @@ class MasterPredictContext : public MasterGrpcContext<MasterPredictContext> {
   ~MasterPredictContext() = default;
 
   void StartEnqueueRequest() override {
-    async_service_->RequestCallModel(&ctx_, &request_, &responder_, cq_, cq_, this);
+    async_service_->RequestCallModel(&ctx_, request_, &responder_, cq_, cq_, this);
   }
 
   void HandleRequest() override {
-    PredictOnFinish on_finish = [this]() { responder_.Finish(response_, grpc::Status::OK, this); };
-    service_impl_->PredictAsync(&request_, &response_, on_finish);
+    PredictOnFinish on_finish = [this]() { responder_.Finish(*response_, grpc::Status::OK, this); };
+    SetCallDeadline(ctx_, request_->mutable_servable_spec());
+    service_impl_->PredictAsync(request_, response_, on_finish);
   }
 
  private:
   grpc::ServerAsyncResponseWriter<proto::PredictReply> responder_;
-  proto::PredictRequest request_;
-  proto::PredictReply response_;
+  // request and reply of the call are allocated on the arena, and freed all at once with the context
+  google::protobuf::Arena arena_;
+  proto::PredictRequest *request_ = google::protobuf::Arena::CreateMessage<proto::PredictRequest>(&arena_);
+  proto::PredictReply *response_ = google::protobuf::Arena::CreateMessage<proto::PredictReply>(&arena_);
 };
 
 class MasterGrpcServer : public GrpcAsyncServer<proto::MSMaster::AsyncService> {
@@ -159,12 +162,12 @@ class MasterGrpcServer : public GrpcAsyncServer<proto::MSMaster::AsyncService> {
       : GrpcAsyncServer<proto::MSMaster::AsyncService>(), service_impl_(MSMasterImpl(dispatcher)) {}
   ~MasterGrpcServer() {}
 
-  void EnqueueRequests() override {
-    MasterRegisterContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    MasterExitContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    MasterNotifyFailedContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    MasterGetModelInfoContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    MasterPredictContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
+  void EnqueueRequests(grpc::ServerCompletionQueue *cq) override {
+    MasterRegisterContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    MasterExitContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    MasterNotifyFailedContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    MasterGetModelInfoContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    MasterPredictContext::EnqueueRequest(&service_impl_, &svc_, cq);
   }
 
  protected:
@@ -30,4 +30,24 @@ void MasterContext::SetMaxEnqueuedRequests(uint32_t max_enqueued_requests) {
 }
 
 uint32_t MasterContext::GetMaxEnqueuedRequests() const { return max_enqueued_requests_; }
+
+void MasterContext::SetEnablePassthrough(bool enable_passthrough) { enable_passthrough_ = enable_passthrough; }
+
+bool MasterContext::GetEnablePassthrough() const { return enable_passthrough_; }
+
+void MasterContext::SetServingGrpcThreadNum(uint32_t thread_num) { serving_grpc_thread_num_ = thread_num; }
+
+uint32_t MasterContext::GetServingGrpcThreadNum() const { return serving_grpc_thread_num_; }
+
+void MasterContext::SetMasterGrpcThreadNum(uint32_t thread_num) { master_grpc_thread_num_ = thread_num; }
+
+uint32_t MasterContext::GetMasterGrpcThreadNum() const { return master_grpc_thread_num_; }
+
+void MasterContext::SetWorkerClientThreadNum(uint32_t thread_num) { worker_client_thread_num_ = thread_num; }
+
+uint32_t MasterContext::GetWorkerClientThreadNum() const { return worker_client_thread_num_; }
+
+void MasterContext::SetWorkerChannelNum(uint32_t channel_num) { worker_channel_num_ = channel_num; }
+
+uint32_t MasterContext::GetWorkerChannelNum() const { return worker_channel_num_; }
 }  // namespace mindspore::serving
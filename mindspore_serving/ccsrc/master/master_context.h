@@ -29,9 +29,27 @@ class MS_API MasterContext {
 
   void SetMaxEnqueuedRequests(uint32_t max_enqueued_requests);
   uint32_t GetMaxEnqueuedRequests() const;
+  // forward the instances of gRPC requests to the workers without decoding them in the master
+  void SetEnablePassthrough(bool enable_passthrough);
+  bool GetEnablePassthrough() const;
+  // number of completion queues and threads of the client-facing gRPC server and of the master gRPC server
+  void SetServingGrpcThreadNum(uint32_t thread_num);
+  uint32_t GetServingGrpcThreadNum() const;
+  void SetMasterGrpcThreadNum(uint32_t thread_num);
+  uint32_t GetMasterGrpcThreadNum() const;
+  // number of completion queues and threads of the client to the workers, and number of channels to every worker
+  void SetWorkerClientThreadNum(uint32_t thread_num);
+  uint32_t GetWorkerClientThreadNum() const;
+  void SetWorkerChannelNum(uint32_t channel_num);
+  uint32_t GetWorkerChannelNum() const;
 
  private:
   uint32_t max_enqueued_requests_ = 10000;  // default 10000
+  bool enable_passthrough_ = false;
+  uint32_t serving_grpc_thread_num_ = 1;
+  uint32_t master_grpc_thread_num_ = 1;
+  uint32_t worker_client_thread_num_ = 2;
+  uint32_t worker_channel_num_ = 2;
 };
 
 }  // namespace mindspore::serving
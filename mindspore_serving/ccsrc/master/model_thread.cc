@@ -15,9 +15,35 @@
  */
 
 #include "master/model_thread.h"
+#include <algorithm>
+#include <cmath>
 #include "common/proto_tensor.h"
 
 namespace mindspore::serving {
+constexpr double kLatencyEwmaWeight = 0.2;  // weight of the latest batch
+// a worker is ejected when its latency is kOutlierLatencyRatio times the median latency of the other workers and
+// at least kOutlierLatencyGapUs more, or when its error rate exceeds kOutlierErrorRate
+constexpr double kOutlierLatencyRatio = 3.0;
+constexpr double kOutlierLatencyGapUs = 1000.0;
+constexpr double kOutlierErrorRate = 0.5;
+constexpr uint64_t kOutlierMinReplyCount = 8;  // replies of a worker before it can be judged as an outlier
+constexpr int64_t kBaseEjectTimeMs = 1000;
+constexpr int64_t kMaxEjectTimeMs = 30000;
+// in-flight window of a worker in batches
+constexpr double kInitialWindow = 3.0;
+constexpr double kMinWindow = 1.0;
+constexpr double kMaxWindow = 64.0;
+// the window shrinks when the latency exceeds kQueueLatencyRatio times the min latency, the batches are queued in
+// the worker then
+constexpr double kQueueLatencyRatio = 1.5;
+constexpr double kWindowDecreaseFactor = 0.75;
+// the min latency is measured again every period, to follow the changes of the worker and the network
+constexpr int64_t kMinLatencyProbeIntervalMs = 10000;
+// the tasks of each priority are served kPriorityWeightRatio times as often as the ones of the priority below when
+// both are waiting
+constexpr uint32_t kMaxPriority = 7;
+constexpr double kPriorityWeightRatio = 8.0;
+
 ModelThread::ModelThread(const std::string &servable_name, const std::string &method_name, uint64_t version_number,
                          uint64_t batch_size, ServableMethodInfo method_info) {
   spec_.servable_name = servable_name;
@@ -34,52 +60,53 @@ void ModelThread::Clear() {
 
 void ModelThread::InnerClear() {
   for (auto &job_item : job_) {
-    auto reply = job_item.second.reply;
     bool has_reply = false;
     bool has_error = false;
     proto::ErrorMsg detect_error;
     proto::ErrorMsg exit_error;
-    RequestSpec request_spec;
-    GrpcTensorHelper::GetRequestSpec(*job_item.second.request, &request_spec);
-    auto status = INFER_STATUS(INVALID_INPUTS) << "Request " << request_spec.Repr() << ", servable is not available";
+    auto status = INFER_STATUS(INVALID_INPUTS)
+                  << "Request " << job_item.second.request_spec.Repr() << ", servable is not available";
     exit_error.set_error_code(status.StatusCode());
     exit_error.set_error_msg(status.StatusMessage());
+    std::vector<proto::ErrorMsg> errors;
+    std::vector<const std::string *> outputs;
     for (auto &task_item : job_item.second.task) {
-      auto instance = reply->add_instances();
-      auto error = reply->add_error_msg();
+      outputs.push_back(nullptr);
       if (task_item.error.error_code() != 0) {
-        *error = task_item.error;
+        errors.push_back(task_item.error);
         if (!has_error) {
           has_error = true;
           detect_error = task_item.error;
         }
       } else if (task_item.output != nullptr) {
-        *instance = *task_item.output;
+        errors.push_back(task_item.error);
+        outputs.back() = task_item.output;
         has_reply = true;
       } else {
-        *error = exit_error;
+        errors.push_back(exit_error);
       }
     }
-    if (!has_error && !has_reply) {
-      job_item.second.reply->clear_instances();
-      job_item.second.reply->clear_error_msg();
-      auto error_msg = job_item.second.reply->add_error_msg();
-      *error_msg = exit_error;
-    } else if (!has_reply) {
-      job_item.second.reply->clear_instances();
-      job_item.second.reply->clear_error_msg();
-      auto error_msg = job_item.second.reply->add_error_msg();
-      *error_msg = detect_error;
+    // reply one error for all instances if no instance has result
+    if (!has_reply) {
+      errors.assign(errors.size(), has_error ? detect_error : exit_error);
     }
-    job_item.second.callback();
+    ReplyJob(&job_item.second, errors, outputs);
   }
   job_.clear();
   pid_process_.clear();
-  task_wait_queue_ = std::queue<std::pair<uint64_t, uint64_t>>();
-  worker_wait_map_.clear();
+  task_wait_queues_.clear();
+  task_wait_count_ = 0;
+  task_wait_pass_ = 0;
+  worker_stats_.clear();
 }
 
-ModelThread::~ModelThread() { Clear(); }
+ModelThread::~ModelThread() {
+  if (expired_task_count_ > 0) {
+    MSI_LOG_INFO << spec_.Repr() << " dropped " << expired_task_count_
+                 << " instances at dispatch after their deadlines";
+  }
+  Clear();
+}
 
 Status ModelThread::AddWorker(uint64_t pid, const std::shared_ptr<WorkerContext> &notify) {
   {
@@ -90,11 +117,15 @@ Status ModelThread::AddWorker(uint64_t pid, const std::shared_ptr<WorkerContext>
       return FAILED;
     }
     pid_process_.insert(std::make_pair(pid, notify));
-    if (single_batch_dispatch_) {
-      worker_wait_map_[pid] = static_cast<int64_t>(round_ * batch_size_);
-    } else {
-      worker_wait_map_[pid] = static_cast<int64_t>(round_);
-    }
+    auto servable_spec = notify->GetWorkerSpec().servable_spec;
+    auto &stats = worker_stats_[pid];
+    stats = WorkerStats();
+    stats.batch_size = servable_spec.batch_size > 0 ? servable_spec.batch_size : batch_size_;
+    // the capacity is taken as proportional to the batch size if not specified
+    stats.capacity_weight = static_cast<double>(
+      servable_spec.capacity_weight > 0 ? servable_spec.capacity_weight : stats.batch_size);
+    stats.window = kInitialWindow * static_cast<double>(GetWindowScale(stats));
+    stats.min_latency_time = std::chrono::steady_clock::now();
   }
   SendTasks();
   return SUCCESS;
@@ -109,19 +140,14 @@ Status ModelThread::DelWorker(uint64_t pid) {
       return FAILED;
     }
     (void)pid_process_.erase(it);
-    auto worker_it = worker_wait_map_.find(pid);
-    if (worker_it == worker_wait_map_.end()) {
-      MSI_LOG(INFO) << "pid not existed in worker wait map: " << pid;
-      return FAILED;
-    }
-    (void)worker_wait_map_.erase(worker_it);
+    (void)worker_stats_.erase(pid);
+    KeepOneWorkerAdmitted();
     for (auto &job_item : job_) {
       auto job_id = job_item.first;
       auto &task_list = job_item.second.task;
       for (size_t i = 0; i < task_list.size(); ++i) {
         if (task_list[i].pid == pid) {
-          auto task_id = i;
-          task_wait_queue_.push(std::make_pair(job_id, task_id));
+          PushWaitTask(job_item.second.request_spec.priority, job_id, i);
         }
       }
     }
@@ -133,21 +159,52 @@ Status ModelThread::DelWorker(uint64_t pid) {
   return SUCCESS;
 }
 
+// choose the worker with the least expected completion time per capacity: its latency times the batches queued on it,
+// including the new one, divided by its capacity weight. workers that have not replied yet are expected to be as fast
+// as the median, and the ties are broken by the most free slots and then round-robin by pid. an ejected worker whose
+// ejection has expired is chosen first, to probe it with one batch
 Status ModelThread::FindProcessQueue(uint64_t *pid) {
+  auto now = std::chrono::steady_clock::now();
+  auto median_latency = GetMedianLatency(0);
   int64_t max_free_slot = 0;
+  double min_cost = 0;
   uint64_t cur_pid = 0;
-  for (auto &item : worker_wait_map_) {
-    auto slot = item.second;
-    if (slot <= 0 || slot < max_free_slot) {
+  for (auto &item : worker_stats_) {
+    auto &stats = item.second;
+    // one batch in flight when probing the min latency
+    auto window = stats.min_latency_probing ? kMinWindow * static_cast<double>(GetWindowScale(stats)) : stats.window;
+    auto slot = static_cast<int64_t>(window) - static_cast<int64_t>(stats.inflight);
+    if (slot <= 0) {
+      continue;
+    }
+    if (stats.ejected) {
+      if (stats.probing || now < stats.readmit_time) {
+        continue;
+      }
+      cur_pid = item.first;
+      break;
+    }
+    auto latency = stats.reply_count > 0
+                     ? stats.latency_us
+                     : median_latency * static_cast<double>(stats.batch_size) / stats.capacity_weight;
+    auto cost = latency * static_cast<double>(stats.inflight + 1) / stats.capacity_weight;
+    if (cur_pid != 0 && (cost > min_cost || (cost == min_cost && slot < max_free_slot))) {
       continue;
     }
-    if (slot > max_free_slot || (cur_pid <= last_worker_pid_ && item.first > last_worker_pid_)) {
+    if (cur_pid == 0 || cost < min_cost || slot > max_free_slot ||
+        (cur_pid <= last_worker_pid_ && item.first > last_worker_pid_)) {
+      min_cost = cost;
       max_free_slot = slot;
       cur_pid = item.first;
     }
   }
   if (cur_pid != 0) {
-    worker_wait_map_[cur_pid]--;
+    auto &stats = worker_stats_[cur_pid];
+    stats.inflight++;
+    if (stats.ejected) {
+      stats.probing = true;
+      MSI_LOG_INFO << "Send probe batch to ejected worker " << cur_pid << " of " << spec_.Repr();
+    }
     last_worker_pid_ = cur_pid;
     *pid = cur_pid;
     return SUCCESS;
@@ -155,46 +212,303 @@ Status ModelThread::FindProcessQueue(uint64_t *pid) {
   return FAILED;
 }
 
-Status ModelThread::PushTasks(const proto::PredictRequest &request, proto::PredictReply *reply,
-                              const PredictOnFinish &callback) {
-  auto status = GrpcTensorHelper::CheckRequestInstances(request, method_info_.input_names);
-  if (status != SUCCESS) {
-    MSI_LOG_ERROR << "Check request failed";
-    return status;
+// the batch latency of workers with the same capacity per instance of batch is the same
+double ModelThread::GetNormalizedLatency(const WorkerStats &stats, double latency_us) {
+  return latency_us * stats.capacity_weight / static_cast<double>(stats.batch_size);
+}
+
+// median normalized latency of the admitted workers that have replied, 0 if there is none
+double ModelThread::GetMedianLatency(uint64_t exclude_pid) const {
+  std::vector<double> latency_list;
+  for (auto &item : worker_stats_) {
+    if (item.first != exclude_pid && !item.second.ejected && item.second.reply_count > 0) {
+      latency_list.push_back(GetNormalizedLatency(item.second, item.second.latency_us));
+    }
+  }
+  if (latency_list.empty()) {
+    return 0;
+  }
+  auto middle = latency_list.begin() + latency_list.size() / 2;
+  std::nth_element(latency_list.begin(), middle, latency_list.end());
+  return *middle;
+}
+
+// windows are counted in instances when every instance is dispatched as a batch
+uint64_t ModelThread::GetWindowScale(const WorkerStats &stats) const {
+  return single_batch_dispatch_ ? stats.batch_size : 1;
+}
+
+// AIMD: additive increase while the window is full and the batches are not queued in the worker, multiplicative
+// decrease at most once per round trip when they are, or when the batch fails
+void ModelThread::AdjustWorkerWindow(WorkerStats *stats, double latency_us, bool failed,
+                                     std::chrono::steady_clock::time_point send_time,
+                                     std::chrono::steady_clock::time_point now) {
+  if (stats->min_latency_probing) {
+    // the batches sent after the probe starts are not queued behind others in the worker
+    if (!failed && send_time >= stats->min_latency_time) {
+      stats->min_latency_us = latency_us;
+      stats->min_latency_probing = false;
+      stats->min_latency_time = now;
+    }
+    return;
+  }
+  stats->min_latency_us = std::min(stats->min_latency_us, latency_us);
+  if (now - stats->min_latency_time >= std::chrono::milliseconds(kMinLatencyProbeIntervalMs)) {
+    stats->min_latency_probing = true;
+    stats->min_latency_time = now;
+  }
+  auto scale = static_cast<double>(GetWindowScale(*stats));
+  if (failed || latency_us > stats->min_latency_us * kQueueLatencyRatio) {
+    if (send_time > stats->last_decrease_time) {
+      stats->window = std::max(kMinWindow * scale, stats->window * kWindowDecreaseFactor);
+      stats->last_decrease_time = now;
+    }
+    return;
+  }
+  // the window limits the batches only when it is full
+  if (static_cast<double>(stats->inflight + 1) > stats->window) {
+    stats->window = std::min(kMaxWindow * scale, stats->window + scale / stats->window);
   }
+}
+
+void ModelThread::UpdateWorkerStats(uint64_t pid, double latency_us, bool failed,
+                                    std::chrono::steady_clock::time_point now) {
+  auto &stats = worker_stats_[pid];
+  if (stats.inflight > 0) {
+    stats.inflight--;
+  }
+  auto median_latency = GetMedianLatency(pid);
+  auto is_slow = [median_latency, &stats](double latency) {
+    latency = GetNormalizedLatency(stats, latency);
+    return median_latency > 0 && latency > median_latency * kOutlierLatencyRatio &&
+           latency > median_latency + kOutlierLatencyGapUs;
+  };
+  if (stats.ejected) {
+    if (!stats.probing) {  // reply of a batch sent before the ejection
+      return;
+    }
+    stats.probing = false;
+    if (failed || is_slow(latency_us)) {
+      EjectWorker(pid, &stats, now);
+      return;
+    }
+    MSI_LOG_INFO << "Readmit worker " << pid << ", probe latency " << latency_us << "us, " << spec_.Repr();
+    stats.ejected = false;
+    stats.latency_us = latency_us;
+    stats.error_rate = 0;
+    stats.reply_count = 1;
+    return;
+  }
+  if (stats.reply_count == 0) {
+    stats.latency_us = latency_us;
+  } else {
+    stats.latency_us += kLatencyEwmaWeight * (latency_us - stats.latency_us);
+  }
+  stats.error_rate += kLatencyEwmaWeight * ((failed ? 1.0 : 0.0) - stats.error_rate);
+  stats.reply_count++;
+  if (stats.reply_count < kOutlierMinReplyCount) {
+    return;
+  }
+  if (stats.error_rate <= kOutlierErrorRate && !is_slow(stats.latency_us)) {
+    stats.eject_count = 0;
+    return;
+  }
+  // at least one worker is kept admitted
+  auto admitted_count = std::count_if(worker_stats_.begin(), worker_stats_.end(),
+                                      [](const std::pair<const uint64_t, WorkerStats> &item) {
+                                        return !item.second.ejected;
+                                      });
+  if (admitted_count > 1) {
+    EjectWorker(pid, &stats, now);
+  }
+}
+
+void ModelThread::EjectWorker(uint64_t pid, WorkerStats *stats, std::chrono::steady_clock::time_point now) {
+  auto eject_time_ms = std::min(kBaseEjectTimeMs << std::min<uint64_t>(stats->eject_count, 5), kMaxEjectTimeMs);
+  MSI_LOG_WARNING << "Eject worker " << pid << " for " << eject_time_ms << "ms, latency " << stats->latency_us
+                  << "us, error rate " << stats->error_rate << ", " << spec_.Repr();
+  stats->ejected = true;
+  stats->probing = false;
+  stats->eject_count++;
+  stats->readmit_time = now + std::chrono::milliseconds(eject_time_ms);
+}
+
+// when the last admitted worker is removed, the ejected worker whose ejection ends first is readmitted at once,
+// or the tasks would wait for its ejection to end with nothing to compare it with
+void ModelThread::KeepOneWorkerAdmitted() {
+  uint64_t readmit_pid = 0;
+  WorkerStats *readmit_stats = nullptr;
+  for (auto &item : worker_stats_) {
+    if (!item.second.ejected) {
+      return;
+    }
+    if (readmit_stats == nullptr || item.second.readmit_time < readmit_stats->readmit_time) {
+      readmit_pid = item.first;
+      readmit_stats = &item.second;
+    }
+  }
+  if (readmit_stats == nullptr) {
+    return;
+  }
+  MSI_LOG_INFO << "Readmit worker " << readmit_pid << " before its ejection ends, no other worker is admitted, "
+               << spec_.Repr();
+  readmit_stats->ejected = false;
+  readmit_stats->probing = false;
+}
+
+Status ModelThread::PushTasks(Job &&job, const std::vector<const std::string *> &inputs) {
   std::unique_lock<std::mutex> lock(lock_);
   if (pid_process_.empty()) {
-    RequestSpec request_spec;
-    GrpcTensorHelper::GetRequestSpec(request, &request_spec);
     return INFER_STATUS_LOG_ERROR(SERVABLE_UNAVAILABLE)
-           << "Request " << request_spec.Repr() << ", servable is not available";
+           << "Request " << job.request_spec.Repr() << ", servable is not available";
   }
   auto it = job_.find(job_id_);
   if (it != job_.end()) {
     MSI_LOG(ERROR) << "job_id has existed: " << job_id_;
     return FAILED;
   }
-  int instance_size = request.instances_size();
-  Job job;
+  auto instance_size = inputs.size();
   job.wait_task_num = instance_size;
-  job.callback = callback;
-  job.request = &request;
-  job.reply = reply;
   job.task.resize(instance_size);
-  for (int i = 0; i < instance_size; i++) {
+  job.request_spec.priority = std::min(job.request_spec.priority, kMaxPriority);
+  for (size_t i = 0; i < instance_size; i++) {
     Task &task = job.task[i];
-    task.input = &request.instances(i);
+    task.input = inputs[i];
     task.pid = 0;
-    task_wait_queue_.push(std::make_pair(job_id_, i));
+    PushWaitTask(job.request_spec.priority, job_id_, i);
   }
-  job_.insert(std::make_pair(job_id_, job));
+  // moving keeps the strings of serialized_inputs, which inputs may point to
+  (void)job_.emplace(job_id_, std::move(job));
   job_id_++;
   return SUCCESS;
 }
 
+// stride scheduling between the priorities: the queue with the least virtual time is popped. a queue becoming
+// non-empty starts from the current virtual time, it gets no credit for the time it was empty
+void ModelThread::PushWaitTask(uint32_t priority, uint64_t job_id, uint64_t task_id) {
+  auto it = task_wait_queues_.find(priority);
+  if (it == task_wait_queues_.end()) {
+    it = task_wait_queues_.emplace(priority, TaskWaitQueue()).first;
+    it->second.weight = std::pow(kPriorityWeightRatio, static_cast<double>(priority));
+    it->second.pass = task_wait_pass_;
+  } else if (it->second.tasks.empty()) {
+    it->second.pass = std::max(it->second.pass, task_wait_pass_);
+  }
+  it->second.tasks.push(std::make_pair(job_id, task_id));
+  task_wait_count_++;
+}
+
+std::pair<uint64_t, uint64_t> ModelThread::PopWaitTask() {
+  TaskWaitQueue *wait_queue = nullptr;
+  // the higher priority wins the ties
+  for (auto it = task_wait_queues_.rbegin(); it != task_wait_queues_.rend(); ++it) {
+    if (!it->second.tasks.empty() && (wait_queue == nullptr || it->second.pass < wait_queue->pass)) {
+      wait_queue = &it->second;
+    }
+  }
+  if (wait_queue == nullptr) {
+    MSI_LOG_EXCEPTION << "No task is waiting, " << spec_.Repr();
+  }
+  auto task = wait_queue->tasks.front();
+  wait_queue->tasks.pop();
+  task_wait_count_--;
+  task_wait_pass_ = wait_queue->pass;
+  wait_queue->pass += 1.0 / wait_queue->weight;
+  return task;
+}
+
+// tasks whose requests are past their deadlines are dropped instead of sent, the callers have given up on them
+bool ModelThread::ShedTaskIfExpired(const std::pair<uint64_t, uint64_t> &task,
+                                    std::chrono::steady_clock::time_point now, std::vector<Job> *expired_jobs) {
+  auto job_it = job_.find(task.first);
+  if (job_it == job_.end()) {
+    MSI_LOG_ERROR << "job_id not exist: " << task.first;
+    return true;
+  }
+  auto &job = job_it->second;
+  if (job.request_spec.deadline > now) {
+    return false;
+  }
+  auto &error = job.task[task.second].error;
+  error.set_error_code(DEADLINE_EXCEEDED);
+  error.set_error_msg("Request " + job.request_spec.Repr() + ", deadline exceeded before the instance was dispatched");
+  expired_task_count_++;
+  job.wait_task_num--;
+  if (job.wait_task_num == 0) {
+    expired_jobs->push_back(std::move(job));
+    (void)job_.erase(job_it);
+  }
+  return true;
+}
+
+// drop the expired tasks at the front of each priority, so that they do not hold the workers
+void ModelThread::ShedExpiredTasks(std::chrono::steady_clock::time_point now, std::vector<Job> *expired_jobs) {
+  for (auto &item : task_wait_queues_) {
+    auto &tasks = item.second.tasks;
+    while (!tasks.empty() && ShedTaskIfExpired(tasks.front(), now, expired_jobs)) {
+      tasks.pop();
+      task_wait_count_--;
+    }
+  }
+}
+
+bool ModelThread::PopUnexpiredTask(std::chrono::steady_clock::time_point now, std::pair<uint64_t, uint64_t> *task,
+                                   std::vector<Job> *expired_jobs) {
+  while (task_wait_count_ > 0) {
+    *task = PopWaitTask();
+    if (!ShedTaskIfExpired(*task, now, expired_jobs)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status ModelThread::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
                                   const PredictOnFinish &callback) {
-  auto status = PushTasks(request, reply, callback);
+  auto status = GrpcTensorHelper::CheckRequestInstances(request, method_info_.input_names);
+  if (status != SUCCESS) {
+    MSI_LOG_ERROR << "Check request failed";
+    return status;
+  }
+  Job job;
+  job.callback = callback;
+  job.reply = reply;
+  GrpcTensorHelper::GetRequestSpec(request, &job.request_spec);
+  job.serialized_inputs.resize(request.instances_size());
+  std::vector<const std::string *> inputs;
+  for (int i = 0; i < request.instances_size(); i++) {
+    if (!request.instances(i).SerializeToString(&job.serialized_inputs[i])) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Serialize request instance " << i << " failed";
+    }
+    inputs.push_back(&job.serialized_inputs[i]);
+  }
+  status = PushTasks(std::move(job), inputs);
+  if (status != SUCCESS) {
+    MSI_LOG_ERROR << "Push tasks into queue failed";
+    return status;
+  }
+  SendTasks();
+  return SUCCESS;
+}
+
+Status ModelThread::DispatchAsync(const proto::PassthroughPredictRequest &request,
+                                  proto::PassthroughPredictReply *reply, const PredictOnFinish &callback) {
+  // the tensors are not decoded, but a malformed instance or one without the inputs is rejected with its own request,
+  // instead of failing the batch it would be sent to the worker with
+  auto status = GrpcTensorHelper::CheckPassthroughInstances(request, method_info_.input_names);
+  if (status != SUCCESS) {
+    MSI_LOG_ERROR << "Check request failed";
+    return status;
+  }
+  Job job;
+  job.callback = callback;
+  job.passthrough_reply = reply;
+  GrpcTensorHelper::GetRequestSpec(request, &job.request_spec);
+  std::vector<const std::string *> inputs;
+  for (auto &instance : request.instances()) {
+    inputs.push_back(&instance);
+  }
+  status = PushTasks(std::move(job), inputs);
   if (status != SUCCESS) {
     MSI_LOG_ERROR << "Push tasks into queue failed";
     return status;
@@ -204,54 +518,61 @@ Status ModelThread::DispatchAsync(const proto::PredictRequest &request, proto::P
 }
 
 Status ModelThread::Combine(const std::vector<std::pair<uint64_t, uint64_t>> &ids, uint64_t pid,
-                            proto::PredictRequest *msg) {
-  std::vector<const proto::Instance *> inputs;
+                            proto::PassthroughPredictRequest *msg) {
+  std::vector<const std::string *> inputs;
+  // the batch takes the highest priority of its tasks, the tasks of lower priorities only fill it up. and it takes
+  // the latest deadline, no instance is dropped by the worker while its caller is waiting
+  RequestSpec request_spec = spec_;
+  request_spec.deadline = std::chrono::steady_clock::time_point::min();
   // ids->inputs
   for (auto it = begin(ids); it != end(ids); it++) {
     uint64_t job_id = it->first;
     uint64_t task_id = it->second;
-    job_[job_id].task[task_id].pid = pid;
-    inputs.push_back(job_[job_id].task[task_id].input);
+    auto &job = job_[job_id];
+    job.task[task_id].pid = pid;
+    inputs.push_back(job.task[task_id].input);
+    request_spec.priority = std::max(request_spec.priority, job.request_spec.priority);
+    request_spec.deadline = std::max(request_spec.deadline, job.request_spec.deadline);
   }
-  return GrpcTensorHelper::CreatePredictRequestFromInstances(spec_, inputs, msg);
+  return GrpcTensorHelper::CreatePredictRequestFromInstances(request_spec, inputs, msg);
 }
 
 void ModelThread::SendTasks() {
   while (true) {
     std::shared_ptr<PredictContext> context;
     std::shared_ptr<WorkerContext> worker;
+    std::vector<Job> expired_jobs;
     {  // pop tasks
       std::unique_lock<std::mutex> lock(lock_);
-      if (task_wait_queue_.empty()) {
-        return;
-      }
+      auto now = std::chrono::steady_clock::now();
+      ShedExpiredTasks(now, &expired_jobs);
       uint64_t pid;
-      auto status = FindProcessQueue(&pid);
-      if (status != SUCCESS) {
-        return;
-      }
-      context = std::make_shared<PredictContext>();
-      std::vector<std::pair<uint64_t, uint64_t>> &inputs = context->inputs;
-      if (single_batch_dispatch_) {
-        inputs.push_back(task_wait_queue_.front());
-        task_wait_queue_.pop();
-      } else {
-        for (uint64_t i = 0; i < batch_size_; i++) {
-          if (task_wait_queue_.empty()) {
-            break;
-          }
-          inputs.push_back(task_wait_queue_.front());
-          task_wait_queue_.pop();
+      if (task_wait_count_ > 0 && FindProcessQueue(&pid) == SUCCESS) {
+        context = std::make_shared<PredictContext>();
+        std::vector<std::pair<uint64_t, uint64_t>> &inputs = context->inputs;
+        // the chunk fits the batch size of the worker. the first task popped is at the front of its priority, and
+        // not expired
+        auto chunk_size = single_batch_dispatch_ ? 1 : worker_stats_[pid].batch_size;
+        std::pair<uint64_t, uint64_t> task;
+        while (inputs.size() < chunk_size && PopUnexpiredTask(now, &task, &expired_jobs)) {
+          inputs.push_back(task);
         }
+        context->pid = pid;
+        context->send_time = now;
+        Combine(inputs, pid, context->request);  // inputs string->InstanceData,task pid status
+        worker = pid_process_[pid];
       }
-      context->pid = pid;
-      Combine(inputs, pid, &context->request);  // inputs string->InstanceData,task pid status
-      worker = pid_process_[pid];
+    }
+    for (auto &job : expired_jobs) {
+      ReplyFinishedJob(&job);
+    }
+    if (context == nullptr) {
+      return;
     }
     // send request
     PredictOnFinish callback = [context, worker, this]() {
       bool worker_not_available = false;
-      for (auto &error : context->reply.error_msg()) {
+      for (auto &error : context->reply->error_msg()) {
         if (error.error_code() == WORKER_UNAVAILABLE) {
           worker_not_available = true;
           break;
@@ -263,9 +584,9 @@ void ModelThread::SendTasks() {
         Commit(context);
       }
     };
-    auto status = worker->DispatchAsync(context->request, &context->reply, callback);
+    auto status = worker->DispatchAsync(*context->request, context->reply, callback);
     if (status != SUCCESS) {
-      auto error_msg = context->reply.add_error_msg();
+      auto error_msg = context->reply->add_error_msg();
       error_msg->set_error_code(WORKER_UNAVAILABLE);
       error_msg->set_error_msg(status.StatusMessage());
       worker->NotifyNotAvailable();
@@ -274,15 +595,13 @@ void ModelThread::SendTasks() {
 }
 
 void ModelThread::OnTasksFinished(const std::shared_ptr<PredictContext> &context) {
-  std::unique_lock<std::mutex> lock(lock_);
   const auto pid = context->pid;
   const auto &inputs = context->inputs;
-  if (pid_process_.find(pid) != pid_process_.end()) {
-    worker_wait_map_[pid]++;
-  }
+  // the replies of the workers are split and merged outside the lock, so that the client completion threads work in
+  // parallel
   std::vector<proto::ErrorMsg> error;
-  std::vector<const proto::Instance *> output;
-  auto status = GrpcTensorHelper::CreateInstanceFromPredictReply(spec_, context->reply, &error, &output);
+  std::vector<const std::string *> output;
+  auto status = GrpcTensorHelper::CreateInstanceFromPredictReply(spec_, *context->reply, &error, &output);
   if (status != SUCCESS) {
     status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR)
              << "Get reply failed, servable name: " << spec_.servable_name << ", method name: " << spec_.method_name
@@ -301,6 +620,27 @@ void ModelThread::OnTasksFinished(const std::shared_ptr<PredictContext> &context
     error_msg.set_error_msg(status.StatusMessage());
     error.push_back(error_msg);
   }
+  auto now = std::chrono::steady_clock::now();
+  auto latency_us = std::chrono::duration<double, std::micro>(now - context->send_time).count();
+  // errors of the whole batch caused by the worker, not by the instances
+  bool failed = output.empty() && !error.empty() && error[0].error_code() == SYSTEM_ERROR;
+  // the latency of the batch dropped by the worker after its deadline tells nothing about the worker
+  bool expired = !error.empty() && std::all_of(error.begin(), error.end(), [](const proto::ErrorMsg &item) {
+    return item.error_code() == DEADLINE_EXCEEDED;
+  });
+  std::vector<Job> finished_jobs;
+  std::unique_lock<std::mutex> lock(lock_);
+  auto stats_it = worker_stats_.find(pid);
+  if (stats_it != worker_stats_.end() && expired) {
+    auto &stats = stats_it->second;
+    if (stats.inflight > 0) {
+      stats.inflight--;
+    }
+    stats.probing = false;  // probed again with the next batch
+  } else if (stats_it != worker_stats_.end()) {
+    AdjustWorkerWindow(&stats_it->second, latency_us, failed, context->send_time, now);
+    UpdateWorkerStats(pid, latency_us, failed, now);
+  }
   for (unsigned int i = 0; i < inputs.size(); i++) {
     uint64_t task_id = inputs[i].second;
     uint64_t job_id = inputs[i].first;
@@ -326,18 +666,48 @@ void ModelThread::OnTasksFinished(const std::shared_ptr<PredictContext> &context
     job_item.wait_task_num--;
     job_item.reply_context_list.push_back(context);
     if (job_item.wait_task_num == 0) {
-      // reply job
-      std::vector<const proto::Instance *> out;
-      std::vector<proto::ErrorMsg> error_reply;
-      for (auto &item : job_item.task) {
-        out.push_back(item.output);
-        error_reply.push_back(item.error);
-      }
-      GrpcTensorHelper::CreatePredictReplyFromInstances(*job_item.request, error_reply, out, job_item.reply);
-      job_item.callback();
+      finished_jobs.push_back(std::move(job_item));
       (void)job_.erase(iter2);
     }
   }
+  lock.unlock();
+  for (auto &job : finished_jobs) {
+    ReplyFinishedJob(&job);
+  }
+}
+
+void ModelThread::ReplyFinishedJob(Job *job) {
+  std::vector<const std::string *> out;
+  std::vector<proto::ErrorMsg> error_reply;
+  for (auto &item : job->task) {
+    out.push_back(item.output);
+    error_reply.push_back(item.error);
+  }
+  ReplyJob(job, error_reply, out);
+}
+
+void ModelThread::ReplyJob(Job *job, const std::vector<proto::ErrorMsg> &errors,
+                           const std::vector<const std::string *> &outputs) {
+  // an instance that fails the input check in the worker fails its whole request, as the check in the master does
+  auto status = GrpcTensorHelper::GetInstanceCheckError(errors);
+  if (status != SUCCESS) {
+    if (job->passthrough_reply != nullptr) {
+      GrpcTensorHelper::CreateReplyFromErrorMsg(status, job->passthrough_reply);
+    } else {
+      GrpcTensorHelper::CreateReplyFromErrorMsg(status, job->reply);
+    }
+    job->callback();
+    return;
+  }
+  if (job->passthrough_reply != nullptr) {
+    status = GrpcTensorHelper::CreatePredictReplyFromInstances(errors, outputs, job->passthrough_reply);
+  } else {
+    status = GrpcTensorHelper::CreatePredictReplyFromInstances(errors, outputs, job->reply);
+    if (status != SUCCESS) {
+      GrpcTensorHelper::CreateReplyFromErrorMsg(status, job->reply);
+    }
+  }
+  job->callback();
 }
 
 void ModelThread::Commit(const std::shared_ptr<PredictContext> &context) {
@@ -24,6 +24,7 @@
 #include <mutex>
 #include <map>
 #include <queue>
+#include <chrono>
 #include "common/serving_common.h"
 #include "common/instance.h"
 #include "master/notify_worker/base_notify.h"
@@ -32,26 +33,69 @@
 #include "master/worker_context.h"
 
 namespace mindspore::serving {
+// instances are serialized proto::Instance, the master forwards them without decoding
 struct Task {
-  const proto::Instance *input = nullptr;
-  const proto::Instance *output = nullptr;
+  const std::string *input = nullptr;
+  const std::string *output = nullptr;
   proto::ErrorMsg error;
   uint64_t pid = 0;  // 0:not execute or have executed.others: executing
 };
 
+// tasks of one priority waiting for a worker. the priorities are served in proportion to their weights, so that the
+// higher priorities fill the batches first while the lower ones are not starved
+struct TaskWaitQueue {
+  std::queue<std::pair<uint64_t, uint64_t>> tasks;  // job id, task id
+  double weight = 1;
+  double pass = 0;  // virtual time of the queue, advances by 1/weight with each task popped
+};
+
 struct PredictContext {
-  proto::PredictRequest request;
-  proto::PredictReply reply;
+  // request and reply sent to the worker are allocated on the arena, and freed all at once with the context
+  google::protobuf::Arena arena;
+  proto::PassthroughPredictRequest *request =
+    google::protobuf::Arena::CreateMessage<proto::PassthroughPredictRequest>(&arena);
+  proto::PassthroughPredictReply *reply =
+    google::protobuf::Arena::CreateMessage<proto::PassthroughPredictReply>(&arena);
   uint64_t pid;
   std::vector<std::pair<uint64_t, uint64_t>> inputs;
+  std::chrono::steady_clock::time_point send_time;
+};
+
+// latency and error rate of a worker, measured from the batches it has replied
+struct WorkerStats {
+  // reported by the worker at registration. the batches of a worker are shared out in proportion to its capacity
+  // weight, and its latency is compared with the others after being normalized by the weight and the batch size
+  uint64_t batch_size = 1;
+  double capacity_weight = 1;
+  double latency_us = 0;  // ewma of the batch latency
+  double error_rate = 0;  // ewma of the failed batches
+  uint64_t reply_count = 0;
+  uint64_t inflight = 0;  // batches sent and not replied
+  // an ejected worker gets no batches until readmit_time, then one probe batch decides whether it is readmitted
+  bool ejected = false;
+  bool probing = false;
+  uint64_t eject_count = 0;  // consecutive ejections, the ejection time doubles with each one
+  std::chrono::steady_clock::time_point readmit_time;
+  // window of in-flight batches. it grows by one batch per round trip while the latency stays close to the latency
+  // without queueing, and shrinks when the batches queue in the worker, so that the tasks wait in the master instead
+  double window = 0;
+  // latency without queueing in the worker, measured again periodically with one batch in flight
+  double min_latency_us = 0;
+  bool min_latency_probing = true;
+  std::chrono::steady_clock::time_point min_latency_time;  // start time of the last probe
+  std::chrono::steady_clock::time_point last_decrease_time;
 };
 
 struct Job {
   std::vector<Task> task;
   uint64_t wait_task_num = 0;
   PredictOnFinish callback;
-  const proto::PredictRequest *request = nullptr;
+  RequestSpec request_spec;
+  // instances of PredictRequest serialized by the master, empty for PassthroughPredictRequest
+  std::vector<std::string> serialized_inputs;
+  // reply of PredictRequest or PassthroughPredictRequest
   proto::PredictReply *reply = nullptr;
+  proto::PassthroughPredictReply *passthrough_reply = nullptr;
   std::vector<std::shared_ptr<PredictContext>> reply_context_list;
 };
 
@@ -64,26 +108,49 @@ class ModelThread {
   Status AddWorker(uint64_t pid, const std::shared_ptr<WorkerContext> &notify);
   Status DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
                        const PredictOnFinish &callback);
+  // instances are forwarded to the worker as they are, and checked by the worker
+  Status DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
+                       const PredictOnFinish &callback);
 
  private:
   std::map<uint64_t, std::shared_ptr<WorkerContext>> pid_process_;
   uint64_t last_worker_pid_ = 0;
-  std::map<uint64_t, int64_t> worker_wait_map_;
-  std::queue<std::pair<uint64_t, uint64_t>> task_wait_queue_;
+  std::map<uint64_t, WorkerStats> worker_stats_;
+  std::map<uint32_t, TaskWaitQueue> task_wait_queues_;  // priority: tasks
+  uint64_t task_wait_count_ = 0;
+  double task_wait_pass_ = 0;  // virtual time of the last popped task
+  uint64_t expired_task_count_ = 0;  // tasks dropped at dispatch after the deadlines of their requests
   std::map<uint64_t, Job> job_;
   uint64_t job_id_ = 0;
-  uint64_t round_ = 3;
   std::mutex lock_;
   RequestSpec spec_;
   ServableMethodInfo method_info_;
-  uint64_t batch_size_;
+  uint64_t batch_size_;  // of the workers that report no batch size
   bool single_batch_dispatch_ = false;
 
   void Clear();
   void InnerClear();
   Status FindProcessQueue(uint64_t *pid);
-  Status PushTasks(const proto::PredictRequest &request, proto::PredictReply *reply, const PredictOnFinish &callback);
-  Status Combine(const std::vector<std::pair<uint64_t, uint64_t>> &ids, uint64_t pid, proto::PredictRequest *msg);
+  double GetMedianLatency(uint64_t exclude_pid) const;
+  static double GetNormalizedLatency(const WorkerStats &stats, double latency_us);
+  void UpdateWorkerStats(uint64_t pid, double latency_us, bool failed, std::chrono::steady_clock::time_point now);
+  void EjectWorker(uint64_t pid, WorkerStats *stats, std::chrono::steady_clock::time_point now);
+  void KeepOneWorkerAdmitted();
+  void AdjustWorkerWindow(WorkerStats *stats, double latency_us, bool failed,
+                          std::chrono::steady_clock::time_point send_time, std::chrono::steady_clock::time_point now);
+  uint64_t GetWindowScale(const WorkerStats &stats) const;
+  Status PushTasks(Job &&job, const std::vector<const std::string *> &inputs);
+  void PushWaitTask(uint32_t priority, uint64_t job_id, uint64_t task_id);
+  std::pair<uint64_t, uint64_t> PopWaitTask();
+  bool PopUnexpiredTask(std::chrono::steady_clock::time_point now, std::pair<uint64_t, uint64_t> *task,
+                        std::vector<Job> *expired_jobs);
+  void ShedExpiredTasks(std::chrono::steady_clock::time_point now, std::vector<Job> *expired_jobs);
+  bool ShedTaskIfExpired(const std::pair<uint64_t, uint64_t> &task, std::chrono::steady_clock::time_point now,
+                         std::vector<Job> *expired_jobs);
+  void ReplyFinishedJob(Job *job);
+  void ReplyJob(Job *job, const std::vector<proto::ErrorMsg> &errors, const std::vector<const std::string *> &outputs);
+  Status Combine(const std::vector<std::pair<uint64_t, uint64_t>> &ids, uint64_t pid,
+                 proto::PassthroughPredictRequest *msg);
   void OnTasksFinished(const std::shared_ptr<PredictContext> &context);
   void SendTasks();
   void Commit(const std::shared_ptr<PredictContext> &context);
@@ -30,7 +30,7 @@ class MS_API BaseNotifyWorker {
  public:
   BaseNotifyWorker() = default;
   virtual ~BaseNotifyWorker() = default;
-  virtual Status DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+  virtual Status DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
                                const PredictOnFinish &on_finish) = 0;
 };
 
@@ -17,36 +17,47 @@
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/health_check_service_interface.h>
 #include <thread>
+#include <mutex>
 #include "common/exit_handle.h"
 #include "common/grpc_server.h"
 #include "common/proto_tensor.h"
+#include "master/master_context.h"
 
 namespace mindspore {
 namespace serving {
 GrpcNotifyWorker::GrpcNotifyWorker(const std::string &worker_address) {
   worker_address_ = worker_address;
-  std::shared_ptr<grpc::Channel> channel = GrpcServer::CreateChannel(worker_address);
-  stub_ = proto::MSWorker::NewStub(channel);
+  auto channels = GrpcServer::CreateChannels(worker_address, MasterContext::Instance()->GetWorkerChannelNum());
+  for (auto &channel : channels) {
+    stubs_.push_back(proto::MSWorker::NewStub(channel));
+  }
 }
 
 GrpcNotifyWorker::~GrpcNotifyWorker() = default;
 
-Status GrpcNotifyWorker::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                                       const PredictOnFinish &on_finish) {
-  if (!stub_) {
+Status GrpcNotifyWorker::DispatchAsync(const proto::PassthroughPredictRequest &request,
+                                       proto::PassthroughPredictReply *reply, const PredictOnFinish &on_finish) {
+  if (stubs_.empty()) {
     return INFER_STATUS_LOG_ERROR(WORKER_UNAVAILABLE)
            << "Predict failed, worker gRPC has not been inited or has already exited, worker address "
            << worker_address_;
   }
-  if (!client_) {
+  static std::once_flag client_init_flag;
+  std::call_once(client_init_flag, []() {
     client_ = std::make_unique<MSPredictClient>();
-    client_->Start();
-  }
+    client_->Start(MasterContext::Instance()->GetWorkerClientThreadNum());
+  });
   AsyncPredictCallback callback = [reply, on_finish](Status status) {
     GrpcTensorHelper::CreateReplyFromErrorMsg(status, reply);
     on_finish();
   };
-  client_->PredictAsync(request, reply, stub_.get(), callback, worker_address_);
+  auto &stub = stubs_[next_stub_index_.fetch_add(1, std::memory_order_relaxed) % stubs_.size()];
+  // the instances not decoded by the master are parsed one by one by the worker
+  if (MasterContext::Instance()->GetEnablePassthrough()) {
+    client_->PredictPassthroughAsync(request, reply, stub.get(), callback, worker_address_);
+  } else {
+    client_->PredictAsync(request, reply, stub.get(), callback, worker_address_);
+  }
   return SUCCESS;
 }
 }  // namespace serving
@@ -31,12 +31,14 @@ class MS_API GrpcNotifyWorker : public BaseNotifyWorker {
   explicit GrpcNotifyWorker(const std::string &worker_address);
   ~GrpcNotifyWorker() override;
 
-  Status DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+  Status DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
                        const PredictOnFinish &on_finish) override;
 
  private:
   std::string worker_address_;
-  std::shared_ptr<proto::MSWorker::Stub> stub_ = nullptr;
+  // one stub on every channel to the worker, the rpcs are spread over them in turn
+  std::vector<std::shared_ptr<proto::MSWorker::Stub>> stubs_;
+  std::atomic<uint64_t> next_stub_index_{0};
 };
 
 }  // namespace serving
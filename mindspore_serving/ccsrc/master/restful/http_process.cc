@@ -754,6 +754,7 @@ Status RestfulService::ParseReqCommonMsg(const std::shared_ptr<RestfulRequest> &
   request->mutable_servable_spec()->set_name(request_ptr->model_name_);
   request->mutable_servable_spec()->set_version_number(request_ptr->version_);
   request->mutable_servable_spec()->set_method_name(request_ptr->service_method_);
+  GrpcTensorHelper::SetRequestDeadline(request_ptr->deadline_, request->mutable_servable_spec());
   return status;
 }
 
@@ -21,6 +21,7 @@
 #include <event2/http.h>
 #include <string>
 #include <memory>
+#include <chrono>
 #include <nlohmann/json.hpp>
 #include "common/serving_common.h"
 
@@ -42,6 +43,7 @@ class DecomposeEvRequest {
   std::string service_method_;
   uint32_t version_{};
   uint32_t max_msg_size_{};
+  std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
   nlohmann::json request_message_;
 };
 
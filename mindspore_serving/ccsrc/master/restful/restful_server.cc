@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <vector>
+#include <chrono>
 #include "openssl/ssl.h"
 #include "openssl/err.h"
 #include "event2/bufferevent.h"
@@ -40,6 +41,9 @@ void RestfulServer::DispatchEvHttpRequest(evhttp_request *request) {
   Status status(SUCCESS);
 
   auto de_request = std::make_unique<DecomposeEvRequest>(request, max_msg_size_);
+  if (time_out_second_ > 0) {
+    de_request->deadline_ = std::chrono::steady_clock::now() + std::chrono::seconds(time_out_second_);
+  }
   Status de_status = de_request->Decompose();
   auto restful_request = std::make_shared<RestfulRequest>(std::move(de_request));
   status = restful_request->RestfulReplayBufferInit();
@@ -241,6 +245,7 @@ Status RestfulServer::Start(const std::string &socket_address, const SSLConfig &
   socket_address_ = socket_address;
   constexpr int mbytes_to_bytes = static_cast<int>(1u << 20);
   max_msg_size_ = max_msg_size * mbytes_to_bytes;
+  time_out_second_ = time_out_second;
 
   if (ssl_config.use_ssl) {
     status = CreatHttpsServer(time_out_second, ssl_config);
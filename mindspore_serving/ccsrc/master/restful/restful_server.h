@@ -65,6 +65,7 @@ class RestfulServer {
 
   std::string socket_address_;
   int max_msg_size_ = 0;
+  int time_out_second_ = 0;  // the connection is closed after it, and so is the request dropped
   bool in_running_ = false;
 
   struct evhttp *event_http_ = nullptr;
@@ -23,8 +23,8 @@ ServableEndPoint::ServableEndPoint(const ServableReprInfo &repr) : worker_repr_(
 
 ServableEndPoint::~ServableEndPoint() { Clear(); }
 
-Status ServableEndPoint::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                                       const PredictOnFinish &on_finish) {
+template <class Request, class Reply>
+Status ServableEndPoint::DispatchAsyncInner(const Request &request, Reply *reply, const PredictOnFinish &on_finish) {
   auto method_name = request.servable_spec().method_name();
   auto it = model_thread_list_.find(method_name);
   if (it == model_thread_list_.end()) {
@@ -34,8 +34,23 @@ Status ServableEndPoint::DispatchAsync(const proto::PredictRequest &request, pro
   return status;
 }
 
+Status ServableEndPoint::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+                                       const PredictOnFinish &on_finish) {
+  return DispatchAsyncInner(request, reply, on_finish);
+}
+
+Status ServableEndPoint::DispatchAsync(const proto::PassthroughPredictRequest &request,
+                                       proto::PassthroughPredictReply *reply, const PredictOnFinish &on_finish) {
+  return DispatchAsyncInner(request, reply, on_finish);
+}
+
 Status ServableEndPoint::RegisterWorker(const ServableRegSpec &servable_spec, std::shared_ptr<WorkerContext> worker) {
   auto &methods = servable_spec.methods;
+  // the batch size of every worker may differ, the tasks are dispatched to each worker in chunks of its batch size
+  if (servable_spec.batch_size <= 0) {
+    MSI_LOG_ERROR << "Register Worker,method batch_size should be greater than 0";
+    return FAILED;
+  }
   // first init
   if (worker_contexts_.empty()) {
     methods_ = servable_spec.methods;
@@ -43,10 +58,6 @@ Status ServableEndPoint::RegisterWorker(const ServableRegSpec &servable_spec, st
       version_number_ = servable_spec.version_number;
     }
     for (auto &method : methods) {
-      if (servable_spec.batch_size <= 0) {
-        MSI_LOG_ERROR << "Register Worker,method batch_size should be greater than 0";
-        return FAILED;
-      }
       auto model_thread = std::make_shared<ModelThread>(servable_spec.servable_name, method.name,
                                                         servable_spec.version_number, servable_spec.batch_size, method);
       (void)model_thread_list_.emplace(method.name, model_thread);
@@ -35,6 +35,8 @@ class ServableEndPoint {
   ~ServableEndPoint();
   Status DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
                        const PredictOnFinish &on_finish);
+  Status DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
+                       const PredictOnFinish &on_finish);
 
   Status RegisterWorker(const ServableRegSpec &servable_spec, std::shared_ptr<WorkerContext> worker);
   Status UnregisterWorker(const std::string &worker_address);
@@ -45,6 +47,9 @@ class ServableEndPoint {
   std::vector<ServableMethodInfo> GetMethods() const { return methods_; }
 
  private:
+  template <class Request, class Reply>
+  Status DispatchAsyncInner(const Request &request, Reply *reply, const PredictOnFinish &on_finish);
+
   std::map<std::string, std::shared_ptr<ModelThread>> model_thread_list_;
   ServableReprInfo worker_repr_;
   std::vector<ServableMethodInfo> methods_;
@@ -22,6 +22,7 @@
 #include "common/serving_common.h"
 #include "master/grpc/grpc_process.h"
 #include "master/grpc/grpc_server.h"
+#include "master/master_context.h"
 
 namespace mindspore {
 namespace serving {
@@ -35,7 +36,8 @@ Status Server::StartGrpcServer(const std::string &socket_address, const SSLConfi
     max_msg_mb_size = gRpcMaxMBMsgSize;
   }
   grpc_async_server_ = std::make_shared<ServiceGrpcServer>(dispatcher_);
-  return grpc_async_server_->Start(socket_address, ssl_config, max_msg_mb_size, "Serving gRPC");
+  return grpc_async_server_->Start(socket_address, ssl_config, max_msg_mb_size, "Serving gRPC",
+                                   MasterContext::Instance()->GetServingGrpcThreadNum());
 }
 
 Status Server::StartGrpcMasterServer(const std::string &master_address) {
@@ -45,7 +47,8 @@ Status Server::StartGrpcMasterServer(const std::string &master_address) {
   SSLConfig ssl_config;
   ssl_config.use_ssl = false;
   master_async_server_ = std::make_shared<MasterGrpcServer>(dispatcher_);
-  return master_async_server_->Start(master_address, ssl_config, gRpcMaxMBMsgSize, "Master");
+  return master_async_server_->Start(master_address, ssl_config, gRpcMaxMBMsgSize, "Master",
+                                     MasterContext::Instance()->GetMasterGrpcThreadNum());
 }
 
 Status Server::StartRestfulServer(const std::string &socket_address, const SSLConfig &ssl_config, int max_msg_mb_size,
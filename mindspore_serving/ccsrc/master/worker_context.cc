@@ -30,8 +30,8 @@ std::shared_ptr<WorkerContext> WorkerContext::PyInitWorkerContext(std::string se
 }
 
 // from Dispatcher
-Status WorkerContext::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                                    const PredictOnFinish &on_finish) {
+Status WorkerContext::DispatchAsync(const proto::PassthroughPredictRequest &request,
+                                    proto::PassthroughPredictReply *reply, const PredictOnFinish &on_finish) {
   auto shared_this = shared_from_this();
   PredictOnFinish callback = [shared_this, on_finish, reply]() {
     auto &error_msg = reply->error_msg();
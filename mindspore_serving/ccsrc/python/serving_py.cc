@@ -65,12 +65,17 @@ void PyRegServable(pybind11::module *m_ptr) {
     .def_readwrite("inputs_count", &CommonModelMeta::inputs_count)
     .def_readwrite("outputs_count", &CommonModelMeta::outputs_count)
     .def_readwrite("with_batch_dim", &CommonModelMeta::with_batch_dim)
-    .def_readwrite("without_batch_dim_inputs", &CommonModelMeta::without_batch_dim_inputs);
+    .def_readwrite("without_batch_dim_inputs", &CommonModelMeta::without_batch_dim_inputs)
+    .def_readwrite("preferred_batch_size", &CommonModelMeta::preferred_batch_size)
+    .def_readwrite("max_queue_delay_us", &CommonModelMeta::max_queue_delay_us);
 
   py::class_<LocalModelMeta>(m, "LocalModelMeta_")
     .def(py::init<>())
     .def_readwrite("model_file", &LocalModelMeta::model_files)
     .def_readwrite("config_file", &LocalModelMeta::config_file)
+    .def_readwrite("batch_bucket_files", &LocalModelMeta::batch_bucket_files)
+    .def_readwrite("replica_num", &LocalModelMeta::replica_num)
+    .def_readwrite("input_buffer_num", &LocalModelMeta::input_buffer_num)
     .def_readwrite("model_context", &LocalModelMeta::model_context)
     .def("set_model_format", &LocalModelMeta::SetModelFormat);
 
@@ -104,6 +109,7 @@ void PyRegServable(pybind11::module *m_ptr) {
     .def_static("register_method", &PyServableRegister::RegisterMethod)
     .def_static("declare_model", &PyServableRegister::DeclareModel)
     .def_static("declare_distributed_model", &PyServableRegister::DeclareDistributedModel)
+    .def_static("set_cpp_stage_thread_num", &PyServableRegister::SetCppStageThreadNum)
     .def_static("run", &PyServableRegister::Run);
 
   py::class_<OneRankConfig>(m, "OneRankConfig_")
@@ -185,6 +191,21 @@ void PyRegWorker(pybind11::module *m_ptr) {
     .def_static("support_reuse_device", &PyWorker::SupportReuseDevice)
     .def_static("notify_failed", &PyWorker::NotifyFailed);
 
+  py::class_<SharedMemoryItem>(m, "SharedMemoryItem_")
+    .def_readonly("memory_key_prefix", &SharedMemoryItem::memory_key_prefix)
+    .def_readonly("memory_key", &SharedMemoryItem::memory_key)
+    .def_readonly("bytes_size", &SharedMemoryItem::bytes_size)
+    .def_readonly("offset", &SharedMemoryItem::offset)
+    .def_readonly("size", &SharedMemoryItem::size)
+    .def_property_readonly("buffer", &PySharedMemory::GetItemBuffer);
+
+  py::class_<PySharedMemory>(m, "SharedMemory_")
+    .def_static("new_memory_buffer", &PySharedMemory::NewMemoryBuffer)
+    .def_static("delete_memory_buffer", &PySharedMemory::DeleteMemoryBuffer)
+    .def_static("alloc_memory_item", &PySharedMemory::AllocMemoryItem)
+    .def_static("release_memory_item", &PySharedMemory::ReleaseMemoryItem)
+    .def_static("attach", &PySharedMemory::Attach);
+
   py::class_<ServableContext, std::shared_ptr<ServableContext>>(m, "ServableContext_")
     .def(py::init<>())
     .def_static("get_instance", &ServableContext::Instance)
@@ -196,12 +217,20 @@ void PyRegWorker(pybind11::module *m_ptr) {
            }
          })
     .def("set_device_id", &ServableContext::SetDeviceId)
-    .def("set_enable_lite", &ServableContext::SetEnableLite);
+    .def("set_enable_lite", &ServableContext::SetEnableLite)
+    .def("set_worker_grpc_thread_num", &ServableContext::SetWorkerGrpcThreadNum)
+    .def("set_agent_grpc_thread_num", &ServableContext::SetAgentGrpcThreadNum)
+    .def("set_worker_capacity_weight", &ServableContext::SetWorkerCapacityWeight);
 
   py::class_<MasterContext, std::shared_ptr<MasterContext>>(m, "MasterContext_")
     .def(py::init<>())
     .def_static("get_instance", &MasterContext::Instance)
-    .def("set_max_enqueued_requests", &MasterContext::SetMaxEnqueuedRequests);
+    .def("set_max_enqueued_requests", &MasterContext::SetMaxEnqueuedRequests)
+    .def("set_enable_passthrough", &MasterContext::SetEnablePassthrough)
+    .def("set_serving_grpc_thread_num", &MasterContext::SetServingGrpcThreadNum)
+    .def("set_master_grpc_thread_num", &MasterContext::SetMasterGrpcThreadNum)
+    .def("set_worker_client_thread_num", &MasterContext::SetWorkerClientThreadNum)
+    .def("set_worker_channel_num", &MasterContext::SetWorkerChannelNum);
 }
 
 void PyRegWorkerAgent(pybind11::module *m_ptr) {
@@ -39,6 +39,12 @@ void PyServableRegister::DeclareDistributedModel(const ModelMeta &servable) {
     MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
   }
 }
+void PyServableRegister::SetCppStageThreadNum(uint32_t thread_num) {
+  auto status = ServableRegister::Instance().SetCppStageThreadNum(thread_num);
+  if (status != SUCCESS) {
+    MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
+  }
+}
 void PyServableRegister::RegisterInputOutputInfo(const std::string &model_key, size_t inputs_count,
                                                  size_t outputs_count, uint64_t subgraph) {
   auto status = ServableRegister::Instance().RegisterInputOutputInfo(model_key, inputs_count, outputs_count, subgraph);
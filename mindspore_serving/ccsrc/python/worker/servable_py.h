@@ -34,6 +34,7 @@ class MS_API PyServableRegister {
 
   static void DeclareModel(const ModelMeta &servable);
   static void DeclareDistributedModel(const ModelMeta &servable);
+  static void SetCppStageThreadNum(uint32_t thread_num);
 
   static void RegisterInputOutputInfo(const std::string &model_key, size_t inputs_count, size_t outputs_count,
                                       uint64_t subgraph = 0);
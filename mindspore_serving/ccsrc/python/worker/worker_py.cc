@@ -255,4 +255,51 @@ bool PyWorker::SupportReuseDevice() { return InferenceLoader::Instance().Support
 void PyWorker::NotifyFailed(const std::string &master_address, const std::string &error_msg) {
   GrpcNotifyMaster::NotifyFailed(master_address, error_msg);
 }
+void PySharedMemory::NewMemoryBuffer(const std::string &memory_key_prefix, uint64_t item_size, uint64_t item_count) {
+  auto status = SharedMemoryAllocator::Instance().NewMemoryBuffer(memory_key_prefix, item_size, item_count);
+  if (status != SUCCESS) {
+    MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
+  }
+}
+
+void PySharedMemory::DeleteMemoryBuffer(const std::string &memory_key_prefix) {
+  auto status = SharedMemoryAllocator::Instance().DeleteMemoryBuffer(memory_key_prefix);
+  if (status != SUCCESS) {
+    MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
+  }
+}
+
+SharedMemoryItem PySharedMemory::AllocMemoryItem(const std::string &memory_key_prefix) {
+  SharedMemoryItem shm_item;
+  auto status = SharedMemoryAllocator::Instance().AllocMemoryItem(memory_key_prefix, &shm_item);
+  if (status != SUCCESS) {
+    MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
+  }
+  return shm_item;
+}
+
+void PySharedMemory::ReleaseMemoryItem(const SharedMemoryItem &shm_item) {
+  SharedMemoryAllocator::Instance().ReleaseMemoryItem(shm_item);
+}
+
+py::array PySharedMemory::GetItemBuffer(const SharedMemoryItem &shm_item) {
+  return AsNumpyBuffer(shm_item.offset_address, shm_item.size);
+}
+
+py::array PySharedMemory::Attach(const std::string &memory_key, uint64_t bytes_size, uint64_t offset, uint64_t size) {
+  SharedMemoryAttachItem attach_item;
+  auto status = SharedMemoryManager::Instance().Attach(memory_key, bytes_size, offset, size, &attach_item);
+  if (status != SUCCESS) {
+    MSI_LOG_EXCEPTION << "Raise failed: " << status.StatusMessage();
+  }
+  return AsNumpyBuffer(attach_item.offset_address, attach_item.size);
+}
+
+py::array PySharedMemory::AsNumpyBuffer(uint8_t *address, uint64_t size) {
+  // the shared memory is not owned by the numpy array, the empty capsule only avoids the copy of the data
+  py::capsule base(address, static_cast<void (*)(void *)>([](void *) {}));
+  std::vector<ssize_t> shape = {static_cast<ssize_t>(size)};
+  std::vector<ssize_t> strides = {static_cast<ssize_t>(sizeof(uint8_t))};
+  return py::array(py::dtype::of<uint8_t>(), shape, strides, address, base);
+}
 }  // namespace mindspore::serving
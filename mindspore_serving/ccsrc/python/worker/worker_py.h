@@ -24,6 +24,7 @@
 #include "common/serving_common.h"
 #include "worker/worker.h"
 #include "worker/task_queue.h"
+#include "common/shared_memory.h"
 #include "python/tensor_py.h"
 
 namespace mindspore::serving {
@@ -65,6 +66,22 @@ class MS_API PyWorker {
                                 std::map<std::string, std::shared_ptr<ModelLoaderBase>> *models_loader);
 };
 
+// shared memory of the inputs and outputs of python stages running in helper processes
+class MS_API PySharedMemory {
+ public:
+  static void NewMemoryBuffer(const std::string &memory_key_prefix, uint64_t item_size, uint64_t item_count);
+  static void DeleteMemoryBuffer(const std::string &memory_key_prefix);
+  static SharedMemoryItem AllocMemoryItem(const std::string &memory_key_prefix);
+  static void ReleaseMemoryItem(const SharedMemoryItem &shm_item);
+  // uint8 numpy array of the allocated item, valid until the memory buffer is deleted
+  static py::array GetItemBuffer(const SharedMemoryItem &shm_item);
+  // uint8 numpy array of the shared memory created by other processes
+  static py::array Attach(const std::string &memory_key, uint64_t bytes_size, uint64_t offset, uint64_t size);
+
+ private:
+  static py::array AsNumpyBuffer(uint8_t *address, uint64_t size);
+};
+
 }  // namespace mindspore::serving
 
 #endif  // MINDSPORE_SERVING_WORKER_PY_H
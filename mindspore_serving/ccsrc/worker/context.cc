@@ -61,4 +61,16 @@ Status ServableContext::SetDeviceTypeStr(const std::string &device_type) {
 void ServableContext::SetEnableLite(bool enable_lite) { enable_lite_ = enable_lite; }
 
 bool ServableContext::EnableLite() const { return enable_lite_; }
+
+void ServableContext::SetWorkerGrpcThreadNum(uint32_t thread_num) { worker_grpc_thread_num_ = thread_num; }
+
+uint32_t ServableContext::GetWorkerGrpcThreadNum() const { return worker_grpc_thread_num_; }
+
+void ServableContext::SetAgentGrpcThreadNum(uint32_t thread_num) { agent_grpc_thread_num_ = thread_num; }
+
+uint32_t ServableContext::GetAgentGrpcThreadNum() const { return agent_grpc_thread_num_; }
+
+void ServableContext::SetWorkerCapacityWeight(uint64_t capacity_weight) { worker_capacity_weight_ = capacity_weight; }
+
+uint64_t ServableContext::GetWorkerCapacityWeight() const { return worker_capacity_weight_; }
 }  // namespace mindspore::serving
@@ -38,10 +38,23 @@ class MS_API ServableContext {
   void SetEnableLite(bool enable_lite);
   bool EnableLite() const;
 
+  // number of completion queues and threads of the worker and distributed worker gRPC servers
+  void SetWorkerGrpcThreadNum(uint32_t thread_num);
+  uint32_t GetWorkerGrpcThreadNum() const;
+  // number of completion queues of the agent gRPC server
+  void SetAgentGrpcThreadNum(uint32_t thread_num);
+  uint32_t GetAgentGrpcThreadNum() const;
+  // relative capacity of the worker reported to the master, 0: proportional to the batch size
+  void SetWorkerCapacityWeight(uint64_t capacity_weight);
+  uint64_t GetWorkerCapacityWeight() const;
+
  private:
   DeviceType device_type_ = kDeviceTypeNotSpecified;
   uint32_t device_id_ = 0;
   bool enable_lite_ = false;
+  uint32_t worker_grpc_thread_num_ = 1;
+  uint32_t agent_grpc_thread_num_ = 1;
+  uint64_t worker_capacity_weight_ = 0;
 };
 
 }  // namespace mindspore::serving
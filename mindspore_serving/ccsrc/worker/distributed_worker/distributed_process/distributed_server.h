@@ -187,13 +187,13 @@ class DistributedWorkerGrpcServer : public GrpcAsyncServer<proto::MSDistributedW
       : GrpcAsyncServer<proto::MSDistributedWorker::AsyncService>(),
         service_impl_(MSDistributedImpl(servable, server_address)) {}
 
-  void EnqueueRequests() override {
-    WorkerAgentRegisterContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    WorkerAgentExitContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    WorkerAgentFailedContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    WorkerAgentConfigAcquireContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    WorkerPingContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
-    WorkerPongContext::EnqueueRequest(&service_impl_, &svc_, cq_.get());
+  void EnqueueRequests(grpc::ServerCompletionQueue *cq) override {
+    WorkerAgentRegisterContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerAgentExitContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerAgentFailedContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerAgentConfigAcquireContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerPingContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerPongContext::EnqueueRequest(&service_impl_, &svc_, cq);
   }
 
  private:
@@ -18,6 +18,7 @@
 #include <grpcpp/health_check_service_interface.h>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <thread>
+#include <mutex>
 #include "common/exit_handle.h"
 #include "common/grpc_server.h"
 #include "common/grpc_client.h"
@@ -28,6 +29,10 @@ GrpcNotifyAgent::GrpcNotifyAgent(const std::string &agent_address) {
   agent_address_ = agent_address;
   std::shared_ptr<grpc::Channel> channel = GrpcServer::CreateChannel(agent_address_);
   stub_ = proto::MSAgent::NewStub(channel);
+  auto predict_channels = GrpcServer::CreateChannels(agent_address_, kDefaultClientChannelNum);
+  for (auto &predict_channel : predict_channels) {
+    predict_stubs_.push_back(proto::MSAgent::NewStub(predict_channel));
+  }
 }
 
 GrpcNotifyAgent::~GrpcNotifyAgent() = default;
@@ -55,15 +60,17 @@ Status GrpcNotifyAgent::Exit() {
 
 Status GrpcNotifyAgent::DispatchAsync(const proto::DistributedPredictRequest &request,
                                       proto::DistributedPredictReply *reply, AsyncPredictCallback callback) {
-  if (!stub_) {
+  if (predict_stubs_.empty()) {
     return INFER_STATUS_LOG_ERROR(FAILED)
            << "Predict failed, agent gRPC has not been inited or has already exited, agent address " << agent_address_;
   }
-  if (!distributed_client_) {
+  static std::once_flag client_init_flag;
+  std::call_once(client_init_flag, []() {
     distributed_client_ = std::make_unique<MSDistributedClient>();
-    distributed_client_->Start();
-  }
-  distributed_client_->PredictAsync(request, reply, stub_.get(), callback, agent_address_);
+    distributed_client_->Start(kDefaultClientThreadNum);
+  });
+  auto &stub = predict_stubs_[next_stub_index_.fetch_add(1, std::memory_order_relaxed) % predict_stubs_.size()];
+  distributed_client_->PredictAsync(request, reply, stub.get(), callback, agent_address_);
   return SUCCESS;
 }  // namespace serving
 }  // namespace serving
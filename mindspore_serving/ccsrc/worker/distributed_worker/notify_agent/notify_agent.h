@@ -39,6 +39,9 @@ class MS_API GrpcNotifyAgent : public BaseNotifyAgent {
  private:
   std::string agent_address_;
   std::shared_ptr<proto::MSAgent::Stub> stub_ = nullptr;
+  // predict stubs on the channels to the agent, the rpcs are spread over them in turn
+  std::vector<std::shared_ptr<proto::MSAgent::Stub>> predict_stubs_;
+  std::atomic<uint64_t> next_stub_index_{0};
 };
 
 }  // namespace serving
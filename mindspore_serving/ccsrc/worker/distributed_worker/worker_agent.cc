@@ -20,6 +20,7 @@
 #include "worker/distributed_worker/notify_distributed/notify_worker.h"
 #include "common/exit_handle.h"
 #include "common/proto_tensor.h"
+#include "worker/context.h"
 
 namespace mindspore {
 namespace serving {
@@ -85,7 +86,8 @@ Status WorkerAgent::StartAgent(const AgentStartUpConfig &config, const std::stri
 
 Status WorkerAgent::StartGrpcServer() {
   std::string server_address = config_.agent_address;
-  return grpc_server_.Start(std::make_shared<MSAgentImpl>(server_address), server_address, gRpcMaxMBMsgSize, "Agent");
+  return grpc_server_.Start(std::make_shared<MSAgentImpl>(server_address), server_address, gRpcMaxMBMsgSize, "Agent",
+                            ServableContext::Instance()->GetAgentGrpcThreadNum());
 }
 
 Status WorkerAgent::RegisterAgent() {
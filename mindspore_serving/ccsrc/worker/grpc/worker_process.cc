@@ -27,9 +27,25 @@ void MSWorkerImpl::Exit(const proto::ExitRequest *request, proto::ExitReply *rep
 
 void MSWorkerImpl::PredictAsync(const proto::PredictRequest *request, proto::PredictReply *reply,
                                 const PredictOnFinish &on_finish) {
+  PredictAsyncInner(
+    [request, reply, on_finish]() { return Worker::GetInstance().RunAsync(*request, reply, on_finish); }, reply,
+    on_finish);
+}
+
+void MSWorkerImpl::PredictAsync(const proto::PassthroughPredictRequest *request, proto::PredictRequest *parsed_request,
+                                proto::PredictReply *reply, const PredictOnFinish &on_finish) {
+  PredictAsyncInner(
+    [request, parsed_request, reply, on_finish]() {
+      return Worker::GetInstance().RunAsync(*request, parsed_request, reply, on_finish);
+    },
+    reply, on_finish);
+}
+
+void MSWorkerImpl::PredictAsyncInner(const std::function<Status()> &run, proto::PredictReply *reply,
+                                     const PredictOnFinish &on_finish) {
   Status status(WORKER_UNAVAILABLE);
   try {
-    status = Worker::GetInstance().RunAsync(*request, reply, on_finish);
+    status = run();
   } catch (const std::bad_alloc &ex) {
     MSI_LOG(ERROR) << "Serving Error: malloc memory failed";
   } catch (const std::runtime_error &ex) {
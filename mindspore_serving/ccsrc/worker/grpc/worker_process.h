@@ -22,6 +22,7 @@
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <memory>
 #include <string>
+#include <functional>
 #include "common/serving_common.h"
 #include "common/heart_beat.h"
 #include "common/grpc_client.h"
@@ -40,6 +41,13 @@ class MSWorkerImpl {
   ~MSWorkerImpl() = default;
   void Exit(const proto::ExitRequest *request, proto::ExitReply *reply);
   void PredictAsync(const proto::PredictRequest *request, proto::PredictReply *reply, const PredictOnFinish &on_finish);
+  // the instances are parsed into parsed_request, which lives as long as the request
+  void PredictAsync(const proto::PassthroughPredictRequest *request, proto::PredictRequest *parsed_request,
+                    proto::PredictReply *reply, const PredictOnFinish &on_finish);
+
+ private:
+  void PredictAsyncInner(const std::function<Status()> &run, proto::PredictReply *reply,
+                         const PredictOnFinish &on_finish);
 };
 
 }  // namespace serving
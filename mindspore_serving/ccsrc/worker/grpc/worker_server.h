@@ -28,46 +28,109 @@
 
 namespace mindspore {
 namespace serving {
+// MSWorker with Predict requested as PredictRequest and PredictReply, which have the same wire format as the
+// PassthroughPredictRequest and PassthroughPredictReply forwarded by the master. the instances of PredictPassthrough
+// are not decoded by the master, and are parsed one by one, so that a malformed instance fails alone instead of the
+// whole batch
+class MSWorkerAsyncService : public proto::MSWorker::AsyncService {
+ public:
+  void RequestPredictInstances(grpc::ServerContext *context, proto::PredictRequest *request,
+                               grpc::ServerAsyncResponseWriter<proto::PredictReply> *response,
+                               grpc::CompletionQueue *new_call_cq, grpc::ServerCompletionQueue *notification_cq,
+                               void *tag) {
+    grpc::Service::RequestAsyncUnary(kPredictMethodIndex, context, request, response, new_call_cq, notification_cq,
+                                     tag);
+  }
+
+  void RequestPredictPassthroughInstances(grpc::ServerContext *context, proto::PassthroughPredictRequest *request,
+                                          grpc::ServerAsyncResponseWriter<proto::PredictReply> *response,
+                                          grpc::CompletionQueue *new_call_cq,
+                                          grpc::ServerCompletionQueue *notification_cq, void *tag) {
+    grpc::Service::RequestAsyncUnary(kPredictPassthroughMethodIndex, context, request, response, new_call_cq,
+                                     notification_cq, tag);
+  }
+
+ private:
+  // index of Predict and PredictPassthrough in MSWorker
+  static constexpr int kPredictMethodIndex = 0;
+  static constexpr int kPredictPassthroughMethodIndex = 2;
+};
+
 template <class Derived>
-class WorkerServiceContext : public GrpcAsyncServiceContext<MSWorkerImpl, proto::MSWorker::AsyncService, Derived> {
+class WorkerServiceContext : public GrpcAsyncServiceContext<MSWorkerImpl, MSWorkerAsyncService, Derived> {
  public:
-  WorkerServiceContext(MSWorkerImpl *service_impl, proto::MSWorker::AsyncService *async_service,
+  WorkerServiceContext(MSWorkerImpl *service_impl, MSWorkerAsyncService *async_service,
                        grpc::ServerCompletionQueue *cq)
-      : GrpcAsyncServiceContext<MSWorkerImpl, proto::MSWorker::AsyncService, Derived>(service_impl, async_service, cq) {
-  }
+      : GrpcAsyncServiceContext<MSWorkerImpl, MSWorkerAsyncService, Derived>(service_impl, async_service, cq) {}
   virtual void StartEnqueueRequest() = 0;
   virtual void HandleRequest() = 0;
 };
 
 class WorkerPredictContext : public WorkerServiceContext<WorkerPredictContext> {
  public:
-  WorkerPredictContext(MSWorkerImpl *service_impl, proto::MSWorker::AsyncService *async_service,
+  WorkerPredictContext(MSWorkerImpl *service_impl, MSWorkerAsyncService *async_service,
                        grpc::ServerCompletionQueue *cq)
       : WorkerServiceContext(service_impl, async_service, cq), responder_(&ctx_) {}
 
   ~WorkerPredictContext() = default;
 
-  void StartEnqueueRequest() override { async_service_->RequestPredict(&ctx_, &request_, &responder_, cq_, cq_, this); }
+  void StartEnqueueRequest() override {
+    async_service_->RequestPredictInstances(&ctx_, request_, &responder_, cq_, cq_, this);
+  }
+
+  void HandleRequest() override {
+    MSI_TIME_STAMP_START(WorkerRequestHandle)
+    auto method_name = request_->servable_spec().method_name();
+    PredictOnFinish on_finish = [this, method_name, time_start_WorkerRequestHandle]() {
+      responder_.Finish(*response_, grpc::Status::OK, this);
+      MSI_TIME_STAMP_END_EXTRA(WorkerRequestHandle, "Method " + method_name)
+    };
+    service_impl_->PredictAsync(request_, response_, on_finish);
+  }
+
+ private:
+  grpc::ServerAsyncResponseWriter<proto::PredictReply> responder_;
+  // request and reply of the call are allocated on the arena, and freed all at once with the context
+  google::protobuf::Arena arena_;
+  proto::PredictRequest *request_ = google::protobuf::Arena::CreateMessage<proto::PredictRequest>(&arena_);
+  proto::PredictReply *response_ = google::protobuf::Arena::CreateMessage<proto::PredictReply>(&arena_);
+};
+
+class WorkerPredictPassthroughContext : public WorkerServiceContext<WorkerPredictPassthroughContext> {
+ public:
+  WorkerPredictPassthroughContext(MSWorkerImpl *service_impl, MSWorkerAsyncService *async_service,
+                                  grpc::ServerCompletionQueue *cq)
+      : WorkerServiceContext(service_impl, async_service, cq), responder_(&ctx_) {}
+
+  ~WorkerPredictPassthroughContext() = default;
+
+  void StartEnqueueRequest() override {
+    async_service_->RequestPredictPassthroughInstances(&ctx_, request_, &responder_, cq_, cq_, this);
+  }
 
   void HandleRequest() override {
     MSI_TIME_STAMP_START(WorkerRequestHandle)
-    auto method_name = request_.servable_spec().method_name();
+    auto method_name = request_->servable_spec().method_name();
     PredictOnFinish on_finish = [this, method_name, time_start_WorkerRequestHandle]() {
-      responder_.Finish(response_, grpc::Status::OK, this);
+      responder_.Finish(*response_, grpc::Status::OK, this);
       MSI_TIME_STAMP_END_EXTRA(WorkerRequestHandle, "Method " + method_name)
     };
-    service_impl_->PredictAsync(&request_, &response_, on_finish);
+    service_impl_->PredictAsync(request_, parsed_request_, response_, on_finish);
   }
 
  private:
   grpc::ServerAsyncResponseWriter<proto::PredictReply> responder_;
-  proto::PredictRequest request_;
-  proto::PredictReply response_;
+  // the instances parsed one by one are kept on the arena too
+  google::protobuf::Arena arena_;
+  proto::PassthroughPredictRequest *request_ =
+    google::protobuf::Arena::CreateMessage<proto::PassthroughPredictRequest>(&arena_);
+  proto::PredictRequest *parsed_request_ = google::protobuf::Arena::CreateMessage<proto::PredictRequest>(&arena_);
+  proto::PredictReply *response_ = google::protobuf::Arena::CreateMessage<proto::PredictReply>(&arena_);
 };
 
 class WorkerExitContext : public WorkerServiceContext<WorkerPredictContext> {
  public:
-  WorkerExitContext(MSWorkerImpl *service_impl, proto::MSWorker::AsyncService *async_service,
+  WorkerExitContext(MSWorkerImpl *service_impl, MSWorkerAsyncService *async_service,
                     grpc::ServerCompletionQueue *cq)
       : WorkerServiceContext(service_impl, async_service, cq), responder_(&ctx_) {}
 
@@ -86,10 +149,13 @@ class WorkerExitContext : public WorkerServiceContext<WorkerPredictContext> {
   proto::ExitReply response_;
 };
 
-class WorkerGrpcServer : public GrpcAsyncServer<proto::MSWorker::AsyncService> {
+class WorkerGrpcServer : public GrpcAsyncServer<MSWorkerAsyncService> {
  public:
-  WorkerGrpcServer() : GrpcAsyncServer<proto::MSWorker::AsyncService>() {}
-  void EnqueueRequests() override { WorkerPredictContext::EnqueueRequest(&service_impl_, &svc_, cq_.get()); }
+  WorkerGrpcServer() : GrpcAsyncServer<MSWorkerAsyncService>() {}
+  void EnqueueRequests(grpc::ServerCompletionQueue *cq) override {
+    WorkerPredictContext::EnqueueRequest(&service_impl_, &svc_, cq);
+    WorkerPredictPassthroughContext::EnqueueRequest(&service_impl_, &svc_, cq);
+  }
 
  protected:
   MSWorkerImpl service_impl_;
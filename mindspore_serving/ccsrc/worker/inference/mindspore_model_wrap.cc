@@ -20,6 +20,7 @@
 #include <functional>
 #include <map>
 #include <vector>
+#include "common/buffer_tensor.h"
 
 namespace mindspore {
 namespace serving {
@@ -526,17 +527,11 @@ Status MindSporeModelWrap::UnloadModel() {
 Status MindSporeModelWrap::ExecuteModel(const RequestBase &request, serving::ReplyBase *reply, bool return_result,
                                         uint64_t subgraph) {
   MSI_EXCEPTION_IF_NULL(reply);
-  FuncMakeInBuffer func_in = [&request](size_t index, const std::string &name) {
-    auto input_tensor = request[index];
-    if (input_tensor == nullptr || input_tensor->data() == nullptr) {
-      MSI_LOG_EXCEPTION << "Input tensor data cannot be nullptr, index " << index;
-    }
-    return mindspore::MSTensor::CreateRefTensor(name, TransInferDataType2ApiTypeId(input_tensor->data_type()),
-                                                input_tensor->shape(), const_cast<uint8_t *>(input_tensor->data()),
-                                                input_tensor->data_size());
-  };
-
-  FuncMakeOutTensor func_out = [&reply](const mindspore::MSTensor &result_tensor, DataType data_type,
+  std::vector<const TensorBase *> inputs;
+  for (size_t i = 0; i < request.size(); i++) {
+    inputs.push_back(request[i]);
+  }
+  FuncMakeOutTensor func_out = [&reply](size_t, const mindspore::MSTensor &result_tensor, DataType data_type,
                                         const std::vector<int64_t> &shape) {
     if (result_tensor.IsDevice()) {
       MSI_LOG_EXCEPTION << "Can not support device type tensor";
@@ -547,7 +542,7 @@ Status MindSporeModelWrap::ExecuteModel(const RequestBase &request, serving::Rep
     tensor->set_data_type(data_type);
     tensor->set_shape(shape);
   };
-  return ExecuteModelCommon(request.size(), func_in, func_out, return_result, subgraph);
+  return ExecuteModelCommon(inputs, {}, func_out, return_result, subgraph);
 }
 
 Status MindSporeModelWrap::ExecuteModel(const std::vector<TensorBasePtr> &request, std::vector<TensorBasePtr> *reply,
@@ -557,30 +552,47 @@ Status MindSporeModelWrap::ExecuteModel(const std::vector<TensorBasePtr> &reques
                                           << ", total graph number is " << models_.size();
   }
   MSI_EXCEPTION_IF_NULL(reply);
-  FuncMakeInBuffer func_in = [&request](size_t index, const std::string &name) {
-    auto &input_tensor = request[index];
-    return mindspore::MSTensor::CreateRefTensor(name, TransInferDataType2ApiTypeId(input_tensor->data_type()),
-                                                input_tensor->shape(), const_cast<uint8_t *>(input_tensor->data()),
-                                                input_tensor->data_size());
-  };
-  FuncMakeOutTensor func_out = [&reply](const mindspore::MSTensor &result_tensor, DataType data_type,
-                                        const std::vector<int64_t> &shape) {
+  std::vector<const TensorBase *> inputs;
+  for (auto &item : request) {
+    inputs.push_back(item.get());
+  }
+  // lite backend allocates the outputs in every predict, bind the outputs to buffers from the tensor buffer pool
+  // instead, so that the outputs are written into the tensors of the reply without copy
+  std::vector<TensorBasePtr> output_buffers;
+  if (InferenceLoader::Instance().GetEnableLite() && return_result) {
+    for (auto &output_info : models_[subgraph].output_tensor_infos) {
+      auto tensor = std::make_shared<Tensor>();
+      tensor->set_data_type(output_info.data_type);
+      tensor->set_shape(output_info.shape);
+      if (!tensor->resize_data_no_fill(output_info.size)) {
+        return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Create output buffer of size " << output_info.size << " failed";
+      }
+      output_buffers.push_back(tensor);
+    }
+  }
+  FuncMakeOutTensor func_out = [&reply, &output_buffers](size_t index, const mindspore::MSTensor &result_tensor,
+                                                         DataType data_type, const std::vector<int64_t> &shape) {
     if (result_tensor.IsDevice()) {
       MSI_LOG_EXCEPTION << "Can not support device type tensor";
     }
     TensorBasePtr tensor = nullptr;
-    // lite backend, output tensor result in all predict
-    if (InferenceLoader::Instance().GetEnableLite()) {
-      tensor = std::make_shared<Tensor>(data_type, shape, result_tensor.Data().get(), result_tensor.DataSize());
+    if (!output_buffers.empty()) {
+      tensor = output_buffers[index];
+      // the backend has not written the output into the buffer bound
+      if (result_tensor.Data().get() != tensor->data() &&
+          !tensor->set_data(result_tensor.Data().get(), result_tensor.DataSize())) {
+        MSI_LOG_EXCEPTION << "Copy output " << index << " of size " << result_tensor.DataSize() << " failed";
+      }
     } else {
       tensor = std::make_shared<ApiBufferTensorWrap>(data_type, shape, result_tensor);
     }
     reply->push_back(tensor);
   };
-  return ExecuteModelCommon(request.size(), func_in, func_out, return_result, subgraph);
+  return ExecuteModelCommon(inputs, output_buffers, func_out, return_result, subgraph);
 }
 
-Status MindSporeModelWrap::ExecuteModelCommon(size_t request_size, const FuncMakeInBuffer &in_func,
+Status MindSporeModelWrap::ExecuteModelCommon(const std::vector<const TensorBase *> &request,
+                                              const std::vector<TensorBasePtr> &output_buffers,
                                               const FuncMakeOutTensor &out_func, bool return_result,
                                               uint64_t subgraph) {
   if (models_[subgraph].model == nullptr) {
@@ -590,20 +602,29 @@ Status MindSporeModelWrap::ExecuteModelCommon(size_t request_size, const FuncMak
   auto model = model_info.model;
   auto &input_names = model_info.input_names;
   auto &output_names = model_info.output_names;
-  if (input_names.size() != request_size) {
-    return INFER_STATUS_LOG_ERROR(FAILED) << "Inputs size not match, request inputs size " << request_size
+  if (input_names.size() != request.size()) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Inputs size not match, request inputs size " << request.size()
                                           << ", model inputs size " << input_names.size();
   }
-  std::vector<mindspore::MSTensor> inputs;
-  for (size_t i = 0; i < input_names.size(); i++) {
-    auto tensor = in_func(i, input_names[i]);
-    if (tensor == nullptr) {
-      return INFER_STATUS_LOG_ERROR(FAILED) << "Failed to create input " << i << " MSTensor";
+  for (size_t i = 0; i < request.size(); i++) {
+    if (request[i] == nullptr || request[i]->data() == nullptr) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "Input tensor data cannot be nullptr, index " << i;
     }
-    inputs.push_back(*tensor);
-    mindspore::MSTensor::DestroyTensorPtr(tensor);
+  }
+  std::vector<mindspore::MSTensor> inputs;
+  if (!model_info.input_cache->GetRefTensors(input_names, request, &inputs)) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Failed to create input MSTensor";
   }
   std::vector<mindspore::MSTensor> outputs;
+  if (!output_buffers.empty()) {
+    std::vector<const TensorBase *> buffers;
+    for (auto &item : output_buffers) {
+      buffers.push_back(item.get());
+    }
+    if (!model_info.output_cache->GetRefTensors(output_names, buffers, &outputs)) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "Failed to create output MSTensor";
+    }
+  }
   mindspore::Status status;
   if (SupportMultiThreads()) {
     status = model->Predict(inputs, &outputs);
@@ -629,7 +650,7 @@ Status MindSporeModelWrap::ExecuteModelCommon(size_t request_size, const FuncMak
                << "Get output failed, predict output data size " << result_tensor.DataSize()
                << " not match model info data size " << output_info.size << ", output_name " << output_names[i];
       }
-      out_func(result_tensor, output_info.data_type, output_info.shape);
+      out_func(i, result_tensor, output_info.data_type, output_info.shape);
     }
   }
   return SUCCESS;
@@ -732,6 +753,67 @@ mindspore::DeviceType MindSporeModelWrap::GetMsDeviceType(serving::DeviceType de
   return ms_device_type;
 }
 
+bool RefTensorCache::GetRefTensors(const std::vector<std::string> &names,
+                                   const std::vector<const TensorBase *> &tensors,
+                                   std::vector<mindspore::MSTensor> *ms_tensors) {
+  MSI_EXCEPTION_IF_NULL(ms_tensors);
+  ms_tensors->clear();
+  auto create_ref_tensor = [&names, ms_tensors](size_t index, const TensorBase *tensor) {
+    auto ms_tensor = mindspore::MSTensor::CreateRefTensor(
+      names[index], TransInferDataType2ApiTypeId(tensor->data_type()), tensor->shape(),
+      const_cast<uint8_t *>(tensor->data()), tensor->data_size());
+    if (ms_tensor == nullptr) {
+      MSI_LOG_ERROR << "Failed to create MSTensor " << names[index];
+      return false;
+    }
+    ms_tensors->push_back(*ms_tensor);
+    mindspore::MSTensor::DestroyTensorPtr(ms_tensor);
+    return true;
+  };
+  std::unique_lock<std::mutex> lock(lock_);
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto &tensor = tensors[i];
+    // the data is owned by one request, the address is not used again by the same buffer
+    if (dynamic_cast<const BufferTensor *>(tensor) != nullptr) {
+      if (!create_ref_tensor(i, tensor)) {
+        return false;
+      }
+      continue;
+    }
+    auto data = tensor->data();
+    auto it = item_map_.find(data);
+    if (it != item_map_.end()) {
+      items_.splice(items_.begin(), items_, it->second);
+      auto &item = items_.front();
+      if (item.name == names[i] && item.data_type == tensor->data_type() && item.data_size == tensor->data_size() &&
+          item.shape == tensor->shape()) {
+        ms_tensors->push_back(item.ms_tensor);
+        continue;
+      }
+    }
+    if (!create_ref_tensor(i, tensor)) {
+      return false;
+    }
+    if (it == item_map_.end()) {
+      if (items_.size() >= kMaxCacheCount) {
+        (void)item_map_.erase(items_.back().data);
+        items_.pop_back();
+      }
+      items_.emplace_front();
+      item_map_[data] = items_.begin();
+    }
+    // the shape or size of the buffer has been changed, the handle is replaced
+    auto &item = items_.front();
+    item.data = data;
+    item.name = names[i];
+    item.data_type = tensor->data_type();
+    item.shape = tensor->shape();
+    item.data_size = tensor->data_size();
+    item.ms_tensor = ms_tensors->back();
+  }
+  return true;
+}
+
 ApiBufferTensorWrap::ApiBufferTensorWrap() = default;
 
 ApiBufferTensorWrap::ApiBufferTensorWrap(DataType type, const std::vector<int64_t> &shape,
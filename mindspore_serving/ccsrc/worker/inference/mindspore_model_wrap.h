@@ -18,6 +18,7 @@
 #define MINDSPORE_SERVING_WROERK_MODEL_WRAP_H
 
 #include <unordered_map>
+#include <list>
 #include <string>
 #include <memory>
 #include <vector>
@@ -33,12 +34,39 @@
 
 namespace mindspore {
 namespace serving {
+// MSTensor ref handles of the buffers used by predict before, keyed by the buffer address. The input buffers of one
+// batch size and the pooled tensor buffers are used by predict again and again
+class RefTensorCache {
+ public:
+  // handles of the tensors, created if not cached, return false if failed to create. the buffer tensors referring to
+  // the data of one request, such as the instance inputs of batch 1, get handles without being cached
+  bool GetRefTensors(const std::vector<std::string> &names, const std::vector<const TensorBase *> &tensors,
+                     std::vector<mindspore::MSTensor> *ms_tensors);
+
+ private:
+  struct Item {
+    const uint8_t *data = nullptr;
+    std::string name;
+    DataType data_type = kMSI_Unknown;
+    std::vector<int64_t> shape;
+    size_t data_size = 0;
+    mindspore::MSTensor ms_tensor;
+  };
+  static constexpr size_t kMaxCacheCount = 256;
+  std::mutex lock_;
+  // the least recently used item is at the back and evicted first when the cache is full
+  std::list<Item> items_;
+  std::unordered_map<const uint8_t *, std::list<Item>::iterator> item_map_;
+};
+
 struct ApiModelInfo {
   std::vector<std::string> input_names;
   std::vector<serving::TensorInfo> input_tensor_infos;
   std::vector<std::string> output_names;
   std::vector<serving::TensorInfo> output_tensor_infos;
   std::shared_ptr<mindspore::Model> model = nullptr;
+  std::shared_ptr<RefTensorCache> input_cache = std::make_shared<RefTensorCache>();
+  std::shared_ptr<RefTensorCache> output_cache = std::make_shared<RefTensorCache>();
 };
 
 struct ApiCommonModelInfo {
@@ -76,17 +104,18 @@ class MindSporeModelWrap : public InferenceBase {
 
   uint64_t GetSubGraphNum() const override;
   bool SupportReuseDevice() const override;
-  bool SupportMultiThreads() const;
+  bool SupportMultiThreads() const override;
 
  private:
   ApiCommonModelInfo common_model_info_;
   std::vector<ApiModelInfo> models_;
   static std::mutex infer_mutex_;
 
-  using FuncMakeInBuffer = std::function<mindspore::MSTensor *(size_t index, const std::string &name)>;
-  using FuncMakeOutTensor =
-    std::function<void(const mindspore::MSTensor, DataType data_type, const std::vector<int64_t> &shape)>;
-  Status ExecuteModelCommon(size_t request_size, const FuncMakeInBuffer &in_func, const FuncMakeOutTensor &out_func,
+  using FuncMakeOutTensor = std::function<void(size_t index, const mindspore::MSTensor &result_tensor,
+                                                DataType data_type, const std::vector<int64_t> &shape)>;
+  // output_buffers are bound as the outputs of predict if not empty
+  Status ExecuteModelCommon(const std::vector<const TensorBase *> &request,
+                            const std::vector<TensorBasePtr> &output_buffers, const FuncMakeOutTensor &out_func,
                             bool return_result, uint64_t subgraph);
   Status GetModelInfos(ApiModelInfo *model_info);
   Status SetApiModelInfo(serving::DeviceType device_type, uint32_t device_id,
@@ -39,6 +39,36 @@ Status LocalModelLoader::Predict(const std::vector<TensorBasePtr> &input, std::v
   return model_session_->ExecuteModel(input, output, true, subgraph);
 }
 
+std::vector<uint64_t> LocalModelLoader::GetBatchBuckets() const {
+  std::vector<uint64_t> batch_buckets;
+  if (replicas_.empty()) {
+    return batch_buckets;
+  }
+  for (auto &item : replicas_[0].bucket_sessions) {
+    batch_buckets.push_back(item.first);
+  }
+  return batch_buckets;
+}
+
+Status LocalModelLoader::ExecuteReplica(const std::vector<TensorBasePtr> &input, std::vector<TensorBasePtr> *output,
+                                        uint64_t subgraph, uint64_t batch_size, uint64_t replica) {
+  if (replica >= replicas_.size()) {
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR)
+           << "Model '" << GetModelKey() << "' does not have replica " << replica << ", replica count "
+           << replicas_.size();
+  }
+  auto &model_replica = replicas_[replica];
+  if (batch_size == GetBatchSize()) {
+    return model_replica.model_session->ExecuteModel(input, output, true, subgraph);
+  }
+  auto it = model_replica.bucket_sessions.find(batch_size);
+  if (it == model_replica.bucket_sessions.end()) {
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR)
+           << "Model '" << GetModelKey() << "' does not have batch bucket " << batch_size;
+  }
+  return it->second->ExecuteModel(input, output, true, subgraph);
+}
+
 std::vector<TensorInfo> LocalModelLoader::GetInputInfos(uint64_t subgraph) const {
   if (!model_session_) {
     MSI_LOG_EXCEPTION << "Model '" << GetModelKey() << "' has not been loaded";
@@ -116,8 +146,6 @@ Status LocalModelLoader::InitDevice(ModelType model_type) {
 }
 
 Status LocalModelLoader::LoadModel(uint64_t version_number, const std::string &dec_key, const std::string &dec_mode) {
-  const auto &model_meta = model_meta_;
-  auto context = ServableContext::Instance();
   std::string model_dir =
     base_spec_.servable_directory + "/" + base_spec_.servable_name + "/" + std::to_string(version_number);
   if (!common::DirOrFileExist(model_dir)) {
@@ -126,17 +154,7 @@ Status LocalModelLoader::LoadModel(uint64_t version_number, const std::string &d
            << version_number << ", servable directory: '" << base_spec_.servable_directory << "', servable name: '"
            << base_spec_.servable_name << "'";
   }
-  const auto &common_meta = model_meta.common_meta;
-  const auto &local_meta = model_meta.local_meta;
-  std::vector<std::string> model_file_names;
-  for (auto &file : local_meta.model_files) {
-    std::string model_file_name = model_dir + "/" + file;
-    model_file_names.push_back(model_file_name);
-  }
-  auto session = InferenceLoader::Instance().CreateMindSporeInfer();
-  if (session == nullptr) {
-    return INFER_STATUS_LOG_ERROR(FAILED) << "Create MindSpore infer failed";
-  }
+  const auto &local_meta = model_meta_.local_meta;
   std::string config_file_path;
   if (!local_meta.config_file.empty()) {
     if (local_meta.config_file[0] == '/') {
@@ -145,32 +163,194 @@ Status LocalModelLoader::LoadModel(uint64_t version_number, const std::string &d
       config_file_path = base_spec_.servable_directory + "/" + base_spec_.servable_name + "/" + local_meta.config_file;
     }
   }
+  std::vector<ModelContext> replica_contexts;
+  auto status = GetReplicaContexts(&replica_contexts);
+  if (status != SUCCESS) {
+    return status;
+  }
+  graph_num_ = local_meta.model_files.size();
+  for (auto &replica_context : replica_contexts) {
+    LocalModelReplica replica;
+    status = LoadReplica(model_dir, dec_key, dec_mode, config_file_path, replica_context, &replica);
+    if (status != SUCCESS) {
+      return INFER_STATUS_LOG_ERROR(FAILED)
+             << "Load model failed, servable directory: '" << base_spec_.servable_directory << "', servable name: '"
+             << base_spec_.servable_name << "', model file: '" << local_meta.model_files << "', version number "
+             << version_number << ", replica " << replicas_.size() << ", model context: " << replica_context.AsString()
+             << ", load error details: " << status.StatusMessage();
+    }
+    replicas_.push_back(replica);
+    if (model_session_ == nullptr) {
+      model_session_ = replica.model_session;
+    }
+    // model_session_ of replica 0 is needed to check batch buckets
+    status = LoadBatchBuckets(model_dir, dec_key, dec_mode, config_file_path, replica_context, &replicas_.back());
+    if (status != SUCCESS) {
+      return status;
+    }
+  }
+  MSI_LOG_INFO << "Load model success, servable directory: '" << base_spec_.servable_directory << "', servable name: '"
+               << base_spec_.servable_name << "', model file: '" << local_meta.model_files << "', version number "
+               << version_number << ", context " << local_meta.model_context.AsString() << ", replica count "
+               << replicas_.size();
+  return SUCCESS;
+}
+
+Status LocalModelLoader::GetReplicaContexts(std::vector<ModelContext> *replica_contexts) const {
+  const auto &local_meta = model_meta_.local_meta;
+  auto replica_num = local_meta.replica_num;
+  if (replica_num == 0) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Invalid replica num 0 of model '" << GetModelKey() << "'";
+  }
+  if (replica_num > 1 && !InferenceLoader::Instance().SupportMultiThreads()) {
+    MSI_LOG_WARNING << "Current inference backend does not support concurrent predicting, replica num "
+                    << replica_num << " of model '" << GetModelKey() << "' is reset to 1";
+    replica_num = 1;
+  }
+  const auto &core_list = local_meta.model_context.thread_affinity_core_list;
+  if (replica_num > 1 && !core_list.empty() && core_list.size() < replica_num) {
+    return INFER_STATUS_LOG_ERROR(FAILED)
+           << "The size " << core_list.size() << " of thread affinity core list of model '" << GetModelKey()
+           << "' is less than the replica num " << replica_num << ", each replica should have its own cores";
+  }
+  // split the thread affinity cores evenly, so that replicas do not compete for the same cores
+  auto cores_per_replica = core_list.size() / replica_num;
+  for (uint32_t i = 0; i < replica_num; i++) {
+    auto replica_context = local_meta.model_context;
+    if (replica_num > 1 && !core_list.empty()) {
+      auto core_begin = core_list.begin() + static_cast<ptrdiff_t>(i * cores_per_replica);
+      replica_context.thread_affinity_core_list.assign(core_begin,
+                                                       core_begin + static_cast<ptrdiff_t>(cores_per_replica));
+      if (replica_context.thread_num == -1) {
+        replica_context.thread_num = static_cast<int32_t>(cores_per_replica);
+      }
+    }
+    replica_contexts->push_back(replica_context);
+  }
+  return SUCCESS;
+}
+
+Status LocalModelLoader::LoadReplica(const std::string &model_dir, const std::string &dec_key,
+                                     const std::string &dec_mode, const std::string &config_file_path,
+                                     const ModelContext &model_context, LocalModelReplica *replica) {
+  const auto &common_meta = model_meta_.common_meta;
+  const auto &local_meta = model_meta_.local_meta;
+  auto context = ServableContext::Instance();
+  std::vector<std::string> model_file_names;
+  for (auto &file : local_meta.model_files) {
+    model_file_names.push_back(model_dir + "/" + file);
+  }
+  auto session = InferenceLoader::Instance().CreateMindSporeInfer();
+  if (session == nullptr) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Create MindSpore infer failed";
+  }
   auto enable_lite = InferenceLoader::Instance().GetEnableLite();
   Status status = session->LoadModelFromFile(context->GetDeviceType(), context->GetDeviceId(), model_file_names,
                                              local_meta.model_format, common_meta.with_batch_dim,
-                                             common_meta.without_batch_dim_inputs, model_meta.local_meta.model_context,
-                                             dec_key, dec_mode, config_file_path, enable_lite);
+                                             common_meta.without_batch_dim_inputs, model_context, dec_key, dec_mode,
+                                             config_file_path, enable_lite);
   if (status != SUCCESS) {
-    return INFER_STATUS_LOG_ERROR(FAILED)
-           << "Load model failed, servable directory: '" << base_spec_.servable_directory << "', servable name: '"
-           << base_spec_.servable_name << "', model file: '" << local_meta.model_files << "', version number "
-           << version_number << ",model context: " << local_meta.model_context.AsString()
-           << ", load error details: " << status.StatusMessage();
+    return status;
   }
-  model_session_ = session;
-  graph_num_ = model_file_names.size();
+  replica->model_session = session;
+  return SUCCESS;
+}
 
-  MSI_LOG_INFO << "Load model success, servable directory: '" << base_spec_.servable_directory << "', servable name: '"
-               << base_spec_.servable_name << "', model file: '" << local_meta.model_files << "', version number "
-               << version_number << ", context " << local_meta.model_context.AsString();
+Status LocalModelLoader::LoadBatchBuckets(const std::string &model_dir, const std::string &dec_key,
+                                          const std::string &dec_mode, const std::string &config_file_path,
+                                          const ModelContext &model_context, LocalModelReplica *replica) {
+  const auto &common_meta = model_meta_.common_meta;
+  const auto &local_meta = model_meta_.local_meta;
+  auto context = ServableContext::Instance();
+  auto enable_lite = InferenceLoader::Instance().GetEnableLite();
+  for (auto &bucket_file : local_meta.batch_bucket_files) {
+    auto session = InferenceLoader::Instance().CreateMindSporeInfer();
+    if (session == nullptr) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "Create MindSpore infer failed";
+    }
+    Status status = session->LoadModelFromFile(context->GetDeviceType(), context->GetDeviceId(),
+                                               {model_dir + "/" + bucket_file}, local_meta.model_format,
+                                               common_meta.with_batch_dim, common_meta.without_batch_dim_inputs,
+                                               model_context, dec_key, dec_mode, config_file_path, enable_lite);
+    if (status != SUCCESS) {
+      return INFER_STATUS_LOG_ERROR(FAILED)
+             << "Load batch bucket model failed, servable directory: '" << base_spec_.servable_directory
+             << "', servable name: '" << base_spec_.servable_name << "', batch bucket file: '" << bucket_file
+             << "', load error details: " << status.StatusMessage();
+    }
+    auto bucket_batch_size = session->GetBatchSize(0);
+    if (bucket_batch_size <= 0) {
+      (void)session->UnloadModel();
+      return INFER_STATUS_LOG_ERROR(FAILED)
+             << "Invalid batch size " << bucket_batch_size << " of batch bucket file '" << bucket_file << "'";
+    }
+    status = CheckBatchBucket(bucket_file, session, static_cast<uint64_t>(bucket_batch_size), *replica);
+    if (status != SUCCESS) {
+      (void)session->UnloadModel();
+      return status;
+    }
+    replica->bucket_sessions[static_cast<uint64_t>(bucket_batch_size)] = session;
+    MSI_LOG_INFO << "Load batch bucket model success, batch bucket file: '" << bucket_file << "', batch size "
+                 << bucket_batch_size << ", model file: '" << local_meta.model_files << "'";
+  }
+  return SUCCESS;
+}
+
+Status LocalModelLoader::CheckBatchBucket(const std::string &bucket_file, const std::shared_ptr<InferenceBase> &session,
+                                          uint64_t bucket_batch_size, const LocalModelReplica &replica) const {
+  auto batch_size = GetBatchSize();
+  if (bucket_batch_size >= batch_size || replica.bucket_sessions.count(bucket_batch_size) > 0) {
+    return INFER_STATUS_LOG_ERROR(FAILED)
+           << "The batch size " << bucket_batch_size << " of batch bucket file '" << bucket_file
+           << "' should be less than the model batch size " << batch_size << " and unique in batch bucket files";
+  }
+  if (session->GetSubGraphNum() != graph_num_) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "The subgraph count of batch bucket file '" << bucket_file
+                                          << "' does not match the model";
+  }
+  // each instance of the batch bucket should be the same as the instance of the model
+  auto check_infos = [bucket_batch_size, batch_size](const std::vector<TensorInfo> &bucket_infos,
+                                                     const std::vector<TensorInfo> &model_infos) {
+    if (bucket_infos.size() != model_infos.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < model_infos.size(); i++) {
+      auto &bucket_info = bucket_infos[i];
+      auto &model_info = model_infos[i];
+      if (bucket_info.data_type != model_info.data_type || bucket_info.is_no_batch_dim != model_info.is_no_batch_dim) {
+        return false;
+      }
+      if (model_info.is_no_batch_dim) {
+        if (bucket_info.size != model_info.size) {
+          return false;
+        }
+      } else if (bucket_info.size / bucket_batch_size != model_info.size / batch_size) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (uint64_t i = 0; i < graph_num_; i++) {
+    if (!check_infos(session->GetInputInfos(i), GetInputInfos(i)) ||
+        !check_infos(session->GetOutputInfos(i), GetOutputInfos(i))) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "The inputs or outputs of batch bucket file '" << bucket_file
+                                            << "' do not match the model, subgraph " << i;
+    }
+  }
   return SUCCESS;
 }
 
 void LocalModelLoader::Clear() {
-  if (model_session_ != nullptr) {
-    (void)model_session_->UnloadModel();
-    model_session_ = nullptr;
+  for (auto &replica : replicas_) {
+    for (auto &item : replica.bucket_sessions) {
+      (void)item.second->UnloadModel();
+    }
+    if (replica.model_session != nullptr) {
+      (void)replica.model_session->UnloadModel();
+    }
   }
+  replicas_.clear();
+  model_session_ = nullptr;
   model_loaded_ = false;
 }
 }  // namespace mindspore::serving
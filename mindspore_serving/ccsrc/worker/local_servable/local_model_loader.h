@@ -29,6 +29,11 @@
 #include "worker/inference/inference.h"
 
 namespace mindspore::serving {
+struct LocalModelReplica {
+  std::shared_ptr<InferenceBase> model_session = nullptr;
+  std::map<uint64_t, std::shared_ptr<InferenceBase>> bucket_sessions;  // batch size: model of batch bucket
+};
+
 class MS_API LocalModelLoader final : public DirectModelLoaderBase {
  public:
   LocalModelLoader() = default;
@@ -36,6 +41,11 @@ class MS_API LocalModelLoader final : public DirectModelLoaderBase {
 
   Status Predict(const std::vector<TensorBasePtr> &input, std::vector<TensorBasePtr> *output,
                  uint64_t subgraph) override;
+  std::vector<uint64_t> GetBatchBuckets() const override;
+  Status ExecuteReplica(const std::vector<TensorBasePtr> &input, std::vector<TensorBasePtr> *output,
+                        uint64_t subgraph, uint64_t batch_size, uint64_t replica) override;
+  uint64_t GetReplicaNum() const override { return replicas_.size(); }
+  uint64_t GetInputBufferNum() const override { return model_meta_.local_meta.input_buffer_num; }
 
   std::vector<TensorInfo> GetInputInfos(uint64_t subgraph) const override;
   std::vector<TensorInfo> GetOutputInfos(uint64_t subgraph) const override;
@@ -53,11 +63,21 @@ class MS_API LocalModelLoader final : public DirectModelLoaderBase {
   ServableLoadSpec base_spec_;
   ModelMeta model_meta_;
   uint64_t graph_num_ = 0;
-  std::shared_ptr<InferenceBase> model_session_ = nullptr;
+  std::shared_ptr<InferenceBase> model_session_ = nullptr;  // model session of replica 0
+  std::vector<LocalModelReplica> replicas_;
 
   bool model_loaded_ = false;
 
   Status LoadModel(uint64_t version, const std::string &dec_key, const std::string &dec_mode);
+  Status LoadReplica(const std::string &model_dir, const std::string &dec_key, const std::string &dec_mode,
+                     const std::string &config_file_path, const ModelContext &model_context,
+                     LocalModelReplica *replica);
+  Status LoadBatchBuckets(const std::string &model_dir, const std::string &dec_key, const std::string &dec_mode,
+                          const std::string &config_file_path, const ModelContext &model_context,
+                          LocalModelReplica *replica);
+  Status CheckBatchBucket(const std::string &bucket_file, const std::shared_ptr<InferenceBase> &session,
+                          uint64_t bucket_batch_size, const LocalModelReplica &replica) const;
+  Status GetReplicaContexts(std::vector<ModelContext> *replica_contexts) const;
 };
 
 }  // namespace mindspore::serving
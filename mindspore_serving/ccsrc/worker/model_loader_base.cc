@@ -20,26 +20,106 @@
 namespace mindspore::serving {
 Status DirectModelLoaderBase::Predict(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
                                       uint64_t subgraph) {
-  MSI_EXCEPTION_IF_NULL(outputs);
-  if (subgraph >= model_info_.sub_graph_infos.size()) {
+  return PredictWithReplica(inputs, outputs, subgraph, 0);
+}
+
+Status DirectModelLoaderBase::PredictWithReplica(const std::vector<InstanceData> &inputs,
+                                                 std::vector<ResultInstance> *outputs, uint64_t subgraph,
+                                                 uint64_t replica) {
+  auto status = AssembleBatch(inputs, subgraph, replica, 0);
+  if (status != SUCCESS) {
+    return status;
+  }
+  return ExecuteBatch(inputs, outputs, subgraph, replica, 0);
+}
+
+Status DirectModelLoaderBase::GetSubgraphExecuteInfo(size_t input_batch_size, uint64_t subgraph, uint64_t replica,
+                                                     uint64_t buffer_index,
+                                                     const ModelExecutorSubgraphInfo **subgraph_info,
+                                                     uint64_t *batch_size) const {
+  auto buffer_num = GetInputBufferNum();
+  if (buffer_index >= buffer_num || replica * buffer_num + buffer_index >= model_infos_.size()) {
+    return INFER_STATUS_LOG_ERROR(FAILED)
+           << "Invalid model replica index " << replica << " or input buffer index " << buffer_index
+           << ", model info: " << model_key_ << ", input buffer count: " << buffer_num;
+  }
+  auto &model_info = model_infos_[replica * buffer_num + buffer_index];
+  if (subgraph >= model_info.sub_graph_infos.size()) {
     return INFER_STATUS_LOG_ERROR(FAILED)
            << "Invalid input subgraph index " << subgraph << ", model info: " << model_key_
-           << ", subgraph count: " << model_info_.sub_graph_infos.size();
+           << ", subgraph count: " << model_info.sub_graph_infos.size();
   }
-  Status status;
-  std::vector<TensorBasePtr> predict_outputs;
-  auto &subgraph_info = model_info_.sub_graph_infos[subgraph];
-  status = PrePredict(subgraph_info, model_info_.batch_size, inputs);
+  // pick the smallest batch bucket that fits the instances, the model batch size if there is none
+  *batch_size = model_info.batch_size;
+  *subgraph_info = &model_info.sub_graph_infos[subgraph];
+  auto bucket_it = model_info.bucket_graph_infos.lower_bound(input_batch_size);
+  if (bucket_it != model_info.bucket_graph_infos.end()) {
+    *batch_size = bucket_it->first;
+    *subgraph_info = &bucket_it->second[subgraph];
+  }
+  return SUCCESS;
+}
+
+uint64_t DirectModelLoaderBase::GetExecuteBatchSize(uint64_t instance_count) const {
+  if (model_infos_.empty()) {
+    return GetBatchSize();
+  }
+  // the same batch buckets for all replicas and input buffer sets
+  auto &model_info = model_infos_[0];
+  auto bucket_it = model_info.bucket_graph_infos.lower_bound(instance_count);
+  if (bucket_it != model_info.bucket_graph_infos.end()) {
+    return bucket_it->first;
+  }
+  return model_info.batch_size;
+}
+
+Status DirectModelLoaderBase::AssembleBatch(const std::vector<InstanceData> &inputs, uint64_t subgraph,
+                                            uint64_t replica, uint64_t buffer_index) {
+  const ModelExecutorSubgraphInfo *subgraph_info = nullptr;
+  uint64_t batch_size = 0;
+  auto status = GetSubgraphExecuteInfo(inputs.size(), subgraph, replica, buffer_index, &subgraph_info, &batch_size);
+  if (status != SUCCESS) {
+    return status;
+  }
+  // batch 1, the instance tensors are used as the model inputs directly in ExecuteBatch, no copy
+  if (batch_size == 1) {
+    return SUCCESS;
+  }
+  status = PrePredict(*subgraph_info, batch_size, inputs);
   if (status != SUCCESS) {
     MSI_LOG_ERROR << "Call Pre Predict failed, model info " << model_key_;
     return status;
   }
-  status = Predict(subgraph_info.input_buffers, &predict_outputs, subgraph);
+  return SUCCESS;
+}
+
+Status DirectModelLoaderBase::ExecuteBatch(const std::vector<InstanceData> &inputs,
+                                           std::vector<ResultInstance> *outputs, uint64_t subgraph, uint64_t replica,
+                                           uint64_t buffer_index) {
+  MSI_EXCEPTION_IF_NULL(outputs);
+  const ModelExecutorSubgraphInfo *subgraph_info = nullptr;
+  uint64_t batch_size = 0;
+  auto status = GetSubgraphExecuteInfo(inputs.size(), subgraph, replica, buffer_index, &subgraph_info, &batch_size);
+  if (status != SUCCESS) {
+    return status;
+  }
+  std::vector<TensorBasePtr> predict_outputs;
+  if (batch_size == 1) {
+    std::vector<TensorBasePtr> ref_inputs;
+    status = CreateRefInputs(*subgraph_info, inputs, &ref_inputs);
+    if (status != SUCCESS) {
+      return status;
+    }
+    status = ExecuteReplica(ref_inputs, &predict_outputs, subgraph, batch_size, replica);
+  } else {
+    status = ExecuteReplica(subgraph_info->input_buffers, &predict_outputs, subgraph, batch_size, replica);
+  }
   if (status != SUCCESS) {
-    MSI_LOG_ERROR << "Predict failed, model info " << model_key_;
+    MSI_LOG_ERROR << "Predict failed, model info " << model_key_ << ", batch size " << batch_size << ", replica "
+                  << replica;
     return status;
   }
-  status = PostPredict(subgraph_info, model_info_.batch_size, inputs, predict_outputs, outputs);
+  status = PostPredict(*subgraph_info, batch_size, inputs, predict_outputs, outputs);
   if (status != SUCCESS) {
     MSI_LOG_ERROR << "Call Post Predict failed, model info " << model_key_;
     return status;
@@ -88,6 +168,34 @@ Status DirectModelLoaderBase::PrePredict(const ModelExecutorSubgraphInfo &subgra
   return SUCCESS;
 }
 
+Status DirectModelLoaderBase::CreateRefInputs(const ModelExecutorSubgraphInfo &subgraph_info,
+                                              const std::vector<InstanceData> &instances,
+                                              std::vector<TensorBasePtr> *ref_inputs) {
+  if (instances.size() != 1) {
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Invalid input batch size " << instances.size()
+                                                << ", model batch size 1";
+  }
+  auto &instance = instances[0];
+  auto &input_infos = subgraph_info.input_infos;
+  for (size_t i = 0; i < input_infos.size(); i++) {
+    if (i >= instance.size()) {
+      return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Batch index 0 does not have input " << i;
+    }
+    auto &input = instance[i];
+    auto &input_info = input_infos[i];
+    if (input->data_size() != input_info.size) {
+      return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Input " << i << " data size " << input->data_size()
+                                                  << " does not match size " << input_info.size << " defined in model";
+    }
+    // reference the instance data with the shape of model input, the model does not modify the inputs
+    auto tensor = std::make_shared<BufferTensorWithOwner>(input, input_info.data_type, input_info.shape,
+                                                          const_cast<uint8_t *>(input->data()), input->data_size(),
+                                                          true);
+    ref_inputs->push_back(tensor);
+  }
+  return SUCCESS;
+}
+
 Status DirectModelLoaderBase::PostPredict(const ModelExecutorSubgraphInfo &subgraph_info, uint64_t model_batch_size,
                                           const std::vector<InstanceData> &instances,
                                           const std::vector<TensorBasePtr> &predict_result,
@@ -127,43 +235,99 @@ Status DirectModelLoaderBase::PostPredict(const ModelExecutorSubgraphInfo &subgr
 }
 
 Status DirectModelLoaderBase::AfterLoadModel() {
-  InitModelExecuteInfo();
+  auto replica_num = GetReplicaNum();
+  auto buffer_num = GetInputBufferNum();
+  if (replica_num == 0 || buffer_num == 0) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Invalid replica count " << replica_num << " or input buffer count "
+                                          << buffer_num << ", model info: " << model_key_;
+  }
+  model_infos_.clear();
+  model_infos_.resize(replica_num * buffer_num);
+  for (auto &model_info : model_infos_) {
+    InitModelExecuteInfo(&model_info);
+  }
   return SUCCESS;
 }
 
-void DirectModelLoaderBase::InitModelExecuteInfo() {
+Status DirectModelLoaderBase::ExecuteReplica(const std::vector<TensorBasePtr> &input,
+                                             std::vector<TensorBasePtr> *output, uint64_t subgraph,
+                                             uint64_t batch_size, uint64_t replica) {
+  if (replica != 0 || batch_size != GetBatchSize()) {
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Batch size " << batch_size << " of replica " << replica
+                                                << " is not supported, model info: " << model_key_;
+  }
+  return Predict(input, output, subgraph);
+}
+
+void DirectModelLoaderBase::InitModelExecuteInfo(ModelExecutorInfo *model_info) {
   auto graph_num = GetGraphNum();
-  model_info_.sub_graph_infos.resize(graph_num);
-  model_info_.batch_size = GetBatchSize();
+  model_info->sub_graph_infos.resize(graph_num);
+  model_info->batch_size = GetBatchSize();
 
   for (uint64_t i = 0; i < graph_num; i++) {
-    auto input_infos = GetInputInfos(i);
-    auto output_infos = GetOutputInfos(i);
-    auto &subgraph_info = model_info_.sub_graph_infos[i];
-    subgraph_info.input_infos = input_infos;
-    for (auto &item : output_infos) {
-      TensorInfoOutput info;
-      info.tensor_info = item;
-      if (item.is_no_batch_dim) {
-        info.shape_one_batch = item.shape;
-        info.size_one_batch = item.size;
-      } else {
-        info.shape_one_batch = item.shape;
-        (void)info.shape_one_batch.erase(info.shape_one_batch.begin());
-        // the batch size has been checked in WorkerExecutor
-        info.size_one_batch = item.size / model_info_.batch_size;
-      }
-      subgraph_info.output_infos.push_back(info);
+    InitSubgraphExecuteInfo(i, model_info->batch_size, &model_info->sub_graph_infos[i]);
+  }
+  model_info->bucket_graph_infos.clear();
+  for (auto bucket_batch_size : GetBatchBuckets()) {
+    if (bucket_batch_size == 0 || bucket_batch_size >= model_info->batch_size) {
+      MSI_LOG_EXCEPTION << "Invalid batch bucket " << bucket_batch_size << ", model batch size "
+                        << model_info->batch_size;
+    }
+    auto &bucket_infos = model_info->bucket_graph_infos[bucket_batch_size];
+    bucket_infos.resize(graph_num);
+    for (uint64_t i = 0; i < graph_num; i++) {
+      InitSubgraphExecuteInfo(i, bucket_batch_size, &bucket_infos[i]);
+    }
+  }
+}
+
+void DirectModelLoaderBase::InitSubgraphExecuteInfo(uint64_t subgraph, uint64_t batch_size,
+                                                    ModelExecutorSubgraphInfo *subgraph_info) {
+  // the inputs and outputs of batch bucket are the ones of the model with batch dim replaced by the bucket size
+  auto model_batch_size = GetBatchSize();
+  auto to_batch_size = [model_batch_size, batch_size](TensorInfo *info) {
+    if (info->is_no_batch_dim || batch_size == model_batch_size) {
+      return;
     }
-    // init input buffer
-    subgraph_info.input_buffers.clear();
-    for (auto &input_info : subgraph_info.input_infos) {
-      auto tensor = std::make_shared<Tensor>();
-      tensor->set_data_type(input_info.data_type);
-      tensor->set_shape(input_info.shape);
-      (void)tensor->resize_data(input_info.size);
-      subgraph_info.input_buffers.push_back(tensor);
+    info->size = info->size / model_batch_size * batch_size;
+    info->shape[0] = static_cast<int64_t>(batch_size);
+  };
+  auto input_infos = GetInputInfos(subgraph);
+  auto output_infos = GetOutputInfos(subgraph);
+  subgraph_info->input_infos.clear();
+  for (auto &item : input_infos) {
+    to_batch_size(&item);
+    subgraph_info->input_infos.push_back(item);
+  }
+  subgraph_info->output_infos.clear();
+  for (auto &item : output_infos) {
+    to_batch_size(&item);
+    TensorInfoOutput info;
+    info.tensor_info = item;
+    if (item.is_no_batch_dim) {
+      info.shape_one_batch = item.shape;
+      info.size_one_batch = item.size;
+    } else {
+      info.shape_one_batch = item.shape;
+      (void)info.shape_one_batch.erase(info.shape_one_batch.begin());
+      // the batch size has been checked in WorkerExecutor
+      info.size_one_batch = item.size / batch_size;
+    }
+    subgraph_info->output_infos.push_back(info);
+  }
+  // init input buffer, batch 1 uses the instance data as inputs directly and has no input buffer
+  subgraph_info->input_buffers.clear();
+  if (batch_size == 1) {
+    return;
+  }
+  for (auto &input_info : subgraph_info->input_infos) {
+    auto tensor = std::make_shared<Tensor>();
+    tensor->set_data_type(input_info.data_type);
+    tensor->set_shape(input_info.shape);
+    if (!tensor->resize_data(input_info.size)) {
+      MSI_LOG_EXCEPTION << "Create input buffer of size " << input_info.size << " failed";
     }
+    subgraph_info->input_buffers.push_back(tensor);
   }
 }
 }  // namespace mindspore::serving
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <map>
 #include <vector>
 #include <string>
 
@@ -36,11 +37,27 @@ class ModelLoaderBase {
   virtual std::vector<TensorInfo> GetInputInfos(uint64_t subgraph) const = 0;
   virtual std::vector<TensorInfo> GetOutputInfos(uint64_t subgraph) const = 0;
   virtual uint64_t GetBatchSize() const = 0;
+  // batch size of the model executing the instances, smaller than GetBatchSize() when a batch bucket fits them
+  virtual uint64_t GetExecuteBatchSize(uint64_t) const { return GetBatchSize(); }
   virtual uint64_t GetGraphNum() const = 0;
   virtual void Clear() = 0;
 
   virtual Status Predict(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
                          uint64_t subgraph) = 0;
+  // model replicas can predict concurrently, each predict thread uses one replica in [0, GetReplicaNum())
+  virtual uint64_t GetReplicaNum() const { return 1; }
+  virtual Status PredictWithReplica(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
+                                    uint64_t subgraph, uint64_t) {
+    return Predict(inputs, outputs, subgraph);
+  }
+  // predict split into batch assembly and execution, assembling the next batch into another input buffer set can
+  // overlap with executing the current batch, buffer_index: [0, GetInputBufferNum())
+  virtual uint64_t GetInputBufferNum() const { return 1; }
+  virtual Status AssembleBatch(const std::vector<InstanceData> &, uint64_t, uint64_t, uint64_t) { return SUCCESS; }
+  virtual Status ExecuteBatch(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
+                              uint64_t subgraph, uint64_t replica, uint64_t) {
+    return PredictWithReplica(inputs, outputs, subgraph, replica);
+  }
   virtual Status AfterLoadModel() = 0;
   virtual bool OwnDevice() const = 0;
 };
@@ -54,26 +71,46 @@ struct ModelExecutorSubgraphInfo {
 struct ModelExecutorInfo {
   std::vector<ModelExecutorSubgraphInfo> sub_graph_infos;
   uint64_t batch_size = 0;
+  // batch bucket size: subgraph infos, batch buckets are smaller than batch_size
+  std::map<uint64_t, std::vector<ModelExecutorSubgraphInfo>> bucket_graph_infos;
 };
 
 class MS_API DirectModelLoaderBase : public ModelLoaderBase {
  public:
   virtual Status Predict(const std::vector<TensorBasePtr> &input, std::vector<TensorBasePtr> *output,
                          uint64_t subgraph) = 0;
+  // the batch sizes of models exported with smaller batch sizes, each is less than GetBatchSize()
+  virtual std::vector<uint64_t> GetBatchBuckets() const { return {}; }
+  uint64_t GetExecuteBatchSize(uint64_t instance_count) const override;
+  // predict by the model of batch size(GetBatchSize() or one of GetBatchBuckets()) of the replica
+  virtual Status ExecuteReplica(const std::vector<TensorBasePtr> &input, std::vector<TensorBasePtr> *output,
+                                uint64_t subgraph, uint64_t batch_size, uint64_t replica);
 
   Status Predict(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
                  uint64_t subgraph) override;
+  Status PredictWithReplica(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
+                            uint64_t subgraph, uint64_t replica) override;
+  Status AssembleBatch(const std::vector<InstanceData> &inputs, uint64_t subgraph, uint64_t replica,
+                       uint64_t buffer_index) override;
+  Status ExecuteBatch(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
+                      uint64_t subgraph, uint64_t replica, uint64_t buffer_index) override;
 
   Status AfterLoadModel() override;
   bool OwnDevice() const override { return true; }
 
  private:
   std::string model_key_;
-  ModelExecutorInfo model_info_;
+  // one for each input buffer set of each replica, index: replica * GetInputBufferNum() + buffer index
+  std::vector<ModelExecutorInfo> model_infos_;
 
-  void InitModelExecuteInfo();
+  void InitModelExecuteInfo(ModelExecutorInfo *model_info);
+  Status GetSubgraphExecuteInfo(size_t input_batch_size, uint64_t subgraph, uint64_t replica, uint64_t buffer_index,
+                                const ModelExecutorSubgraphInfo **subgraph_info, uint64_t *batch_size) const;
+  void InitSubgraphExecuteInfo(uint64_t subgraph, uint64_t batch_size, ModelExecutorSubgraphInfo *subgraph_info);
   Status PrePredict(const ModelExecutorSubgraphInfo &subgraph_info, uint64_t model_batch_size,
                     const std::vector<InstanceData> &instances);
+  static Status CreateRefInputs(const ModelExecutorSubgraphInfo &subgraph_info,
+                                const std::vector<InstanceData> &instances, std::vector<TensorBasePtr> *ref_inputs);
   Status PostPredict(const ModelExecutorSubgraphInfo &subgraph_info, uint64_t model_batch_size,
                      const std::vector<InstanceData> &instances, const std::vector<TensorBasePtr> &predict_result,
                      std::vector<ResultInstance> *instance_result);
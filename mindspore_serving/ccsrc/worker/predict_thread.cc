@@ -18,6 +18,7 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <utility>
 #include "worker/task_queue.h"
 #include "worker/stage_function.h"
 #include "common/buffer_tensor.h"
@@ -44,23 +45,131 @@ void PredictThread::PushPredictTask(const MethodStage &stage, const std::vector<
   }
 }
 
-void PredictThread::ThreadFunc(PredictThread *queue) { queue->Predict(); }
+void PredictThread::ThreadFunc(PredictThread *queue, uint64_t replica) { queue->Predict(replica); }
 
-void PredictThread::Predict() {
+void PredictThread::AssembleThreadFunc(PredictThread *queue, uint64_t replica) { queue->AssembleLoop(replica); }
+
+void PredictThread::ExecuteThreadFunc(PredictThread *queue, uint64_t replica) { queue->ExecuteLoop(replica); }
+
+bool PredictThread::PopTask(TaskItem *task_item) {
+  task_que_.PopTask(task_item);
+  if (task_item->has_stopped) {
+    MSI_LOG_INFO << "Predict task has stopped, exit predict thread";
+    return false;
+  }
+  auto execute_batch_size = model_loader_->GetExecuteBatchSize(task_item->instance_list.size());
+  predict_batch_count_ += 1;
+  predict_instance_count_ += task_item->instance_list.size();
+  predict_batch_slot_count_ += execute_batch_size;
+  MSI_LOG_DEBUG << task_item->task_info.tag << " predict instances count " << task_item->instance_list.size()
+                << ", batch size " << execute_batch_size << ", batch fill ratio " << GetBatchFillRatio();
+  return true;
+}
+
+void PredictThread::Predict(uint64_t replica) {
   while (true) {
     TaskItem task_item;
-    task_que_.PopTask(&task_item);
-    if (task_item.has_stopped) {
-      MSI_LOG_INFO << "Predict task has stopped, exit predict thread";
+    if (!PopTask(&task_item)) {
       break;
     }
     MSI_TIME_STAMP_START(InvokePredict)
-    PredictHandle(task_item.task_info, task_item.instance_list);
+    std::vector<InstanceData> inputs;
+    auto status = AssembleBatch(task_item, replica, 0, &inputs);
+    if (status != SUCCESS) {
+      task_que_.PushTaskResult(task_item.instance_list, status);
+    } else {
+      ExecuteBatch(task_item, inputs, replica, 0);
+    }
     MSI_TIME_STAMP_END_EXTRA(InvokePredict, task_item.task_info.tag)
   }
 }
 
+void PredictThread::AssembleLoop(uint64_t replica) {
+  auto &pipeline = *pipelines_[replica];
+  while (true) {
+    PredictBatch batch;
+    {
+      std::unique_lock<std::mutex> lock{pipeline.lock};
+      pipeline.cond_var.wait(lock, [&pipeline] { return pipeline.stopped || !pipeline.free_buffers.empty(); });
+      if (pipeline.stopped) {
+        return;
+      }
+      batch.buffer_index = pipeline.free_buffers.back();
+      pipeline.free_buffers.pop_back();
+    }
+    if (!PopTask(&batch.task_item)) {
+      std::unique_lock<std::mutex> lock{pipeline.lock};
+      pipeline.stopped = true;
+      pipeline.cond_var.notify_all();
+      return;
+    }
+    batch.status = AssembleBatch(batch.task_item, replica, batch.buffer_index, &batch.inputs);
+    {
+      std::unique_lock<std::mutex> lock{pipeline.lock};
+      if (pipeline.stopped) {  // the execute thread may have exited
+        lock.unlock();
+        FailStoppedBatch(batch);
+        return;
+      }
+      pipeline.ready_batches.push_back(std::move(batch));
+    }
+    pipeline.cond_var.notify_all();
+  }
+}
+
+void PredictThread::ExecuteLoop(uint64_t replica) {
+  auto &pipeline = *pipelines_[replica];
+  while (true) {
+    PredictBatch batch;
+    {
+      std::unique_lock<std::mutex> lock{pipeline.lock};
+      pipeline.cond_var.wait(lock, [&pipeline] { return pipeline.stopped || !pipeline.ready_batches.empty(); });
+      if (pipeline.stopped) {
+        // the batches assembled and not executed fail, or their instances never get results
+        auto ready_batches = std::move(pipeline.ready_batches);
+        pipeline.ready_batches.clear();
+        lock.unlock();
+        for (auto &ready_batch : ready_batches) {
+          FailStoppedBatch(ready_batch);
+        }
+        return;
+      }
+      batch = std::move(pipeline.ready_batches.front());
+      pipeline.ready_batches.pop_front();
+    }
+    if (batch.status != SUCCESS) {
+      task_que_.PushTaskResult(batch.task_item.instance_list, batch.status);
+    } else {
+      ExecuteBatch(batch.task_item, batch.inputs, replica, batch.buffer_index);
+    }
+    {
+      std::unique_lock<std::mutex> lock{pipeline.lock};
+      pipeline.free_buffers.push_back(batch.buffer_index);
+    }
+    pipeline.cond_var.notify_all();
+  }
+}
+
+void PredictThread::FailStoppedBatch(const PredictBatch &batch) {
+  task_que_.PushTaskResult(batch.task_item.instance_list, Status(WORKER_UNAVAILABLE, "Model predict stopped"));
+}
+
 void PredictThread::Stop() {
+  // the ready batches are failed by the execute threads before the task queue stops delivering results
+  for (auto &pipeline : pipelines_) {
+    {
+      std::unique_lock<std::mutex> lock{pipeline->lock};
+      pipeline->stopped = true;
+      pipeline->cond_var.notify_all();
+    }
+    if (pipeline->execute_thread.joinable()) {
+      try {
+        pipeline->execute_thread.join();
+      } catch (const std::system_error &) {
+      } catch (...) {
+      }
+    }
+  }
   task_que_.Stop();
   for (auto &predict_thread : predict_threads_) {
     if (predict_thread.joinable()) {
@@ -71,6 +180,22 @@ void PredictThread::Stop() {
       }
     }
   }
+  predict_threads_.clear();
+  pipelines_.clear();
+  if (predict_batch_count_ > 0) {
+    MSI_LOG_INFO << "Model " << model_meta_.common_meta.model_key << " predict batch count " << predict_batch_count_
+                 << ", instance count " << predict_instance_count_ << ", batch fill ratio " << GetBatchFillRatio()
+                 << ", batch assembly time " << assemble_time_us_ / 1000 << " ms, execute time "
+                 << execute_time_us_ / 1000 << " ms";
+  }
+}
+
+double PredictThread::GetBatchFillRatio() const {
+  uint64_t batch_slot_count = predict_batch_slot_count_;
+  if (batch_slot_count == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(predict_instance_count_) / static_cast<double>(batch_slot_count);
 }
 
 std::string PredictThread::AsGroupName(const std::string &model_key, uint64_t subgraph) const {
@@ -95,6 +220,12 @@ void PredictThread::Start(const std::string &que_name, const std::shared_ptr<Mod
     auto &subgraph_info = executor_info_.sub_graph_infos[i];
     subgraph_info.input_infos = input_infos;
   }
+  auto preferred_batch_size = model_meta.common_meta.preferred_batch_size;
+  if (preferred_batch_size > batch_size) {
+    MSI_LOG_WARNING << "The preferred batch size " << preferred_batch_size << " of model " << model_key
+                    << " is greater than the model batch size " << batch_size << ", use the model batch size";
+    preferred_batch_size = batch_size;
+  }
   // init task infos
   std::vector<TaskInfo> task_infos;
   for (uint64_t i = 0; i < graph_num; i++) {
@@ -105,28 +236,48 @@ void PredictThread::Start(const std::string &que_name, const std::shared_ptr<Mod
     info.priority = 0;
     info.batch_size = batch_size;
     info.tag = "Model " + model_key + (graph_num > 1 ? " subgraph " + std::to_string(i) : "");
+    info.preferred_batch_size = preferred_batch_size;
+    info.max_queue_delay_us = model_meta.common_meta.max_queue_delay_us;
     task_infos.push_back(info);
   }
   task_que_.Start(que_name, task_infos, task_callback);  // start before predict_thread_ start
   bool support_pipeline_infer = model_meta.distributed_meta.enable_pipeline_infer &&
                                 (std::dynamic_pointer_cast<DistributedModelLoader>(model_loader) != nullptr);
-  size_t thread_num = support_pipeline_infer ? model_meta.distributed_meta.stage_size : 1;
-  for (size_t i = 0; i < thread_num; i++) {
-    predict_threads_.emplace_back(ThreadFunc, this);
+  if (support_pipeline_infer) {
+    for (size_t i = 0; i < model_meta.distributed_meta.stage_size; i++) {
+      predict_threads_.emplace_back(ThreadFunc, this, 0);
+    }
+    return;
+  }
+  // one predict thread for each model replica, all fed from the same task queue
+  auto replica_num = model_loader_->GetReplicaNum();
+  auto buffer_num = model_loader_->GetInputBufferNum();
+  for (uint64_t i = 0; i < replica_num; i++) {
+    if (buffer_num <= 1) {
+      predict_threads_.emplace_back(ThreadFunc, this, i);
+      continue;
+    }
+    // the assembly thread copies the next batch into a free input buffer set while the execute thread runs
+    auto pipeline = std::make_unique<PredictPipeline>();
+    for (uint64_t k = 0; k < buffer_num; k++) {
+      pipeline->free_buffers.push_back(buffer_num - 1 - k);
+    }
+    pipelines_.push_back(std::move(pipeline));
+  }
+  for (uint64_t i = 0; i < pipelines_.size(); i++) {
+    predict_threads_.emplace_back(AssembleThreadFunc, this, i);
+    pipelines_[i]->execute_thread = std::thread(ExecuteThreadFunc, this, i);
+  }
+  if (replica_num > 1 || buffer_num > 1) {
+    MSI_LOG_INFO << "Model " << model_key << " predicts with " << replica_num << " replicas, " << buffer_num
+                 << " input buffer sets each replica";
   }
 }
 
-void PredictThread::PredictHandle(const TaskInfo &task_info, const std::vector<InstancePtr> &instances) {
+Status PredictThread::CallWithCatch(const std::function<Status()> &func) {
   Status status;
   try {
-    std::vector<ResultInstance> instance_result;
-    status = PredictInner(task_info, instances, &instance_result);
-    if (status != SUCCESS) {
-      task_que_.PushTaskResult(instances, status);
-      return;
-    }
-    task_que_.PushTaskResult(instances, instance_result);
-    return;
+    status = func();
   } catch (const std::bad_alloc &ex) {
     status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: malloc memory failed";
   } catch (const std::runtime_error &ex) {
@@ -136,23 +287,44 @@ void PredictThread::PredictHandle(const TaskInfo &task_info, const std::vector<I
   } catch (...) {
     status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred";
   }
-  task_que_.PushTaskResult(instances, status);
+  return status;
 }
 
-Status PredictThread::PredictInner(const TaskInfo &task_info, const std::vector<InstancePtr> &instances,
-                                   std::vector<ResultInstance> *instance_result) {
-  Status status;
-  std::vector<InstanceData> inputs;
-  for (auto &item : instances) {
+Status PredictThread::AssembleBatch(const TaskItem &task_item, uint64_t replica, uint64_t buffer_index,
+                                    std::vector<InstanceData> *inputs) {
+  auto start = std::chrono::steady_clock::now();
+  for (auto &item : task_item.instance_list) {
     // cppcheck-suppress useStlAlgorithm
-    inputs.push_back(item->data);
+    inputs->push_back(item->data);
   }
-  status = model_loader_->Predict(inputs, instance_result, task_info.subgraph);
+  auto status = CallWithCatch([this, &task_item, replica, buffer_index, inputs]() {
+    return model_loader_->AssembleBatch(*inputs, task_item.task_info.subgraph, replica, buffer_index);
+  });
+  auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  assemble_time_us_ += static_cast<uint64_t>(cost.count());
+  if (status != SUCCESS) {
+    MSI_LOG_ERROR << "Assemble batch failed, model info " << model_meta_.common_meta.model_key;
+  }
+  return status;
+}
+
+void PredictThread::ExecuteBatch(const TaskItem &task_item, const std::vector<InstanceData> &inputs,
+                                 uint64_t replica, uint64_t buffer_index) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<ResultInstance> instance_result;
+  auto status = CallWithCatch([this, &task_item, &inputs, &instance_result, replica, buffer_index]() {
+    return model_loader_->ExecuteBatch(inputs, &instance_result, task_item.task_info.subgraph, replica,
+                                       buffer_index);
+  });
+  auto cost = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  execute_time_us_ += static_cast<uint64_t>(cost.count());
+  MSI_LOG_DEBUG << task_item.task_info.tag << " execute time " << cost.count() << " us, replica " << replica;
   if (status != SUCCESS) {
     MSI_LOG_ERROR << "Predict failed, model info " << model_meta_.common_meta.model_key;
-    return status;
+    task_que_.PushTaskResult(task_item.instance_list, status);
+    return;
   }
-  return SUCCESS;
+  task_que_.PushTaskResult(task_item.instance_list, instance_result);
 }
 
 Status PredictThread::CheckPredictInput(uint64_t subgraph, const InstancePtr &instance) {
@@ -25,6 +25,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <deque>
 #include "common/instance.h"
 #include "worker/inference/inference.h"
 #include "worker/task_queue.h"
@@ -40,6 +41,23 @@ struct PredictModelInfo {
   uint64_t batch_size = 0;
 };
 
+struct PredictBatch {
+  TaskItem task_item;
+  std::vector<InstanceData> inputs;
+  uint64_t buffer_index = 0;
+  Status status;  // status of batch assembly
+};
+
+// batch assembly and execution pipeline of one replica, batches are assembled into free input buffer sets
+struct PredictPipeline {
+  std::mutex lock;
+  std::condition_variable cond_var;
+  std::deque<PredictBatch> ready_batches;  // assembled, waiting for execution
+  std::vector<uint64_t> free_buffers;      // input buffer set index
+  bool stopped = false;
+  std::thread execute_thread;
+};
+
 class PredictThread {
  public:
   PredictThread();
@@ -51,6 +69,8 @@ class PredictThread {
   void Stop();
 
   uint64_t GetBatchSize() const { return executor_info_.batch_size; }
+  // ratio of the instances predicted to the batch slots of the models executed, padded slots are wasted compute
+  double GetBatchFillRatio() const;
 
  private:
   TaskQueue task_que_;
@@ -58,13 +78,27 @@ class PredictThread {
   ModelMeta model_meta_;
   std::shared_ptr<ModelLoaderBase> model_loader_ = nullptr;
   PredictModelInfo executor_info_;
+  std::atomic<uint64_t> predict_batch_count_ = 0;
+  std::atomic<uint64_t> predict_instance_count_ = 0;
+  std::atomic<uint64_t> predict_batch_slot_count_ = 0;  // sum of the batch sizes of the models(or buckets) executed
+  std::atomic<uint64_t> assemble_time_us_ = 0;  // time of copying instances into input buffers
+  std::atomic<uint64_t> execute_time_us_ = 0;   // time of model executing and splitting outputs
+  std::vector<std::unique_ptr<PredictPipeline>> pipelines_;
 
-  static void ThreadFunc(PredictThread *queue);
-  void Predict();
+  static void ThreadFunc(PredictThread *queue, uint64_t replica);
+  static void AssembleThreadFunc(PredictThread *queue, uint64_t replica);
+  static void ExecuteThreadFunc(PredictThread *queue, uint64_t replica);
+  void Predict(uint64_t replica);
+  void AssembleLoop(uint64_t replica);
+  void ExecuteLoop(uint64_t replica);
+  void FailStoppedBatch(const PredictBatch &batch);
+  bool PopTask(TaskItem *task_item);
 
-  void PredictHandle(const TaskInfo &task_info, const std::vector<InstancePtr> &instances);
-  Status PredictInner(const TaskInfo &task_info, const std::vector<InstancePtr> &instances,
-                      std::vector<ResultInstance> *instance_result);
+  Status AssembleBatch(const TaskItem &task_item, uint64_t replica, uint64_t buffer_index,
+                       std::vector<InstanceData> *inputs);
+  void ExecuteBatch(const TaskItem &task_item, const std::vector<InstanceData> &inputs, uint64_t replica,
+                    uint64_t buffer_index);
+  static Status CallWithCatch(const std::function<Status()> &func);
   Status CheckPredictInput(uint64_t subgraph, const InstancePtr &instance);
   std::string AsGroupName(const std::string &model_key, uint64_t subgraph) const;
 };
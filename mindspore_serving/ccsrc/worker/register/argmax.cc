@@ -15,6 +15,7 @@
  */
 
 #include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
 #include "mindspore_serving/ccsrc/common/tensor.h"
 
 namespace mindspore::serving {
@@ -44,7 +45,7 @@ class ArgmaxStageFunc : public CppStageFunctionBase {
     auto y_data = reinterpret_cast<size_t *>(out_tensor->mutable_data());
     switch (input_x->data_type()) {
       case kMSI_Float32:
-        ArgmaxImp<float>(x_data, y_data, input_x->data_size(), input_x->itemsize());
+        *y_data = GetStageKernels().argmax_fp32(reinterpret_cast<const float *>(x_data), input_x->element_cnt());
         break;
       case kMSI_Float64:
         ArgmaxImp<double>(x_data, y_data, input_x->data_size(), input_x->itemsize());
@@ -0,0 +1,137 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+namespace {
+template <typename DT>
+void CastToFp32Imp(const void *input, float *output, size_t count) {
+  auto data = reinterpret_cast<const DT *>(input);
+  for (size_t i = 0; i < count; i++) {
+    output[i] = static_cast<float>(data[i]);
+  }
+}
+
+// uint8, float16 and float32 use the vectorized kernels, other number types are cast one by one
+Status CastToFp32(const TensorBasePtr &input_x, float *output) {
+  auto x_data = input_x->data();
+  auto count = input_x->element_cnt();
+  auto &kernels = GetStageKernels();
+  switch (input_x->data_type()) {
+    case kMSI_Float32:
+      CastToFp32Imp<float>(x_data, output, count);
+      break;
+    case kMSI_Float16:
+      kernels.cast_fp16_to_fp32(reinterpret_cast<const uint16_t *>(x_data), output, count);
+      break;
+    case kMSI_Uint8:
+      kernels.cast_uint8_to_fp32(x_data, output, count);
+      break;
+    case kMSI_Bool:
+      CastToFp32Imp<bool>(x_data, output, count);
+      break;
+    case kMSI_Float64:
+      CastToFp32Imp<double>(x_data, output, count);
+      break;
+    case kMSI_Int8:
+      CastToFp32Imp<int8_t>(x_data, output, count);
+      break;
+    case kMSI_Int16:
+      CastToFp32Imp<int16_t>(x_data, output, count);
+      break;
+    case kMSI_Uint16:
+      CastToFp32Imp<uint16_t>(x_data, output, count);
+      break;
+    case kMSI_Int32:
+      CastToFp32Imp<int32_t>(x_data, output, count);
+      break;
+    case kMSI_Uint32:
+      CastToFp32Imp<uint32_t>(x_data, output, count);
+      break;
+    case kMSI_Int64:
+      CastToFp32Imp<int64_t>(x_data, output, count);
+      break;
+    case kMSI_Uint64:
+      CastToFp32Imp<uint64_t>(x_data, output, count);
+      break;
+    default:
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Cast not support data type " << input_x->data_type();
+  }
+  return SUCCESS;
+}
+}  // namespace
+
+// cast number input to float32
+class CastFp32StageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    auto out_tensor = std::make_shared<Tensor>();
+    out_tensor->set_data_type(kMSI_Float32);
+    (void)out_tensor->resize_data(input_x->element_cnt() * sizeof(float));
+    out_tensor->set_shape(input_x->shape());
+    output->push_back(out_tensor);
+    return CastToFp32(input_x, reinterpret_cast<float *>(out_tensor->mutable_data()));
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+// cast number input to float16, input other than float32 and float16 is cast to float32 first
+class CastFp16StageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    auto count = input_x->element_cnt();
+    auto out_tensor = std::make_shared<Tensor>();
+    out_tensor->set_data_type(kMSI_Float16);
+    (void)out_tensor->resize_data(count * sizeof(uint16_t));
+    out_tensor->set_shape(input_x->shape());
+    output->push_back(out_tensor);
+    auto y_data = reinterpret_cast<uint16_t *>(out_tensor->mutable_data());
+    if (input_x->data_type() == kMSI_Float16) {
+      (void)out_tensor->set_data(input_x->data(), input_x->data_size());
+      return SUCCESS;
+    }
+    if (input_x->data_type() == kMSI_Float32) {
+      GetStageKernels().cast_fp32_to_fp16(reinterpret_cast<const float *>(input_x->data()), y_data, count);
+      return SUCCESS;
+    }
+    std::vector<float> fp32_data(count);
+    auto status = CastToFp32(input_x, fp32_data.data());
+    if (status != SUCCESS) {
+      return status;
+    }
+    GetStageKernels().cast_fp32_to_fp16(fp32_data.data(), y_data, count);
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+REGISTER_STAGE_FUNCTION(CastFp32StageFunc, "cast_float32_cpp")
+REGISTER_STAGE_FUNCTION(CastFp16StageFunc, "cast_float16_cpp")
+}  // namespace mindspore::serving
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+namespace {
+Status GetFp32Scalar(const std::string &func_name, const std::string &input_name, const TensorBasePtr &tensor,
+                     float *value) {
+  if (tensor->data_type() != kMSI_Float32 || tensor->element_cnt() != 1) {
+    return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+           << func_name << " input " << input_name << " should be a float32 scalar, given data type "
+           << tensor->data_type() << ", shape " << tensor->shape();
+  }
+  *value = *reinterpret_cast<const float *>(tensor->data());
+  return SUCCESS;
+}
+
+Status CreateFp32Output(const std::string &func_name, const TensorBasePtr &input_x, InstanceData *output,
+                        float **y_data) {
+  if (input_x->data_type() != kMSI_Float32) {
+    return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+           << func_name << " only support float32 input, given data type " << input_x->data_type();
+  }
+  auto out_tensor = std::make_shared<Tensor>();
+  out_tensor->set_data_type(kMSI_Float32);
+  (void)out_tensor->resize_data(input_x->data_size());
+  out_tensor->set_shape(input_x->shape());
+  output->push_back(out_tensor);
+  *y_data = reinterpret_cast<float *>(out_tensor->mutable_data());
+  return SUCCESS;
+}
+}  // namespace
+
+// inputs: x float32, min and max float32 scalar; outputs: min(max(x, min), max)
+class ClipStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    float min_value = 0;
+    float max_value = 0;
+    auto status = GetFp32Scalar(func_name, "min", input[1], &min_value);
+    if (status != SUCCESS) {
+      return status;
+    }
+    status = GetFp32Scalar(func_name, "max", input[2], &max_value);
+    if (status != SUCCESS) {
+      return status;
+    }
+    float *y_data = nullptr;
+    status = CreateFp32Output(func_name, input[0], output, &y_data);
+    if (status != SUCCESS) {
+      return status;
+    }
+    auto x_data = reinterpret_cast<const float *>(input[0]->data());
+    GetStageKernels().clip_fp32(x_data, y_data, input[0]->element_cnt(), min_value, max_value);
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 3; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+// inputs: x float32, threshold float32 scalar; outputs: float32, 1 if x > threshold else 0
+class ThresholdStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    float threshold = 0;
+    auto status = GetFp32Scalar(func_name, "threshold", input[1], &threshold);
+    if (status != SUCCESS) {
+      return status;
+    }
+    float *y_data = nullptr;
+    status = CreateFp32Output(func_name, input[0], output, &y_data);
+    if (status != SUCCESS) {
+      return status;
+    }
+    auto x_data = reinterpret_cast<const float *>(input[0]->data());
+    GetStageKernels().threshold_fp32(x_data, y_data, input[0]->element_cnt(), threshold);
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 2; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+REGISTER_STAGE_FUNCTION(ClipStageFunc, "clip_cpp")
+REGISTER_STAGE_FUNCTION(ThresholdStageFunc, "threshold_cpp")
+}  // namespace mindspore::serving
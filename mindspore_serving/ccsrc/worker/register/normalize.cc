@@ -0,0 +1,92 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+// (x - mean) / std of the channels in the last dimension, such as HWC image,
+// inputs: x float32 or uint8, mean and std float32 with one value of each channel or one value for all;
+// outputs: float32
+class NormalizeStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    auto mean_tensor = input[1];
+    auto std_tensor = input[2];
+    if (input_x->data_type() != kMSI_Float32 && input_x->data_type() != kMSI_Uint8) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Normalize only support float32 or uint8 input, given data type " << input_x->data_type();
+    }
+    if (mean_tensor->data_type() != kMSI_Float32 || std_tensor->data_type() != kMSI_Float32) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Normalize input mean and std should be float32";
+    }
+    auto channels = mean_tensor->element_cnt();
+    auto shape = input_x->shape();
+    if (channels == 0 || std_tensor->element_cnt() != channels) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Normalize input mean and std should have the same and non-zero size, mean size " << channels
+             << ", std size " << std_tensor->element_cnt();
+    }
+    if (channels != 1 && (shape.empty() || static_cast<size_t>(shape.back()) != channels)) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Normalize input mean size " << channels << " is not equal to the last dimension of x, x shape "
+             << shape;
+    }
+    auto mean_data = reinterpret_cast<const float *>(mean_tensor->data());
+    auto std_data = reinterpret_cast<const float *>(std_tensor->data());
+    auto period = channels * kStageKernelPeriodRepeat;
+    std::vector<float> scale(period);
+    std::vector<float> bias(period);
+    for (size_t i = 0; i < period; i++) {
+      auto channel = i % channels;
+      if (std_data[channel] == 0.0f) {
+        return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Normalize input std cannot be 0";
+      }
+      scale[i] = 1.0f / std_data[channel];
+      bias[i] = -mean_data[channel] / std_data[channel];
+    }
+    auto count = input_x->element_cnt();
+    auto out_tensor = std::make_shared<Tensor>();
+    out_tensor->set_data_type(kMSI_Float32);
+    (void)out_tensor->resize_data(count * sizeof(float));
+    out_tensor->set_shape(shape);
+    output->push_back(out_tensor);
+    if (count == 0) {
+      return SUCCESS;
+    }
+    auto &kernels = GetStageKernels();
+    auto y_data = reinterpret_cast<float *>(out_tensor->mutable_data());
+    const float *x_data = y_data;
+    if (input_x->data_type() == kMSI_Uint8) {
+      kernels.cast_uint8_to_fp32(input_x->data(), y_data, count);
+    } else {
+      x_data = reinterpret_cast<const float *>(input_x->data());
+    }
+    kernels.scale_bias_fp32(x_data, y_data, count, scale.data(), bias.data(), period);
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 3; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+REGISTER_STAGE_FUNCTION(NormalizeStageFunc, "normalize_cpp")
+}  // namespace mindspore::serving
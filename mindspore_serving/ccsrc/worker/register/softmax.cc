@@ -0,0 +1,78 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+// softmax of the last dimension
+class SoftmaxStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    if (input_x->data_type() != kMSI_Float32) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << func_name << " only support float32 input, given data type " << input_x->data_type();
+    }
+    auto shape = input_x->shape();
+    auto count = input_x->element_cnt();
+    auto out_tensor = std::make_shared<Tensor>();
+    out_tensor->set_data_type(kMSI_Float32);
+    (void)out_tensor->resize_data(input_x->data_size());
+    out_tensor->set_shape(shape);
+    output->push_back(out_tensor);
+    auto axis_size = shape.empty() ? 1 : static_cast<size_t>(shape.back());
+    if (count == 0 || axis_size == 0) {
+      return SUCCESS;
+    }
+    auto x_data = reinterpret_cast<const float *>(input_x->data());
+    auto y_data = reinterpret_cast<float *>(out_tensor->mutable_data());
+    auto &kernels = GetStageKernels();
+    for (size_t offset = 0; offset < count; offset += axis_size) {
+      auto x_row = x_data + offset;
+      auto y_row = y_data + offset;
+      auto max_value = kernels.reduce_max_fp32(x_row, axis_size);
+      auto sum = kernels.exp_sum_fp32(x_row, y_row, axis_size, max_value);
+      if (log_softmax_) {
+        // subtract max first, x - (max + log(sum)) loses precision when x is large
+        kernels.add_fp32(x_row, y_row, axis_size, -max_value);
+        kernels.add_fp32(y_row, y_row, axis_size, -std::log(sum));
+      } else {
+        kernels.scale_fp32(y_row, y_row, axis_size, 1.0f / sum);
+      }
+    }
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+
+ protected:
+  bool log_softmax_ = false;
+};
+
+class LogSoftmaxStageFunc : public SoftmaxStageFunc {
+ public:
+  LogSoftmaxStageFunc() { log_softmax_ = true; }
+};
+
+REGISTER_STAGE_FUNCTION(SoftmaxStageFunc, "softmax_cpp")
+REGISTER_STAGE_FUNCTION(LogSoftmaxStageFunc, "log_softmax_cpp")
+}  // namespace mindspore::serving
@@ -0,0 +1,203 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "worker/register/stage_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "common/float16.h"
+#include "common/serving_common.h"
+
+namespace mindspore::serving {
+namespace {
+size_t ArgmaxFp32(const float *input, size_t count) {
+  size_t index = 0;
+  for (size_t i = 1; i < count; i++) {
+    if (input[i] > input[index]) {
+      index = i;
+    }
+  }
+  return index;
+}
+
+size_t FindGreaterFp32(const float *input, size_t count, float threshold) {
+  for (size_t i = 0; i < count; i++) {
+    if (input[i] > threshold) {
+      return i;
+    }
+  }
+  return count;
+}
+
+float ReduceMaxFp32(const float *input, size_t count) {
+  float max_value = -INFINITY;
+  for (size_t i = 0; i < count; i++) {
+    max_value = std::max(max_value, input[i]);
+  }
+  return max_value;
+}
+
+float ExpSumFp32(const float *input, float *output, size_t count, float max_value) {
+  float sum = 0;
+  for (size_t i = 0; i < count; i++) {
+    output[i] = std::exp(input[i] - max_value);
+    sum += output[i];
+  }
+  return sum;
+}
+
+void ScaleFp32(const float *input, float *output, size_t count, float scale) {
+  for (size_t i = 0; i < count; i++) {
+    output[i] = input[i] * scale;
+  }
+}
+
+void AddFp32(const float *input, float *output, size_t count, float bias) {
+  for (size_t i = 0; i < count; i++) {
+    output[i] = input[i] + bias;
+  }
+}
+
+void ScaleBiasFp32(const float *input, float *output, size_t count, const float *scale, const float *bias,
+                   size_t period) {
+  for (size_t i = 0; i < count; i += period) {
+    auto block = std::min(period, count - i);
+    for (size_t j = 0; j < block; j++) {
+      output[i + j] = input[i + j] * scale[j] + bias[j];
+    }
+  }
+}
+
+void ClipFp32(const float *input, float *output, size_t count, float min_value, float max_value) {
+  for (size_t i = 0; i < count; i++) {
+    output[i] = std::min(std::max(input[i], min_value), max_value);
+  }
+}
+
+void ThresholdFp32(const float *input, float *output, size_t count, float threshold) {
+  for (size_t i = 0; i < count; i++) {
+    output[i] = input[i] > threshold ? 1.0f : 0.0f;
+  }
+}
+
+void CastUint8ToFp32(const uint8_t *input, float *output, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    output[i] = static_cast<float>(input[i]);
+  }
+}
+
+void CastFp32ToFp16(const float *input, uint16_t *output, size_t count) {
+  static_assert(sizeof(float16) == sizeof(uint16_t));
+  auto fp16_output = reinterpret_cast<float16 *>(output);
+  for (size_t i = 0; i < count; i++) {
+    fp16_output[i] = static_cast<float16>(input[i]);
+  }
+}
+
+void CastFp16ToFp32(const uint16_t *input, float *output, size_t count) {
+  auto fp16_input = reinterpret_cast<const float16 *>(input);
+  for (size_t i = 0; i < count; i++) {
+    output[i] = half_to_float(fp16_input[i]);
+  }
+}
+
+template <typename DT>
+void TransposeImp(const DT *input, DT *output, size_t rows, size_t cols) {
+  // blocking keeps both the read rows and the written columns in cache
+  constexpr size_t block = 32;
+  for (size_t row_begin = 0; row_begin < rows; row_begin += block) {
+    auto row_end = std::min(rows, row_begin + block);
+    for (size_t col_begin = 0; col_begin < cols; col_begin += block) {
+      auto col_end = std::min(cols, col_begin + block);
+      for (size_t row = row_begin; row < row_end; row++) {
+        for (size_t col = col_begin; col < col_end; col++) {
+          output[col * rows + row] = input[row * cols + col];
+        }
+      }
+    }
+  }
+}
+
+void Transpose(const uint8_t *input, uint8_t *output, size_t rows, size_t cols, size_t item_size) {
+  switch (item_size) {
+    case sizeof(uint8_t):
+      TransposeImp(input, output, rows, cols);
+      break;
+    case sizeof(uint16_t):
+      TransposeImp(reinterpret_cast<const uint16_t *>(input), reinterpret_cast<uint16_t *>(output), rows, cols);
+      break;
+    case sizeof(uint32_t):
+      TransposeImp(reinterpret_cast<const uint32_t *>(input), reinterpret_cast<uint32_t *>(output), rows, cols);
+      break;
+    case sizeof(uint64_t):
+      TransposeImp(reinterpret_cast<const uint64_t *>(input), reinterpret_cast<uint64_t *>(output), rows, cols);
+      break;
+    default:
+      for (size_t row = 0; row < rows; row++) {
+        for (size_t col = 0; col < cols; col++) {
+          (void)memcpy(output + (col * rows + row) * item_size, input + (row * cols + col) * item_size, item_size);
+        }
+      }
+      break;
+  }
+}
+
+StageKernels CreateScalarStageKernels() {
+  StageKernels kernels;
+  kernels.isa = "scalar";
+  kernels.argmax_fp32 = ArgmaxFp32;
+  kernels.find_greater_fp32 = FindGreaterFp32;
+  kernels.reduce_max_fp32 = ReduceMaxFp32;
+  kernels.exp_sum_fp32 = ExpSumFp32;
+  kernels.scale_fp32 = ScaleFp32;
+  kernels.add_fp32 = AddFp32;
+  kernels.scale_bias_fp32 = ScaleBiasFp32;
+  kernels.clip_fp32 = ClipFp32;
+  kernels.threshold_fp32 = ThresholdFp32;
+  kernels.cast_uint8_to_fp32 = CastUint8ToFp32;
+  kernels.cast_fp32_to_fp16 = CastFp32ToFp16;
+  kernels.cast_fp16_to_fp32 = CastFp16ToFp32;
+  kernels.transpose = Transpose;
+  return kernels;
+}
+
+StageKernels SelectStageKernels() {
+  auto kernels = CreateScalarStageKernels();
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c")) {
+    InitAvx2StageKernels(&kernels);
+    if (__builtin_cpu_supports("avx512f")) {
+      InitAvx512StageKernels(&kernels);
+    }
+  }
+#elif defined(ENABLE_ARM64)
+  InitNeonStageKernels(&kernels);
+#endif
+  MSI_LOG_INFO << "Built-in cpp stage functions use " << kernels.isa << " kernels";
+  return kernels;
+}
+}  // namespace
+
+const StageKernels &GetStageKernels() {
+  static const StageKernels kernels = SelectStageKernels();
+  return kernels;
+}
+
+const StageKernels &GetScalarStageKernels() {
+  static const StageKernels kernels = CreateScalarStageKernels();
+  return kernels;
+}
+}  // namespace mindspore::serving
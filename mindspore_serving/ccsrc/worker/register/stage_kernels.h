@@ -0,0 +1,84 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDSPORE_SERVING_WORKER_REGISTER_STAGE_KERNELS_H
+#define MINDSPORE_SERVING_WORKER_REGISTER_STAGE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mindspore::serving {
+// scale and bias of scale_bias_fp32 repeat with a period of channels * kStageKernelPeriodRepeat elements,
+// so that every vector load of the scale and bias stays aligned with the channels of the input
+constexpr size_t kStageKernelPeriodRepeat = 16;
+
+// polynomial exp approximation of the vectorized kernels, the same as cephes expf
+constexpr float kExpInputMax = 88.3762626647949f;
+constexpr float kExpInputMin = -88.3762626647949f;
+constexpr float kExpLog2e = 1.44269504088896341f;
+constexpr float kExpLn2Hi = 0.693359375f;
+constexpr float kExpLn2Lo = -2.12194440e-4f;
+constexpr float kExpPoly0 = 1.9875691500e-4f;
+constexpr float kExpPoly1 = 1.3981999507e-3f;
+constexpr float kExpPoly2 = 8.3334519073e-3f;
+constexpr float kExpPoly3 = 4.1665795894e-2f;
+constexpr float kExpPoly4 = 1.6666665459e-1f;
+constexpr float kExpPoly5 = 5.0000001201e-1f;
+
+// kernels of the built-in cpp stage functions, the table is selected once by the instruction sets the cpu supports,
+// kernels of one element-wise operation allow input and output to be the same buffer
+struct StageKernels {
+  std::string isa = "scalar";
+  // index of the first max element
+  size_t (*argmax_fp32)(const float *input, size_t count) = nullptr;
+  // index of the first element greater than threshold, count if not found
+  size_t (*find_greater_fp32)(const float *input, size_t count, float threshold) = nullptr;
+  float (*reduce_max_fp32)(const float *input, size_t count) = nullptr;
+  // output[i] = exp(input[i] - max_value), return the sum of output
+  float (*exp_sum_fp32)(const float *input, float *output, size_t count, float max_value) = nullptr;
+  // output[i] = input[i] * scale
+  void (*scale_fp32)(const float *input, float *output, size_t count, float scale) = nullptr;
+  // output[i] = input[i] + bias
+  void (*add_fp32)(const float *input, float *output, size_t count, float bias) = nullptr;
+  // output[i] = input[i] * scale[i % period] + bias[i % period], period is a multiple of kStageKernelPeriodRepeat
+  void (*scale_bias_fp32)(const float *input, float *output, size_t count, const float *scale, const float *bias,
+                          size_t period) = nullptr;
+  void (*clip_fp32)(const float *input, float *output, size_t count, float min_value, float max_value) = nullptr;
+  // output[i] = input[i] > threshold ? 1 : 0
+  void (*threshold_fp32)(const float *input, float *output, size_t count, float threshold) = nullptr;
+  void (*cast_uint8_to_fp32)(const uint8_t *input, float *output, size_t count) = nullptr;
+  // float16 is stored as its bits in uint16_t
+  void (*cast_fp32_to_fp16)(const float *input, uint16_t *output, size_t count) = nullptr;
+  void (*cast_fp16_to_fp32)(const uint16_t *input, float *output, size_t count) = nullptr;
+  // transpose matrix [rows, cols] to [cols, rows], HWC to CHW is rows = H * W and cols = C
+  void (*transpose)(const uint8_t *input, uint8_t *output, size_t rows, size_t cols, size_t item_size) = nullptr;
+};
+
+// kernels of the best instruction set supported by the cpu
+const StageKernels &GetStageKernels();
+// portable reference kernels, also the fallback of kernels not vectorized for the instruction set
+const StageKernels &GetScalarStageKernels();
+
+#if defined(__x86_64__) || defined(__i386__)
+void InitAvx2StageKernels(StageKernels *kernels);
+void InitAvx512StageKernels(StageKernels *kernels);
+#elif defined(ENABLE_ARM64)
+void InitNeonStageKernels(StageKernels *kernels);
+#endif
+}  // namespace mindspore::serving
+
+#endif  // MINDSPORE_SERVING_WORKER_REGISTER_STAGE_KERNELS_H
@@ -0,0 +1,271 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(ENABLE_ARM64)
+#include <arm_neon.h>
+#include <algorithm>
+#include <cmath>
+#include "worker/register/stage_kernels.h"
+
+namespace mindspore::serving {
+namespace {
+constexpr size_t kNeonLanes = 4;
+constexpr size_t kRgbChannels = 3;
+
+float32x4_t NeonExp(float32x4_t x) {
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(kExpInputMin)), vdupq_n_f32(kExpInputMax));
+  float32x4_t fx = vrndmq_f32(vfmaq_f32(vdupq_n_f32(0.5f), x, vdupq_n_f32(kExpLog2e)));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kExpLn2Hi));
+  x = vfmsq_f32(x, fx, vdupq_n_f32(kExpLn2Lo));
+  float32x4_t y = vdupq_n_f32(kExpPoly0);
+  y = vfmaq_f32(vdupq_n_f32(kExpPoly1), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpPoly2), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpPoly3), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpPoly4), y, x);
+  y = vfmaq_f32(vdupq_n_f32(kExpPoly5), y, x);
+  y = vfmaq_f32(vaddq_f32(x, vdupq_n_f32(1.0f)), y, vmulq_f32(x, x));
+  int32x4_t pow2n = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(fx), vdupq_n_s32(127)), 23);
+  return vmulq_f32(y, vreinterpretq_f32_s32(pow2n));
+}
+
+size_t NeonArgmaxFp32(const float *input, size_t count) {
+  if (count < kNeonLanes || count > UINT32_MAX) {
+    return GetScalarStageKernels().argmax_fp32(input, count);
+  }
+  float32x4_t max_values = vld1q_f32(input);
+  const uint32_t first_indexes[kNeonLanes] = {0, 1, 2, 3};
+  uint32x4_t indexes = vld1q_u32(first_indexes);
+  uint32x4_t max_indexes = indexes;
+  const uint32x4_t step = vdupq_n_u32(kNeonLanes);
+  size_t i = kNeonLanes;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    indexes = vaddq_u32(indexes, step);
+    float32x4_t values = vld1q_f32(input + i);
+    uint32x4_t greater = vcgtq_f32(values, max_values);
+    max_values = vbslq_f32(greater, values, max_values);
+    max_indexes = vbslq_u32(greater, indexes, max_indexes);
+  }
+  float lane_values[kNeonLanes];
+  uint32_t lane_indexes[kNeonLanes];
+  vst1q_f32(lane_values, max_values);
+  vst1q_u32(lane_indexes, max_indexes);
+  auto max_value = lane_values[0];
+  size_t index = lane_indexes[0];
+  for (size_t lane = 1; lane < kNeonLanes; lane++) {
+    if (lane_values[lane] > max_value || (lane_values[lane] == max_value && lane_indexes[lane] < index)) {
+      max_value = lane_values[lane];
+      index = lane_indexes[lane];
+    }
+  }
+  for (; i < count; i++) {
+    if (input[i] > max_value) {
+      max_value = input[i];
+      index = i;
+    }
+  }
+  return index;
+}
+
+size_t NeonFindGreaterFp32(const float *input, size_t count, float threshold) {
+  const float32x4_t threshold_vec = vdupq_n_f32(threshold);
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    if (vmaxvq_u32(vcgtq_f32(vld1q_f32(input + i), threshold_vec)) != 0) {
+      break;
+    }
+  }
+  for (; i < count; i++) {
+    if (input[i] > threshold) {
+      return i;
+    }
+  }
+  return count;
+}
+
+float NeonReduceMaxFp32(const float *input, size_t count) {
+  float32x4_t max_values = vdupq_n_f32(-INFINITY);
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    max_values = vmaxq_f32(max_values, vld1q_f32(input + i));
+  }
+  auto max_value = vmaxvq_f32(max_values);
+  for (; i < count; i++) {
+    max_value = std::max(max_value, input[i]);
+  }
+  return max_value;
+}
+
+float NeonExpSumFp32(const float *input, float *output, size_t count, float max_value) {
+  const float32x4_t max_vec = vdupq_n_f32(max_value);
+  float32x4_t sum_vec = vdupq_n_f32(0.0f);
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    float32x4_t value = NeonExp(vsubq_f32(vld1q_f32(input + i), max_vec));
+    vst1q_f32(output + i, value);
+    sum_vec = vaddq_f32(sum_vec, value);
+  }
+  auto sum = vaddvq_f32(sum_vec);
+  for (; i < count; i++) {
+    output[i] = std::exp(input[i] - max_value);
+    sum += output[i];
+  }
+  return sum;
+}
+
+void NeonScaleFp32(const float *input, float *output, size_t count, float scale) {
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    vst1q_f32(output + i, vmulq_n_f32(vld1q_f32(input + i), scale));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] * scale;
+  }
+}
+
+void NeonAddFp32(const float *input, float *output, size_t count, float bias) {
+  const float32x4_t bias_vec = vdupq_n_f32(bias);
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    vst1q_f32(output + i, vaddq_f32(vld1q_f32(input + i), bias_vec));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] + bias;
+  }
+}
+
+void NeonScaleBiasFp32(const float *input, float *output, size_t count, const float *scale, const float *bias,
+                       size_t period) {
+  for (size_t i = 0; i < count; i += period) {
+    auto block = std::min(period, count - i);
+    size_t j = 0;
+    for (; j + kNeonLanes <= block; j += kNeonLanes) {
+      vst1q_f32(output + i + j, vfmaq_f32(vld1q_f32(bias + j), vld1q_f32(input + i + j), vld1q_f32(scale + j)));
+    }
+    for (; j < block; j++) {
+      output[i + j] = input[i + j] * scale[j] + bias[j];
+    }
+  }
+}
+
+void NeonClipFp32(const float *input, float *output, size_t count, float min_value, float max_value) {
+  const float32x4_t min_vec = vdupq_n_f32(min_value);
+  const float32x4_t max_vec = vdupq_n_f32(max_value);
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    vst1q_f32(output + i, vminq_f32(vmaxq_f32(vld1q_f32(input + i), min_vec), max_vec));
+  }
+  for (; i < count; i++) {
+    output[i] = std::min(std::max(input[i], min_value), max_value);
+  }
+}
+
+void NeonThresholdFp32(const float *input, float *output, size_t count, float threshold) {
+  const float32x4_t threshold_vec = vdupq_n_f32(threshold);
+  const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    uint32x4_t greater = vcgtq_f32(vld1q_f32(input + i), threshold_vec);
+    vst1q_f32(output + i, vreinterpretq_f32_u32(vandq_u32(greater, one)));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] > threshold ? 1.0f : 0.0f;
+  }
+}
+
+void NeonCastUint8ToFp32(const uint8_t *input, float *output, size_t count) {
+  constexpr size_t step = 8;
+  size_t i = 0;
+  for (; i + step <= count; i += step) {
+    uint16x8_t value = vmovl_u8(vld1_u8(input + i));
+    vst1q_f32(output + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(value))));
+    vst1q_f32(output + i + kNeonLanes, vcvtq_f32_u32(vmovl_u16(vget_high_u16(value))));
+  }
+  for (; i < count; i++) {
+    output[i] = static_cast<float>(input[i]);
+  }
+}
+
+void NeonCastFp32ToFp16(const float *input, uint16_t *output, size_t count) {
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    vst1_u16(output + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(input + i))));
+  }
+  GetScalarStageKernels().cast_fp32_to_fp16(input + i, output + i, count - i);
+}
+
+void NeonCastFp16ToFp32(const uint16_t *input, float *output, size_t count) {
+  size_t i = 0;
+  for (; i + kNeonLanes <= count; i += kNeonLanes) {
+    vst1q_f32(output + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(input + i))));
+  }
+  GetScalarStageKernels().cast_fp16_to_fp32(input + i, output + i, count - i);
+}
+
+void NeonTranspose(const uint8_t *input, uint8_t *output, size_t rows, size_t cols, size_t item_size) {
+  if (item_size != sizeof(float) || (cols != kRgbChannels && rows != kRgbChannels)) {
+    GetScalarStageKernels().transpose(input, output, rows, cols, item_size);
+    return;
+  }
+  auto src = reinterpret_cast<const float *>(input);
+  auto dst = reinterpret_cast<float *>(output);
+  size_t i = 0;
+  if (cols == kRgbChannels) {
+    for (; i + kNeonLanes <= rows; i += kNeonLanes) {
+      float32x4x3_t value = vld3q_f32(src + i * kRgbChannels);
+      vst1q_f32(dst + i, value.val[0]);
+      vst1q_f32(dst + rows + i, value.val[1]);
+      vst1q_f32(dst + rows * 2 + i, value.val[2]);
+    }
+    for (; i < rows; i++) {
+      for (size_t c = 0; c < kRgbChannels; c++) {
+        dst[c * rows + i] = src[i * kRgbChannels + c];
+      }
+    }
+    return;
+  }
+  for (; i + kNeonLanes <= cols; i += kNeonLanes) {
+    float32x4x3_t value;
+    value.val[0] = vld1q_f32(src + i);
+    value.val[1] = vld1q_f32(src + cols + i);
+    value.val[2] = vld1q_f32(src + cols * 2 + i);
+    vst3q_f32(dst + i * kRgbChannels, value);
+  }
+  for (; i < cols; i++) {
+    for (size_t c = 0; c < kRgbChannels; c++) {
+      dst[i * kRgbChannels + c] = src[c * cols + i];
+    }
+  }
+}
+}  // namespace
+
+void InitNeonStageKernels(StageKernels *kernels) {
+  kernels->isa = "neon";
+  kernels->argmax_fp32 = NeonArgmaxFp32;
+  kernels->find_greater_fp32 = NeonFindGreaterFp32;
+  kernels->reduce_max_fp32 = NeonReduceMaxFp32;
+  kernels->exp_sum_fp32 = NeonExpSumFp32;
+  kernels->scale_fp32 = NeonScaleFp32;
+  kernels->add_fp32 = NeonAddFp32;
+  kernels->scale_bias_fp32 = NeonScaleBiasFp32;
+  kernels->clip_fp32 = NeonClipFp32;
+  kernels->threshold_fp32 = NeonThresholdFp32;
+  kernels->cast_uint8_to_fp32 = NeonCastUint8ToFp32;
+  kernels->cast_fp32_to_fp16 = NeonCastFp32ToFp16;
+  kernels->cast_fp16_to_fp32 = NeonCastFp16ToFp32;
+  kernels->transpose = NeonTranspose;
+}
+}  // namespace mindspore::serving
+#endif
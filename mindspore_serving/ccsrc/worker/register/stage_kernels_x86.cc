@@ -0,0 +1,502 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include "worker/register/stage_kernels.h"
+
+// the library is built without -mavx2, kernels are compiled for the instruction set by the target attribute and
+// only called after the cpu is checked in SelectStageKernels
+#define AVX2_TARGET __attribute__((target("avx2,fma,f16c")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx2,fma,f16c")))
+
+namespace mindspore::serving {
+namespace {
+constexpr size_t kAvx2Lanes = 8;
+constexpr size_t kAvx512Lanes = 16;
+constexpr size_t kRgbChannels = 3;
+
+AVX2_TARGET float Avx2HorizontalMax(__m256 value) {
+  __m128 result = _mm_max_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+  result = _mm_max_ps(result, _mm_movehl_ps(result, result));
+  result = _mm_max_ss(result, _mm_shuffle_ps(result, result, 1));
+  return _mm_cvtss_f32(result);
+}
+
+AVX2_TARGET float Avx2HorizontalSum(__m256 value) {
+  __m128 result = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+  result = _mm_add_ps(result, _mm_movehl_ps(result, result));
+  result = _mm_add_ss(result, _mm_shuffle_ps(result, result, 1));
+  return _mm_cvtss_f32(result);
+}
+
+AVX2_TARGET __m256 Avx2Exp(__m256 x) {
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(kExpInputMin)), _mm256_set1_ps(kExpInputMax));
+  __m256 fx = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(kExpLog2e), _mm256_set1_ps(0.5f)));
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpLn2Hi), x);
+  x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(kExpLn2Lo), x);
+  __m256 y = _mm256_set1_ps(kExpPoly0);
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpPoly1));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpPoly2));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpPoly3));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpPoly4));
+  y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpPoly5));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+  __m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127)), 23);
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+// select the first index of the max value from the lanes, and continue with the elements not in lanes
+size_t ReduceArgmaxLanes(const float *lane_values, const int32_t *lane_indexes, size_t lanes, const float *input,
+                         size_t begin, size_t count) {
+  auto max_value = lane_values[0];
+  auto index = static_cast<size_t>(lane_indexes[0]);
+  for (size_t i = 1; i < lanes; i++) {
+    auto lane_index = static_cast<size_t>(lane_indexes[i]);
+    if (lane_values[i] > max_value || (lane_values[i] == max_value && lane_index < index)) {
+      max_value = lane_values[i];
+      index = lane_index;
+    }
+  }
+  for (size_t i = begin; i < count; i++) {
+    if (input[i] > max_value) {
+      max_value = input[i];
+      index = i;
+    }
+  }
+  return index;
+}
+
+AVX2_TARGET size_t Avx2ArgmaxFp32(const float *input, size_t count) {
+  if (count < kAvx2Lanes || count > INT32_MAX) {
+    return GetScalarStageKernels().argmax_fp32(input, count);
+  }
+  __m256 max_values = _mm256_loadu_ps(input);
+  __m256i indexes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  __m256i max_indexes = indexes;
+  const __m256i step = _mm256_set1_epi32(kAvx2Lanes);
+  size_t i = kAvx2Lanes;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    indexes = _mm256_add_epi32(indexes, step);
+    __m256 values = _mm256_loadu_ps(input + i);
+    __m256 greater = _mm256_cmp_ps(values, max_values, _CMP_GT_OQ);
+    max_values = _mm256_blendv_ps(max_values, values, greater);
+    max_indexes = _mm256_castps_si256(
+      _mm256_blendv_ps(_mm256_castsi256_ps(max_indexes), _mm256_castsi256_ps(indexes), greater));
+  }
+  float lane_values[kAvx2Lanes];
+  int32_t lane_indexes[kAvx2Lanes];
+  _mm256_storeu_ps(lane_values, max_values);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lane_indexes), max_indexes);
+  return ReduceArgmaxLanes(lane_values, lane_indexes, kAvx2Lanes, input, i, count);
+}
+
+AVX2_TARGET size_t Avx2FindGreaterFp32(const float *input, size_t count, float threshold) {
+  const __m256 threshold_vec = _mm256_set1_ps(threshold);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    auto mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(input + i), threshold_vec, _CMP_GT_OQ));
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  for (; i < count; i++) {
+    if (input[i] > threshold) {
+      return i;
+    }
+  }
+  return count;
+}
+
+AVX2_TARGET float Avx2ReduceMaxFp32(const float *input, size_t count) {
+  __m256 max_values = _mm256_set1_ps(-INFINITY);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    max_values = _mm256_max_ps(max_values, _mm256_loadu_ps(input + i));
+  }
+  auto max_value = Avx2HorizontalMax(max_values);
+  for (; i < count; i++) {
+    max_value = std::max(max_value, input[i]);
+  }
+  return max_value;
+}
+
+AVX2_TARGET float Avx2ExpSumFp32(const float *input, float *output, size_t count, float max_value) {
+  const __m256 max_vec = _mm256_set1_ps(max_value);
+  __m256 sum_vec = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m256 value = Avx2Exp(_mm256_sub_ps(_mm256_loadu_ps(input + i), max_vec));
+    _mm256_storeu_ps(output + i, value);
+    sum_vec = _mm256_add_ps(sum_vec, value);
+  }
+  auto sum = Avx2HorizontalSum(sum_vec);
+  for (; i < count; i++) {
+    output[i] = std::exp(input[i] - max_value);
+    sum += output[i];
+  }
+  return sum;
+}
+
+AVX2_TARGET void Avx2ScaleFp32(const float *input, float *output, size_t count, float scale) {
+  const __m256 scale_vec = _mm256_set1_ps(scale);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), scale_vec));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] * scale;
+  }
+}
+
+AVX2_TARGET void Avx2AddFp32(const float *input, float *output, size_t count, float bias) {
+  const __m256 bias_vec = _mm256_set1_ps(bias);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    _mm256_storeu_ps(output + i, _mm256_add_ps(_mm256_loadu_ps(input + i), bias_vec));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] + bias;
+  }
+}
+
+AVX2_TARGET void Avx2ScaleBiasFp32(const float *input, float *output, size_t count, const float *scale,
+                                   const float *bias, size_t period) {
+  for (size_t i = 0; i < count; i += period) {
+    auto block = std::min(period, count - i);
+    size_t j = 0;
+    for (; j + kAvx2Lanes <= block; j += kAvx2Lanes) {
+      __m256 value = _mm256_fmadd_ps(_mm256_loadu_ps(input + i + j), _mm256_loadu_ps(scale + j),
+                                     _mm256_loadu_ps(bias + j));
+      _mm256_storeu_ps(output + i + j, value);
+    }
+    for (; j < block; j++) {
+      output[i + j] = input[i + j] * scale[j] + bias[j];
+    }
+  }
+}
+
+AVX2_TARGET void Avx2ClipFp32(const float *input, float *output, size_t count, float min_value, float max_value) {
+  const __m256 min_vec = _mm256_set1_ps(min_value);
+  const __m256 max_vec = _mm256_set1_ps(max_value);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    _mm256_storeu_ps(output + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(input + i), min_vec), max_vec));
+  }
+  for (; i < count; i++) {
+    output[i] = std::min(std::max(input[i], min_value), max_value);
+  }
+}
+
+AVX2_TARGET void Avx2ThresholdFp32(const float *input, float *output, size_t count, float threshold) {
+  const __m256 threshold_vec = _mm256_set1_ps(threshold);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m256 greater = _mm256_cmp_ps(_mm256_loadu_ps(input + i), threshold_vec, _CMP_GT_OQ);
+    _mm256_storeu_ps(output + i, _mm256_and_ps(greater, one));
+  }
+  for (; i < count; i++) {
+    output[i] = input[i] > threshold ? 1.0f : 0.0f;
+  }
+}
+
+AVX2_TARGET void Avx2CastUint8ToFp32(const uint8_t *input, float *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m128i value = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i));
+    _mm256_storeu_ps(output + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(value)));
+  }
+  for (; i < count; i++) {
+    output[i] = static_cast<float>(input[i]);
+  }
+}
+
+AVX2_TARGET void Avx2CastFp32ToFp16(const float *input, uint16_t *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m128i value = _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), value);
+  }
+  GetScalarStageKernels().cast_fp32_to_fp16(input + i, output + i, count - i);
+}
+
+AVX2_TARGET void Avx2CastFp16ToFp32(const uint16_t *input, float *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= count; i += kAvx2Lanes) {
+    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+    _mm256_storeu_ps(output + i, _mm256_cvtph_ps(value));
+  }
+  GetScalarStageKernels().cast_fp16_to_fp32(input + i, output + i, count - i);
+}
+
+// [rows, 3] to [3, rows]: every 8 rows are loaded as 3 vectors, the lanes of one channel come from different
+// positions of the 3 vectors, they are blended into one vector and then permuted into order
+AVX2_TARGET void Avx2DeinterleaveRgbFp32(const float *input, float *output, size_t rows) {
+  const __m256i r_order = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+  const __m256i g_order = _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6);
+  const __m256i b_order = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= rows; i += kAvx2Lanes) {
+    auto src = input + i * kRgbChannels;
+    __m256 v0 = _mm256_loadu_ps(src);
+    __m256 v1 = _mm256_loadu_ps(src + kAvx2Lanes);
+    __m256 v2 = _mm256_loadu_ps(src + kAvx2Lanes * 2);
+    __m256 r = _mm256_blend_ps(_mm256_blend_ps(v0, v1, 0x92), v2, 0x24);
+    __m256 g = _mm256_blend_ps(_mm256_blend_ps(v0, v1, 0x24), v2, 0x49);
+    __m256 b = _mm256_blend_ps(_mm256_blend_ps(v0, v1, 0x49), v2, 0x92);
+    _mm256_storeu_ps(output + i, _mm256_permutevar8x32_ps(r, r_order));
+    _mm256_storeu_ps(output + rows + i, _mm256_permutevar8x32_ps(g, g_order));
+    _mm256_storeu_ps(output + rows * 2 + i, _mm256_permutevar8x32_ps(b, b_order));
+  }
+  for (; i < rows; i++) {
+    for (size_t c = 0; c < kRgbChannels; c++) {
+      output[c * rows + i] = input[i * kRgbChannels + c];
+    }
+  }
+}
+
+// [3, cols] to [cols, 3], the reverse of Avx2DeinterleaveRgbFp32
+AVX2_TARGET void Avx2InterleaveRgbFp32(const float *input, float *output, size_t cols) {
+  const __m256i r_order = _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5);
+  const __m256i g_order = _mm256_setr_epi32(5, 0, 3, 6, 1, 4, 7, 2);
+  const __m256i b_order = _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7);
+  size_t i = 0;
+  for (; i + kAvx2Lanes <= cols; i += kAvx2Lanes) {
+    __m256 r = _mm256_permutevar8x32_ps(_mm256_loadu_ps(input + i), r_order);
+    __m256 g = _mm256_permutevar8x32_ps(_mm256_loadu_ps(input + cols + i), g_order);
+    __m256 b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(input + cols * 2 + i), b_order);
+    auto dst = output + i * kRgbChannels;
+    _mm256_storeu_ps(dst, _mm256_blend_ps(_mm256_blend_ps(r, g, 0x92), b, 0x24));
+    _mm256_storeu_ps(dst + kAvx2Lanes, _mm256_blend_ps(_mm256_blend_ps(r, g, 0x24), b, 0x49));
+    _mm256_storeu_ps(dst + kAvx2Lanes * 2, _mm256_blend_ps(_mm256_blend_ps(r, g, 0x49), b, 0x92));
+  }
+  for (; i < cols; i++) {
+    for (size_t c = 0; c < kRgbChannels; c++) {
+      output[i * kRgbChannels + c] = input[c * cols + i];
+    }
+  }
+}
+
+AVX2_TARGET void Avx2Transpose(const uint8_t *input, uint8_t *output, size_t rows, size_t cols, size_t item_size) {
+  if (item_size == sizeof(float) && cols == kRgbChannels) {
+    Avx2DeinterleaveRgbFp32(reinterpret_cast<const float *>(input), reinterpret_cast<float *>(output), rows);
+    return;
+  }
+  if (item_size == sizeof(float) && rows == kRgbChannels) {
+    Avx2InterleaveRgbFp32(reinterpret_cast<const float *>(input), reinterpret_cast<float *>(output), cols);
+    return;
+  }
+  GetScalarStageKernels().transpose(input, output, rows, cols, item_size);
+}
+
+// the _mm512_undefined_* used inside gcc avx512 intrinsics is reported as uninitialized when inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+AVX512_TARGET __mmask16 Avx512TailMask(size_t remain) { return static_cast<__mmask16>((1u << remain) - 1); }
+
+AVX512_TARGET __m512 Avx512Exp(__m512 x) {
+  x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(kExpInputMin)), _mm512_set1_ps(kExpInputMax));
+  __m512 fx = _mm512_fmadd_ps(x, _mm512_set1_ps(kExpLog2e), _mm512_set1_ps(0.5f));
+  fx = _mm512_roundscale_ps(fx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpLn2Hi), x);
+  x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(kExpLn2Lo), x);
+  __m512 y = _mm512_set1_ps(kExpPoly0);
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpPoly1));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpPoly2));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpPoly3));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpPoly4));
+  y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpPoly5));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, _mm512_set1_ps(1.0f)));
+  __m512i pow2n = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvttps_epi32(fx), _mm512_set1_epi32(127)), 23);
+  return _mm512_mul_ps(y, _mm512_castsi512_ps(pow2n));
+}
+
+AVX512_TARGET size_t Avx512ArgmaxFp32(const float *input, size_t count) {
+  if (count < kAvx512Lanes || count > INT32_MAX) {
+    return Avx2ArgmaxFp32(input, count);
+  }
+  __m512 max_values = _mm512_loadu_ps(input);
+  __m512i indexes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m512i max_indexes = indexes;
+  const __m512i step = _mm512_set1_epi32(kAvx512Lanes);
+  size_t i = kAvx512Lanes;
+  for (; i + kAvx512Lanes <= count; i += kAvx512Lanes) {
+    indexes = _mm512_add_epi32(indexes, step);
+    __m512 values = _mm512_loadu_ps(input + i);
+    __mmask16 greater = _mm512_cmp_ps_mask(values, max_values, _CMP_GT_OQ);
+    max_values = _mm512_mask_blend_ps(greater, max_values, values);
+    max_indexes = _mm512_mask_blend_epi32(greater, max_indexes, indexes);
+  }
+  float lane_values[kAvx512Lanes];
+  int32_t lane_indexes[kAvx512Lanes];
+  _mm512_storeu_ps(lane_values, max_values);
+  _mm512_storeu_si512(lane_indexes, max_indexes);
+  return ReduceArgmaxLanes(lane_values, lane_indexes, kAvx512Lanes, input, i, count);
+}
+
+AVX512_TARGET size_t Avx512FindGreaterFp32(const float *input, size_t count, float threshold) {
+  const __m512 threshold_vec = _mm512_set1_ps(threshold);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto load_mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    __m512 value = _mm512_maskz_loadu_ps(load_mask, input + i);
+    auto mask = _mm512_mask_cmp_ps_mask(load_mask, value, threshold_vec, _CMP_GT_OQ);
+    if (mask != 0) {
+      return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+  }
+  return count;
+}
+
+AVX512_TARGET float Avx512ReduceMaxFp32(const float *input, size_t count) {
+  __m512 max_values = _mm512_set1_ps(-INFINITY);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    max_values = _mm512_mask_max_ps(max_values, mask, max_values, _mm512_maskz_loadu_ps(mask, input + i));
+  }
+  return _mm512_reduce_max_ps(max_values);
+}
+
+AVX512_TARGET float Avx512ExpSumFp32(const float *input, float *output, size_t count, float max_value) {
+  const __m512 max_vec = _mm512_set1_ps(max_value);
+  __m512 sum_vec = _mm512_setzero_ps();
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    __m512 value = Avx512Exp(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, input + i), max_vec));
+    _mm512_mask_storeu_ps(output + i, mask, value);
+    sum_vec = _mm512_mask_add_ps(sum_vec, mask, sum_vec, value);
+  }
+  return _mm512_reduce_add_ps(sum_vec);
+}
+
+AVX512_TARGET void Avx512ScaleFp32(const float *input, float *output, size_t count, float scale) {
+  const __m512 scale_vec = _mm512_set1_ps(scale);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    _mm512_mask_storeu_ps(output + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, input + i), scale_vec));
+  }
+}
+
+AVX512_TARGET void Avx512AddFp32(const float *input, float *output, size_t count, float bias) {
+  const __m512 bias_vec = _mm512_set1_ps(bias);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    _mm512_mask_storeu_ps(output + i, mask, _mm512_add_ps(_mm512_maskz_loadu_ps(mask, input + i), bias_vec));
+  }
+}
+
+AVX512_TARGET void Avx512ScaleBiasFp32(const float *input, float *output, size_t count, const float *scale,
+                                       const float *bias, size_t period) {
+  for (size_t i = 0; i < count; i += period) {
+    auto block = std::min(period, count - i);
+    for (size_t j = 0; j < block; j += kAvx512Lanes) {
+      auto mask = Avx512TailMask(std::min(kAvx512Lanes, block - j));
+      __m512 value = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, input + i + j), _mm512_loadu_ps(scale + j),
+                                     _mm512_loadu_ps(bias + j));
+      _mm512_mask_storeu_ps(output + i + j, mask, value);
+    }
+  }
+}
+
+AVX512_TARGET void Avx512ClipFp32(const float *input, float *output, size_t count, float min_value,
+                                  float max_value) {
+  const __m512 min_vec = _mm512_set1_ps(min_value);
+  const __m512 max_vec = _mm512_set1_ps(max_value);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    __m512 value = _mm512_min_ps(_mm512_max_ps(_mm512_maskz_loadu_ps(mask, input + i), min_vec), max_vec);
+    _mm512_mask_storeu_ps(output + i, mask, value);
+  }
+}
+
+AVX512_TARGET void Avx512ThresholdFp32(const float *input, float *output, size_t count, float threshold) {
+  const __m512 threshold_vec = _mm512_set1_ps(threshold);
+  const __m512 one = _mm512_set1_ps(1.0f);
+  for (size_t i = 0; i < count; i += kAvx512Lanes) {
+    auto mask = Avx512TailMask(std::min(kAvx512Lanes, count - i));
+    auto greater = _mm512_cmp_ps_mask(_mm512_maskz_loadu_ps(mask, input + i), threshold_vec, _CMP_GT_OQ);
+    _mm512_mask_storeu_ps(output + i, mask, _mm512_maskz_mov_ps(greater, one));
+  }
+}
+
+AVX512_TARGET void Avx512CastUint8ToFp32(const uint8_t *input, float *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx512Lanes <= count; i += kAvx512Lanes) {
+    __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+    _mm512_storeu_ps(output + i, _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(value)));
+  }
+  Avx2CastUint8ToFp32(input + i, output + i, count - i);
+}
+
+AVX512_TARGET void Avx512CastFp32ToFp16(const float *input, uint16_t *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx512Lanes <= count; i += kAvx512Lanes) {
+    __m256i value = _mm512_cvtps_ph(_mm512_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), value);
+  }
+  Avx2CastFp32ToFp16(input + i, output + i, count - i);
+}
+
+AVX512_TARGET void Avx512CastFp16ToFp32(const uint16_t *input, float *output, size_t count) {
+  size_t i = 0;
+  for (; i + kAvx512Lanes <= count; i += kAvx512Lanes) {
+    __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+    _mm512_storeu_ps(output + i, _mm512_cvtph_ps(value));
+  }
+  Avx2CastFp16ToFp32(input + i, output + i, count - i);
+}
+#pragma GCC diagnostic pop
+}  // namespace
+
+void InitAvx2StageKernels(StageKernels *kernels) {
+  kernels->isa = "avx2";
+  kernels->argmax_fp32 = Avx2ArgmaxFp32;
+  kernels->find_greater_fp32 = Avx2FindGreaterFp32;
+  kernels->reduce_max_fp32 = Avx2ReduceMaxFp32;
+  kernels->exp_sum_fp32 = Avx2ExpSumFp32;
+  kernels->scale_fp32 = Avx2ScaleFp32;
+  kernels->add_fp32 = Avx2AddFp32;
+  kernels->scale_bias_fp32 = Avx2ScaleBiasFp32;
+  kernels->clip_fp32 = Avx2ClipFp32;
+  kernels->threshold_fp32 = Avx2ThresholdFp32;
+  kernels->cast_uint8_to_fp32 = Avx2CastUint8ToFp32;
+  kernels->cast_fp32_to_fp16 = Avx2CastFp32ToFp16;
+  kernels->cast_fp16_to_fp32 = Avx2CastFp16ToFp32;
+  kernels->transpose = Avx2Transpose;
+}
+
+// transpose keeps the avx2 kernel, the 3 channels shuffle gains nothing from wider vectors
+void InitAvx512StageKernels(StageKernels *kernels) {
+  kernels->isa = "avx512";
+  kernels->argmax_fp32 = Avx512ArgmaxFp32;
+  kernels->find_greater_fp32 = Avx512FindGreaterFp32;
+  kernels->reduce_max_fp32 = Avx512ReduceMaxFp32;
+  kernels->exp_sum_fp32 = Avx512ExpSumFp32;
+  kernels->scale_fp32 = Avx512ScaleFp32;
+  kernels->add_fp32 = Avx512AddFp32;
+  kernels->scale_bias_fp32 = Avx512ScaleBiasFp32;
+  kernels->clip_fp32 = Avx512ClipFp32;
+  kernels->threshold_fp32 = Avx512ThresholdFp32;
+  kernels->cast_uint8_to_fp32 = Avx512CastUint8ToFp32;
+  kernels->cast_fp32_to_fp16 = Avx512CastFp32ToFp16;
+  kernels->cast_fp16_to_fp32 = Avx512CastFp16ToFp32;
+}
+}  // namespace mindspore::serving
+#endif
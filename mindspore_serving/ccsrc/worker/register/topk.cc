@@ -0,0 +1,126 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+// the k largest values and their indexes of the last dimension, sorted from the largest,
+// inputs: x float32, k int32 or int64 scalar; outputs: values float32, indexes int64
+class TopkStageFunc : public CppStageFunctionBase {
+ public:
+  static void TopkImp(const StageKernels &kernels, const float *input, size_t count, size_t k, float *values,
+                      int64_t *indexes) {
+    // the element with larger value, or the same value and smaller index, is better
+    auto better = [input](size_t left, size_t right) {
+      return input[left] > input[right] || (input[left] == input[right] && left < right);
+    };
+    // heap of the current top k, its front is the worst one, later elements should be greater than it to enter,
+    // most of the elements are skipped by the vectorized find_greater_fp32 when k is small
+    std::vector<size_t> heap(k);
+    std::iota(heap.begin(), heap.end(), 0);
+    std::make_heap(heap.begin(), heap.end(), better);
+    size_t index = k;
+    while (index < count) {
+      index += kernels.find_greater_fp32(input + index, count - index, input[heap.front()]);
+      if (index >= count) {
+        break;
+      }
+      std::pop_heap(heap.begin(), heap.end(), better);
+      heap.back() = index;
+      std::push_heap(heap.begin(), heap.end(), better);
+      index++;
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+    for (size_t i = 0; i < k; i++) {
+      values[i] = input[heap[i]];
+      indexes[i] = static_cast<int64_t>(heap[i]);
+    }
+  }
+
+  static Status GetK(const TensorBasePtr &tensor, int64_t *k) {
+    if (tensor->element_cnt() != 1) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Topk input k should be a scalar";
+    }
+    if (tensor->data_type() == kMSI_Int32) {
+      *k = *reinterpret_cast<const int32_t *>(tensor->data());
+    } else if (tensor->data_type() == kMSI_Int64) {
+      *k = *reinterpret_cast<const int64_t *>(tensor->data());
+    } else {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Topk input k only support int32 or int64, given data type " << tensor->data_type();
+    }
+    return SUCCESS;
+  }
+
+  Status Call(const std::string &, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    if (input_x->data_type() != kMSI_Float32) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Topk only support float32 input, given data type " << input_x->data_type();
+    }
+    auto shape = input_x->shape();
+    if (shape.empty()) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Topk input x cannot be a scalar";
+    }
+    int64_t k = 0;
+    auto status = GetK(input[1], &k);
+    if (status != SUCCESS) {
+      return status;
+    }
+    if (k < 0 || k > shape.back()) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
+             << "Topk input k " << k << " should be in range [0, " << shape.back() << "]";
+    }
+    auto top_k = static_cast<size_t>(k);
+    auto axis_size = static_cast<size_t>(shape.back());
+    auto rows = axis_size == 0 ? 0 : input_x->element_cnt() / axis_size;
+    shape.back() = k;
+    auto values_tensor = std::make_shared<Tensor>();
+    values_tensor->set_data_type(kMSI_Float32);
+    (void)values_tensor->resize_data(rows * top_k * sizeof(float));
+    values_tensor->set_shape(shape);
+    auto indexes_tensor = std::make_shared<Tensor>();
+    indexes_tensor->set_data_type(kMSI_Int64);
+    (void)indexes_tensor->resize_data(rows * top_k * sizeof(int64_t));
+    indexes_tensor->set_shape(shape);
+    output->push_back(values_tensor);
+    output->push_back(indexes_tensor);
+    if (rows == 0 || top_k == 0) {
+      return SUCCESS;
+    }
+    auto x_data = reinterpret_cast<const float *>(input_x->data());
+    auto values = reinterpret_cast<float *>(values_tensor->mutable_data());
+    auto indexes = reinterpret_cast<int64_t *>(indexes_tensor->mutable_data());
+    auto &kernels = GetStageKernels();
+    for (size_t row = 0; row < rows; row++) {
+      TopkImp(kernels, x_data + row * axis_size, axis_size, top_k, values + row * top_k,
+              indexes + row * top_k);
+    }
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 2; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 2; }
+};
+
+REGISTER_STAGE_FUNCTION(TopkStageFunc, "topk_cpp")
+}  // namespace mindspore::serving
@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+#include "mindspore_serving/ccsrc/common/tensor.h"
+
+namespace mindspore::serving {
+// transpose image of number type from HWC to CHW
+class Hwc2ChwStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) override {
+    MSI_EXCEPTION_IF_NULL(output);
+    auto input_x = input[0];
+    auto shape = input_x->shape();
+    constexpr size_t image_dims = 3;
+    if (shape.size() != image_dims) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << func_name << " input should be 3-D, given shape " << shape;
+    }
+    auto data_type = input_x->data_type();
+    if (data_type == kMSI_Unknown || data_type == kMSI_String || data_type == kMSI_Bytes) {
+      return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << func_name << " not support data type " << data_type;
+    }
+    size_t rows = 0;
+    size_t cols = 0;
+    std::vector<int64_t> out_shape;
+    if (chw_to_hwc_) {
+      rows = static_cast<size_t>(shape[0]);
+      cols = static_cast<size_t>(shape[1] * shape[2]);
+      out_shape = {shape[1], shape[2], shape[0]};
+    } else {
+      rows = static_cast<size_t>(shape[0] * shape[1]);
+      cols = static_cast<size_t>(shape[2]);
+      out_shape = {shape[2], shape[0], shape[1]};
+    }
+    auto out_tensor = std::make_shared<Tensor>();
+    out_tensor->set_data_type(data_type);
+    (void)out_tensor->resize_data(input_x->data_size());
+    out_tensor->set_shape(out_shape);
+    output->push_back(out_tensor);
+    if (input_x->data_size() == 0) {
+      return SUCCESS;
+    }
+    GetStageKernels().transpose(input_x->data(), out_tensor->mutable_data(), rows, cols, input_x->itemsize());
+    return SUCCESS;
+  }
+
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+
+ protected:
+  bool chw_to_hwc_ = false;
+};
+
+// transpose image of number type from CHW to HWC
+class Chw2HwcStageFunc : public Hwc2ChwStageFunc {
+ public:
+  Chw2HwcStageFunc() { chw_to_hwc_ = true; }
+};
+
+REGISTER_STAGE_FUNCTION(Hwc2ChwStageFunc, "hwc2chw_cpp")
+REGISTER_STAGE_FUNCTION(Chw2HwcStageFunc, "chw2hwc_cpp")
+}  // namespace mindspore::serving
@@ -36,6 +36,19 @@ Status ServableRegister::RegisterMethod(const MethodSignature &method) {
     }
   }
   servable_signatures_.methods.push_back(method);
+  auto &method_def = servable_signatures_.methods.back();
+  method_def.BuildStageGraph();
+  for (auto &item : method_def.stage_map) {
+    auto &stage = item.second;
+    if (method_def.parallel_stages) {
+      MSI_LOG_INFO << "Method " << method_def.method_name << " stage " << stage.stage_index << " " << stage.tag
+                   << " depends on stages " << stage.depend_stages << ", run alone: " << stage.run_alone;
+    }
+    if (stage.run_inline) {
+      MSI_LOG_INFO << "Method " << method_def.method_name << " stage " << stage.stage_index << " " << stage.tag
+                   << " runs inline after stage " << stage.stage_index - 1;
+    }
+  }
   return SUCCESS;
 }
 
@@ -57,6 +70,9 @@ Status ServableRegister::DeclareModel(ModelMeta model) {
     for (auto &file_item : model_item.local_meta.model_files) {
       (void)cur_model_files.emplace(file_item);
     }
+    for (auto &file_item : model_item.local_meta.batch_bucket_files) {
+      (void)cur_model_files.emplace(file_item);
+    }
   }
   for (auto &file : local_meta.model_files) {
     if (file.empty()) {
@@ -68,6 +84,21 @@ Status ServableRegister::DeclareModel(ModelMeta model) {
                                             << file << "' has already been used";
     }
   }
+  if (!local_meta.batch_bucket_files.empty() && local_meta.model_files.size() != 1) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Declare model " << local_meta.model_files
+                                          << " failed, batch bucket files are only supported by model of one file";
+  }
+  for (auto &file : local_meta.batch_bucket_files) {
+    if (file.empty()) {
+      return INFER_STATUS_LOG_ERROR(FAILED)
+             << "Declare model " << local_meta.model_files << " failed, batch bucket file cannot be empty";
+    }
+    if (cur_model_files.count(file) > 0 || file == local_meta.model_files[0]) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "Declare model " << local_meta.model_files
+                                            << " failed, batch bucket file '" << file << "' has already been used";
+    }
+    (void)cur_model_files.emplace(file);
+  }
   if (local_meta.model_format == ModelType::kUnknownType) {
     return INFER_STATUS_LOG_ERROR(FAILED)
            << "Declare model " << local_meta.model_files << " failed, model_format is not inited";
@@ -108,6 +139,15 @@ Status ServableRegister::DeclareDistributedModel(ModelMeta model) {
   return SUCCESS;
 }
 
+Status ServableRegister::SetCppStageThreadNum(uint32_t thread_num) {
+  if (thread_num == 0) {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "The thread number of C++ stage functions cannot be 0";
+  }
+  MSI_LOG_INFO << "Set the thread number of C++ stage functions to " << thread_num;
+  servable_signatures_.cpp_stage_thread_num = thread_num;
+  return SUCCESS;
+}
+
 Status ServableRegister::RegisterInputOutputInfo(const std::string &model_key, size_t inputs_count,
                                                  size_t outputs_count, uint64_t subgraph) {
   MSI_LOG_INFO << "Declare model " << model_key << " subgraph " << subgraph << " inputs count " << inputs_count
@@ -41,6 +41,8 @@ class MS_API ServableRegister {
   // declare_model
   Status DeclareModel(ModelMeta model);
   Status DeclareDistributedModel(ModelMeta model);
+  // set_cpp_stage_thread_num
+  Status SetCppStageThreadNum(uint32_t thread_num);
 
   static std::string GetCallModelMethodName(const std::string &model_key, uint64_t subgraph);
 
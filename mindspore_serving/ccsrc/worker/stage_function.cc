@@ -18,6 +18,31 @@
 #include <utility>
 
 namespace mindspore::serving {
+Status CppStageFunctionBase::CallBatch(const std::string &func_name, const std::vector<InstanceData> &inputs,
+                                       std::vector<ResultInstance> *outputs) {
+  MSI_EXCEPTION_IF_NULL(outputs);
+  outputs->resize(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    auto &result = (*outputs)[i];
+    Status status;
+    try {
+      status = Call(func_name, inputs[i], &result.data);
+    } catch (const std::bad_alloc &ex) {
+      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: malloc memory failed";
+    } catch (const std::runtime_error &ex) {
+      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: runtime error occurred: " << ex.what();
+    } catch (const std::exception &ex) {
+      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred: " << ex.what();
+    } catch (...) {
+      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred";
+    }
+    if (status != SUCCESS) {
+      result.error_msg = status;
+    }
+  }
+  return SUCCESS;
+}
+
 bool CppStageFunctionStorage::Register(const std::string &function_name,
                                        std::shared_ptr<CppStageFunctionBase> function) {
   if (function_map_.find(function_name) != function_map_.end()) {
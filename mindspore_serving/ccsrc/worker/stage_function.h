@@ -32,6 +32,10 @@ class CppStageFunctionBase : public std::enable_shared_from_this<CppStageFunctio
   virtual ~CppStageFunctionBase() = default;
 
   virtual Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) = 0;
+  // call once for a batch of instances, vectorized functions can override it to process the whole batch at once,
+  // the default calls Call for each instance, failure of one instance is set to its error_msg
+  virtual Status CallBatch(const std::string &func_name, const std::vector<InstanceData> &inputs,
+                           std::vector<ResultInstance> *outputs);
   virtual size_t GetInputsCount(const std::string &func_name) const = 0;
   virtual size_t GetOutputsCount(const std::string &func_name) const = 0;
 };
@@ -15,6 +15,8 @@
  */
 
 #include "worker/task_queue.h"
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <unordered_map>
 #include "worker/stage_function.h"
@@ -30,16 +32,21 @@ void TaskQueue::Start(const std::string &que_name, const std::vector<TaskInfo> &
   }
   que_name_ = que_name;
   task_callback_ = callback;
-  methods_queue_.group_que_map.clear();
-  methods_queue_.groups_que_instances_count = 0;
+  methods_queue_ = TaskQueueGroups();
   for (auto &info : task_infos) {
     if (info.batch_size == 0) {
       MSI_LOG_EXCEPTION << "Invalid batch size 0, queue name: " << que_name;
     }
-    auto &method_queue = methods_queue_.group_que_map[info.group_name];
+    auto group_it = methods_queue_.group_index_map.find(info.group_name);
+    if (group_it == methods_queue_.group_index_map.end()) {
+      group_it = methods_queue_.group_index_map.emplace(info.group_name, methods_queue_.group_que_list.size()).first;
+      methods_queue_.group_que_list.emplace_back();
+    }
+    auto &method_queue = methods_queue_.group_que_list[group_it->second];
     auto &stage_queue = method_queue.priority_que_map[info.priority];
     stage_queue.task_info = info;
   }
+  pending_instances_count_ = 0;
   is_running = true;
 }
 
@@ -48,7 +55,17 @@ void TaskQueue::Stop() {
   if (!is_running) {
     return;
   }
-  methods_queue_.group_que_map.clear();
+  for (auto &method_que : methods_queue_.group_que_list) {
+    for (auto &stage_it : method_que.priority_que_map) {
+      auto &stage_que = stage_it.second;
+      if (stage_que.expired_instances_count > 0) {
+        MSI_LOG_INFO << que_name_ << " method " << stage_que.task_info.group_name << " stage " << stage_it.first
+                     << " dropped " << stage_que.expired_instances_count << " instances after their deadlines";
+      }
+    }
+  }
+  methods_queue_ = TaskQueueGroups();
+  pending_instances_count_ = 0;
   task_callback_ = nullptr;
 
   is_running = false;
@@ -62,52 +79,120 @@ void TaskQueue::PushTask(const std::string &group_name, size_t priority, const s
   }
   MSI_LOG_DEBUG << que_name_ << " Push instances count " << instances.size()
                 << ", inputs size: " << instances[0]->data.size();
+  bool has_waiter = false;
   {
     std::unique_lock<std::mutex> lock{que_lock_};
-    auto method_it = methods_queue_.group_que_map.find(group_name);
-    if (method_it == methods_queue_.group_que_map.end()) {
+    auto method_it = methods_queue_.group_index_map.find(group_name);
+    if (method_it == methods_queue_.group_index_map.end()) {
       MSI_LOG_EXCEPTION << "Cannot find method " << group_name << " in task queue, queue name: " << que_name_;
     }
-    auto &stage_queue = method_it->second;
+    auto &stage_queue = methods_queue_.group_que_list[method_it->second];
     auto stage_it = stage_queue.priority_que_map.find(priority);
     if (stage_it == stage_queue.priority_que_map.end()) {
       MSI_LOG_EXCEPTION << "Cannot find stage index " << priority << " in task queue, method name: " << group_name
                         << ", queue name: " << que_name_;
     }
     auto &que = stage_it->second;
+    auto now = std::chrono::steady_clock::now();
+    auto &instance_list = que.instance_list;
     for (auto &instance : instances) {
-      que.instance_list.push_back(instance);
+      instance->enqueue_time = now;
+      // behind the instances of the same or higher priority, usually at the back
+      auto pos = instance_list.end();
+      while (pos != instance_list.begin() && (*(pos - 1))->priority < instance->priority) {
+        --pos;
+      }
+      (void)instance_list.insert(pos, instance);
     }
     stage_queue.priority_que_instances_count += instances.size();
     methods_queue_.groups_que_instances_count += instances.size();
+    pending_instances_count_ = methods_queue_.groups_que_instances_count;
+    has_waiter = waiting_threads_count_ > 0;
+  }
+  // wake up one thread, the thread will wake up the next one if there are still instances left after popping
+  if (has_waiter) {
+    cond_var_.notify_one();
   }
-  cond_var_.notify_all();
 }
 
-bool TaskQueue::FindProcessTaskQueue(std::string *method_name) {
-  auto next_que = methods_queue_.next_exe_que;
-  auto &que_map = methods_queue_.group_que_map;
-  size_t index = 0;
-  std::string name;
-  for (auto &item : que_map) {
-    if (item.second.priority_que_instances_count > 0 && (name.empty() || index >= next_que)) {
-      name = item.first;
-      if (index >= next_que) {
-        break;
-      }
+bool TaskQueue::IsTaskReady(const TaskQueueStage &stage_que, const std::chrono::steady_clock::time_point &now,
+                            std::chrono::steady_clock::time_point *wake_time) {
+  auto &instance_list = stage_que.instance_list;
+  if (instance_list.empty()) {
+    return false;
+  }
+  auto &task_info = stage_que.task_info;
+  if (task_info.max_queue_delay_us == 0) {
+    return true;
+  }
+  auto preferred_batch_size = task_info.preferred_batch_size;
+  if (preferred_batch_size == 0 || preferred_batch_size > task_info.batch_size) {
+    preferred_batch_size = task_info.batch_size;
+  }
+  // the expired instances are dropped when popped and do not count toward the preferred batch size. the wait budget
+  // of the oldest live instance decides when the partial batch should be popped, the instances are ordered by priority
+  // first, so the oldest one is not always at the front
+  uint64_t live_count = 0;
+  auto enqueue_time = std::chrono::steady_clock::time_point::max();
+  for (auto &instance : instance_list) {
+    if (instance->deadline <= now) {
+      continue;
+    }
+    live_count++;
+    if (live_count >= preferred_batch_size) {
+      return true;
     }
-    index++;
+    enqueue_time = std::min(enqueue_time, instance->enqueue_time);
   }
-  if (name.empty()) {
-    return false;
+  // all expired, pop them to reply at once
+  if (live_count == 0) {
+    return true;
+  }
+  auto deadline = enqueue_time + std::chrono::microseconds(task_info.max_queue_delay_us);
+  if (now >= deadline) {
+    return true;
   }
-  if (index + 1 >= que_map.size()) {
-    methods_queue_.next_exe_que = 0;
-  } else {
-    methods_queue_.next_exe_que = index + 1;
+  if (deadline < *wake_time) {
+    *wake_time = deadline;
+  }
+  return false;
+}
+
+TaskQueuePriority *TaskQueue::FindProcessTaskQueue(TaskQueueStage **stage_que,
+                                                   std::chrono::steady_clock::time_point *wake_time) {
+  auto &que_list = methods_queue_.group_que_list;
+  auto que_count = que_list.size();
+  auto now = std::chrono::steady_clock::now();
+  // round robin between methods, starting from the next method of the last popped one
+  for (size_t i = 0; i < que_count; i++) {
+    auto index = (methods_queue_.next_exe_que + i) % que_count;
+    auto &method_que = que_list[index];
+    if (method_que.priority_que_instances_count == 0) {
+      continue;
+    }
+    // the later stage first
+    auto &stage_que_map = method_que.priority_que_map;
+    for (auto stage_it = stage_que_map.rbegin(); stage_it != stage_que_map.rend(); ++stage_it) {
+      if (IsTaskReady(stage_it->second, now, wake_time)) {
+        methods_queue_.next_exe_que = (index + 1) % que_count;
+        *stage_que = &stage_it->second;
+        return &method_que;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void TaskQueue::SpinWaitTask() const {
+  // spin for a while before parking, new instances usually come soon under load, and parking and waking up
+  // a thread costs much more than a few yields
+  constexpr uint32_t kMaxSpinCount = 64;
+  for (uint32_t i = 0; i < kMaxSpinCount; i++) {
+    if (!is_running || pending_instances_count_.load(std::memory_order_relaxed) > 0) {
+      return;
+    }
+    std::this_thread::yield();
   }
-  *method_name = name;
-  return true;
 }
 
 void TaskQueue::PopTask(TaskItem *task_item) {
@@ -120,49 +205,82 @@ void TaskQueue::PopTask(TaskItem *task_item) {
   }
   while (true) {
     if (methods_queue_.groups_que_instances_count == 0) {
+      lock.unlock();
+      SpinWaitTask();
+      lock.lock();
+      waiting_threads_count_++;
       cond_var_.wait(lock, [this] { return !is_running || methods_queue_.groups_que_instances_count > 0; });
+      waiting_threads_count_--;
       if (!is_running) {
         MSI_LOG_INFO << "Detect task queue '" << que_name_ << "' is not running, maybe the Serving server is stopped.";
         task_item->has_stopped = true;
         return;
       }
     }
-    std::string method_name;
-    if (!FindProcessTaskQueue(&method_name)) {
-      MSI_LOG_EXCEPTION << "Cannot find task when the number " << methods_queue_.groups_que_instances_count
-                        << " of instances in task queue is not 0";
+    TaskQueueStage *stage_que = nullptr;
+    auto wake_time = std::chrono::steady_clock::time_point::max();
+    auto method_que = FindProcessTaskQueue(&stage_que, &wake_time);
+    if (method_que == nullptr) {
+      if (wake_time == std::chrono::steady_clock::time_point::max()) {
+        MSI_LOG_EXCEPTION << "Cannot find task when the number " << methods_queue_.groups_que_instances_count
+                          << " of instances in task queue is not 0";
+      }
+      // all queued instances are held for batching, wait for more instances or the earliest wait budget running out
+      waiting_threads_count_++;
+      (void)cond_var_.wait_until(lock, wake_time);
+      waiting_threads_count_--;
+      if (!is_running) {
+        MSI_LOG_INFO << "Detect task queue '" << que_name_ << "' is not running, maybe the Serving server is stopped.";
+        task_item->has_stopped = true;
+        return;
+      }
+      continue;
     }
-    auto &method_que = methods_queue_.group_que_map[method_name];
-    auto &stage_que_map = method_que.priority_que_map;
-    auto stage_it = stage_que_map.rbegin();
-    for (; stage_it != stage_que_map.rend(); ++stage_it) {
-      if (!stage_it->second.instance_list.empty()) {
-        break;
+    auto batch_size = stage_que->task_info.batch_size;
+    auto &instances_reserved = stage_que->instance_list;
+    task_item->has_stopped = false;
+    task_item->task_info = stage_que->task_info;
+    auto &instances_ret = task_item->instance_list;
+    instances_ret.clear();
+    instances_ret.reserve(std::min<size_t>(batch_size, instances_reserved.size()));
+    // Pop a maximum of batch_size instances, the expired instances are dropped and take no place in the batch
+    auto now = std::chrono::steady_clock::now();
+    std::vector<InstancePtr> expired_instances;
+    size_t pop_count = 0;
+    while (pop_count < instances_reserved.size() && instances_ret.size() < batch_size) {
+      auto &instance = instances_reserved[pop_count++];
+      if (instance->deadline <= now) {
+        expired_instances.push_back(std::move(instance));
+      } else {
+        instances_ret.push_back(std::move(instance));
       }
     }
-    if (stage_it == stage_que_map.rend()) {
-      MSI_LOG_EXCEPTION << "Cannot find task when the number " << method_que.priority_que_instances_count
-                        << " of instances in method task queue is not 0";
+    auto pop_end = instances_reserved.begin() + static_cast<ptrdiff_t>(pop_count);
+    (void)instances_reserved.erase(instances_reserved.begin(), pop_end);
+    stage_que->expired_instances_count += expired_instances.size();
+    MSI_LOG_DEBUG << que_name_ << " Pop instances count " << pop_count << ", batch size: " << batch_size;
+
+    method_que->priority_que_instances_count -= pop_count;
+    methods_queue_.groups_que_instances_count -= pop_count;
+    pending_instances_count_ = methods_queue_.groups_que_instances_count;
+    // chain the wake up, PushTask only notifies one thread
+    if (methods_queue_.groups_que_instances_count > 0 && waiting_threads_count_ > 0) {
+      cond_var_.notify_one();
     }
-    auto &task_handle = stage_it->second;
-    auto batch_size = task_handle.task_info.batch_size;
-    // Pop a maximum of batch_size instances
-    if (task_handle.instance_list.size() <= batch_size) {
-      *task_item = task_handle;
-      task_handle.instance_list.clear();
-    } else {
-      *task_item = task_handle;
-      auto &instances_ret = task_item->instance_list;
-      (void)instances_ret.erase(instances_ret.begin() + static_cast<ptrdiff_t>(batch_size), instances_ret.end());
-      auto &instances_reserved = task_handle.instance_list;
-      (void)instances_reserved.erase(instances_reserved.begin(),
-                                     instances_reserved.begin() + static_cast<ptrdiff_t>(batch_size));
+    if (!expired_instances.empty()) {
+      lock.unlock();
+      PushTaskResult(expired_instances, INFER_STATUS(DEADLINE_EXCEEDED)
+                                          << "Deadline exceeded before the instance was run by stage "
+                                          << task_item->task_info.task_name);
+      lock.lock();
+    }
+    if (instances_ret.empty()) {  // all expired
+      if (!is_running) {
+        task_item->has_stopped = true;
+        return;
+      }
+      continue;
     }
-    MSI_LOG_DEBUG << que_name_ << " Pop instances count " << task_item->instance_list.size()
-                  << ", batch size: " << batch_size;
-
-    method_que.priority_que_instances_count -= task_item->instance_list.size();
-    methods_queue_.groups_que_instances_count -= task_item->instance_list.size();
     break;
   }
 }
@@ -207,7 +325,8 @@ void PyTaskQueue::Start(const std::string &que_name, const std::vector<MethodSta
     task_infos.push_back(info);
   }
   task_queue_.Start(que_name, task_infos, callback);
-  py_task_item_processing_ = TaskItem();
+  std::unique_lock<std::mutex> lock{py_task_lock_};
+  py_task_items_processing_.clear();
 }
 
 void PyTaskQueue::Stop() { task_queue_.Stop(); }
@@ -221,7 +340,8 @@ void PyTaskQueue::PyPopTask(TaskItem *task_item) {
   MSI_EXCEPTION_IF_NULL(task_item);
   task_queue_.PopTask(task_item);
   if (!task_item->has_stopped) {
-    py_task_item_processing_ = *task_item;
+    std::unique_lock<std::mutex> lock{py_task_lock_};
+    py_task_items_processing_.push_back(*task_item);
   }
 }
 
@@ -230,19 +350,33 @@ void PyTaskQueue::PyPushTaskResult(const std::vector<ResultInstance> &outputs) {
     MSI_LOG_INFO << "Task queue has exited";
     return;
   }
-  auto &instance_list = py_task_item_processing_.instance_list;
-  if (outputs.empty() || instance_list.size() < outputs.size()) {
-    MSI_LOG_EXCEPTION << "processing task not match result, processing size " << instance_list.size()
-                      << ", result size " << outputs.size();
-  }
   std::vector<InstancePtr> instances;
-  std::vector<ResultInstance> results;
-  for (size_t i = 0; i < outputs.size(); i++) {
-    instances.push_back(instance_list[i]);
-    results.push_back(outputs[i]);
+  {
+    std::unique_lock<std::mutex> lock{py_task_lock_};
+    if (py_task_items_processing_.empty()) {
+      MSI_LOG_EXCEPTION << "processing task not match result, no task in processing, result size " << outputs.size();
+    }
+    auto &instance_list = py_task_items_processing_.front().instance_list;
+    if (outputs.empty() || instance_list.size() < outputs.size()) {
+      MSI_LOG_EXCEPTION << "processing task not match result, processing size " << instance_list.size()
+                        << ", result size " << outputs.size();
+    }
+    auto end = instance_list.begin() + static_cast<ptrdiff_t>(outputs.size());
+    instances.assign(instance_list.begin(), end);
+    (void)instance_list.erase(instance_list.begin(), end);
+    if (instance_list.empty()) {
+      py_task_items_processing_.pop_front();
+    }
+  }
+  task_queue_.PushTaskResult(instances, outputs);
+}
+
+TaskInfo PyTaskQueue::GetHandledTaskInfo() {
+  std::unique_lock<std::mutex> lock{py_task_lock_};
+  if (py_task_items_processing_.empty()) {
+    return TaskInfo();
   }
-  task_queue_.PushTaskResult(instances, results);
-  (void)instance_list.erase(instance_list.begin(), instance_list.begin() + static_cast<ptrdiff_t>(outputs.size()));
+  return py_task_items_processing_.front().task_info;
 }
 
 CppTaskQueueThreadPool::CppTaskQueueThreadPool() = default;
@@ -307,31 +441,48 @@ void CppTaskQueueThreadPool::PushTask(const std::string &method_name, size_t sta
 }
 
 Status CppTaskQueueThreadPool::HandleTask(const TaskItem &task_item) {
-  Status status;
   auto &task_name = task_item.task_info.task_name;
+  if (!CppStageFunctionStorage::Instance().GetFunction(task_name)) {
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "System error, get preprocess " << task_name << " failed";
+  }
+  std::vector<ResultInstance> results;
+  auto status = CallStageFunction(task_name, task_item.instance_list, &results);
+  if (status != SUCCESS) {
+    task_queue_.PushTaskResult(task_item.instance_list, status);
+    return SUCCESS;
+  }
+  task_queue_.PushTaskResult(task_item.instance_list, results);
+  return SUCCESS;
+}
+
+Status CppTaskQueueThreadPool::CallStageFunction(const std::string &task_name,
+                                                 const std::vector<InstancePtr> &instances,
+                                                 std::vector<ResultInstance> *results) {
+  Status status;
   auto preprocess = CppStageFunctionStorage::Instance().GetFunction(task_name);
   if (!preprocess) {
-    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "System error, get preprocess " << task_name << " failed";
-    return status;
-  }
-  for (const auto &instance : task_item.instance_list) {
-    ResultInstance result;
-    try {
-      status = preprocess->Call(task_name, instance->data, &result.data);
-    } catch (const std::bad_alloc &ex) {
-      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: malloc memory failed";
-    } catch (const std::runtime_error &ex) {
-      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: runtime error occurred: " << ex.what();
-    } catch (const std::exception &ex) {
-      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred: " << ex.what();
-    } catch (...) {
-      status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred";
-    }
-    if (status != SUCCESS) {
-      result.error_msg = status;
-    }
-    task_queue_.PushTaskResult(instance, result);
+    return INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "System error, get preprocess " << task_name << " failed";
   }
-  return SUCCESS;
+  std::vector<InstanceData> inputs;
+  for (const auto &instance : instances) {
+    // cppcheck-suppress useStlAlgorithm
+    inputs.push_back(instance->data);
+  }
+  try {
+    status = preprocess->CallBatch(task_name, inputs, results);
+  } catch (const std::bad_alloc &ex) {
+    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: malloc memory failed";
+  } catch (const std::runtime_error &ex) {
+    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: runtime error occurred: " << ex.what();
+  } catch (const std::exception &ex) {
+    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred: " << ex.what();
+  } catch (...) {
+    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "Serving Error: exception occurred";
+  }
+  if (status == SUCCESS && results->size() != inputs.size()) {
+    status = INFER_STATUS_LOG_ERROR(SYSTEM_ERROR) << "The outputs count " << results->size() << " of function "
+                                                  << task_name << " does not match the inputs count " << inputs.size();
+  }
+  return status;
 }
 }  // namespace mindspore::serving
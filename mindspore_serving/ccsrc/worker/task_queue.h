@@ -22,12 +22,14 @@
 #include <memory>
 #include <string>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <set>
 #include <thread>
 #include <map>
+#include <chrono>
 #include "common/instance.h"
 
 namespace mindspore::serving {
@@ -38,6 +40,9 @@ struct TaskInfo {
   uint64_t batch_size = 0;
   uint64_t subgraph = 0;  // for model
   std::string tag;
+  // dynamic batching, hold instances until preferred_batch_size reached or the oldest waited max_queue_delay_us
+  uint64_t preferred_batch_size = 0;  // 0: same as batch_size
+  uint64_t max_queue_delay_us = 0;    // 0: do not hold instances
 };
 
 struct TaskItem {
@@ -49,14 +54,23 @@ struct TaskItem {
 using TaskCallBack =
   std::function<void(const std::vector<InstancePtr> &inputs, const std::vector<ResultInstance> &output)>;
 
+struct TaskQueueStage {
+  TaskInfo task_info;
+  // pop from front by move, no O(n) erase of vector. ordered by the priority of the instances, and then by the
+  // enqueue time
+  std::deque<InstancePtr> instance_list;
+  uint64_t expired_instances_count = 0;  // dropped when popped after their deadlines
+};
+
 struct TaskQueuePriority {
-  std::map<uint64_t, TaskItem> priority_que_map;  // priority: stage index, task list
+  std::map<uint64_t, TaskQueueStage> priority_que_map;  // priority: stage index, task list
   uint64_t priority_que_instances_count = 0;
 };
 
 struct TaskQueueGroups {
-  std::map<std::string, TaskQueuePriority> group_que_map;  // group name: method name, task que
-  size_t next_exe_que = 0;                                 // next method index
+  std::vector<TaskQueuePriority> group_que_list;             // group: method, task que
+  std::unordered_map<std::string, size_t> group_index_map;  // group name: index of group_que_list
+  size_t next_exe_que = 0;                                   // next method index
   uint64_t groups_que_instances_count = 0;
 };
 
@@ -81,9 +95,16 @@ class TaskQueue {
   TaskCallBack task_callback_ = nullptr;
   std::mutex que_lock_;  // Lock only when the queue changes to avoid deadlock caused by lock in complex scenarios.
   std::condition_variable cond_var_;
-  bool is_running = false;
-
-  bool FindProcessTaskQueue(std::string *method_name);
+  std::atomic<bool> is_running = false;
+  // mirror of groups_que_instances_count, checked without lock when spinning before parking
+  std::atomic<uint64_t> pending_instances_count_ = 0;
+  uint64_t waiting_threads_count_ = 0;  // threads parked on cond_var_, only notify when there are waiters
+
+  TaskQueuePriority *FindProcessTaskQueue(TaskQueueStage **stage_que,
+                                          std::chrono::steady_clock::time_point *wake_time);
+  static bool IsTaskReady(const TaskQueueStage &stage_que, const std::chrono::steady_clock::time_point &now,
+                          std::chrono::steady_clock::time_point *wake_time);
+  void SpinWaitTask() const;
 };
 
 class MS_API PyTaskQueue {
@@ -96,14 +117,17 @@ class MS_API PyTaskQueue {
   void PushTask(const std::string &method_name, size_t stage_index, const std::vector<InstancePtr> &instances);
   // for python task
   void PyPopTask(TaskItem *task_item);
+  // results are pushed in the order the tasks are popped, to the earliest popped task not yet finished
   void PyPushTaskResult(const std::vector<ResultInstance> &outputs);
-  TaskInfo GetHandledTaskInfo() const { return py_task_item_processing_.task_info; }
+  TaskInfo GetHandledTaskInfo();
 
   bool IsRunning() const { return task_queue_.IsRunning(); }
 
  private:
   TaskQueue task_queue_;
-  TaskItem py_task_item_processing_;
+  // more than one task can be in processing when python stages run in helper processes
+  std::deque<TaskItem> py_task_items_processing_;
+  std::mutex py_task_lock_;
 };
 
 class CppTaskQueueThreadPool {
@@ -116,6 +140,9 @@ class CppTaskQueueThreadPool {
   void Stop();
 
   void PushTask(const std::string &method_name, size_t stage_index, const std::vector<InstancePtr> &instances);
+  // call the function with the data of the instances, also used by the stages running inline without the queue
+  static Status CallStageFunction(const std::string &task_name, const std::vector<InstancePtr> &instances,
+                                  std::vector<ResultInstance> *results);
 
  protected:
   TaskQueue task_queue_;
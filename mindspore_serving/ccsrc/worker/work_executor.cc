@@ -20,11 +20,36 @@
 #include <thread>
 #include <chrono>
 #include <map>
+#include <algorithm>
 #include "worker/stage_function.h"
 #include "common/tensor.h"
+#include "common/tensor_buffer_pool.h"
 #include "worker/servable_register.h"
 
 namespace mindspore::serving {
+namespace {
+constexpr size_t kMaxFreeInferSessionCount = 256;  // of one shard
+
+void LogPoolStats(const std::string &name, const ObjectPoolStats &stats) {
+  MSI_LOG_INFO << name << " pool, acquired: " << stats.acquire_count << ", reused: " << stats.reuse_count
+               << ", allocated: " << stats.alloc_count << ", dropped: " << stats.drop_count;
+}
+}  // namespace
+
+void InferSession::Reset() {
+  user_id = 0;
+  instances.clear();
+  remain_count = 0;
+  finished = false;
+  call_back = nullptr;
+}
+
+ObjectPool<InferSession> &WorkExecutor::GetInferSessionPool() {
+  // never destroyed, sessions may be released by threads still running at exit
+  static auto pool = new ObjectPool<InferSession>(kMaxFreeInferSessionCount);
+  return *pool;
+}
+
 WorkExecutor::WorkExecutor() = default;
 
 WorkExecutor::~WorkExecutor() noexcept { Stop(); }
@@ -43,6 +68,12 @@ Status WorkExecutor::Init(const std::map<std::string, std::shared_ptr<ModelLoade
   }
   InitStageFunctionQueue();
   InitPredictTaskQueue();
+  expired_stage_instances_.clear();
+  for (auto &method : ServableRegister::Instance().GetServableSignature().methods) {
+    for (auto &stage_it : method.stage_map) {
+      (void)expired_stage_instances_[method.method_name][stage_it.first];  // insert
+    }
+  }
 
   init_flag_ = true;
   return SUCCESS;
@@ -56,9 +87,15 @@ void WorkExecutor::StageCallback(const std::vector<InstancePtr> &instances,
   }
   // <method name, <stage index, instances>>
   std::map<std::string, std::map<uint64_t, std::vector<InstancePtr>>> outputs_real;
+  // <method name, <stage index, request instances>>, stages ready when stages of the method run concurrently
+  std::map<std::string, std::map<uint64_t, std::vector<InstancePtr>>> ready_stages;
   for (size_t i = 0; i < instances.size(); i++) {
     auto &instance = instances[i];
     auto &output = outputs[i];
+    if (instance->stage_state != nullptr || instance->request_instance != nullptr) {
+      OnReceiveParallelStageResult(instance, output, &ready_stages);
+      continue;
+    }
     if (output.error_msg != SUCCESS) {
       (void)ReplyError(instance, output.error_msg);
       continue;
@@ -76,6 +113,77 @@ void WorkExecutor::StageCallback(const std::vector<InstancePtr> &instances,
       }
     }
   }
+  for (auto &method_instances_it : ready_stages) {
+    for (auto &stage_instances_it : method_instances_it.second) {
+      auto &stage_instances = stage_instances_it.second;
+      OnReceiveParallelStageInputs(*stage_instances[0]->method_def, stage_instances_it.first, stage_instances);
+    }
+  }
+}
+
+void WorkExecutor::OnReceiveParallelStageResult(
+  const InstancePtr &instance, const ResultInstance &output,
+  std::map<std::string, std::map<uint64_t, std::vector<InstancePtr>>> *ready_stages) {
+  auto request_instance = instance->request_instance != nullptr ? instance->request_instance : instance;
+  auto &state = *request_instance->stage_state;
+  {
+    std::unique_lock<std::mutex> lock(state.lock);
+    if (state.finished) {
+      return;
+    }
+    if (output.error_msg == SUCCESS) {
+      auto &method_def = *request_instance->method_def;
+      auto stage_it = method_def.stage_map.find(instance->stage_index);
+      if (stage_it == method_def.stage_map.end()) {
+        MSI_LOG_EXCEPTION << "Cannot find stage " << instance->stage_index;
+      }
+      instance->data.clear();
+      request_instance->stage_data_list[instance->stage_index] = output.data;
+      for (auto next_stage : stage_it->second.next_stages) {
+        state.wait_count[next_stage] -= 1;
+        if (state.wait_count[next_stage] == 0) {
+          (*ready_stages)[method_def.method_name][next_stage].push_back(request_instance);
+        }
+      }
+      return;
+    }
+    // the results of the other running stages will be dropped
+    state.finished = true;
+  }
+  (void)ReplyError(request_instance, output.error_msg);
+}
+
+void WorkExecutor::OnReceiveParallelStageInputs(const MethodSignature &method_def, uint64_t stage_index,
+                                                const std::vector<InstancePtr> &instances) {
+  auto stage_it = method_def.stage_map.find(stage_index);
+  if (stage_it == method_def.stage_map.end()) {
+    MSI_LOG_EXCEPTION << "Cannot find stage " << stage_index;
+  }
+  auto &stage = stage_it->second;
+  // no other stage is running, the request instances go through the stage
+  if (stage.run_alone) {
+    OnReceiveStageInputs(method_def, stage_index, instances);
+    return;
+  }
+  std::vector<InstancePtr> stage_instances;
+  for (auto &instance : instances) {
+    auto stage_instance = GetInstancePool().Acquire();
+    stage_instance->method_def = instance->method_def;
+    stage_instance->stage_max = instance->stage_max;
+    stage_instance->user_id = instance->user_id;
+    stage_instance->priority = instance->priority;
+    stage_instance->deadline = instance->deadline;
+    stage_instance->request_instance = instance;
+    std::unique_lock<std::mutex> lock(instance->stage_state->lock);
+    if (instance->stage_state->finished) {
+      continue;
+    }
+    CreateInputInstance(stage, stage_instance);
+    stage_instances.push_back(stage_instance);
+  }
+  if (!stage_instances.empty()) {
+    PushStageTask(method_def, stage, stage_instances);
+  }
 }
 
 void WorkExecutor::InitStageFunctionQueue() {
@@ -87,6 +195,8 @@ void WorkExecutor::InitStageFunctionQueue() {
   // start task queue for handle preprocess and postprocess
   std::vector<MethodStage> py_stage_infos;
   std::vector<MethodStage> cpp_stage_infos;
+  // no stage is running before Init finishes
+  inline_stage_hops_.clear();
   for (auto &method : signature.methods) {
     for (auto &stage_it : method.stage_map) {
       auto &stage = stage_it.second;
@@ -96,8 +206,12 @@ void WorkExecutor::InitStageFunctionQueue() {
         py_stage_infos.push_back(stage);
       } else if (stage.stage_type == kMethodStageTypeCppFunction) {
         MSI_LOG_INFO << "CppFunction stage " << stage.stage_key << ", method name: " << stage.method_name
-                     << ", stage index: " << stage.stage_index << ", batch size: " << stage.batch_size;
+                     << ", stage index: " << stage.stage_index << ", batch size: " << stage.batch_size
+                     << ", run inline: " << stage.run_inline;
         cpp_stage_infos.push_back(stage);
+        if (stage.run_inline) {
+          (void)inline_stage_hops_[stage.method_name][stage.stage_index];  // insert
+        }
       }
     }
   }
@@ -105,7 +219,7 @@ void WorkExecutor::InitStageFunctionQueue() {
     py_task_queue_.Start("PyTask", py_stage_infos, stage_callback);
   }
   if (!cpp_stage_infos.empty()) {
-    cpp_task_queue_pool_.Start("CppTask", cpp_stage_infos, stage_callback, 3);  // 3 thread
+    cpp_task_queue_pool_.Start("CppTask", cpp_stage_infos, stage_callback, signature.cpp_stage_thread_num);
   }
 }
 
@@ -134,6 +248,27 @@ void WorkExecutor::Stop() {
   model_loaders_.clear();
   py_task_queue_.Stop();
   cpp_task_queue_pool_.Stop();
+  for (auto &method_it : inline_stage_hops_) {
+    for (auto &stage_it : method_it.second) {
+      MSI_LOG_INFO << "Method " << method_it.first << " stage " << stage_it.first
+                   << " ran inline, task queue hops saved: " << stage_it.second.load();
+    }
+  }
+  for (auto &method_it : expired_stage_instances_) {
+    for (auto &stage_it : method_it.second) {
+      if (stage_it.second > 0) {
+        MSI_LOG_INFO << "Method " << method_it.first << " stage " << stage_it.first << " dropped "
+                     << stage_it.second.load() << " instances before running after their deadlines";
+      }
+    }
+  }
+  LogPoolStats("Request session", GetInferSessionPool().GetStats());
+  LogPoolStats("Instance", GetInstancePool().GetStats());
+  LogPoolStats("Instance stage state", GetInstanceStageStatePool().GetStats());
+  auto buffer_stats = TensorBufferPool::Instance().GetStats();
+  MSI_LOG_INFO << "Tensor buffer pool, allocated: " << buffer_stats.alloc_count << ", hit: " << buffer_stats.hit_count
+               << ", dropped: " << buffer_stats.drop_count << ", cached bytes: " << buffer_stats.cached_bytes
+               << ", cached bytes high water: " << buffer_stats.cached_high_water_bytes;
 }
 
 Status WorkExecutor::Work(const RequestSpec &request_spec, const std::vector<InstanceData> &instances_data,
@@ -141,38 +276,61 @@ Status WorkExecutor::Work(const RequestSpec &request_spec, const std::vector<Ins
   if (!init_flag_) {
     MSI_LOG_EXCEPTION << "Worker service has not been initialized";
   }
-  auto user_id = WorkExecutor::GetNextUserId();
-  InferSession infer_session;
-  infer_session.call_back = on_process_done;
-
   auto const &signature = ServableRegister::Instance().GetServableSignature();
   auto method_def = signature.GetMethodDeclare(request_spec.method_name);
   if (method_def == nullptr) {
     return INFER_STATUS_LOG_ERROR(FAILED) << "Not support method " << request_spec.method_name;
   }
-
-  std::vector<InstancePtr> instances;
   for (size_t i = 0; i < instances_data.size(); i++) {
     if (method_def->inputs.size() != instances_data[i].size()) {
       return INFER_STATUS_LOG_ERROR(FAILED) << "The inputs count " << instances_data[i].size() << " of instance " << i
                                             << " is not equal to the inputs count " << method_def->inputs.size()
                                             << " of the method " << request_spec.method_name;
     }
+  }
+  auto user_id = WorkExecutor::GetNextUserId();
+  auto infer_session = GetInferSessionPool().Acquire();
+  infer_session->user_id = user_id;
+  infer_session->call_back = on_process_done;
 
-    auto instance = std::make_shared<Instance>();
-    instances.push_back(instance);
-
+  auto stage_max = method_def->GetStageMax();
+  // the session keeps the instances alive while they are dispatched
+  auto &instances = infer_session->instances;
+  for (auto &instance_data : instances_data) {
+    auto instance = GetInstancePool().Acquire();
     instance->method_def = method_def;
-    instance->stage_data_list[0] = instances_data[i];  // stage 0 data: input
-    instance->stage_max = method_def->GetStageMax();
+    instance->stage_data_list.resize(stage_max + 1);
+    instance->stage_data_list[0] = instance_data;  // stage 0 data: input
+    instance->stage_max = stage_max;
     instance->user_id = user_id;
+    instance->priority = request_spec.priority;
+    instance->deadline = request_spec.deadline;
+    instance->session = infer_session;
+    instances.push_back(instance);
+  }
+  if (method_def->parallel_stages) {
+    for (auto &instance : instances) {
+      instance->stage_state = GetInstanceStageStatePool().Acquire();
+      auto &wait_count = instance->stage_state->wait_count;
+      wait_count.assign(stage_max + 1, 0);
+      for (auto &stage_it : method_def->stage_map) {
+        wait_count[stage_it.first] = stage_it.second.depend_stages.size();
+      }
+    }
   }
-  infer_session.instances = instances;
+  infer_session->remain_count = instances.size();
   {
-    std::unique_lock<std::mutex> lock(infer_session_map_mutex_);
-    infer_session_map_[user_id] = infer_session;
+    auto &shard = GetSessionShard(user_id);
+    std::unique_lock<std::mutex> lock(shard.lock);
+    shard.sessions[user_id] = infer_session;
+  }
+  if (method_def->parallel_stages) {
+    for (auto stage_index : method_def->start_stages) {
+      OnReceiveParallelStageInputs(*method_def, stage_index, instances);
+    }
+  } else {
+    OnReceiveStageInputs(*method_def, kStageStartIndex, instances);  // stage 1 is the first stage
   }
-  OnReceiveStageInputs(*method_def, kStageStartIndex, instances);  // stage 1 is the first stage
   return SUCCESS;
 }
 
@@ -191,7 +349,55 @@ void WorkExecutor::OnReceiveStageInputs(const MethodSignature &method_def, uint6
     (void)ReplyRequest(instances);
     return;
   }
-  if (stage.stage_type == kMethodStageTypePyFunction) {
+  PushStageTask(method_def, stage, instances);
+}
+
+// the instances past their deadlines are dropped before each stage, the callers have given up on them
+void WorkExecutor::PushStageTask(const MethodSignature &method_def, const MethodStage &stage,
+                                 const std::vector<InstancePtr> &instances) {
+  auto now = std::chrono::steady_clock::now();
+  auto is_expired = [now](const InstancePtr &instance) { return instance->deadline <= now; };
+  if (!std::any_of(instances.begin(), instances.end(), is_expired)) {
+    PushStageTaskInner(method_def, stage, instances);
+    return;
+  }
+  std::vector<InstancePtr> live_instances;
+  std::vector<InstancePtr> expired_instances;
+  for (auto &instance : instances) {
+    if (is_expired(instance)) {
+      expired_instances.push_back(instance);
+    } else {
+      live_instances.push_back(instance);
+    }
+  }
+  ShedExpiredInstances(method_def, stage, expired_instances);
+  if (!live_instances.empty()) {
+    PushStageTaskInner(method_def, stage, live_instances);
+  }
+}
+
+void WorkExecutor::ShedExpiredInstances(const MethodSignature &method_def, const MethodStage &stage,
+                                        const std::vector<InstancePtr> &instances) {
+  auto method_it = expired_stage_instances_.find(method_def.method_name);
+  if (method_it != expired_stage_instances_.end()) {
+    auto stage_it = method_it->second.find(stage.stage_index);
+    if (stage_it != method_it->second.end()) {
+      stage_it->second += instances.size();
+    }
+  }
+  ResultInstance result;
+  result.error_msg = INFER_STATUS(DEADLINE_EXCEEDED)
+                     << "Deadline exceeded before the instance was run by stage " << stage.stage_key;
+  // replied as failed by the stage, the same as the other errors of the stage
+  StageCallback(instances, std::vector<ResultInstance>(instances.size(), result));
+}
+
+void WorkExecutor::PushStageTaskInner(const MethodSignature &method_def, const MethodStage &stage,
+                                      const std::vector<InstancePtr> &instances) {
+  auto stage_index = stage.stage_index;
+  if (stage.run_inline) {
+    RunInlineStage(method_def, stage, instances);
+  } else if (stage.stage_type == kMethodStageTypePyFunction) {
     py_task_queue_.PushTask(method_def.method_name, stage_index, instances);
   } else if (stage.stage_type == kMethodStageTypeCppFunction) {
     cpp_task_queue_pool_.PushTask(method_def.method_name, stage_index, instances);
@@ -206,6 +412,38 @@ void WorkExecutor::OnReceiveStageInputs(const MethodSignature &method_def, uint6
   }
 }
 
+void WorkExecutor::RunInlineStage(const MethodSignature &method_def, const MethodStage &stage,
+                                  const std::vector<InstancePtr> &instances) {
+  std::atomic<uint64_t> *hops = nullptr;
+  auto method_it = inline_stage_hops_.find(method_def.method_name);
+  if (method_it != inline_stage_hops_.end()) {
+    auto stage_it = method_it->second.find(stage.stage_index);
+    if (stage_it != method_it->second.end()) {
+      hops = &stage_it->second;
+    }
+  }
+  auto batch_size = stage.batch_size > 0 ? stage.batch_size : instances.size();
+  for (size_t offset = 0; offset < instances.size(); offset += batch_size) {
+    auto end = std::min(instances.size(), offset + batch_size);
+    std::vector<InstancePtr> batch_instances(instances.begin() + offset, instances.begin() + end);
+    std::vector<ResultInstance> results;
+    auto status = CppTaskQueueThreadPool::CallStageFunction(stage.stage_key, batch_instances, &results);
+    if (status != SUCCESS) {
+      results.clear();
+      for (size_t i = 0; i < batch_instances.size(); i++) {
+        ResultInstance result;
+        result.error_msg = status;
+        results.push_back(result);
+      }
+    }
+    if (hops != nullptr) {
+      (void)hops->fetch_add(1);
+    }
+    // the next stage is dispatched on this thread as well, and runs inline again if it is fused
+    StageCallback(batch_instances, results);
+  }
+}
+
 bool WorkExecutor::ReplyRequest(const std::vector<InstancePtr> &outputs) {
   MSI_TIME_STAMP_START(ReplyRequest)
   for (auto &item : outputs) {
@@ -215,21 +453,37 @@ bool WorkExecutor::ReplyRequest(const std::vector<InstancePtr> &outputs) {
   return true;
 }
 
+InferSessionShard &WorkExecutor::GetSessionShard(uint64_t user_id) {
+  return infer_session_shards_[user_id % kInferSessionShardCount];
+}
+
+void WorkExecutor::FinishSession(const InferSessionPtr &session) {
+  if (session->finished.exchange(true)) {
+    return;
+  }
+  {
+    auto &shard = GetSessionShard(session->user_id);
+    std::unique_lock<std::mutex> lock(shard.lock);
+    (void)shard.sessions.erase(session->user_id);
+  }
+  session->call_back(session->instances);
+}
+
 bool WorkExecutor::ReplyCallback(const InstancePtr &instance) {
-  instance->stage_data_list.clear();
+  for (auto &item : instance->stage_data_list) {
+    item.clear();
+  }
   instance->stage_index = instance->stage_max;
 
-  std::unique_lock<std::mutex> lock(infer_session_map_mutex_);
-  auto it = infer_session_map_.find(instance->user_id);
-  if (it == infer_session_map_.end()) {
-    MSI_LOG_WARNING << "Cannot find user in session map, user id " << instance->user_id;
+  // the replied instance no longer refers to the session, so that the session can be recycled
+  auto session = std::move(instance->session);
+  if (session == nullptr || session->finished) {
+    MSI_LOG_WARNING << "Request has been finished or cleared, user id " << instance->user_id;
     return false;
   }
-  auto &infer_session = it->second;
-  infer_session.reply_count++;
-  if (infer_session.reply_count == infer_session.instances.size()) {
-    infer_session.call_back(infer_session.instances);
-    (void)infer_session_map_.erase(it);
+  // the last replied instance finishes the request
+  if (session->remain_count.fetch_sub(1) == 1) {
+    FinishSession(session);
   }
   return true;
 }
@@ -255,12 +509,15 @@ void WorkExecutor::CreateInputInstance(const MethodStage &stage, const InstanceP
   instance->data.clear();
   const auto &inputs = stage.stage_inputs;
   instance->stage_index = stage.stage_index;
+  // the instance of one running stage gets inputs from the request instance
+  auto &stage_data_list =
+    instance->request_instance != nullptr ? instance->request_instance->stage_data_list : instance->stage_data_list;
   for (auto &item : inputs) {
-    if (item.first >= instance->stage_data_list.size()) {
+    if (item.first >= stage_data_list.size()) {
       MSI_LOG_EXCEPTION << "Invalid input stage index " << item.first << ", data stage count "
-                        << instance->stage_data_list.size();
+                        << stage_data_list.size();
     }
-    auto &data = instance->stage_data_list[item.first];
+    auto &data = stage_data_list[item.first];
     if (data.size() <= item.second) {
       MSI_LOG_EXCEPTION << "Invalid output index " << item.second << ", output count " << data.size()
                         << ", input stage index " << item.first << ", stage index " << stage.stage_index << ", method "
@@ -293,17 +550,27 @@ uint64_t WorkExecutor::GetMaxBatchSize() const {
 }
 
 void WorkExecutor::ClearInstances(const Status &error_msg) {
-  std::unique_lock<std::mutex> lock(infer_session_map_mutex_);
-  MSI_LOG_INFO << "Clear instances, remain request count " << infer_session_map_.size();
-  for (auto &item : infer_session_map_) {
-    auto &infer_session = item.second;
-    for (auto &instance : infer_session.instances) {
+  std::vector<InferSessionPtr> sessions;
+  for (auto &shard : infer_session_shards_) {
+    std::unique_lock<std::mutex> lock(shard.lock);
+    for (auto &item : shard.sessions) {
+      sessions.push_back(item.second);
+    }
+    shard.sessions.clear();
+  }
+  MSI_LOG_INFO << "Clear instances, remain request count " << sessions.size();
+  for (auto &session : sessions) {
+    if (session->finished.exchange(true)) {
+      continue;
+    }
+    for (auto &instance : session->instances) {
       if (instance->stage_index != instance->stage_max) {
         instance->error_msg = error_msg;
       }
     }
-    item.second.call_back(item.second.instances);
+    session->call_back(session->instances);
+    // the instances not replied refer to the session
+    session->instances.clear();
   }
-  infer_session_map_.clear();
 }
 }  // namespace mindspore::serving
@@ -22,6 +22,9 @@
 #include <string>
 #include <mutex>
 #include <map>
+#include <atomic>
+#include <array>
+#include <unordered_map>
 #include "common/serving_common.h"
 #include "common/instance.h"
 #include "common/servable.h"
@@ -32,10 +35,23 @@
 namespace mindspore::serving {
 using WorkCallBack = std::function<void(const std::vector<InstancePtr> &instances)>;
 
+// pooled with the instances, the session is the arena of one request reused by later requests
 struct InferSession {
+  uint64_t user_id = 0;
   std::vector<InstancePtr> instances;
-  size_t reply_count = 0;
+  std::atomic<size_t> remain_count = 0;  // count of instances not replied
+  std::atomic<bool> finished = false;    // call_back has been invoked by the last reply or ClearInstances
   WorkCallBack call_back = nullptr;
+
+  void Reset();
+};
+using InferSessionPtr = std::shared_ptr<InferSession>;
+
+// running requests are only looked up by ClearInstances, the shards keep the registering and finishing of
+// concurrent requests from contending for one lock
+struct InferSessionShard {
+  std::mutex lock;
+  std::unordered_map<uint64_t, InferSessionPtr> sessions;
 };
 
 class WorkExecutor : public std::enable_shared_from_this<WorkExecutor> {
@@ -54,6 +70,7 @@ class WorkExecutor : public std::enable_shared_from_this<WorkExecutor> {
   uint64_t GetMaxBatchSize() const;
 
   PyTaskQueue &GetPyTaskQueue() { return py_task_queue_; }
+  static ObjectPool<InferSession> &GetInferSessionPool();
 
  private:
   std::map<std::string, std::shared_ptr<ModelLoaderBase>> model_loaders_;
@@ -64,9 +81,17 @@ class WorkExecutor : public std::enable_shared_from_this<WorkExecutor> {
   PyTaskQueue py_task_queue_;
   CppTaskQueueThreadPool cpp_task_queue_pool_;
 
-  std::map<uint64_t, InferSession> infer_session_map_;
-  std::mutex infer_session_map_mutex_;
-
+  static constexpr size_t kInferSessionShardCount = 16;
+  std::array<InferSessionShard, kInferSessionShardCount> infer_session_shards_;
+  // <method name, <stage index, task queue hops saved by running the stage inline>>, built in Init and not changed
+  // until the next Init, the stages running on the request threads may still read it while stopping
+  std::map<std::string, std::map<uint64_t, std::atomic<uint64_t>>> inline_stage_hops_;
+  // <method name, <stage index, instances dropped before the stage after their deadlines>>, built in Init the same as
+  // inline_stage_hops_, and read by the request threads without lock
+  std::map<std::string, std::map<uint64_t, std::atomic<uint64_t>>> expired_stage_instances_;
+
+  InferSessionShard &GetSessionShard(uint64_t user_id);
+  void FinishSession(const InferSessionPtr &session);
   bool ReplyCallback(const InstancePtr &instance);
   bool ReplyError(const InstancePtr &context, const Status &error_msg);
   bool ReplyRequest(const std::vector<InstancePtr> &outputs);
@@ -74,6 +99,20 @@ class WorkExecutor : public std::enable_shared_from_this<WorkExecutor> {
 
   void OnReceiveStageInputs(const MethodSignature &method_def, uint64_t stage_index,
                             const std::vector<InstancePtr> &instances);
+  void PushStageTask(const MethodSignature &method_def, const MethodStage &stage,
+                     const std::vector<InstancePtr> &instances);
+  void PushStageTaskInner(const MethodSignature &method_def, const MethodStage &stage,
+                          const std::vector<InstancePtr> &instances);
+  void ShedExpiredInstances(const MethodSignature &method_def, const MethodStage &stage,
+                            const std::vector<InstancePtr> &instances);
+  // run the fused c++ function stage on the current thread
+  void RunInlineStage(const MethodSignature &method_def, const MethodStage &stage,
+                      const std::vector<InstancePtr> &instances);
+  // for methods whose stages run concurrently, a stage is dispatched once all its depend stages finish
+  void OnReceiveParallelStageInputs(const MethodSignature &method_def, uint64_t stage_index,
+                                    const std::vector<InstancePtr> &instances);
+  void OnReceiveParallelStageResult(const InstancePtr &instance, const ResultInstance &output,
+                                    std::map<std::string, std::map<uint64_t, std::vector<InstancePtr>>> *ready_stages);
 
   static void CreateInputInstance(const MethodStage &stage, const InstancePtr &instance);
   static void CreateInputInstance(const MethodStage &stage, const std::vector<InstancePtr> &instances);
@@ -16,6 +16,7 @@
 
 #include "worker/worker.h"
 #include <unistd.h>
+#include <algorithm>
 #include <condition_variable>
 #include <regex>
 #include "pybind11/pybind11.h"
@@ -46,37 +47,103 @@ Status Worker::RegisterWorker(const std::string &master_address, const std::stri
   return status;
 }
 
-Status Worker::RunAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                        const PredictOnFinish &on_finish) {
-  Status status;
-  RequestSpec request_spec;
-  GrpcTensorHelper::GetRequestSpec(request, &request_spec);
-
-  auto servable_name = request_spec.servable_name;
-  auto method_name = request_spec.method_name;
-
+Status Worker::GetMethodSignature(const RequestSpec &request_spec, const MethodSignature **method) const {
+  auto &servable_name = request_spec.servable_name;
+  auto &method_name = request_spec.method_name;
   const ServableSignature &servable_signature = ServableRegister::Instance().GetServableSignature();
   if (servable_signature.servable_name != servable_name) {
     return INFER_STATUS_LOG_ERROR(INVALID_INPUTS) << "Servable " << servable_name << " is not declared";
   }
-  auto method_signature = servable_signature.GetMethodDeclare(method_name);
-  if (method_signature == nullptr) {
+  *method = servable_signature.GetMethodDeclare(method_name);
+  if (*method == nullptr) {
     return INFER_STATUS_LOG_ERROR(INVALID_INPUTS)
            << "Method " << method_name << " is not registered for servable " << servable_name;
   }
-  const MethodSignature &method = *method_signature;
+  return SUCCESS;
+}
+
+Status Worker::RunAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+                        const PredictOnFinish &on_finish) {
+  RequestSpec request_spec;
+  GrpcTensorHelper::GetRequestSpec(request, &request_spec);
+  const MethodSignature *method = nullptr;
+  auto status = GetMethodSignature(request_spec, &method);
+  if (status != SUCCESS) {
+    return status;
+  }
+  std::vector<InstanceData> instances_data;
+  std::vector<Status> instance_errors;
+  status = GrpcTensorHelper::CreateInstanceFromRequest(*method, request, &instances_data, &instance_errors);
+  if (status != SUCCESS) {
+    MSI_LOG(ERROR) << "transfer request to instances failed";
+    return status;
+  }
+  return RunAsyncInstances(request, request_spec, *method, &instances_data, instance_errors, reply, on_finish);
+}
+
+Status Worker::RunAsync(const proto::PassthroughPredictRequest &request, proto::PredictRequest *parsed_request,
+                        proto::PredictReply *reply, const PredictOnFinish &on_finish) {
+  RequestSpec request_spec;
+  GrpcTensorHelper::GetRequestSpec(request, &request_spec);
+  const MethodSignature *method = nullptr;
+  auto status = GetMethodSignature(request_spec, &method);
+  if (status != SUCCESS) {
+    return status;
+  }
   std::vector<InstanceData> instances_data;
-  status = GrpcTensorHelper::CreateInstanceFromRequest(method, request, &instances_data);
+  std::vector<Status> instance_errors;
+  status = GrpcTensorHelper::CreateInstanceFromRequest(*method, request, parsed_request, &instances_data,
+                                                       &instance_errors);
   if (status != SUCCESS) {
     MSI_LOG(ERROR) << "transfer request to instances failed";
     return status;
   }
+  return RunAsyncInstances(*parsed_request, request_spec, *method, &instances_data, instance_errors, reply,
+                           on_finish);
+}
+
+// the instances may come from different requests batched by the master, an invalid instance fails alone in the batch,
+// and is replied as INVALID_INSTANCE, so that the master fails the request it comes from
+Status Worker::RunAsyncInstances(const proto::PredictRequest &request, const RequestSpec &request_spec,
+                                 const MethodSignature &method, std::vector<InstanceData> *instances_data,
+                                 const std::vector<Status> &instance_errors, proto::PredictReply *reply,
+                                 const PredictOnFinish &on_finish) {
+  std::vector<InstanceData> valid_instances_data;
+  for (size_t i = 0; i < instances_data->size(); i++) {
+    if (instance_errors[i] == SUCCESS) {
+      valid_instances_data.push_back(std::move((*instances_data)[i]));
+    }
+  }
+  bool same_error = std::all_of(instance_errors.begin(), instance_errors.end(), [&instance_errors](const Status &item) {
+    return item.StatusCode() == instance_errors[0].StatusCode() &&
+           item.StatusMessage() == instance_errors[0].StatusMessage();
+  });
+  if (valid_instances_data.empty() && same_error) {
+    return instance_errors[0];
+  }
   *(reply->mutable_servable_spec()) = request.servable_spec();
-  WorkCallBack on_process_done = [&request, reply, on_finish, method](const std::vector<InstancePtr> &instances) {
-    GrpcTensorHelper::CreateReplyFromInstances(request, method, instances, reply);
+  WorkCallBack on_process_done = [&request, instance_errors, reply, on_finish,
+                                  method](const std::vector<InstancePtr> &instances) {
+    // the results of the valid instances are merged with the errors of the invalid ones, in the request order
+    std::vector<InstancePtr> results;
+    auto valid_it = instances.begin();
+    for (auto &error : instance_errors) {
+      if (error == SUCCESS && valid_it != instances.end()) {
+        results.push_back(*valid_it++);
+        continue;
+      }
+      auto instance = std::make_shared<Instance>();
+      instance->error_msg = Status(INVALID_INSTANCE, error.StatusMessage());
+      results.push_back(instance);
+    }
+    GrpcTensorHelper::CreateReplyFromInstances(request, method, results, reply);
     on_finish();
   };
-  return RunAsync(request_spec, instances_data, on_process_done);
+  if (valid_instances_data.empty()) {
+    on_process_done({});
+    return SUCCESS;
+  }
+  return RunAsync(request_spec, valid_instances_data, on_process_done);
 }
 
 Status Worker::RunAsync(const RequestSpec &request_spec, const std::vector<InstanceData> &instances_data,
@@ -138,7 +205,8 @@ Status Worker::StartGrpcServer(const std::string &server_address) {
   }
   worker_grpc_server_ = std::make_shared<WorkerGrpcServer>();
   SSLConfig ssl_config;
-  return worker_grpc_server_->Start(server_address, ssl_config, gRpcMaxMBMsgSize, "Worker gRPC");
+  return worker_grpc_server_->Start(server_address, ssl_config, gRpcMaxMBMsgSize, "Worker gRPC",
+                                    ServableContext::Instance()->GetWorkerGrpcThreadNum());
 }
 
 Status Worker::StartDistributedGrpcServer(std::shared_ptr<DistributedModelLoader> servable,
@@ -148,7 +216,8 @@ Status Worker::StartDistributedGrpcServer(std::shared_ptr<DistributedModelLoader
   }
   distributed_grpc_server_ = std::make_shared<DistributedWorkerGrpcServer>(servable, server_address);
   SSLConfig ssl_config;
-  return distributed_grpc_server_->Start(server_address, ssl_config, gRpcMaxMBMsgSize, "Distributed gRPC");
+  return distributed_grpc_server_->Start(server_address, ssl_config, gRpcMaxMBMsgSize, "Distributed gRPC",
+                                         ServableContext::Instance()->GetWorkerGrpcThreadNum());
 }
 
 Status Worker::StartServable(const std::string &servable_directory, const std::string &servable_name,
@@ -189,6 +258,7 @@ Status Worker::StartServableInner(const std::string &servable_name, uint32_t ver
   servable_spec_.servable_name = servable_name;
   servable_spec_.version_number = version_number;
   servable_spec_.batch_size = worker_executor_.GetMaxBatchSize();
+  servable_spec_.capacity_weight = ServableContext::Instance()->GetWorkerCapacityWeight();
   servable_spec_.methods.clear();
   servable_spec_.own_device = own_device;
 
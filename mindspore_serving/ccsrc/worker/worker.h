@@ -46,7 +46,11 @@ class MS_API Worker {
   void Clear();
   Status Run(const RequestSpec &request_spec, const std::vector<InstanceData> &instances_data,
              std::vector<InstancePtr> *out);
+  // the instances have been decoded by the master
   Status RunAsync(const proto::PredictRequest &request, proto::PredictReply *reply, const PredictOnFinish &on_finish);
+  // the instances are forwarded serialized by the master, and parsed into parsed_request one by one
+  Status RunAsync(const proto::PassthroughPredictRequest &request, proto::PredictRequest *parsed_request,
+                  proto::PredictReply *reply, const PredictOnFinish &on_finish);
 
   Status RunAsync(const RequestSpec &request_spec, const std::vector<InstanceData> &instances_data,
                   const WorkCallBack &on_process_done);
@@ -92,6 +96,11 @@ class MS_API Worker {
 
   Status RunAsyncInner(const RequestSpec &request_spec, const std::vector<InstanceData> &instances_data,
                        const WorkCallBack &on_process_done);
+  Status GetMethodSignature(const RequestSpec &request_spec, const MethodSignature **method) const;
+  Status RunAsyncInstances(const proto::PredictRequest &request, const RequestSpec &request_spec,
+                           const MethodSignature &method, std::vector<InstanceData> *instances_data,
+                           const std::vector<Status> &instance_errors, proto::PredictReply *reply,
+                           const PredictOnFinish &on_finish);
   bool CheckServableRequest(const RequestSpec &request_spec);
 };
 
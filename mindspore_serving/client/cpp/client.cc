@@ -21,6 +21,10 @@
 #include <unordered_map>
 #include <utility>
 #include <sstream>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
 #include "proto/ms_service.pb.h"
 #include "proto/ms_service.grpc.pb.h"
 
@@ -462,6 +466,167 @@ Status Client::SendRequest(const InstancesRequest &request, InstancesReply *repl
   Status result = impl_->Predict(*proto_request, proto_reply);
   return result;
 }
+
+class ClientStreamImpl {
+ public:
+  ClientStreamImpl(const std::string &server_ip, uint64_t server_port) {
+    std::string target_str = server_ip + ":" + std::to_string(server_port);
+    auto channel = grpc::CreateChannel(target_str, grpc::InsecureChannelCredentials());
+    stub_ = proto::MSService::NewStub(channel);
+    stream_ = stub_->PredictStream(&context_);
+    read_thread_ = std::thread(&ClientStreamImpl::ReadReplies, this);
+    read_thread_id_ = read_thread_.get_id();
+  }
+  ~ClientStreamImpl() { (void)Close(); }
+
+  Status Predict(proto::PredictRequest *request, const PredictCallback &callback) {
+    uint64_t request_id;
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      request_id = next_request_id_++;
+      pending_callbacks_[request_id] = callback;
+    }
+    std::unique_lock<std::mutex> write_lock(write_lock_);
+    if (stream_closed_) {
+      write_lock.unlock();
+      RemoveCallback(request_id);
+      return Status(UNAVAILABLE, "The stream has been closed");
+    }
+    proto::PredictStreamRequest stream_request;
+    stream_request.set_request_id(request_id);
+    // borrow the request without copying it
+    stream_request.set_allocated_request(request);
+    auto write_ok = stream_->Write(stream_request);
+    (void)stream_request.release_request();
+    write_lock.unlock();
+    if (!write_ok) {
+      // the callback is invoked with the status of the stream if it has been taken by the receiving thread
+      if (RemoveCallback(request_id)) {
+        return Status(UNAVAILABLE, "Write request to the stream failed");
+      }
+    }
+    return SUCCESS;
+  }
+
+  Status Close() {
+    {
+      std::unique_lock<std::mutex> write_lock(write_lock_);
+      if (!stream_closed_) {
+        stream_closed_ = true;
+        (void)stream_->WritesDone();
+      }
+    }
+    // called in a callback, the receiving thread cannot wait for itself, the replies left are still received by it
+    if (std::this_thread::get_id() == read_thread_id_) {
+      return SUCCESS;
+    }
+    std::unique_lock<std::mutex> close_lock(close_lock_);
+    if (read_thread_.joinable()) {
+      read_thread_.join();
+    }
+    return finish_status_;
+  }
+
+ private:
+  grpc::ClientContext context_;
+  std::unique_ptr<proto::MSService::Stub> stub_;
+  std::unique_ptr<grpc::ClientReaderWriter<proto::PredictStreamRequest, proto::PredictStreamReply>> stream_;
+  std::thread read_thread_;
+  std::thread::id read_thread_id_;
+  Status finish_status_ = SUCCESS;
+
+  std::mutex write_lock_;  // at most one write is in flight
+  bool stream_closed_ = false;
+  std::mutex close_lock_;
+
+  std::mutex lock_;
+  uint64_t next_request_id_ = 0;
+  std::map<uint64_t, PredictCallback> pending_callbacks_;
+
+  bool RemoveCallback(uint64_t request_id) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return pending_callbacks_.erase(request_id) > 0;
+  }
+
+  void ReadReplies() {
+    proto::PredictStreamReply stream_reply;
+    while (stream_->Read(&stream_reply)) {
+      PredictCallback callback;
+      {
+        std::unique_lock<std::mutex> lock(lock_);
+        auto it = pending_callbacks_.find(stream_reply.request_id());
+        if (it == pending_callbacks_.end()) {
+          continue;
+        }
+        callback = std::move(it->second);
+        (void)pending_callbacks_.erase(it);
+      }
+      InstancesReply reply;
+      reply.reply_->Swap(stream_reply.mutable_reply());
+      callback(SUCCESS, reply);
+    }
+    grpc::Status status;
+    {
+      std::unique_lock<std::mutex> write_lock(write_lock_);
+      stream_closed_ = true;
+      status = stream_->Finish();
+    }
+    if (!status.ok()) {
+      finish_status_ = Status(UNAVAILABLE, status.error_message());
+    }
+    // the requests without reply fail with the status of the stream
+    std::map<uint64_t, PredictCallback> callbacks;
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      callbacks.swap(pending_callbacks_);
+    }
+    for (auto &item : callbacks) {
+      InstancesReply reply;
+      item.second(status.ok() ? Status(FAILED, "The stream is closed before the reply is received") : finish_status_,
+                  reply);
+    }
+  }
+};
+
+StreamClient::StreamClient(const std::string &server_ip, uint64_t server_port, const std::string &servable_name,
+                           const std::string &method_name, uint64_t version_number)
+    : servable_name_(servable_name),
+      method_name_(method_name),
+      version_number_(version_number),
+      impl_(std::make_shared<ClientStreamImpl>(server_ip, server_port)) {}
+
+StreamClient::~StreamClient() = default;
+
+Status StreamClient::SendRequestAsync(const InstancesRequest &request, const PredictCallback &callback) {
+  if (!callback) {
+    return Status(SYSTEM_ERROR) << "input callback cannot be empty";
+  }
+  proto::PredictRequest *proto_request = request.request_.get();
+  auto servable_spec = proto_request->mutable_servable_spec();
+  servable_spec->set_name(servable_name_);
+  servable_spec->set_method_name(method_name_);
+  servable_spec->set_version_number(version_number_);
+  return impl_->Predict(proto_request, callback);
+}
+
+Status StreamClient::SendRequest(const InstancesRequest &request, InstancesReply *reply) {
+  if (reply == nullptr) {
+    return Status(SYSTEM_ERROR) << "input reply cannot be nullptr";
+  }
+  std::promise<Status> promise;
+  auto future = promise.get_future();
+  auto callback = [&promise, reply](Status status, const InstancesReply &instances_reply) {
+    *reply = instances_reply;
+    promise.set_value(status);
+  };
+  auto status = SendRequestAsync(request, callback);
+  if (!status.IsSuccess()) {
+    return status;
+  }
+  return future.get();
+}
+
+Status StreamClient::Close() { return impl_->Close(); }
 }  // namespace client
 }  // namespace serving
 }  // namespace mindspore
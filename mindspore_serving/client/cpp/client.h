@@ -21,6 +21,7 @@
 #include <vector>
 #include <memory>
 #include <sstream>
+#include <functional>
 
 namespace google {
 namespace protobuf {
@@ -189,6 +190,7 @@ class MS_API InstancesRequest {
  private:
   std::shared_ptr<proto::PredictRequest> request_ = nullptr;
   friend class Client;
+  friend class StreamClient;
 };
 
 class MS_API InstancesReply {
@@ -200,6 +202,7 @@ class MS_API InstancesReply {
  private:
   std::shared_ptr<proto::PredictReply> reply_ = nullptr;
   friend class Client;
+  friend class ClientStreamImpl;
 };
 
 class ClientImpl;
@@ -220,6 +223,32 @@ class MS_API Client {
   std::shared_ptr<ClientImpl> impl_;
 };
 
+using PredictCallback = std::function<void(Status status, const InstancesReply &reply)>;
+
+class ClientStreamImpl;
+// the requests are sent over one PredictStream of the server, and the replies are returned as they complete, which
+// may be out of the order of the requests
+class MS_API StreamClient {
+ public:
+  StreamClient(const std::string &server_ip, uint64_t server_port, const std::string &servable_name,
+               const std::string &method_name, uint64_t version_number = 0);
+  ~StreamClient();
+
+  // the callback is invoked by the receiving thread of the stream when the reply arrives or the stream is broken, the
+  // StreamClient should not be destroyed in the callback
+  Status SendRequestAsync(const InstancesRequest &request, const PredictCallback &callback);
+  Status SendRequest(const InstancesRequest &request, InstancesReply *reply);
+  // wait for the replies of all the sent requests and close the stream. called in a callback, it only stops sending
+  // and returns at once, and the replies left are still passed to their callbacks
+  Status Close();
+
+ private:
+  std::string servable_name_;
+  std::string method_name_;
+  uint64_t version_number_ = 0;
+  std::shared_ptr<ClientStreamImpl> impl_;
+};
+
 template <class T>
 Status &Status::operator<<(T val) {
   std::stringstream stringstream;
@@ -187,6 +187,9 @@ class Client:
             running versions. Default: 0.
         ssl_config (mindspore_serving.client.SSLConfig, optional): The server's ssl_config, if None, disabled ssl.
             Default: None.
+        priority (int, optional): The priority of the requests, requests of higher priority are served first, such as
+            interactive requests, while requests of priority 0 fill the idle capacity, such as bulk requests. Range
+            [0, 7]. Default: 0.
 
     Raises:
         RuntimeError: The type or value of the parameters are invalid, or other errors happened.
@@ -203,16 +206,18 @@ class Client:
         >>> print(result)
     """
 
-    def __init__(self, address, servable_name, method_name, version_number=0, ssl_config=None):
+    def __init__(self, address, servable_name, method_name, version_number=0, ssl_config=None, priority=0):
         _check_str("address", address)
         _check_str("servable_name", servable_name)
         _check_str("method_name", method_name)
         _check_int("version_number", version_number, 0)
+        _check_int("priority", priority, 0, 7)
 
         self.address = address
         self.servable_name = servable_name
         self.method_name = method_name
         self.version_number = version_number
+        self.priority = priority
 
         msg_bytes_size = 512 * 1024 * 1024  # 512MB
         options = [
@@ -323,6 +328,7 @@ class Client:
         request.servable_spec.name = self.servable_name
         request.servable_spec.method_name = self.method_name
         request.servable_spec.version_number = self.version_number
+        request.servable_spec.priority = self.priority
 
         for item in instances:
             if isinstance(item, dict):
@@ -13,10 +13,11 @@
 # limitations under the License.
 # ============================================================================
 """Set context of serving"""
+import os
 from mindspore_serving._mindspore_serving import MasterContext_
 from mindspore_serving.server.common import check_type
 
-__all__ = ["set_max_enqueued_requests"]
+__all__ = ["set_max_enqueued_requests", "set_enable_passthrough", "set_grpc_thread_num", "set_worker_client_pool"]
 
 _context = MasterContext_.get_instance()
 
@@ -34,3 +35,82 @@ def set_max_enqueued_requests(max_enqueued_requests):
     """
     check_type.check_int("max_enqueued_requests", max_enqueued_requests, 1)
     _context.set_max_enqueued_requests(max_enqueued_requests)
+
+
+def set_enable_passthrough(enable_passthrough):
+    r"""
+    Set whether the master forwards the instances of gRPC requests to the workers without decoding them. When enabled,
+    the master only parses the servable and method of the request and the input names of the instances, and the input
+    tensors are checked by the workers, which fail only the invalid instances. It takes effect on the gRPC server
+    started after it.
+
+    Args:
+        enable_passthrough (bool): Whether to enable passthrough forwarding, default False.
+
+    Raises:
+        RuntimeError: The type or value of the parameters are invalid, or other error happened.
+    """
+    check_type.check_bool("enable_passthrough", enable_passthrough)
+    _context.set_enable_passthrough(enable_passthrough)
+
+
+def set_grpc_thread_num(serving_thread_num=None, master_thread_num=None, worker_thread_num=None,
+                        agent_thread_num=None):
+    r"""
+    Set the number of completion queues of the gRPC servers, and every completion queue is drained by its own thread.
+    It takes effect on the gRPC servers started after it, the settings of the workers and the agents are passed to
+    the worker and agent processes started after it through the environment variables
+    `SERVING_WORKER_GRPC_THREAD_NUM` and `SERVING_AGENT_GRPC_THREAD_NUM`.
+
+    Args:
+        serving_thread_num (int): The thread number of the gRPC server accessed by the clients. If None, the setting is
+            not changed, default 1.
+        master_thread_num (int): The thread number of the master gRPC server accessed by the workers. If None, the
+            setting is not changed, default 1.
+        worker_thread_num (int): The thread number of the worker gRPC server accessed by the master. If None, the
+            setting is not changed, default 1.
+        agent_thread_num (int): The thread number of the agent gRPC server accessed by the distributed worker. If
+            None, the setting is not changed, default 1.
+
+    Raises:
+        RuntimeError: The type or value of the parameters are invalid, or other error happened.
+
+    Examples:
+        >>> from mindspore_serving.server.master import context
+        >>>
+        >>> context.set_grpc_thread_num(serving_thread_num=4, worker_thread_num=2)
+    """
+    if serving_thread_num is not None:
+        check_type.check_int("serving_thread_num", serving_thread_num, 1)
+        _context.set_serving_grpc_thread_num(serving_thread_num)
+    if master_thread_num is not None:
+        check_type.check_int("master_thread_num", master_thread_num, 1)
+        _context.set_master_grpc_thread_num(master_thread_num)
+    if worker_thread_num is not None:
+        check_type.check_int("worker_thread_num", worker_thread_num, 1)
+        os.environ["SERVING_WORKER_GRPC_THREAD_NUM"] = str(worker_thread_num)
+    if agent_thread_num is not None:
+        check_type.check_int("agent_thread_num", agent_thread_num, 1)
+        os.environ["SERVING_AGENT_GRPC_THREAD_NUM"] = str(agent_thread_num)
+
+
+def set_worker_client_pool(thread_num=None, channel_num=None):
+    r"""
+    Set the pool of the gRPC client used by the master to send the requests to the workers. The requests are spread
+    over `thread_num` completion queues, each drained by its own thread, and over `channel_num` channels to every
+    worker. It takes effect before the first worker is registered.
+
+    Args:
+        thread_num (int): The number of completion queues and threads of the client. If None, the setting is not
+            changed, default 2.
+        channel_num (int): The number of channels to every worker. If None, the setting is not changed, default 2.
+
+    Raises:
+        RuntimeError: The type or value of the parameters are invalid, or other error happened.
+    """
+    if thread_num is not None:
+        check_type.check_int("thread_num", thread_num, 1)
+        _context.set_worker_client_thread_num(thread_num)
+    if channel_num is not None:
+        check_type.check_int("channel_num", channel_num, 1)
+        _context.set_worker_channel_num(channel_num)
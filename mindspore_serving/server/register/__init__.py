@@ -18,7 +18,8 @@ See how to configure servable_config.py file, please refer to
 
 from .model import declare_model, Model, Context, AclOptions, GpuOptions
 from .model import AscendDeviceInfo, CPUDeviceInfo, GPUDeviceInfo
-from .method import register_method, add_stage
+from .method import register_method, add_stage, set_cpp_stage_thread_num
+from .method import set_py_stage_process_num
 
 from .model import declare_servable
 from .method import call_preprocess, call_servable, call_postprocess
@@ -33,5 +34,7 @@ __all__.extend([
     "GPUDeviceInfo",
     "Context",
     'register_method',
-    'add_stage'
+    'add_stage',
+    'set_cpp_stage_thread_num',
+    'set_py_stage_process_num'
 ])
@@ -23,7 +23,7 @@ from mindspore_serving._mindspore_serving import MethodSignature_
 from mindspore_serving import log as logger
 from mindspore_serving.server.common import check_type, deprecated
 from .utils import get_func_name, get_servable_dir
-from .stage_function import register_stage_function, check_stage_function
+from .stage_function import register_stage_function, check_stage_function, stage_function_storage
 from .model import g_declared_models, Model
 
 method_def_context_ = MethodSignature_()
@@ -390,6 +390,49 @@ def add_stage(stage, *args, outputs_count, batch_size=None, tag=None):
     return _create_tensor_def_outputs(cur_stage_index_, outputs_count)
 
 
+def set_cpp_stage_thread_num(thread_num):
+    r"""In the `servable_config.py` file of one servable, set the number of threads running the C++ stage functions
+    registered by `REGISTER_STAGE_FUNCTION`. Any idle thread handles the pending instances of any C++ stage, so more
+    threads keep fast stages running while some threads are busy with slow ones.
+
+    Args:
+        thread_num (int): The number of threads running the C++ stage functions. Default value is 3 when this
+            interface is not called.
+
+    Raises:
+        RuntimeError: The type or value of the parameters are invalid.
+
+    Examples:
+        >>> from mindspore_serving.server import register
+        >>> register.set_cpp_stage_thread_num(8)
+    """
+    check_type.check_int("thread_num", thread_num, 1)
+    ServableRegister_.set_cpp_stage_thread_num(thread_num)
+    logger.info(f"Set the thread number of C++ stage functions: {thread_num}")
+
+
+def set_py_stage_process_num(process_num):
+    r"""In the `servable_config.py` file of one servable, set the number of helper processes running the Python stage
+    functions. Python stage functions run in the worker process by default and are serialized by the GIL, helper
+    processes run them in parallel. The inputs and outputs are passed through shared memory, and the results are
+    returned in the order of the tasks.
+
+    Args:
+        process_num (int): The number of helper processes running the Python stage functions, 0 means running them in
+            the worker process. Default value is 0 when this interface is not called.
+
+    Raises:
+        RuntimeError: The type or value of the parameters are invalid.
+
+    Examples:
+        >>> from mindspore_serving.server import register
+        >>> register.set_py_stage_process_num(4)
+    """
+    check_type.check_int("process_num", process_num, 0)
+    stage_function_storage.py_stage_process_num = process_num
+    logger.info(f"Set the helper process number of Python stage functions: {process_num}")
+
+
 _call_servable_name = call_servable.__name__
 _call_stage_names = [call_preprocess.__name__, call_postprocess.__name__]
 _call_stage_batch_names = [call_preprocess_pipeline.__name__, call_postprocess_pipeline.__name__]
@@ -168,7 +168,9 @@ def append_declared_model(model_key):
 
 
 def declare_model(model_file, model_format, with_batch_dim=True, options=None, without_batch_dim_inputs=None,
-                  context=None, config_file=None):
+                  context=None, config_file=None, preferred_batch_size=None, max_queue_delay_us=None,
+                  batch_bucket_files=None, replica_num=None,
+                  input_buffer_num=None):
     r"""
     Declare one model when importing servable_config.py of one servable.
 
@@ -195,6 +197,24 @@ def declare_model(model_file, model_format, with_batch_dim=True, options=None, w
         config_file (str, optional): Config file for model to set mix precision inference. The file path can be an
             absolute path or a relative path to the directory in which servable_config.py resides.
             Default: None.
+        preferred_batch_size (int, optional): Used with `max_queue_delay_us`, the number of queued instances that
+            makes up a batch worth executing. The value greater than the batch size of the model will be replaced by
+            the batch size of the model. Default: None, the batch size of the model.
+        max_queue_delay_us (int, optional): Dynamic batching, the maximum time in microseconds that an instance waits
+            in the queue of the model for other instances to fill the batch. A partial batch is executed when the
+            queued instances reach `preferred_batch_size` or the oldest instance has waited `max_queue_delay_us`.
+            Default: None, the queued instances are executed immediately.
+        batch_bucket_files (Union[str, list[str]], optional): Model files of the same network exported with smaller
+            batch sizes, such as batch sizes 1, 4 and 8 for the model of batch size 32. The smallest batch size that
+            fits the instances is used to predict rather than padding the instances to the batch size of the model.
+            Only supported when `model_file` is one file. Default: None.
+        replica_num (int, optional): The number of model replicas loaded in one worker, the replicas predict
+            concurrently with their own predict threads. When `thread_affinity_core_list` of `context` is set, the
+            cores are split evenly among the replicas. Only takes effect when the inference backend supports
+            concurrent predicting, such as MindSpore Lite. Default: None, one replica.
+        input_buffer_num (int, optional): The number of input buffer sets of each replica, range [1, 3]. When it
+            is greater than 1, the next batch is copied into another input buffer set while the current batch is
+            executing. Default: None, one input buffer set, the batch is copied and executed in turn.
 
     Return:
         Model, identification of this model, can be used for `Model.call` or as the inputs of `add_stage`.
@@ -241,10 +261,33 @@ def declare_model(model_file, model_format, with_batch_dim=True, options=None, w
         check_type.check_str("config_file", config_file)
         meta.local_meta.config_file = config_file
 
+    if batch_bucket_files is not None:
+        batch_bucket_files = check_type.check_and_as_str_tuple_list('batch_bucket_files', batch_bucket_files)
+        if len(model_file) != 1:
+            raise RuntimeError(f"Parameter 'batch_bucket_files' is only supported when 'model_file' is one file, "
+                               f"model_file: {model_file}")
+        meta.local_meta.batch_bucket_files = batch_bucket_files
+
+    if replica_num is not None:
+        check_type.check_int("replica_num", replica_num, 1)
+        meta.local_meta.replica_num = replica_num
+    if input_buffer_num is not None:
+        check_type.check_int("input_buffer_num", input_buffer_num, 1, 3)
+        meta.local_meta.input_buffer_num = input_buffer_num
+
+    if preferred_batch_size is not None:
+        check_type.check_int("preferred_batch_size", preferred_batch_size, 1)
+        meta.common_meta.preferred_batch_size = preferred_batch_size
+    if max_queue_delay_us is not None:
+        check_type.check_int("max_queue_delay_us", max_queue_delay_us, 0)
+        meta.common_meta.max_queue_delay_us = max_queue_delay_us
+
     ServableRegister_.declare_model(meta)
     logger.info(f"Declare model, model_file: {model_file} , model_format: {model_format},  with_batch_dim: "
                 f"{with_batch_dim}, options: {options}, without_batch_dim_inputs: {without_batch_dim_inputs}"
-                f", context: {context}, config file: {config_file}")
+                f", context: {context}, config file: {config_file}, preferred_batch_size: {preferred_batch_size}"
+                f", max_queue_delay_us: {max_queue_delay_us}, batch_bucket_files: {batch_bucket_files}"
+                f", replica_num: {replica_num}, input_buffer_num: {input_buffer_num}")
 
     return append_declared_model(meta.common_meta.model_key)
 
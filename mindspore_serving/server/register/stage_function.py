@@ -47,6 +47,8 @@ class StageFunctionStorage:
     def __init__(self):
         self.function = {}
         self.storage = StageFunctionStorage_.get_instance()
+        # 0: run python stages in worker process
+        self.py_stage_process_num = 0
 
     def register(self, method_name, fun, function_name, inputs_count, outputs_count, use_with_size):
         check_stage_function(method_name, function_name, inputs_count, outputs_count)
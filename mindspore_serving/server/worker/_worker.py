@@ -24,7 +24,7 @@ from mindspore_serving.server.worker import init_mindspore
 from mindspore_serving._mindspore_serving import ExitSignalHandle_
 from mindspore_serving._mindspore_serving import Worker_
 from mindspore_serving._mindspore_serving import ServableContext_
-from .task import _start_py_task
+from .task import _start_py_task, _start_py_stage_processes
 
 _wait_and_clear_thread = None
 
@@ -39,6 +39,30 @@ def _set_device_id(device_id):
     ServableContext_.get_instance().set_device_id(device_id)
 
 
+def _set_grpc_thread_num():
+    """Set thread number of the worker and agent gRPC servers, passed by the master through environment variables"""
+    worker_thread_num = os.getenv("SERVING_WORKER_GRPC_THREAD_NUM")
+    if worker_thread_num:
+        ServableContext_.get_instance().set_worker_grpc_thread_num(int(worker_thread_num))
+    agent_thread_num = os.getenv("SERVING_AGENT_GRPC_THREAD_NUM")
+    if agent_thread_num:
+        ServableContext_.get_instance().set_agent_grpc_thread_num(int(agent_thread_num))
+
+
+def _set_capacity_weight():
+    """Set relative capacity of the worker reported to the master, through the environment variable of the worker
+    process, so that workers on different hardware can declare different capacities"""
+    capacity_weight = os.getenv("SERVING_WORKER_CAPACITY_WEIGHT")
+    if capacity_weight:
+        try:
+            value = int(capacity_weight)
+            check_type.check_int("capacity_weight", value, 0)
+        except (ValueError, RuntimeError) as e:
+            raise RuntimeError(f"Environment variable SERVING_WORKER_CAPACITY_WEIGHT '{capacity_weight}' should be "
+                               f"int >= 0") from e
+        ServableContext_.get_instance().set_worker_capacity_weight(value)
+
+
 def _set_device_type(device_type):
     """Set device type, now can be 'None'(default), 'GPU' and 'Ascend', 'Davinci'(same as 'Ascend'), case ignored. """
     if device_type is not None:
@@ -118,6 +142,8 @@ def _load_servable_config(servable_directory, servable_name):
     except Exception as e:
         logger.error(f"import {servable_name}.servable_config failed, {str(e)}")
         raise RuntimeError(f"import {servable_name}.servable_config failed, {str(e)}")
+    # fork helper processes of python stages before any thread is started
+    _start_py_stage_processes()
 
 
 @stop_on_except
@@ -155,6 +181,8 @@ def start_servable(servable_directory, servable_name, version_number,
 
     _set_device_type(device_type)
     _set_device_id(device_id)
+    _set_grpc_thread_num()
+    _set_capacity_weight()
     Worker_.start_servable(servable_directory, servable_name, version_number, master_address, worker_address,
                            dec_key, dec_mode)
     _start_py_task()
@@ -195,6 +223,8 @@ def start_extra_servable(servable_directory, servable_name, version_number, devi
         version_number = 1
 
     _set_device_type(device_type)
+    _set_grpc_thread_num()
+    _set_capacity_weight()
     Worker_.start_extra_servable(servable_directory, servable_name, version_number, device_ids_empty,
                                  dec_key, dec_mode, master_address, worker_address)
     _start_py_task()
@@ -17,7 +17,8 @@ from mindspore_serving._mindspore_serving import Worker_
 
 from mindspore_serving.server.common import check_type
 from mindspore_serving.server.worker._worker import _start_py_task
-from mindspore_serving.server.worker._worker import stop_on_except, _load_servable_config
+from mindspore_serving.server.worker._worker import stop_on_except, _load_servable_config, _set_grpc_thread_num
+from mindspore_serving.server.worker._worker import _set_capacity_weight
 
 
 @stop_on_except
@@ -34,6 +35,8 @@ def start_servable(servable_directory, servable_name, rank_table_json_file, vers
     check_type.check_str('distributed_address', distributed_address)
 
     _load_servable_config(servable_directory, servable_name)
+    _set_grpc_thread_num()
+    _set_capacity_weight()
     Worker_.start_distributed_servable(servable_directory, servable_name, rank_table_json_file, version_number,
                                        distributed_address, master_address, worker_address,
                                        wait_agents_time_in_seconds)
@@ -21,6 +21,7 @@ from mindspore_serving._mindspore_serving import WorkerAgent_, AgentStartUpConfi
 
 from mindspore_serving import log as logger
 from mindspore_serving.server.worker import init_mindspore
+from mindspore_serving.server.worker._worker import _set_grpc_thread_num
 
 
 def start_worker_agent(start_config, dec_key, dec_mode):
@@ -52,6 +53,7 @@ def start_worker_agent(start_config, dec_key, dec_mode):
         logger.info(f"Env {item}: {os.getenv(item, None)}")
     if dec_key is None:
         dec_key = ''
+    _set_grpc_thread_num()
     WorkerAgent_.start_agent(start_config, dec_key, dec_mode)
 
     start_wait_and_clear()
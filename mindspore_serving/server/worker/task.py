@@ -14,10 +14,18 @@
 # ============================================================================
 """Python run preprocess and postprocess in python"""
 
+import os
 import threading
 import time
 import logging
-from mindspore_serving._mindspore_serving import Worker_
+import signal
+import queue
+import types
+import weakref
+import collections
+import multiprocessing
+import numpy as np
+from mindspore_serving._mindspore_serving import Worker_, SharedMemory_
 from mindspore_serving._mindspore_serving import ExitSignalHandle_
 from mindspore_serving.server.register.stage_function import stage_function_storage
 from mindspore_serving import log as logger
@@ -65,8 +73,7 @@ class PyTaskHandler:
         logger.info("end python task handling thread")
         Worker_.stop_and_clear()
 
-    @staticmethod
-    def run_inner(task):
+    def run_inner(self, task):
         """Iterator get result, and push it to c++"""
         task_name = task.task_name
         task_info = stage_function_storage.get(task_name)
@@ -90,7 +97,7 @@ class PyTaskHandler:
             except Exception as e:
                 logger.warning(f"{task_name} invoke catch exception: ")
                 logging.exception(e)
-                PyTaskHandler.push_failed(instances_size - index, str(e))
+                self.push_failed(instances_size - index, str(e))
                 return  # return will not terminate thread
 
             try:
@@ -104,12 +111,12 @@ class PyTaskHandler:
                         error_msg = f"The outputs number {len(output)} of one instance returned by function " \
                                     f"'{task_name}' is not equal to the outputs number {task_info['outputs_count']} " \
                                     f" registered in method {task.method_name}"
-                        PyTaskHandler.push_system_failed(error_msg)
+                        self.push_system_failed(error_msg)
                         raise ServingSystemException(error_msg)
                     # convert MindSpore Tensor to numpy
                     output = (item.asnumpy() if callable(getattr(item, "asnumpy", None)) else item for item in output)
                     # raise ServingSystemException when user-defined output is invalid
-                    PyTaskHandler.push_result(output)  # push outputs of one instance
+                    self.push_result(output)  # push outputs of one instance
                     index += 1
 
                 get_result_time = time.time()
@@ -120,17 +127,17 @@ class PyTaskHandler:
             except StopIteration:  # raise by next
                 error_msg = f"The number {index} of instances returned by function '{task_name}' is " \
                             f"not equal to the number {instances_size} of instances provided to this function."
-                PyTaskHandler.push_system_failed(error_msg)
+                self.push_system_failed(error_msg)
                 raise RuntimeError(error_msg)
             except ServingSystemException as e:
                 logger.error(f"{task_name} handling catch exception: {e}")
-                PyTaskHandler.push_system_failed(e.msg)
+                self.push_system_failed(e.msg)
                 raise
             except Exception as e:  # pylint: disable=broad-except
                 # catch exception and try next
                 logger.warning(f"{task_name} get result catch exception: {e}")
                 logging.exception(e)
-                PyTaskHandler.push_failed(1, str(e))  # push success results and a failed result
+                self.push_failed(1, str(e))  # push success results and a failed result
                 index += 1
 
     @staticmethod
@@ -152,9 +159,305 @@ class PyTaskHandler:
             raise ServingSystemException(f"Push py task result cause exception: {e}")
 
 
+class _ShmPool:
+    """Allocate shared memory items in size classes of power of 2, one memory buffer group for each size class"""
+
+    min_item_size = 4096
+    buffer_bytes_size = 16 * 1024 * 1024
+
+    def __init__(self, memory_key_prefix):
+        self.memory_key_prefix = memory_key_prefix
+        self.item_sizes = set()
+
+    def alloc(self, nbytes):
+        """Alloc one shared memory item not less than nbytes"""
+        item_size = _ShmPool.min_item_size
+        while item_size < nbytes:
+            item_size *= 2
+        memory_key_prefix = f"{self.memory_key_prefix}_{item_size}"
+        if item_size not in self.item_sizes:
+            item_count = max(1, _ShmPool.buffer_bytes_size // item_size)
+            SharedMemory_.new_memory_buffer(memory_key_prefix, item_size, item_count)
+            self.item_sizes.add(item_size)
+        return SharedMemory_.alloc_memory_item(memory_key_prefix)
+
+    def clear(self):
+        """Unlink all shared memory, the memory attached by other processes is still valid for them"""
+        for item_size in self.item_sizes:
+            SharedMemory_.delete_memory_buffer(f"{self.memory_key_prefix}_{item_size}")
+        self.item_sizes.clear()
+
+
+def _write_shm_value(shm_pool, value, shm_items):
+    """Copy numpy array and bytes to shared memory and return their descriptions, other values are pickled"""
+    if isinstance(value, np.ndarray) and value.dtype != np.object_:
+        shm_item = shm_pool.alloc(value.nbytes)
+        shm_items.append(shm_item)
+        np.copyto(np.ndarray(value.shape, value.dtype, buffer=shm_item.buffer), value)
+        return "array", shm_item.memory_key, shm_item.bytes_size, shm_item.offset, value.dtype.str, value.shape
+    if isinstance(value, bytes):
+        shm_item = shm_pool.alloc(len(value))
+        shm_items.append(shm_item)
+        shm_item.buffer[:len(value)] = np.frombuffer(value, np.uint8)
+        return "bytes", shm_item.memory_key, shm_item.bytes_size, shm_item.offset, len(value)
+    return "object", value
+
+
+def _read_shm_value(desc):
+    """Get value from the description returned by _write_shm_value, numpy array refers to the shared memory"""
+    if desc[0] == "array":
+        _, memory_key, bytes_size, offset, dtype, shape = desc
+        nbytes = int(np.prod(shape)) * np.dtype(dtype).itemsize
+        return np.ndarray(shape, dtype, buffer=SharedMemory_.attach(memory_key, bytes_size, offset, nbytes))
+    if desc[0] == "bytes":
+        _, memory_key, bytes_size, offset, size = desc
+        return SharedMemory_.attach(memory_key, bytes_size, offset, size).tobytes()
+    return desc[1]
+
+
+class _PyTaskResultCollector(PyTaskHandler):
+    """Run one task in helper process, and collect the results in order instead of pushing them to c++"""
+
+    def __init__(self, shm_pool, output_items):
+        super(_PyTaskResultCollector, self).__init__()
+        self.shm_pool = shm_pool
+        self.output_items = output_items
+        self.results = []
+
+    def push_failed(self, count, failed_msg):
+        self.results.append(("failed", count, failed_msg))
+
+    def push_system_failed(self, failed_msg):
+        self.results.append(("system_failed", failed_msg))
+
+    def push_result(self, instance_result):
+        shm_items = []
+        output = tuple(_write_shm_value(self.shm_pool, item, shm_items) for item in instance_result)
+        for shm_item in shm_items:
+            self.output_items[(shm_item.memory_key, shm_item.offset)] = shm_item
+        self.results.append(("result", output))
+
+
+def _py_stage_process_main(conn, other_conns):
+    """Main function of helper process, run the tasks sent by worker process one by one"""
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+    signal.signal(signal.SIGTERM, signal.SIG_DFL)
+    for item in other_conns:
+        item.close()
+    shm_pool = _ShmPool(f"serving_py_stage_{os.getpid()}")
+    output_items = {}
+    try:
+        while True:
+            try:
+                message = conn.recv()
+            except EOFError:
+                break
+            if message is None:
+                break
+            task, release_list = message
+            for key in release_list:
+                SharedMemory_.release_memory_item(output_items.pop(key))
+            collector = _PyTaskResultCollector(shm_pool, output_items)
+            fatal = False
+            try:
+                task.instance_list = tuple(tuple(_read_shm_value(desc) for desc in instance)
+                                           for instance in task.instance_list)
+                collector.run_inner(task)
+            except Exception as e:  # pylint: disable=broad-except
+                logger.error(f"py task catch exception and exit: {e}")
+                if not collector.results or collector.results[-1][0] != "system_failed":
+                    collector.results.append(("system_failed", str(e)))
+                fatal = True
+            try:
+                conn.send((collector.results, fatal))
+            except OSError:
+                break
+            except Exception as e:  # pylint: disable=broad-except
+                conn.send(([("system_failed", f"Send results of py task to worker failed: {e}")], True))
+    finally:
+        shm_pool.clear()
+        conn.close()
+
+
+class _PyStageProcess:
+    """Worker side of one helper process"""
+
+    def __init__(self, process, conn):
+        self.process = process
+        self.conn = conn
+        # outputs in shared memory of helper process to be released, sent with the next task
+        self.release_list = collections.deque()
+
+    def pop_release_list(self):
+        release_list = []
+        while self.release_list:
+            release_list.append(self.release_list.popleft())
+        return release_list
+
+
+class PyStageProcessPool:
+    """Helper processes running python stages, created before any thread of worker is started"""
+
+    def __init__(self, process_num):
+        ctx = multiprocessing.get_context("fork")
+        self.processes = []
+        parent_conns = []
+        for _ in range(process_num):
+            parent_conn, child_conn = ctx.Pipe()
+            parent_conns.append(parent_conn)
+            process = ctx.Process(target=_py_stage_process_main, args=(child_conn, list(parent_conns)), daemon=True)
+            process.start()
+            child_conn.close()
+            self.processes.append(_PyStageProcess(process, parent_conn))
+        self.next_index = 0
+
+    def next_process(self):
+        """Select helper process in turn, results are pushed in task order anyway"""
+        process = self.processes[self.next_index]
+        self.next_index = (self.next_index + 1) % len(self.processes)
+        return process
+
+    def stop(self):
+        """Notify helper processes to exit and wait for them"""
+        for item in self.processes:
+            try:
+                item.conn.send(None)
+            except (OSError, ValueError):
+                pass
+        for item in self.processes:
+            item.process.join(timeout=5)
+            if item.process.is_alive():
+                item.process.terminate()
+            item.conn.close()
+        self.processes = []
+
+
+class PyTaskProcessHandler(PyTaskHandler):
+    """Dispatch preprocess and postprocess to helper processes, and push the results to c++ in task order"""
+
+    def __init__(self, process_pool):
+        super(PyTaskProcessHandler, self).__init__()
+        self.process_pool = process_pool
+        self.shm_pool = _ShmPool(f"serving_py_stage_{os.getpid()}_worker")
+        # two tasks for each helper process, one is running and the other is waiting
+        self.task_slots = threading.Semaphore(2 * len(process_pool.processes))
+        self.pending_tasks = queue.Queue()
+
+    def run(self):
+        """Run tasks of preprocess and postprocess in helper processes"""
+        logger.info(f"start python task dispatching thread, helper process number "
+                    f"{len(self.process_pool.processes)}")
+        collect_thread = threading.Thread(target=self._collect_results)
+        collect_thread.start()
+        while True:
+            try:
+                if has_worker_stopped():
+                    logger.info("Worker has exited, exit python task dispatching thread")
+                    break
+                task = Worker_.get_py_task()
+                if task.has_stopped:
+                    logger.info("Worker has exited, exit python task dispatching thread")
+                    break
+                self._dispatch(task)
+            except Exception as e:  # pylint: disable=broad-except
+                logger.error(f"py task catch exception and exit: {e}")
+                logging.exception(e)
+                break
+        self.pending_tasks.put(None)
+        collect_thread.join()
+        _stop_py_stage_processes()
+        self.shm_pool.clear()
+        logger.info("end python task dispatching thread")
+        Worker_.stop_and_clear()
+
+    def _dispatch(self, task):
+        """Copy inputs to shared memory and send the task to one helper process"""
+        self.task_slots.acquire()
+        process = self.process_pool.next_process()
+        input_items = []
+        instance_list = tuple(tuple(_write_shm_value(self.shm_pool, item, input_items) for item in instance)
+                              for instance in task.instance_list)
+        task_desc = types.SimpleNamespace(task_name=task.task_name, method_name=task.method_name,
+                                          stage_index=task.stage_index, instance_list=instance_list)
+        self.pending_tasks.put((process, input_items))
+        process.conn.send((task_desc, process.pop_release_list()))
+
+    def _collect_results(self):
+        """Receive results of helper processes in task order and push them to c++"""
+        while True:
+            pending = self.pending_tasks.get()
+            if pending is None:
+                break
+            process, input_items = pending
+            try:
+                results, fatal = process.conn.recv()
+            except (EOFError, OSError) as e:
+                results, fatal = [("system_failed", f"Python stage helper process exited: {e}")], True
+            for shm_item in input_items:
+                SharedMemory_.release_memory_item(shm_item)
+            try:
+                self._push_results(process, results)
+            except ServingSystemException as e:
+                logger.error(f"py task handling catch exception: {e}")
+                PyTaskHandler.push_system_failed(e.msg)
+                fatal = True
+            self.task_slots.release()
+            if fatal:
+                logger.error("py task in helper process failed, exit python task handling")
+                Worker_.stop_and_clear()
+                break
+        # unblock the dispatching thread waiting for task slots
+        self.task_slots.release()
+
+    @staticmethod
+    def _push_results(process, results):
+        """Push results collected by helper process in order"""
+        for result in results:
+            if result[0] == "result":
+                outputs = []
+                for desc in result[1]:
+                    output = _read_shm_value(desc)
+                    if desc[0] == "array":
+                        # release the shared memory of helper process when c++ no longer refers to the output
+                        weakref.finalize(output, process.release_list.append, (desc[1], desc[3]))
+                    elif desc[0] == "bytes":
+                        process.release_list.append((desc[1], desc[3]))
+                    outputs.append(output)
+                PyTaskHandler.push_result(outputs)
+            elif result[0] == "failed":
+                PyTaskHandler.push_failed(result[1], result[2])
+            else:
+                PyTaskHandler.push_system_failed(result[1])
+
+
+_py_stage_process_pool = None
+
+
+def _start_py_stage_processes():
+    """Start helper processes of python stages, should be invoked before any thread of worker is started"""
+    global _py_stage_process_pool
+    process_num = stage_function_storage.py_stage_process_num
+    if process_num <= 0 or not stage_function_storage.function or _py_stage_process_pool is not None:
+        return
+    logger.info(f"Start {process_num} helper processes for python stages")
+    _py_stage_process_pool = PyStageProcessPool(process_num)
+
+
+def _stop_py_stage_processes():
+    """Stop helper processes of python stages"""
+    global _py_stage_process_pool
+    if _py_stage_process_pool is not None:
+        _py_stage_process_pool.stop()
+        _py_stage_process_pool = None
+
+
 def _start_py_task():
     """Start python thread for python task"""
     if Worker_.enable_pytask_que():
-        PyTaskHandler().run()
+        if _py_stage_process_pool is not None:
+            PyTaskProcessHandler(_py_stage_process_pool).run()
+        else:
+            PyTaskHandler().run()
     else:
+        _stop_py_stage_processes()
         Worker_.wait_and_clear()
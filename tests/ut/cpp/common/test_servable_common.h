@@ -27,6 +27,7 @@
 #include <utility>
 #include "common/common_test.h"
 #include "master/server.h"
+#include "common/proto_tensor.h"
 
 #define private public
 #include "worker/worker.h"
@@ -416,6 +417,23 @@ class TestMasterWorkerClient : public TestMasterWorker {
     PredictOnFinish callback = [promise]() { promise->set_value(); };
     impl.PredictAsync(&request, reply, callback);
     future.get();
+    // the request fails as a whole when one of its instances fails the input check, as replied by the master
+    std::vector<proto::ErrorMsg> errors(reply->error_msg().begin(), reply->error_msg().end());
+    auto status = GrpcTensorHelper::GetInstanceCheckError(errors);
+    if (status != SUCCESS) {
+      GrpcTensorHelper::CreateReplyFromErrorMsg(status, reply);
+    }
+    return grpc::Status::OK;
+  }
+  // the instances are forwarded serialized, as by the master in passthrough mode
+  static grpc::Status Dispatch(const proto::PassthroughPredictRequest &request, proto::PredictReply *reply) {
+    MSWorkerImpl impl;
+    proto::PredictRequest parsed_request;
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+    PredictOnFinish callback = [promise]() { promise->set_value(); };
+    impl.PredictAsync(&request, &parsed_request, reply, callback);
+    future.get();
     return grpc::Status::OK;
   }
 };
@@ -0,0 +1,240 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "common/tensor.h"
+#define private public
+#include "worker/model_loader_base.h"
+#include "worker/local_servable/local_model_loader.h"
+#undef private
+#include "worker/servable_register.h"
+
+namespace mindspore {
+namespace serving {
+// model with one input and one output of shape [batch_size, 2], counting its executions
+class TestBucketSession : public InferenceBase {
+ public:
+  explicit TestBucketSession(ssize_t batch_size, uint64_t subgraph_num = 1, DataType data_type = kMSI_Float32)
+      : batch_size_(batch_size), subgraph_num_(subgraph_num), data_type_(data_type) {}
+  Status LoadModelFromFile(DeviceType, uint32_t, const std::vector<std::string> &, ModelType, bool,
+                           const std::vector<int> &, const ModelContext &, const std::string &, const std::string &,
+                           const std::string &, bool) override {
+    return SUCCESS;
+  }
+  Status UnloadModel() override { return SUCCESS; }
+  Status ExecuteModel(const RequestBase &, ReplyBase *, bool, uint64_t) override { return FAILED; }
+  Status ExecuteModel(const std::vector<TensorBasePtr> &request, std::vector<TensorBasePtr> *reply, bool,
+                      uint64_t subgraph) override {
+    execute_count_++;
+    input_data_.clear();
+    for (auto &item : request) {
+      input_data_.push_back(item->data());
+    }
+    for (auto &info : GetOutputInfos(subgraph)) {
+      auto tensor = std::make_shared<Tensor>(info.data_type, info.shape, nullptr, info.size);
+      reply->push_back(tensor);
+    }
+    return SUCCESS;
+  }
+  std::vector<TensorInfo> GetInputInfos(uint64_t) const override {
+    TensorInfo info;
+    info.data_type = data_type_;
+    info.shape = {batch_size_, 2};
+    info.size = static_cast<size_t>(batch_size_) * 2 * sizeof(float);
+    return {info};
+  }
+  std::vector<TensorInfo> GetOutputInfos(uint64_t subgraph) const override { return GetInputInfos(subgraph); }
+  ssize_t GetBatchSize(uint64_t) const override { return batch_size_; }
+  bool CheckModelSupport(DeviceType, ModelType) const override { return true; }
+  uint64_t GetSubGraphNum() const override { return subgraph_num_; }
+  bool SupportReuseDevice() const override { return true; }
+  bool SupportMultiThreads() const override { return true; }
+
+  ssize_t batch_size_;
+  uint64_t subgraph_num_;
+  DataType data_type_;
+  uint64_t execute_count_ = 0;
+  std::vector<const uint8_t *> input_data_;
+};
+
+class TestBatchBucket : public UT::Common {
+ public:
+  TestBatchBucket() = default;
+
+  static ModelMeta CreateModelMeta(const std::vector<std::string> &model_files,
+                                   const std::vector<std::string> &batch_bucket_files) {
+    ModelMeta model_meta;
+    model_meta.common_meta.servable_name = "test_servable";
+    model_meta.common_meta.model_key = model_files.empty() ? "" : model_files[0];
+    model_meta.local_meta.model_files = model_files;
+    model_meta.local_meta.batch_bucket_files = batch_bucket_files;
+    model_meta.local_meta.model_format = kMindIR;
+    return model_meta;
+  }
+
+  // model of batch size 8 by default, with the batch buckets loaded
+  static void InitModelLoader(LocalModelLoader *model_loader, const std::vector<uint64_t> &bucket_batch_sizes,
+                              ssize_t model_batch_size = 8) {
+    model_loader->model_meta_ = CreateModelMeta({"model.mindir"}, {});
+    model_loader->model_meta_.local_meta.input_buffer_num = 1;
+    model_loader->model_session_ = std::make_shared<TestBucketSession>(model_batch_size);
+    model_loader->graph_num_ = 1;
+    LocalModelReplica replica;
+    replica.model_session = model_loader->model_session_;
+    for (auto batch_size : bucket_batch_sizes) {
+      replica.bucket_sessions[batch_size] = std::make_shared<TestBucketSession>(batch_size);
+    }
+    model_loader->replicas_.push_back(replica);
+    ASSERT_EQ(model_loader->AfterLoadModel().StatusCode(), SUCCESS);
+  }
+
+  static std::vector<InstanceData> CreateInstances(size_t count) {
+    std::vector<InstanceData> inputs;
+    for (size_t i = 0; i < count; i++) {
+      auto tensor = std::make_shared<Tensor>(kMSI_Float32, std::vector<int64_t>{2}, nullptr, 2 * sizeof(float));
+      inputs.push_back({tensor});
+    }
+    return inputs;
+  }
+};
+
+TEST_F(TestBatchBucket, test_declare_model_with_batch_bucket_files_success) {
+  ServableRegister servable_register;
+  auto status =
+    servable_register.DeclareModel(CreateModelMeta({"model.mindir"}, {"model_b2.mindir", "model_b4.mindir"}));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  auto &model_metas = servable_register.GetServableSignature().model_metas;
+  ASSERT_EQ(model_metas.size(), 1);
+  ASSERT_EQ(model_metas[0].local_meta.batch_bucket_files,
+            (std::vector<std::string>{"model_b2.mindir", "model_b4.mindir"}));
+}
+
+TEST_F(TestBatchBucket, test_declare_model_with_invalid_batch_bucket_files_failed) {
+  {
+    ServableRegister servable_register;
+    auto status = servable_register.DeclareModel(CreateModelMeta({"model.mindir"}, {""}));
+    ASSERT_NE(status.StatusCode(), SUCCESS);
+    ASSERT_NE(status.StatusMessage().find("batch bucket file cannot be empty"), std::string::npos);
+  }
+  {
+    ServableRegister servable_register;
+    auto status = servable_register.DeclareModel(CreateModelMeta({"model.mindir"}, {"model.mindir"}));
+    ASSERT_NE(status.StatusCode(), SUCCESS);
+    ASSERT_NE(status.StatusMessage().find("has already been used"), std::string::npos);
+  }
+  {
+    ServableRegister servable_register;
+    auto status =
+      servable_register.DeclareModel(CreateModelMeta({"model.mindir"}, {"model_b2.mindir", "model_b2.mindir"}));
+    ASSERT_NE(status.StatusCode(), SUCCESS);
+    ASSERT_NE(status.StatusMessage().find("has already been used"), std::string::npos);
+  }
+  {
+    ServableRegister servable_register;
+    auto status =
+      servable_register.DeclareModel(CreateModelMeta({"model_a.mindir", "model_b.mindir"}, {"model_b2.mindir"}));
+    ASSERT_NE(status.StatusCode(), SUCCESS);
+    ASSERT_NE(status.StatusMessage().find("only supported by model of one file"), std::string::npos);
+  }
+}
+
+TEST_F(TestBatchBucket, test_pick_smallest_fit_bucket_success) {
+  LocalModelLoader model_loader;
+  InitModelLoader(&model_loader, {2, 4});
+  ASSERT_EQ(model_loader.GetBatchBuckets(), (std::vector<uint64_t>{2, 4}));
+  // input batch size: batch size executed
+  std::vector<std::pair<size_t, uint64_t>> expected = {{1, 2}, {2, 2}, {3, 4}, {4, 4}, {5, 8}, {8, 8}};
+  for (auto &item : expected) {
+    const ModelExecutorSubgraphInfo *subgraph_info = nullptr;
+    uint64_t batch_size = 0;
+    ASSERT_EQ(model_loader.GetSubgraphExecuteInfo(item.first, 0, 0, 0, &subgraph_info, &batch_size).StatusCode(),
+              SUCCESS);
+    ASSERT_EQ(batch_size, item.second);
+    ASSERT_EQ(model_loader.GetExecuteBatchSize(item.first), item.second);
+    ASSERT_EQ(subgraph_info->input_infos[0].shape[0], static_cast<int64_t>(item.second));
+    ASSERT_EQ(subgraph_info->input_buffers[0]->data_size(), item.second * 2 * sizeof(float));
+  }
+  // the instances are run by the session of the bucket picked
+  auto inputs = CreateInstances(3);
+  ASSERT_EQ(model_loader.AssembleBatch(inputs, 0, 0, 0).StatusCode(), SUCCESS);
+  std::vector<ResultInstance> outputs;
+  ASSERT_EQ(model_loader.ExecuteBatch(inputs, &outputs, 0, 0, 0).StatusCode(), SUCCESS);
+  ASSERT_EQ(outputs.size(), 3);
+  auto &bucket_sessions = model_loader.replicas_[0].bucket_sessions;
+  ASSERT_EQ(std::static_pointer_cast<TestBucketSession>(bucket_sessions[2])->execute_count_, 0);
+  ASSERT_EQ(std::static_pointer_cast<TestBucketSession>(bucket_sessions[4])->execute_count_, 1);
+  ASSERT_EQ(std::static_pointer_cast<TestBucketSession>(model_loader.model_session_)->execute_count_, 0);
+}
+
+TEST_F(TestBatchBucket, test_batch_larger_than_all_buckets_success) {
+  LocalModelLoader model_loader;
+  InitModelLoader(&model_loader, {2, 4});
+  // run by the model of the full batch size
+  auto inputs = CreateInstances(6);
+  ASSERT_EQ(model_loader.AssembleBatch(inputs, 0, 0, 0).StatusCode(), SUCCESS);
+  std::vector<ResultInstance> outputs;
+  ASSERT_EQ(model_loader.ExecuteBatch(inputs, &outputs, 0, 0, 0).StatusCode(), SUCCESS);
+  ASSERT_EQ(outputs.size(), 6);
+  ASSERT_EQ(std::static_pointer_cast<TestBucketSession>(model_loader.model_session_)->execute_count_, 1);
+  // larger than the model batch size
+  ASSERT_NE(model_loader.AssembleBatch(CreateInstances(9), 0, 0, 0).StatusCode(), SUCCESS);
+}
+
+TEST_F(TestBatchBucket, test_batch_one_model_input_without_copy_success) {
+  LocalModelLoader model_loader;
+  InitModelLoader(&model_loader, {}, 1);
+  auto inputs = CreateInstances(1);
+  ASSERT_EQ(model_loader.AssembleBatch(inputs, 0, 0, 0).StatusCode(), SUCCESS);
+  std::vector<ResultInstance> outputs;
+  ASSERT_EQ(model_loader.ExecuteBatch(inputs, &outputs, 0, 0, 0).StatusCode(), SUCCESS);
+  ASSERT_EQ(outputs.size(), 1);
+  // no input buffer is created for batch 1, the model gets the data of the instance
+  ASSERT_TRUE(model_loader.model_infos_[0].sub_graph_infos[0].input_buffers.empty());
+  auto session = std::static_pointer_cast<TestBucketSession>(model_loader.model_session_);
+  ASSERT_EQ(session->execute_count_, 1);
+  ASSERT_EQ(session->input_data_, (std::vector<const uint8_t *>{inputs[0][0]->data()}));
+}
+
+TEST_F(TestBatchBucket, test_check_invalid_batch_bucket_failed) {
+  LocalModelLoader model_loader;
+  InitModelLoader(&model_loader, {2});
+  auto &replica = model_loader.replicas_[0];
+  ASSERT_EQ(model_loader.CheckBatchBucket("model_b4.mindir", std::make_shared<TestBucketSession>(4), 4, replica)
+              .StatusCode(),
+            SUCCESS);
+  // not less than the model batch size
+  ASSERT_NE(model_loader.CheckBatchBucket("model_b8.mindir", std::make_shared<TestBucketSession>(8), 8, replica)
+              .StatusCode(),
+            SUCCESS);
+  // the same batch size as another bucket
+  ASSERT_NE(model_loader.CheckBatchBucket("model_b2.mindir", std::make_shared<TestBucketSession>(2), 2, replica)
+              .StatusCode(),
+            SUCCESS);
+  // different subgraph count
+  ASSERT_NE(model_loader.CheckBatchBucket("model_b4.mindir", std::make_shared<TestBucketSession>(4, 2), 4, replica)
+              .StatusCode(),
+            SUCCESS);
+  // different inputs
+  ASSERT_NE(model_loader
+              .CheckBatchBucket("model_b4.mindir", std::make_shared<TestBucketSession>(4, 1, kMSI_Int32), 4, replica)
+              .StatusCode(),
+            SUCCESS);
+}
+}  // namespace serving
+}  // namespace mindspore
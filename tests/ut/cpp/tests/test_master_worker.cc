@@ -411,6 +411,39 @@ TEST_F(TestMasterWorkerClient, test_master_worker_three_instance_one_input_inval
   ExpectContainMsg(reply.error_msg(0).error_msg(), "Cannot find input x2 in instance input");
 }
 
+TEST_F(TestMasterWorkerClient, test_master_worker_three_instance_one_instance_malformed_failed) {
+  Init("test_servable_dir", "test_servable", 1, "test_add.mindir");
+  RegisterAddServable();
+
+  // start_servable
+  StartAddServable();
+
+  // run servable
+  proto::PredictRequest request;
+  size_t instances_count = 3;
+  auto y_data_list = InitMultiInstancesRequest(&request, servable_name_, "add_common", 0, instances_count);
+  // the instances are forwarded serialized by the master, instance 1 cannot be parsed
+  proto::PassthroughPredictRequest passthrough_request;
+  ASSERT_TRUE(passthrough_request.ParseFromString(request.SerializeAsString()));
+  passthrough_request.set_instances(1, "\x0a\xff\xff");
+
+  proto::PredictReply reply;
+  auto grpc_status = Dispatch(passthrough_request, &reply);
+  EXPECT_TRUE(grpc_status.ok());
+  // checkout output, only the malformed instance fails in the batch, the master fails the request it comes from
+  ASSERT_EQ(reply.error_msg_size(), instances_count);
+  ASSERT_EQ(reply.instances_size(), instances_count);
+  ASSERT_EQ(reply.error_msg(1).error_code(), INVALID_INSTANCE);
+  ExpectContainMsg(reply.error_msg(1).error_msg(), "Parse instance 1 of request failed");
+  for (size_t k : {0, 2}) {
+    ASSERT_EQ(reply.error_msg(k).error_code(), SUCCESS);
+    auto &output_items = reply.instances(k).items();
+    ASSERT_EQ(output_items.size(), 1);
+    CheckTensor(output_items.at("y"), {2, 2}, proto::MS_FLOAT32, y_data_list[k].data(),
+                y_data_list[k].size() * sizeof(float));
+  }
+}
+
 TEST_F(TestMasterWorkerClient, test_master_worker_extra_input_success) {
   Init("test_servable_dir", "test_servable", 1, "test_add.mindir");
   RegisterAddServable();
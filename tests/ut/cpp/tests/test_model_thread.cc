@@ -13,12 +13,17 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <thread>
 #include "common/common_test.h"
-#include "master/server.h"
 #include "common/tensor_base.h"
 #define private public
 #include "master/model_thread.h"
 #undef private
+#include "master/server.h"
+#include "common/proto_tensor.h"
 
 using std::string;
 using std::vector;
@@ -33,32 +38,50 @@ class MS_API TestNotify : public BaseNotifyWorker {
  public:
   explicit TestNotify(proto::PredictReply *reply) {
     if (reply) {
-      reply_ = *reply;
+      // the same wire format
+      (void)reply_.ParseFromString(reply->SerializeAsString());
     }
   }
   ~TestNotify() override = default;
 
-  Status DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
+  Status DispatchAsync(const proto::PassthroughPredictRequest &request, proto::PassthroughPredictReply *reply,
                        const PredictOnFinish &on_finish) override;
 
-  proto::PredictReply reply_;
+  proto::PassthroughPredictRequest request_;
+  std::vector<int> request_instance_counts_;
+  // replies are held and finished by the test, instead of in DispatchAsync
+  bool hold_reply_ = false;
+  std::vector<PredictOnFinish> held_replies_;
+  proto::PassthroughPredictReply reply_;
 };
 
-Status TestNotify::DispatchAsync(const proto::PredictRequest &request, proto::PredictReply *reply,
-                                 const PredictOnFinish &on_finish) {
+Status TestNotify::DispatchAsync(const proto::PassthroughPredictRequest &request,
+                                 proto::PassthroughPredictReply *reply, const PredictOnFinish &on_finish) {
+  request_ = request;
+  request_instance_counts_.push_back(request.instances_size());
   *reply = reply_;
+  if (hold_reply_) {
+    held_replies_.push_back(on_finish);
+    return SUCCESS;
+  }
   on_finish();
   return SUCCESS;
 }
 
-std::shared_ptr<WorkerContext> InitWorkerContext(proto::PredictReply *reply = nullptr) {
+std::shared_ptr<WorkerContext> InitWorkerContext(proto::PredictReply *reply = nullptr,
+                                                 std::shared_ptr<TestNotify> *test_notify = nullptr,
+                                                 uint64_t batch_size = 1, uint64_t capacity_weight = 0) {
   std::shared_ptr<WorkerContext> worker_context = std::make_shared<WorkerContext>();
-  std::shared_ptr<BaseNotifyWorker> notify = std::make_shared<TestNotify>(reply);
+  auto notify = std::make_shared<TestNotify>(reply);
+  if (test_notify) {
+    *test_notify = notify;
+  }
   WorkerRegSpec spec;
   spec.worker_pid = 1;
   spec.servable_spec.servable_name = "test_servable";
   spec.servable_spec.version_number = 1;
-  spec.servable_spec.batch_size = 1;
+  spec.servable_spec.batch_size = batch_size;
+  spec.servable_spec.capacity_weight = capacity_weight;
   spec.servable_spec.methods.push_back(ServableMethodInfo{"add_cast", {}});
   worker_context->OnWorkerRegRequest(spec, notify);
   return worker_context;
@@ -169,5 +192,579 @@ TEST_F(TestModelThead, Commit) {
   status = thread.DelWorker(pid);
   ASSERT_EQ(status.StatusCode(), SUCCESS);
 }
+
+proto::Instance CreateTestInstance(const std::string &name, float value) {
+  proto::Instance instance;
+  auto &tensor = (*instance.mutable_items())[name];
+  tensor.set_dtype(proto::MS_FLOAT32);
+  tensor.mutable_shape()->add_dims(1);
+  tensor.set_data(&value, sizeof(value));
+  return instance;
+}
+
+TEST_F(TestModelThead, DispatchForwardSerializedInstances) {
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  method_info.input_names = {"x"};
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  proto::PredictReply worker_reply;
+  *worker_reply.add_instances() = CreateTestInstance("y", 2.0f);
+  std::shared_ptr<TestNotify> notify;
+  Status status = thread.AddWorker(1, InitWorkerContext(&worker_reply, &notify));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+
+  proto::PredictRequest request;
+  request.mutable_servable_spec()->set_name("test_servable");
+  request.mutable_servable_spec()->set_method_name("add_cast");
+  *request.add_instances() = CreateTestInstance("x", 1.0f);
+  proto::PredictReply reply;
+  bool flag = false;
+  status = thread.DispatchAsync(request, &reply, [&flag]() { flag = true; });
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  ASSERT_TRUE(flag);
+  ASSERT_EQ(notify->request_.instances_size(), 1);
+  ASSERT_EQ(notify->request_.instances(0), request.instances(0).SerializeAsString());
+  ASSERT_EQ(reply.error_msg_size(), 0);
+  ASSERT_EQ(reply.instances_size(), 1);
+  ASSERT_EQ(reply.instances(0).SerializeAsString(), worker_reply.instances(0).SerializeAsString());
+}
+
+TEST_F(TestModelThead, DispatchPassthrough) {
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  method_info.input_names = {"x"};
+  ModelThread thread("test_servable", "add_cast", 0, 2, method_info);
+  proto::PredictReply worker_reply;
+  *worker_reply.add_instances() = CreateTestInstance("y", 2.0f);
+  *worker_reply.add_instances() = CreateTestInstance("y", 3.0f);
+  std::shared_ptr<TestNotify> notify;
+  Status status = thread.AddWorker(1, InitWorkerContext(&worker_reply, &notify, 2));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+
+  proto::PassthroughPredictRequest request;
+  request.mutable_servable_spec()->set_name("test_servable");
+  request.mutable_servable_spec()->set_method_name("add_cast");
+  // instances are forwarded without decoding
+  request.add_instances(CreateTestInstance("x", 1.0f).SerializeAsString());
+  request.add_instances(CreateTestInstance("x", 4.0f).SerializeAsString());
+  proto::PassthroughPredictReply reply;
+  bool flag = false;
+  status = thread.DispatchAsync(request, &reply, [&flag]() { flag = true; });
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  ASSERT_TRUE(flag);
+  ASSERT_EQ(notify->request_.instances_size(), 2);
+  ASSERT_EQ(notify->request_.instances(0), request.instances(0));
+  ASSERT_EQ(notify->request_.instances(1), request.instances(1));
+  ASSERT_EQ(reply.error_msg_size(), 0);
+  ASSERT_EQ(reply.instances_size(), 2);
+  ASSERT_EQ(reply.instances(1), worker_reply.instances(1).SerializeAsString());
+  // the same wire format as PredictReply
+  proto::PredictReply client_reply;
+  ASSERT_TRUE(client_reply.ParseFromString(reply.SerializeAsString()));
+  ASSERT_EQ(client_reply.instances_size(), 2);
+  ASSERT_EQ(client_reply.instances(0).items().at("y").data().size(), sizeof(float));
+}
+
+TEST_F(TestModelThead, DispatchPassthroughRejectInvalidInstance) {
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  method_info.input_names = {"x"};
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  proto::PredictReply worker_reply;
+  *worker_reply.add_instances() = CreateTestInstance("y", 2.0f);
+  std::shared_ptr<TestNotify> notify;
+  Status status = thread.AddWorker(1, InitWorkerContext(&worker_reply, &notify, 1));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  notify->hold_reply_ = true;
+
+  auto create_request = [](const std::vector<std::string> &instances) {
+    proto::PassthroughPredictRequest request;
+    request.mutable_servable_spec()->set_name("test_servable");
+    request.mutable_servable_spec()->set_method_name("add_cast");
+    for (auto &instance : instances) {
+      request.add_instances(instance);
+    }
+    return request;
+  };
+  auto valid_instance = CreateTestInstance("x", 1.0f).SerializeAsString();
+  auto request1 = create_request({valid_instance});
+  // a malformed instance, and an instance without the input x
+  auto request2 = create_request({valid_instance, "not an instance"});
+  auto request3 = create_request({CreateTestInstance("z", 1.0f).SerializeAsString()});
+  auto request4 = create_request({valid_instance});
+  proto::PassthroughPredictReply reply1;
+  proto::PassthroughPredictReply reply2;
+  proto::PassthroughPredictReply reply3;
+  proto::PassthroughPredictReply reply4;
+  status = thread.DispatchAsync(request1, &reply1, []() {});
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  // rejected with their own requests, before they are batched with the other requests
+  status = thread.DispatchAsync(request2, &reply2, []() {});
+  ASSERT_EQ(status.StatusCode(), INVALID_INPUTS);
+  status = thread.DispatchAsync(request3, &reply3, []() {});
+  ASSERT_EQ(status.StatusCode(), INVALID_INPUTS);
+  ASSERT_TRUE(status.StatusMessage().find("Cannot find input x") != std::string::npos);
+  status = thread.DispatchAsync(request4, &reply4, []() {});
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.job_.size(), 2);
+
+  // the valid requests are sent to the worker and replied, the worker is still registered
+  for (size_t i = 0; i < notify->held_replies_.size(); i++) {
+    auto on_finish = notify->held_replies_[i];  // the next batch is held while replying
+    on_finish();
+  }
+  ASSERT_EQ(reply1.error_msg_size(), 0);
+  ASSERT_EQ(reply1.instances_size(), 1);
+  ASSERT_EQ(reply4.error_msg_size(), 0);
+  ASSERT_EQ(reply4.instances_size(), 1);
+  ASSERT_EQ(thread.job_.size(), 0);
+  ASSERT_EQ(thread.pid_process_.size(), 1);
+  ASSERT_EQ(thread.pid_process_.count(1), 1);
+}
+
+TEST_F(TestModelThead, ReplyInstanceCheckErrorForWholeRequest) {
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  method_info.input_names = {"x"};
+  ModelThread thread("test_servable", "add_cast", 0, 3, method_info);
+  proto::PredictReply worker_reply;
+  *worker_reply.add_instances() = CreateTestInstance("y", 2.0f);
+  std::shared_ptr<TestNotify> notify;
+  Status status = thread.AddWorker(1, InitWorkerContext(&worker_reply, &notify, 3));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  notify->hold_reply_ = true;
+
+  auto create_request = [](size_t instances_count) {
+    proto::PredictRequest request;
+    request.mutable_servable_spec()->set_name("test_servable");
+    request.mutable_servable_spec()->set_method_name("add_cast");
+    for (size_t i = 0; i < instances_count; i++) {
+      *request.add_instances() = CreateTestInstance("x", 1.0f);
+    }
+    return request;
+  };
+  // request 0 is sent alone, and request 1 and 2 wait to be sent in one batch
+  auto request0 = create_request(1);
+  auto request1 = create_request(1);
+  auto request2 = create_request(2);
+  proto::PredictReply reply0;
+  proto::PredictReply reply1;
+  proto::PredictReply reply2;
+  ASSERT_EQ(thread.DispatchAsync(request0, &reply0, []() {}).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.DispatchAsync(request1, &reply1, []() {}).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.DispatchAsync(request2, &reply2, []() {}).StatusCode(), SUCCESS);
+  ASSERT_EQ(notify->held_replies_.size(), 1);
+  // the last instance of the batch, which is instance 1 of request 2, fails the input check in the worker
+  notify->reply_.add_instances(CreateTestInstance("y", 3.0f).SerializeAsString());
+  notify->reply_.add_instances();
+  for (auto code : {SUCCESS, SUCCESS, INVALID_INSTANCE}) {
+    auto error_msg = notify->reply_.add_error_msg();
+    error_msg->set_error_code(code);
+    error_msg->set_error_msg(code == SUCCESS ? "" : "Cannot find input x in instance input");
+  }
+  notify->held_replies_[0]();
+  ASSERT_EQ(notify->request_.instances_size(), 3);
+  ASSERT_EQ(notify->held_replies_.size(), 2);
+  notify->held_replies_[1]();
+  ASSERT_EQ(reply0.error_msg_size(), 0);
+  ASSERT_EQ(reply1.error_msg_size(), 0);
+  ASSERT_EQ(reply1.instances_size(), 1);
+  // request 2 fails as a whole with the error of its invalid instance
+  ASSERT_EQ(reply2.instances_size(), 0);
+  ASSERT_EQ(reply2.error_msg_size(), 1);
+  ASSERT_EQ(reply2.error_msg(0).error_code(), INVALID_INPUTS);
+  ASSERT_EQ(reply2.error_msg(0).error_msg(), "Cannot find input x in instance input");
+  ASSERT_EQ(thread.pid_process_.count(1), 1);
+}
+
+void AddTestWorkers(ModelThread *thread, uint64_t worker_num) {
+  for (uint64_t pid = 1; pid <= worker_num; pid++) {
+    ASSERT_EQ(thread->AddWorker(pid, InitWorkerContext()).StatusCode(), SUCCESS);
+    // start with the initial window, instead of one batch to probe the min latency
+    thread->worker_stats_[pid].min_latency_probing = false;
+  }
+}
+
+std::vector<uint64_t> FindTestWorkers(ModelThread *thread, size_t count) {
+  std::vector<uint64_t> pids;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t pid = 0;
+    if (thread->FindProcessQueue(&pid) != SUCCESS) {
+      break;
+    }
+    pids.push_back(pid);
+  }
+  return pids;
+}
+
+TEST_F(TestModelThead, FindWorkerLeastExpectedCompletionTime) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 2);
+  auto now = std::chrono::steady_clock::now();
+  thread.UpdateWorkerStats(1, 100, false, now);
+  thread.UpdateWorkerStats(2, 250, false, now);
+  // expected completion time of worker 1: 100, 200, 300 and 400 with more batches queued, 250 of worker 2
+  ASSERT_EQ(FindTestWorkers(&thread, 4), (std::vector<uint64_t>{1, 1, 2, 1}));
+  ASSERT_EQ(thread.worker_stats_[1].inflight, 3);
+  ASSERT_EQ(thread.worker_stats_[2].inflight, 1);
+}
+
+TEST_F(TestModelThead, FindWorkerRoundRobinWithoutLatency) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 3);
+  ASSERT_EQ(FindTestWorkers(&thread, 4), (std::vector<uint64_t>{1, 2, 3, 1}));
+}
+
+TEST_F(TestModelThead, EjectSlowWorkerAndReadmitAfterProbe) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 3);
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 8; i++) {
+    thread.UpdateWorkerStats(1, 1000, false, now);
+    thread.UpdateWorkerStats(2, 1200, false, now);
+    thread.UpdateWorkerStats(3, 10000, false, now);
+  }
+  ASSERT_FALSE(thread.worker_stats_[1].ejected);
+  ASSERT_FALSE(thread.worker_stats_[2].ejected);
+  ASSERT_TRUE(thread.worker_stats_[3].ejected);
+  // all the free slots of worker 1 and 2 are used, and worker 3 gets no batch
+  auto pids = FindTestWorkers(&thread, 10);
+  ASSERT_EQ(pids.size(), 6);
+  ASSERT_EQ(std::count(pids.begin(), pids.end(), 3), 0);
+
+  // one probe batch after the ejection expires, the worker is ejected again for double time as it is still slow
+  thread.worker_stats_[3].readmit_time = now;
+  ASSERT_EQ(FindTestWorkers(&thread, 2), (std::vector<uint64_t>{3}));
+  thread.UpdateWorkerStats(3, 10000, false, now);
+  ASSERT_TRUE(thread.worker_stats_[3].ejected);
+  ASSERT_EQ(thread.worker_stats_[3].readmit_time, now + std::chrono::milliseconds(2000));
+  ASSERT_EQ(FindTestWorkers(&thread, 1).size(), 0);
+
+  thread.worker_stats_[3].readmit_time = now;
+  ASSERT_EQ(FindTestWorkers(&thread, 1), (std::vector<uint64_t>{3}));
+  thread.UpdateWorkerStats(3, 1100, false, now);
+  ASSERT_FALSE(thread.worker_stats_[3].ejected);
+  ASSERT_EQ(thread.worker_stats_[3].latency_us, 1100);
+}
+
+TEST_F(TestModelThead, EjectFailedWorkerKeepLastWorker) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 2);
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 8; i++) {
+    thread.UpdateWorkerStats(1, 1000, true, now);
+    thread.UpdateWorkerStats(2, 1000, true, now);
+  }
+  // worker 1 is ejected first, and worker 2 is kept as the last admitted worker
+  ASSERT_TRUE(thread.worker_stats_[1].ejected);
+  ASSERT_FALSE(thread.worker_stats_[2].ejected);
+  ASSERT_EQ(FindTestWorkers(&thread, 10), (std::vector<uint64_t>{2, 2, 2}));
+}
+
+TEST_F(TestModelThead, RpcInvalidArgumentCountedAsWorkerFailure) {
+  ASSERT_EQ(MSPredictClient::GetRpcErrorCode(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "")), SYSTEM_ERROR);
+  ASSERT_EQ(MSPredictClient::GetRpcErrorCode(grpc::Status(grpc::StatusCode::INTERNAL, "")), WORKER_UNAVAILABLE);
+  ASSERT_EQ(MSPredictClient::GetRpcErrorCode(grpc::Status(grpc::StatusCode::UNAVAILABLE, "")), WORKER_UNAVAILABLE);
+
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  method_info.input_names = {"x"};
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  // the reply of the rpc rejected for its argument
+  proto::PredictReply worker_reply;
+  auto error_msg = worker_reply.add_error_msg();
+  error_msg->set_error_code(SYSTEM_ERROR);
+  error_msg->set_error_msg("rpc failed");
+  Status status = thread.AddWorker(1, InitWorkerContext(&worker_reply));
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+
+  proto::PredictRequest request;
+  request.mutable_servable_spec()->set_name("test_servable");
+  request.mutable_servable_spec()->set_method_name("add_cast");
+  *request.add_instances() = CreateTestInstance("x", 1.0f);
+  proto::PredictReply reply;
+  status = thread.DispatchAsync(request, &reply, []() {});
+  ASSERT_EQ(status.StatusCode(), SUCCESS);
+  ASSERT_EQ(reply.error_msg_size(), 1);
+  ASSERT_EQ(reply.error_msg(0).error_code(), SYSTEM_ERROR);
+  // the worker stays registered, and the failure is counted in its stats
+  ASSERT_EQ(thread.pid_process_.count(1), 1);
+  ASSERT_GT(thread.worker_stats_[1].error_rate, 0);
+}
+
+TEST_F(TestModelThead, DelLastAdmittedWorkerReadmitEjectedWorker) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 3);
+  auto now = std::chrono::steady_clock::now();
+  // worker 3 is ejected after worker 2, and its ejection ends later
+  thread.EjectWorker(2, &thread.worker_stats_[2], now);
+  thread.EjectWorker(3, &thread.worker_stats_[3], now + std::chrono::milliseconds(100));
+  ASSERT_EQ(FindTestWorkers(&thread, 10), (std::vector<uint64_t>{1, 1, 1}));
+  thread.worker_stats_[1].inflight = 0;
+  ASSERT_EQ(thread.DelWorker(1).StatusCode(), SUCCESS);
+  // the tasks are sent to worker 2 at once, instead of waiting for its ejection to end
+  ASSERT_FALSE(thread.worker_stats_[2].ejected);
+  ASSERT_TRUE(thread.worker_stats_[3].ejected);
+  ASSERT_EQ(FindTestWorkers(&thread, 10), (std::vector<uint64_t>{2, 2, 2}));
+}
+
+// the simulated worker runs the batches one by one, the batches are queued in the worker when the batches in flight
+// take longer than one round trip. return the window after reply_num replies
+double SimulateWorkerWindow(double network_us, double service_us, size_t reply_num) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  (void)thread.AddWorker(1, InitWorkerContext());
+  auto &stats = thread.worker_stats_[1];
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < reply_num; i++) {
+    (void)FindTestWorkers(&thread, 100);
+    auto inflight = static_cast<double>(stats.inflight);
+    auto latency_us = std::max(network_us + service_us, service_us * inflight);
+    now += std::chrono::microseconds(static_cast<int64_t>(std::max(service_us, latency_us / inflight)));
+    auto send_time = now - std::chrono::microseconds(static_cast<int64_t>(latency_us));
+    thread.AdjustWorkerWindow(&stats, latency_us, false, send_time, now);
+    thread.UpdateWorkerStats(1, latency_us, false, now);
+  }
+  return stats.window;
+}
+
+TEST_F(TestModelThead, WorkerWindowFollowLatency) {
+  // the window grows to hide the network latency of a remote worker, and keeps small for a local worker
+  auto remote_window = SimulateWorkerWindow(20000, 1000, 2000);
+  auto local_window = SimulateWorkerWindow(100, 1000, 2000);
+  MSI_LOG_INFO << "Window of remote worker " << remote_window << ", local worker " << local_window;
+  ASSERT_GE(remote_window, 15);
+  ASSERT_LE(remote_window, 40);
+  ASSERT_LE(local_window, 3);
+}
+
+TEST_F(TestModelThead, WorkerWindowDecreaseOncePerRoundTrip) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  AddTestWorkers(&thread, 1);
+  auto &stats = thread.worker_stats_[1];
+  ASSERT_EQ(stats.window, 3);
+  auto now = std::chrono::steady_clock::now();
+  auto send_time = now - std::chrono::milliseconds(1);
+  thread.AdjustWorkerWindow(&stats, 1000, true, send_time, now);
+  ASSERT_EQ(stats.window, 2.25);
+  // the batch is sent before the last decrease
+  thread.AdjustWorkerWindow(&stats, 1000, true, send_time, now + std::chrono::milliseconds(1));
+  ASSERT_EQ(stats.window, 2.25);
+  thread.AdjustWorkerWindow(&stats, 1000, true, now + std::chrono::milliseconds(1), now + std::chrono::milliseconds(2));
+  ASSERT_EQ(stats.window, 1.6875);
+  for (size_t i = 0; i < 4; i++) {
+    now += std::chrono::milliseconds(10);
+    thread.AdjustWorkerWindow(&stats, 1000, true, now, now + std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(stats.window, 1);
+}
+
+TEST_F(TestModelThead, DispatchChunksOfWorkerBatchSize) {
+  ServableMethodInfo method_info;
+  method_info.name = "add_cast";
+  ModelThread thread("test_servable", "add_cast", 0, 8, method_info);
+  std::shared_ptr<TestNotify> cpu_notify;
+  std::shared_ptr<TestNotify> large_notify;
+  ASSERT_EQ(thread.AddWorker(1, InitWorkerContext(nullptr, &cpu_notify, 8)).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.AddWorker(2, InitWorkerContext(nullptr, &large_notify, 64)).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.worker_stats_[2].capacity_weight, 64);
+  cpu_notify->hold_reply_ = true;
+  large_notify->hold_reply_ = true;
+
+  proto::PassthroughPredictRequest request;
+  request.mutable_servable_spec()->set_name("test_servable");
+  request.mutable_servable_spec()->set_method_name("add_cast");
+  for (size_t i = 0; i < 200; i++) {
+    request.add_instances(CreateTestInstance("x", 1.0f).SerializeAsString());
+  }
+  proto::PassthroughPredictReply reply;
+  ASSERT_EQ(thread.DispatchAsync(request, &reply, []() {}).StatusCode(), SUCCESS);
+  std::vector<PredictOnFinish> replies;
+  do {
+    replies.clear();
+    replies.swap(cpu_notify->held_replies_);
+    replies.insert(replies.end(), large_notify->held_replies_.begin(), large_notify->held_replies_.end());
+    large_notify->held_replies_.clear();
+    for (auto &on_finish : replies) {
+      on_finish();
+    }
+  } while (!replies.empty());
+  auto &cpu_counts = cpu_notify->request_instance_counts_;
+  auto &large_counts = large_notify->request_instance_counts_;
+  ASSERT_FALSE(cpu_counts.empty());
+  ASSERT_FALSE(large_counts.empty());
+  ASSERT_TRUE(std::all_of(cpu_counts.begin(), cpu_counts.end(), [](int count) { return count <= 8; }));
+  ASSERT_TRUE(std::all_of(large_counts.begin(), large_counts.end(), [](int count) { return count <= 64; }));
+  ASSERT_EQ(large_counts[0], 64);
+  ASSERT_EQ(std::accumulate(cpu_counts.begin(), cpu_counts.end(), 0) +
+              std::accumulate(large_counts.begin(), large_counts.end(), 0),
+            200);
+}
+
+TEST_F(TestModelThead, FindWorkerByCapacityWeight) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  ASSERT_EQ(thread.AddWorker(1, InitWorkerContext(nullptr, nullptr, 1, 1)).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.AddWorker(2, InitWorkerContext(nullptr, nullptr, 1, 3)).StatusCode(), SUCCESS);
+  thread.worker_stats_[1].min_latency_probing = false;
+  thread.worker_stats_[2].min_latency_probing = false;
+  auto now = std::chrono::steady_clock::now();
+  thread.UpdateWorkerStats(1, 100, false, now);
+  thread.UpdateWorkerStats(2, 100, false, now);
+  // worker 2 gets three times of the batches with the same latency, until its window of 3 batches is full
+  ASSERT_EQ(FindTestWorkers(&thread, 6), (std::vector<uint64_t>{2, 2, 1, 2, 1, 1}));
+}
+
+TEST_F(TestModelThead, NotEjectWorkerOfLargerBatch) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 8, method_info);
+  ASSERT_EQ(thread.AddWorker(1, InitWorkerContext(nullptr, nullptr, 8)).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.AddWorker(2, InitWorkerContext(nullptr, nullptr, 8)).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.AddWorker(3, InitWorkerContext(nullptr, nullptr, 64, 16)).StatusCode(), SUCCESS);
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 8; i++) {
+    thread.UpdateWorkerStats(1, 1000, false, now);
+    thread.UpdateWorkerStats(2, 1000, false, now);
+    // twice the capacity per instance of batch 8 workers, the latency of a batch of 64 is 4 times of theirs
+    thread.UpdateWorkerStats(3, 4000, false, now);
+  }
+  ASSERT_FALSE(thread.worker_stats_[3].ejected);
+  ASSERT_EQ(thread.GetMedianLatency(0), 1000);
+}
+
+TEST_F(TestModelThead, DispatchHigherPriorityFirst) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 4, method_info);
+  std::shared_ptr<TestNotify> notify;
+  ASSERT_EQ(thread.AddWorker(1, InitWorkerContext(nullptr, &notify, 4)).StatusCode(), SUCCESS);
+  notify->hold_reply_ = true;
+  // the instances of the requests are forwarded without copy, the requests are kept until replied
+  auto dispatch = [&thread](const std::string &instance, uint32_t priority, size_t count,
+                            proto::PassthroughPredictRequest *request, proto::PassthroughPredictReply *reply) {
+    request->mutable_servable_spec()->set_name("test_servable");
+    request->mutable_servable_spec()->set_method_name("add_cast");
+    request->mutable_servable_spec()->set_priority(priority);
+    for (size_t i = 0; i < count; i++) {
+      request->add_instances(instance);
+    }
+    return thread.DispatchAsync(*request, reply, []() {});
+  };
+  proto::PassthroughPredictRequest low_request;
+  proto::PassthroughPredictRequest high_request;
+  proto::PassthroughPredictReply low_reply;
+  proto::PassthroughPredictReply high_reply;
+  // one batch in flight while the worker is probed for the min latency, the others wait in the master
+  auto low = CreateTestInstance("x", 0.0f).SerializeAsString();
+  auto high = CreateTestInstance("x", 2.0f).SerializeAsString();
+  ASSERT_EQ(dispatch(low, 0, 8, &low_request, &low_reply).StatusCode(), SUCCESS);
+  ASSERT_EQ(dispatch(high, 2, 3, &high_request, &high_reply).StatusCode(), SUCCESS);
+  ASSERT_EQ(notify->held_replies_.size(), 1);
+  ASSERT_EQ(notify->request_.instances(0), low);
+  ASSERT_EQ(notify->request_.servable_spec().priority(), 0);
+  auto on_finish = notify->held_replies_[0];
+  notify->held_replies_.clear();
+  on_finish();
+  // the high priority instances go first, and a low priority one fills up the batch
+  ASSERT_EQ(notify->held_replies_.size(), 1);
+  ASSERT_EQ(notify->request_.instances_size(), 4);
+  ASSERT_EQ(notify->request_.instances(0), high);
+  ASSERT_EQ(notify->request_.instances(2), high);
+  ASSERT_EQ(notify->request_.instances(3), low);
+  ASSERT_EQ(notify->request_.servable_spec().priority(), 2);
+}
+
+TEST_F(TestModelThead, DropExpiredTasksAtDispatch) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 4, method_info);
+  std::shared_ptr<TestNotify> notify;
+  ASSERT_EQ(thread.AddWorker(1, InitWorkerContext(nullptr, &notify, 4)).StatusCode(), SUCCESS);
+  notify->hold_reply_ = true;
+  auto init_request = [](uint64_t timeout_us, proto::PassthroughPredictRequest *request) {
+    request->mutable_servable_spec()->set_name("test_servable");
+    request->mutable_servable_spec()->set_method_name("add_cast");
+    request->mutable_servable_spec()->set_timeout_us(timeout_us);
+    for (size_t i = 0; i < 2; i++) {
+      request->add_instances(CreateTestInstance("x", 1.0f).SerializeAsString());
+    }
+  };
+  proto::PassthroughPredictRequest request;
+  proto::PassthroughPredictRequest expired_request;
+  proto::PassthroughPredictReply reply;
+  proto::PassthroughPredictReply expired_reply;
+  init_request(10 * 1000 * 1000, &request);  // 10s
+  init_request(1, &expired_request);
+  bool expired_replied = false;
+  ASSERT_EQ(thread.DispatchAsync(request, &reply, []() {}).StatusCode(), SUCCESS);
+  ASSERT_EQ(thread.DispatchAsync(expired_request, &expired_reply, [&expired_replied]() { expired_replied = true; })
+              .StatusCode(),
+            SUCCESS);
+  // the time left of the request is sent to the worker
+  ASSERT_EQ(notify->request_.instances_size(), 2);
+  ASSERT_GT(notify->request_.servable_spec().timeout_us(), 0);
+  ASSERT_LE(notify->request_.servable_spec().timeout_us(), 10 * 1000 * 1000);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  auto on_finish = notify->held_replies_[0];
+  notify->held_replies_.clear();
+  on_finish();
+  // the expired request is replied without being sent to the worker
+  ASSERT_TRUE(notify->held_replies_.empty());
+  ASSERT_TRUE(expired_replied);
+  ASSERT_GE(expired_reply.error_msg_size(), 1);
+  ASSERT_EQ(expired_reply.error_msg(0).error_code(), DEADLINE_EXCEEDED);
+  ASSERT_EQ(thread.expired_task_count_, 2);
+  ASSERT_EQ(thread.task_wait_count_, 0);
+}
+
+TEST_F(TestModelThead, RequestDeadlineOfHugeTimeoutNeverExpires) {
+  proto::PredictRequest request;
+  RequestSpec request_spec;
+  for (uint64_t timeout_us : {UINT64_MAX, static_cast<uint64_t>(INT64_MAX)}) {
+    request.mutable_servable_spec()->set_timeout_us(timeout_us);
+    GrpcTensorHelper::GetRequestSpec(request, &request_spec);
+    ASSERT_EQ(request_spec.deadline, std::chrono::steady_clock::time_point::max());
+  }
+  request.mutable_servable_spec()->set_timeout_us(10 * 1000 * 1000);  // 10s
+  GrpcTensorHelper::GetRequestSpec(request, &request_spec);
+  ASSERT_GT(request_spec.deadline, std::chrono::steady_clock::now());
+  ASSERT_LT(request_spec.deadline, std::chrono::steady_clock::time_point::max());
+}
+
+TEST_F(TestModelThead, PopWaitTaskWeightedByPriority) {
+  ServableMethodInfo method_info;
+  ModelThread thread("test_servable", "add_cast", 0, 1, method_info);
+  for (uint64_t i = 0; i < 18; i++) {
+    thread.PushWaitTask(0, 0, i);
+    thread.PushWaitTask(1, 1, i);
+  }
+  // the lower priority is served once every 8 tasks of the higher one, it is not starved
+  uint64_t high_count = 0;
+  for (size_t i = 0; i < 18; i++) {
+    high_count += thread.PopWaitTask().first;
+  }
+  ASSERT_EQ(high_count, 16);
+  // a priority waiting again gets no credit for the time it was empty
+  while (thread.task_wait_count_ > 0) {
+    (void)thread.PopWaitTask();
+  }
+  for (uint64_t i = 0; i < 80; i++) {
+    thread.PushWaitTask(1, 1, i);
+    (void)thread.PopWaitTask();
+  }
+  for (uint64_t i = 0; i < 9; i++) {
+    thread.PushWaitTask(0, 0, i);
+    thread.PushWaitTask(1, 1, i);
+  }
+  high_count = 0;
+  for (size_t i = 0; i < 9; i++) {
+    high_count += thread.PopWaitTask().first;
+  }
+  ASSERT_EQ(high_count, 8);
+}
 }  // namespace serving
 }  // namespace mindspore
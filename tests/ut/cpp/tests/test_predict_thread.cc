@@ -0,0 +1,203 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "common/common_test.h"
+#define private public
+#include "worker/predict_thread.h"
+#undef private
+
+namespace mindspore {
+namespace serving {
+// model of batch size 1 and two input buffer sets, the execution blocks until released
+class TestBlockedModelLoader : public ModelLoaderBase {
+ public:
+  std::vector<TensorInfo> GetInputInfos(uint64_t subgraph) const override {
+    TensorInfo info;
+    info.size = sizeof(int32_t);
+    info.data_type = kMSI_Int32;
+    info.shape = {1};
+    return {info};
+  }
+  std::vector<TensorInfo> GetOutputInfos(uint64_t subgraph) const override { return GetInputInfos(subgraph); }
+  uint64_t GetBatchSize() const override { return 1; }
+  uint64_t GetGraphNum() const override { return 1; }
+  void Clear() override {}
+  Status Predict(const std::vector<InstanceData> &inputs, std::vector<ResultInstance> *outputs,
+                 uint64_t subgraph) override {
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      execute_count_++;
+      cond_.notify_all();
+      cond_.wait(lock, [this]() { return released_; });
+    }
+    for (auto &input : inputs) {
+      ResultInstance output;
+      output.data = input;
+      outputs->push_back(output);
+    }
+    return SUCCESS;
+  }
+  uint64_t GetInputBufferNum() const override { return 2; }
+  Status AfterLoadModel() override { return SUCCESS; }
+  bool OwnDevice() const override { return false; }
+
+  bool WaitExecuting(uint64_t count) {
+    std::unique_lock<std::mutex> lock(lock_);
+    return cond_.wait_for(lock, std::chrono::seconds(10), [this, count]() { return execute_count_ >= count; });
+  }
+  void Release() {
+    std::unique_lock<std::mutex> lock(lock_);
+    released_ = true;
+    cond_.notify_all();
+  }
+  uint64_t GetExecuteCount() {
+    std::unique_lock<std::mutex> lock(lock_);
+    return execute_count_;
+  }
+
+ private:
+  std::mutex lock_;
+  std::condition_variable cond_;
+  uint64_t execute_count_ = 0;
+  bool released_ = false;
+};
+
+// model of batch size 4 with the batch bucket 2
+class TestBucketModelLoader : public TestBlockedModelLoader {
+ public:
+  std::vector<TensorInfo> GetInputInfos(uint64_t subgraph) const override {
+    TensorInfo info;
+    info.size = 4 * sizeof(int32_t);
+    info.data_type = kMSI_Int32;
+    info.shape = {4};
+    return {info};
+  }
+  uint64_t GetBatchSize() const override { return 4; }
+  uint64_t GetExecuteBatchSize(uint64_t instance_count) const override { return instance_count <= 2 ? 2 : 4; }
+};
+
+class TestPredictThread : public UT::Common {
+ public:
+  TestPredictThread() = default;
+
+  static InstancePtr CreateInstance(int32_t value) {
+    auto instance = std::make_shared<Instance>();
+    auto tensor = std::make_shared<Tensor>(kMSI_Int32, std::vector<int64_t>{1}, nullptr, sizeof(int32_t));
+    reinterpret_cast<int32_t *>(tensor->mutable_data())[0] = value;
+    instance->data = {tensor};
+    return instance;
+  }
+};
+
+TEST_F(TestPredictThread, test_stop_with_ready_batches_fail_them_success) {
+  auto model_loader = std::make_shared<TestBlockedModelLoader>();
+  ModelMeta model_meta;
+  model_meta.common_meta.model_key = "test_model";
+  std::mutex lock;
+  std::map<InstancePtr, Status> results;
+  auto callback = [&lock, &results](const std::vector<InstancePtr> &inputs,
+                                    const std::vector<ResultInstance> &outputs) {
+    std::unique_lock<std::mutex> result_lock(lock);
+    for (size_t i = 0; i < inputs.size(); i++) {
+      results[inputs[i]] = outputs[i].error_msg;
+    }
+  };
+  PredictThread predict_thread;
+  predict_thread.Start("test_predict_queue", model_loader, model_meta, callback);
+  ASSERT_EQ(predict_thread.pipelines_.size(), 1);
+  auto &pipeline = *predict_thread.pipelines_[0];
+
+  std::vector<InstancePtr> instances = {CreateInstance(0), CreateInstance(1), CreateInstance(2)};
+  MethodStage stage;
+  stage.stage_key = "test_model";
+  predict_thread.PushPredictTask(stage, instances);
+  // the first batch is executing, and the second is assembled into the other input buffer set
+  ASSERT_TRUE(model_loader->WaitExecuting(1));
+  for (size_t i = 0; i < 1000; i++) {
+    std::unique_lock<std::mutex> pipeline_lock(pipeline.lock);
+    if (!pipeline.ready_batches.empty()) {
+      break;
+    }
+    pipeline_lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  {
+    std::unique_lock<std::mutex> pipeline_lock(pipeline.lock);
+    ASSERT_EQ(pipeline.ready_batches.size(), 1);
+  }
+  std::thread stop_thread([&predict_thread]() { predict_thread.Stop(); });
+  for (size_t i = 0; i < 1000; i++) {
+    std::unique_lock<std::mutex> pipeline_lock(pipeline.lock);
+    if (pipeline.stopped) {
+      break;
+    }
+    pipeline_lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  model_loader->Release();
+  stop_thread.join();
+
+  // the executing batch finishes, the ready batch fails instead of being lost, the queued one is dropped by the queue
+  ASSERT_EQ(model_loader->GetExecuteCount(), 1);
+  std::unique_lock<std::mutex> result_lock(lock);
+  ASSERT_EQ(results.size(), 2);
+  ASSERT_EQ(results[instances[0]].StatusCode(), SUCCESS);
+  ASSERT_EQ(results[instances[1]].StatusCode(), WORKER_UNAVAILABLE);
+}
+
+TEST_F(TestPredictThread, test_batch_fill_ratio_of_bucket_success) {
+  auto model_loader = std::make_shared<TestBucketModelLoader>();
+  model_loader->Release();
+  ModelMeta model_meta;
+  model_meta.common_meta.model_key = "test_model";
+  std::mutex lock;
+  std::condition_variable cond;
+  uint64_t result_count = 0;
+  auto callback = [&lock, &cond, &result_count](const std::vector<InstancePtr> &inputs,
+                                                const std::vector<ResultInstance> &) {
+    std::unique_lock<std::mutex> result_lock(lock);
+    result_count += inputs.size();
+    cond.notify_all();
+  };
+  auto wait_results = [&lock, &cond, &result_count](uint64_t count) {
+    std::unique_lock<std::mutex> result_lock(lock);
+    return cond.wait_for(result_lock, std::chrono::seconds(10), [&result_count, count]() {
+      return result_count >= count;
+    });
+  };
+  PredictThread predict_thread;
+  predict_thread.Start("test_predict_queue", model_loader, model_meta, callback);
+  MethodStage stage;
+  stage.stage_key = "test_model";
+  // one instance is executed by the bucket of batch size 2
+  predict_thread.PushPredictTask(stage, {CreateInstance(0)});
+  ASSERT_TRUE(wait_results(1));
+  ASSERT_DOUBLE_EQ(predict_thread.GetBatchFillRatio(), 0.5);
+  // three instances are executed by the model of batch size 4
+  predict_thread.PushPredictTask(stage, {CreateInstance(1), CreateInstance(2), CreateInstance(3)});
+  ASSERT_TRUE(wait_results(4));
+  ASSERT_EQ(predict_thread.predict_batch_count_, 2);
+  ASSERT_DOUBLE_EQ(predict_thread.GetBatchFillRatio(), 4.0 / 6);
+  predict_thread.Stop();
+}
+}  // namespace serving
+}  // namespace mindspore
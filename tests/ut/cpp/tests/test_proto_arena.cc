@@ -0,0 +1,58 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/common_test.h"
+#define private public
+#include "master/grpc/grpc_server.h"
+#include "master/model_thread.h"
+#include "worker/grpc/worker_server.h"
+#undef private
+
+namespace mindspore {
+namespace serving {
+class TestProtoArena : public UT::Common {
+ public:
+  TestProtoArena() = default;
+};
+
+TEST_F(TestProtoArena, test_service_predict_context_on_arena_success) {
+  ServicePredictContext context(nullptr, nullptr, nullptr);
+  ASSERT_NE(context.request_->GetArena(), nullptr);
+  ASSERT_NE(context.response_->GetArena(), nullptr);
+
+  ServicePassthroughPredictContext passthrough_context(nullptr, nullptr, nullptr);
+  ASSERT_NE(passthrough_context.request_->GetArena(), nullptr);
+  ASSERT_NE(passthrough_context.response_->GetArena(), nullptr);
+}
+
+TEST_F(TestProtoArena, test_worker_predict_context_on_arena_success) {
+  WorkerPredictContext context(nullptr, nullptr, nullptr);
+  ASSERT_NE(context.request_->GetArena(), nullptr);
+  ASSERT_NE(context.response_->GetArena(), nullptr);
+
+  WorkerPredictPassthroughContext passthrough_context(nullptr, nullptr, nullptr);
+  ASSERT_NE(passthrough_context.request_->GetArena(), nullptr);
+  ASSERT_NE(passthrough_context.parsed_request_->GetArena(), nullptr);
+  ASSERT_NE(passthrough_context.response_->GetArena(), nullptr);
+}
+
+TEST_F(TestProtoArena, test_master_predict_context_on_arena_success) {
+  PredictContext context;
+  ASSERT_NE(context.request->GetArena(), nullptr);
+  ASSERT_NE(context.reply->GetArena(), nullptr);
+}
+}  // namespace serving
+}  // namespace mindspore
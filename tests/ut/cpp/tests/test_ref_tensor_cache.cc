@@ -0,0 +1,119 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "common/common_test.h"
+#include "common/tensor.h"
+#include "common/buffer_tensor.h"
+#define private public
+#include "worker/inference/mindspore_model_wrap.h"
+#undef private
+
+namespace mindspore {
+namespace serving {
+class TestRefTensorCache : public UT::Common {
+ public:
+  TestRefTensorCache() = default;
+
+  static std::shared_ptr<Tensor> CreateTensor(const std::vector<int64_t> &shape) {
+    size_t data_size = sizeof(float);
+    for (auto dim : shape) {
+      data_size *= static_cast<size_t>(dim);
+    }
+    return std::make_shared<Tensor>(kMSI_Float32, shape, nullptr, data_size);
+  }
+};
+
+TEST_F(TestRefTensorCache, test_buffer_tensor_not_cached_success) {
+  RefTensorCache cache;
+  auto tensor = CreateTensor({2, 2});
+  auto buffer_tensor = std::make_shared<BufferTensorWithOwner>(tensor, tensor->data_type(), tensor->shape(),
+                                                               tensor->mutable_data(), tensor->data_size(), true);
+  std::vector<mindspore::MSTensor> ms_tensors;
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {buffer_tensor.get()}, &ms_tensors));
+  ASSERT_EQ(ms_tensors.size(), 1);
+  ASSERT_EQ(ms_tensors[0].Data().get(), tensor->data());
+  ASSERT_EQ(ms_tensors[0].Shape(), tensor->shape());
+  // the per-request data of batch 1 inputs is referred to without being cached
+  ASSERT_TRUE(cache.items_.empty());
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors));
+  ASSERT_EQ(cache.items_.size(), 1);
+}
+
+TEST_F(TestRefTensorCache, test_reuse_cached_handle_success) {
+  RefTensorCache cache;
+  auto tensor = CreateTensor({2, 2});
+  std::vector<mindspore::MSTensor> ms_tensors;
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors));
+  ASSERT_EQ(ms_tensors.size(), 1);
+  auto impl = ms_tensors[0].impl_;
+  std::vector<mindspore::MSTensor> ms_tensors2;
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors2));
+  ASSERT_EQ(ms_tensors2.size(), 1);
+  ASSERT_EQ(ms_tensors2[0].impl_, impl);
+  ASSERT_EQ(cache.items_.size(), 1);
+}
+
+TEST_F(TestRefTensorCache, test_shape_or_size_change_invalidate_handle_success) {
+  RefTensorCache cache;
+  auto tensor = CreateTensor({2, 2});
+  auto data = tensor->data();
+  std::vector<mindspore::MSTensor> ms_tensors;
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors));
+  auto impl = ms_tensors[0].impl_;
+  // the same data with another shape
+  tensor->set_shape({4});
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors));
+  ASSERT_NE(ms_tensors[0].impl_, impl);
+  ASSERT_EQ(ms_tensors[0].Shape(), (std::vector<int64_t>{4}));
+  impl = ms_tensors[0].impl_;
+  // the same data with another size, shrinking keeps the data address
+  tensor->set_shape({2});
+  ASSERT_TRUE(tensor->resize_data(2 * sizeof(float)));
+  ASSERT_EQ(tensor->data(), data);
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensor.get()}, &ms_tensors));
+  ASSERT_NE(ms_tensors[0].impl_, impl);
+  ASSERT_EQ(ms_tensors[0].DataSize(), 2 * sizeof(float));
+  ASSERT_EQ(ms_tensors[0].Data().get(), data);
+  // the entry is replaced, not added
+  ASSERT_EQ(cache.items_.size(), 1);
+  ASSERT_EQ(cache.item_map_.size(), 1);
+}
+
+TEST_F(TestRefTensorCache, test_evict_least_recently_used_success) {
+  RefTensorCache cache;
+  std::vector<std::shared_ptr<Tensor>> tensors;
+  std::vector<mindspore::MSTensor> ms_tensors;
+  for (size_t i = 0; i < RefTensorCache::kMaxCacheCount; i++) {
+    tensors.push_back(CreateTensor({2}));
+    ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensors.back().get()}, &ms_tensors));
+  }
+  ASSERT_EQ(cache.items_.size(), RefTensorCache::kMaxCacheCount);
+  // the first tensor is used again, the second one becomes the least recently used
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {tensors[0].get()}, &ms_tensors));
+  auto new_tensor = CreateTensor({2});
+  ASSERT_TRUE(cache.GetRefTensors({"x"}, {new_tensor.get()}, &ms_tensors));
+  ASSERT_EQ(cache.items_.size(), RefTensorCache::kMaxCacheCount);
+  ASSERT_EQ(cache.item_map_.size(), RefTensorCache::kMaxCacheCount);
+  ASSERT_EQ(cache.item_map_.count(tensors[0]->data()), 1);
+  ASSERT_EQ(cache.item_map_.count(tensors[1]->data()), 0);
+  ASSERT_EQ(cache.item_map_.count(tensors[2]->data()), 1);
+  ASSERT_EQ(cache.item_map_.count(new_tensor->data()), 1);
+}
+}  // namespace serving
+}  // namespace mindspore
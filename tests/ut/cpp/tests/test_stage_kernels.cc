@@ -0,0 +1,358 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include "common/common_test.h"
+#include "common/tensor.h"
+#include "worker/stage_function.h"
+#include "worker/register/stage_kernels.h"
+
+using std::string;
+using std::vector;
+namespace mindspore {
+namespace serving {
+class TestStageKernels : public UT::Common {
+ public:
+  TestStageKernels() = default;
+
+  static vector<float> RandomData(size_t count, float min_value = -10.0f, float max_value = 10.0f) {
+    std::mt19937 random_engine(count);
+    std::uniform_real_distribution<float> distribution(min_value, max_value);
+    vector<float> data(count);
+    for (auto &item : data) {
+      item = distribution(random_engine);
+    }
+    return data;
+  }
+
+  static TensorBasePtr CreateTensor(DataType data_type, const vector<int64_t> &shape, const void *data,
+                                    size_t data_len) {
+    return std::make_shared<Tensor>(data_type, shape, data, data_len);
+  }
+
+  static TensorBasePtr CreateFp32Tensor(const vector<int64_t> &shape, const vector<float> &data) {
+    return CreateTensor(kMSI_Float32, shape, data.data(), data.size() * sizeof(float));
+  }
+
+  static Status CallStageFunction(const string &func_name, const InstanceData &input, InstanceData *output) {
+    auto function = CppStageFunctionStorage::Instance().GetFunction(func_name);
+    if (function == nullptr) {
+      return FAILED;
+    }
+    return function->Call(func_name, input, output);
+  }
+
+  template <typename DT>
+  static const DT *Data(const TensorBasePtr &tensor) {
+    return reinterpret_cast<const DT *>(tensor->data());
+  }
+
+  // kernels selected for the cpu, and the avx2 kernels when avx512 kernels are selected
+  static vector<StageKernels> SelectedKernels() {
+    vector<StageKernels> kernels_list = {GetStageKernels()};
+#if defined(__x86_64__) || defined(__i386__)
+    if (GetStageKernels().isa == "avx512") {
+      auto kernels = GetScalarStageKernels();
+      InitAvx2StageKernels(&kernels);
+      kernels_list.push_back(kernels);
+    }
+#endif
+    return kernels_list;
+  }
+
+  // microseconds of one run, averaged over repeat runs
+  static double CostUs(const std::function<void()> &func, size_t repeat) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeat; i++) {
+      func();
+    }
+    auto cost = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return cost / repeat;
+  }
+};
+
+// odd sizes cover both the vectorized body and the tail of the kernels
+TEST_F(TestStageKernels, test_kernels_same_as_scalar_success) {
+  auto &scalar = GetScalarStageKernels();
+  for (auto &kernels : SelectedKernels()) {
+    for (size_t count : {1, 7, 8, 17, 1003}) {
+      auto input = RandomData(count);
+      ASSERT_EQ(kernels.argmax_fp32(input.data(), count), scalar.argmax_fp32(input.data(), count));
+      ASSERT_EQ(kernels.reduce_max_fp32(input.data(), count), scalar.reduce_max_fp32(input.data(), count));
+      for (float threshold : {-20.0f, 5.0f, 9.9f, 20.0f}) {
+        ASSERT_EQ(kernels.find_greater_fp32(input.data(), count, threshold),
+                  scalar.find_greater_fp32(input.data(), count, threshold));
+      }
+      vector<float> output(count);
+      vector<float> expect(count);
+      auto sum = kernels.exp_sum_fp32(input.data(), output.data(), count, 10.0f);
+      auto expect_sum = scalar.exp_sum_fp32(input.data(), expect.data(), count, 10.0f);
+      ASSERT_NEAR(sum, expect_sum, expect_sum * 1e-5);
+      for (size_t i = 0; i < count; i++) {
+        ASSERT_NEAR(output[i], expect[i], expect[i] * 1e-5 + 1e-30);
+      }
+      kernels.clip_fp32(input.data(), output.data(), count, -1.0f, 2.0f);
+      scalar.clip_fp32(input.data(), expect.data(), count, -1.0f, 2.0f);
+      ASSERT_EQ(output, expect);
+      kernels.threshold_fp32(input.data(), output.data(), count, 0.5f);
+      scalar.threshold_fp32(input.data(), expect.data(), count, 0.5f);
+      ASSERT_EQ(output, expect);
+      kernels.scale_fp32(input.data(), output.data(), count, 0.5f);
+      scalar.scale_fp32(input.data(), expect.data(), count, 0.5f);
+      ASSERT_EQ(output, expect);
+      kernels.add_fp32(input.data(), output.data(), count, 0.5f);
+      scalar.add_fp32(input.data(), expect.data(), count, 0.5f);
+      ASSERT_EQ(output, expect);
+      constexpr size_t channels = 3;
+      auto scale = RandomData(channels * kStageKernelPeriodRepeat);
+      auto bias = RandomData(channels * kStageKernelPeriodRepeat);
+      kernels.scale_bias_fp32(input.data(), output.data(), count, scale.data(), bias.data(), scale.size());
+      scalar.scale_bias_fp32(input.data(), expect.data(), count, scale.data(), bias.data(), scale.size());
+      for (size_t i = 0; i < count; i++) {
+        ASSERT_NEAR(output[i], expect[i], 1e-4);
+      }
+      vector<uint16_t> fp16_output(count);
+      vector<uint16_t> fp16_expect(count);
+      kernels.cast_fp32_to_fp16(input.data(), fp16_output.data(), count);
+      scalar.cast_fp32_to_fp16(input.data(), fp16_expect.data(), count);
+      ASSERT_EQ(fp16_output, fp16_expect);
+      kernels.cast_fp16_to_fp32(fp16_output.data(), output.data(), count);
+      scalar.cast_fp16_to_fp32(fp16_output.data(), expect.data(), count);
+      ASSERT_EQ(output, expect);
+      vector<uint8_t> uint8_input(count);
+      for (size_t i = 0; i < count; i++) {
+        uint8_input[i] = static_cast<uint8_t>(i * 7);
+      }
+      kernels.cast_uint8_to_fp32(uint8_input.data(), output.data(), count);
+      scalar.cast_uint8_to_fp32(uint8_input.data(), expect.data(), count);
+      ASSERT_EQ(output, expect);
+    }
+  }
+}
+
+TEST_F(TestStageKernels, test_transpose_kernels_same_as_scalar_success) {
+  auto &scalar = GetScalarStageKernels();
+  for (auto &kernels : SelectedKernels()) {
+    for (size_t pixels : {1, 8, 35, 224 * 224}) {
+      for (size_t channels : {1, 3, 4}) {
+        auto input = RandomData(pixels * channels);
+        vector<float> output(input.size());
+        vector<float> expect(input.size());
+        auto input_data = reinterpret_cast<const uint8_t *>(input.data());
+        // HWC to CHW
+        kernels.transpose(input_data, reinterpret_cast<uint8_t *>(output.data()), pixels, channels, sizeof(float));
+        scalar.transpose(input_data, reinterpret_cast<uint8_t *>(expect.data()), pixels, channels, sizeof(float));
+        ASSERT_EQ(output, expect);
+        ASSERT_EQ(output[pixels - 1], input[(pixels - 1) * channels]);
+        // CHW to HWC
+        kernels.transpose(input_data, reinterpret_cast<uint8_t *>(output.data()), channels, pixels, sizeof(float));
+        scalar.transpose(input_data, reinterpret_cast<uint8_t *>(expect.data()), channels, pixels, sizeof(float));
+        ASSERT_EQ(output, expect);
+      }
+    }
+  }
+}
+
+TEST_F(TestStageKernels, test_softmax_and_log_softmax_success) {
+  vector<float> data = {1.0f, 2.0f, 3.0f, 4.0f, 1000.0f, 1000.0f, -1000.0f, 0.0f};
+  InstanceData output;
+  ASSERT_EQ(CallStageFunction("softmax_cpp", {CreateFp32Tensor({2, 4}, data)}, &output), SUCCESS);
+  ASSERT_EQ(output.size(), 1);
+  ASSERT_EQ(output[0]->shape(), vector<int64_t>({2, 4}));
+  auto y_data = Data<float>(output[0]);
+  for (size_t row = 0; row < 2; row++) {
+    float max_value = *std::max_element(data.begin() + row * 4, data.begin() + row * 4 + 4);
+    float sum = 0;
+    for (size_t i = row * 4; i < row * 4 + 4; i++) {
+      sum += std::exp(data[i] - max_value);
+    }
+    for (size_t i = row * 4; i < row * 4 + 4; i++) {
+      ASSERT_NEAR(y_data[i], std::exp(data[i] - max_value) / sum, 1e-6);
+    }
+  }
+  InstanceData log_output;
+  ASSERT_EQ(CallStageFunction("log_softmax_cpp", {CreateFp32Tensor({2, 4}, data)}, &log_output), SUCCESS);
+  auto log_data = Data<float>(log_output[0]);
+  ASSERT_NEAR(log_data[0], std::log(y_data[0]), 1e-5);
+  ASSERT_NEAR(log_data[4], std::log(0.5f), 1e-5);
+  ASSERT_NEAR(log_data[6], -2000.0f - std::log(2.0f), 1e-2);
+}
+
+TEST_F(TestStageKernels, test_topk_success) {
+  vector<float> data = {3.0f, 1.0f, 5.0f, 5.0f, 2.0f, 0.0f, 9.0f, -1.0f, 4.0f, 8.0f};
+  int64_t k = 3;
+  InstanceData output;
+  auto k_tensor = CreateTensor(kMSI_Int64, {}, &k, sizeof(k));
+  ASSERT_EQ(CallStageFunction("topk_cpp", {CreateFp32Tensor({2, 5}, data), k_tensor}, &output), SUCCESS);
+  ASSERT_EQ(output.size(), 2);
+  ASSERT_EQ(output[0]->shape(), vector<int64_t>({2, 3}));
+  ASSERT_EQ(vector<float>(Data<float>(output[0]), Data<float>(output[0]) + 6),
+            vector<float>({5.0f, 5.0f, 3.0f, 9.0f, 8.0f, 4.0f}));
+  ASSERT_EQ(vector<int64_t>(Data<int64_t>(output[1]), Data<int64_t>(output[1]) + 6),
+            vector<int64_t>({2, 3, 0, 1, 4, 3}));
+  // large input with small k goes through the vectorized skipping
+  auto large_data = RandomData(10007);
+  k = 5;
+  k_tensor = CreateTensor(kMSI_Int64, {}, &k, sizeof(k));
+  InstanceData large_output;
+  ASSERT_EQ(CallStageFunction("topk_cpp", {CreateFp32Tensor({10007}, large_data), k_tensor}, &large_output),
+            SUCCESS);
+  auto sorted_data = large_data;
+  std::sort(sorted_data.begin(), sorted_data.end(), std::greater<float>());
+  for (size_t i = 0; i < 5; i++) {
+    ASSERT_EQ(Data<float>(large_output[0])[i], sorted_data[i]);
+    ASSERT_EQ(large_data[Data<int64_t>(large_output[1])[i]], sorted_data[i]);
+  }
+}
+
+TEST_F(TestStageKernels, test_topk_k_larger_than_dim_failed) {
+  int32_t k = 6;
+  InstanceData output;
+  auto status = CallStageFunction(
+    "topk_cpp", {CreateFp32Tensor({5}, RandomData(5)), CreateTensor(kMSI_Int32, {}, &k, sizeof(k))}, &output);
+  ASSERT_NE(status, SUCCESS);
+}
+
+TEST_F(TestStageKernels, test_normalize_uint8_image_success) {
+  constexpr size_t pixels = 37;
+  vector<uint8_t> image(pixels * 3);
+  for (size_t i = 0; i < image.size(); i++) {
+    image[i] = static_cast<uint8_t>(i);
+  }
+  vector<float> mean = {1.0f, 2.0f, 3.0f};
+  vector<float> std = {2.0f, 4.0f, 8.0f};
+  InstanceData output;
+  auto status = CallStageFunction("normalize_cpp",
+                                  {CreateTensor(kMSI_Uint8, {1, pixels, 3}, image.data(), image.size()),
+                                   CreateFp32Tensor({3}, mean), CreateFp32Tensor({3}, std)},
+                                  &output);
+  ASSERT_EQ(status, SUCCESS);
+  ASSERT_EQ(output[0]->data_type(), kMSI_Float32);
+  auto y_data = Data<float>(output[0]);
+  for (size_t i = 0; i < image.size(); i++) {
+    ASSERT_NEAR(y_data[i], (image[i] - mean[i % 3]) / std[i % 3], 1e-5);
+  }
+}
+
+TEST_F(TestStageKernels, test_normalize_mean_not_match_channels_failed) {
+  InstanceData output;
+  auto status = CallStageFunction("normalize_cpp",
+                                  {CreateFp32Tensor({2, 3}, RandomData(6)), CreateFp32Tensor({2}, {1.0f, 2.0f}),
+                                   CreateFp32Tensor({2}, {1.0f, 2.0f})},
+                                  &output);
+  ASSERT_NE(status, SUCCESS);
+}
+
+TEST_F(TestStageKernels, test_cast_float16_and_float32_success) {
+  vector<float> data = {0.5f, -2.0f, 65504.0f, 1.0f / 3, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f};
+  InstanceData fp16_output;
+  ASSERT_EQ(CallStageFunction("cast_float16_cpp", {CreateFp32Tensor({9}, data)}, &fp16_output), SUCCESS);
+  ASSERT_EQ(fp16_output[0]->data_type(), kMSI_Float16);
+  ASSERT_EQ(fp16_output[0]->data_size(), 9 * sizeof(uint16_t));
+  InstanceData fp32_output;
+  ASSERT_EQ(CallStageFunction("cast_float32_cpp", fp16_output, &fp32_output), SUCCESS);
+  ASSERT_EQ(fp32_output[0]->data_type(), kMSI_Float32);
+  auto y_data = Data<float>(fp32_output[0]);
+  for (size_t i = 0; i < data.size(); i++) {
+    ASSERT_NEAR(y_data[i], data[i], std::abs(data[i]) * 1e-3);
+  }
+  vector<int32_t> int_data = {1, -2, 3};
+  InstanceData int_output;
+  ASSERT_EQ(CallStageFunction("cast_float32_cpp", {CreateTensor(kMSI_Int32, {3}, int_data.data(), 12)}, &int_output),
+            SUCCESS);
+  ASSERT_EQ(vector<float>(Data<float>(int_output[0]), Data<float>(int_output[0]) + 3),
+            vector<float>({1.0f, -2.0f, 3.0f}));
+}
+
+TEST_F(TestStageKernels, test_hwc2chw_and_chw2hwc_success) {
+  auto data = RandomData(4 * 5 * 3);
+  InstanceData chw_output;
+  ASSERT_EQ(CallStageFunction("hwc2chw_cpp", {CreateFp32Tensor({4, 5, 3}, data)}, &chw_output), SUCCESS);
+  ASSERT_EQ(chw_output[0]->shape(), vector<int64_t>({3, 4, 5}));
+  auto chw_data = Data<float>(chw_output[0]);
+  // pixel (h=2, w=3) channel 1
+  ASSERT_EQ(chw_data[1 * 20 + 2 * 5 + 3], data[(2 * 5 + 3) * 3 + 1]);
+  InstanceData hwc_output;
+  ASSERT_EQ(CallStageFunction("chw2hwc_cpp", chw_output, &hwc_output), SUCCESS);
+  ASSERT_EQ(hwc_output[0]->shape(), vector<int64_t>({4, 5, 3}));
+  ASSERT_EQ(vector<float>(Data<float>(hwc_output[0]), Data<float>(hwc_output[0]) + data.size()), data);
+}
+
+TEST_F(TestStageKernels, test_clip_and_threshold_success) {
+  vector<float> data = {-3.0f, -1.0f, 0.0f, 0.5f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  float min_value = 0.0f;
+  float max_value = 3.0f;
+  InstanceData output;
+  ASSERT_EQ(CallStageFunction("clip_cpp",
+                              {CreateFp32Tensor({9}, data), CreateFp32Tensor({}, {min_value}),
+                               CreateFp32Tensor({}, {max_value})},
+                              &output),
+            SUCCESS);
+  ASSERT_EQ(vector<float>(Data<float>(output[0]), Data<float>(output[0]) + 9),
+            vector<float>({0.0f, 0.0f, 0.0f, 0.5f, 1.0f, 2.0f, 3.0f, 3.0f, 3.0f}));
+  InstanceData threshold_output;
+  ASSERT_EQ(CallStageFunction("threshold_cpp", {CreateFp32Tensor({9}, data), CreateFp32Tensor({}, {1.0f})},
+                              &threshold_output),
+            SUCCESS);
+  ASSERT_EQ(vector<float>(Data<float>(threshold_output[0]), Data<float>(threshold_output[0]) + 9),
+            vector<float>({0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f}));
+}
+
+// micro benchmark: cost of the vectorized kernels against the scalar kernels
+TEST_F(TestStageKernels, DISABLED_test_kernels_benchmark_against_scalar) {
+  constexpr size_t count = 224 * 224 * 3;
+  constexpr size_t repeat = 20;
+  auto input = RandomData(count);
+  vector<float> output(count);
+  vector<uint16_t> fp16_data(count);
+  vector<uint8_t> uint8_data(count);
+  auto scale = RandomData(3 * kStageKernelPeriodRepeat);
+  auto bias = RandomData(3 * kStageKernelPeriodRepeat);
+  auto in = input.data();
+  auto out = output.data();
+  auto in_bytes = reinterpret_cast<const uint8_t *>(in);
+  auto out_bytes = reinterpret_cast<uint8_t *>(out);
+  vector<std::pair<string, std::function<void(const StageKernels &)>>> cases = {
+    {"argmax", [&](const StageKernels &k) { (void)k.argmax_fp32(in, count); }},
+    {"topk find_greater", [&](const StageKernels &k) { (void)k.find_greater_fp32(in, count, 100.0f); }},
+    {"softmax", [&](const StageKernels &k) {
+       auto sum = k.exp_sum_fp32(in, out, count, k.reduce_max_fp32(in, count));
+       k.scale_fp32(out, out, count, 1.0f / sum);
+     }},
+    {"normalize", [&](const StageKernels &k) { k.scale_bias_fp32(in, out, count, scale.data(), bias.data(), 48); }},
+    {"cast uint8 to fp32", [&](const StageKernels &k) { k.cast_uint8_to_fp32(uint8_data.data(), out, count); }},
+    {"cast fp32 to fp16", [&](const StageKernels &k) { k.cast_fp32_to_fp16(in, fp16_data.data(), count); }},
+    {"cast fp16 to fp32", [&](const StageKernels &k) { k.cast_fp16_to_fp32(fp16_data.data(), out, count); }},
+    {"hwc2chw", [&](const StageKernels &k) { k.transpose(in_bytes, out_bytes, count / 3, 3, sizeof(float)); }},
+    {"chw2hwc", [&](const StageKernels &k) { k.transpose(in_bytes, out_bytes, 3, count / 3, sizeof(float)); }},
+    {"clip", [&](const StageKernels &k) { k.clip_fp32(in, out, count, -1.0f, 1.0f); }},
+    {"threshold", [&](const StageKernels &k) { k.threshold_fp32(in, out, count, 0.0f); }},
+  };
+  auto &kernels = GetStageKernels();
+  auto &scalar = GetScalarStageKernels();
+  for (auto &item : cases) {
+    auto scalar_cost = CostUs([&]() { item.second(scalar); }, repeat);
+    auto kernel_cost = CostUs([&]() { item.second(kernels); }, repeat);
+    MSI_LOG_INFO << item.first << " of " << count << " elements, scalar " << scalar_cost << "us, " << kernels.isa
+                 << " " << kernel_cost << "us, speedup " << scalar_cost / kernel_cost;
+  }
+}
+}  // namespace serving
+}  // namespace mindspore
@@ -716,5 +716,118 @@ TEST_F(TestPreprocessPostprocess, test_return_invalid4_failed) {
                                 " 1th output, that is greater than the function output size 1");
 }
 
+TEST_F(TestPreprocessPostprocess, test_build_stage_graph_success) {
+  MethodSignature chain_method = InitDefaultMethod();
+  chain_method.BuildStageGraph();
+  EXPECT_FALSE(chain_method.parallel_stages);
+  EXPECT_EQ(chain_method.start_stages, std::vector<uint64_t>({1}));
+  EXPECT_EQ(chain_method.stage_map[2].next_stages, std::vector<uint64_t>({3, 4}));
+
+  MethodSignature method_signature = InitMethodSig();
+  method_signature.AddStageModel(model_file_, {{0, 0}, {0, 1}});
+  method_signature.AddStageModel(model_file_, {{0, 1}, {0, 0}});
+  method_signature.AddStageModel(model_file_, {{1, 0}, {2, 0}});
+  method_signature.SetReturn({{3, 0}});
+  method_signature.BuildStageGraph();
+  EXPECT_TRUE(method_signature.parallel_stages);
+  EXPECT_EQ(method_signature.start_stages, std::vector<uint64_t>({1, 2}));
+  EXPECT_FALSE(method_signature.stage_map[1].run_alone);
+  EXPECT_FALSE(method_signature.stage_map[2].run_alone);
+  EXPECT_TRUE(method_signature.stage_map[3].run_alone);
+  EXPECT_EQ(method_signature.stage_map[3].depend_stages, std::vector<uint64_t>({1, 2}));
+  EXPECT_EQ(method_signature.stage_map[4].depend_stages, std::vector<uint64_t>({1, 2, 3}));
+  // stages of a method running concurrently are not fused
+  for (auto &item : method_signature.stage_map) {
+    EXPECT_FALSE(item.second.run_inline);
+  }
+}
+
+TEST_F(TestPreprocessPostprocess, test_build_stage_fusion_success) {
+  MethodSignature chain_method = InitDefaultMethod();
+  chain_method.BuildStageGraph();
+  EXPECT_FALSE(chain_method.stage_map[1].run_inline);
+  EXPECT_FALSE(chain_method.stage_map[2].run_inline);
+  EXPECT_TRUE(chain_method.stage_map[3].run_inline);
+  EXPECT_FALSE(chain_method.stage_map[4].run_inline);
+
+  MethodSignature method_signature = InitMethodSig();
+  method_signature.AddStageFunction("stub_preprocess_cast_int32_to_fp32_cpp", {{0, 0}, {0, 1}});
+  method_signature.AddStageFunction("stub_postprocess_cast_fp32_to_int32_cpp", {{1, 0}});
+  method_signature.AddStageModel(model_file_, {{2, 0}, {1, 1}});
+  method_signature.AddStageFunction("stub_postprocess_cast_fp32_to_int32_cpp", {{3, 0}});
+  method_signature.SetReturn({{4, 0}});
+  method_signature.BuildStageGraph();
+  EXPECT_FALSE(method_signature.parallel_stages);
+  EXPECT_FALSE(method_signature.stage_map[1].run_inline);
+  EXPECT_TRUE(method_signature.stage_map[2].run_inline);
+  EXPECT_FALSE(method_signature.stage_map[3].run_inline);
+  EXPECT_TRUE(method_signature.stage_map[4].run_inline);
+}
+
+TEST_F(TestPreprocessPostprocess, test_master_worker_with_fused_preprocess_success) {
+  Init("test_servable_dir", "test_servable", 1, "test_add.mindir");
+  DeclareServable("test_servable", "test_add.mindir", "mindir", false);
+  ServableRegister::Instance().RegisterInputOutputInfo("test_add.mindir", 2, 1);
+
+  MethodSignature method_signature = InitMethodSig();
+  // stage 2 and 3 run inline after stage 1, stage 5 runs inline after the model stage
+  method_signature.AddStageFunction("stub_preprocess_cast_int32_to_fp32_cpp", {{0, 0}, {0, 1}});
+  method_signature.AddStageFunction("stub_postprocess_cast_fp32_to_int32_cpp", {{1, 0}});
+  method_signature.AddStageFunction("stub_preprocess_cast_int32_to_fp32_cpp", {{2, 0}, {0, 1}});
+  method_signature.AddStageModel(model_file_, {{3, 0}, {3, 1}});
+  method_signature.AddStageFunction("stub_postprocess_cast_fp32_to_int32_cpp", {{4, 0}});
+  method_signature.SetReturn({{5, 0}});
+  ServableRegister::Instance().RegisterMethod(method_signature);
+
+  Status status = StartServable("test_servable_dir", "test_servable", 1);
+  EXPECT_TRUE(status.IsSuccess());
+  proto::PredictRequest request;
+  size_t instances_count = 3;
+  auto y_data_list =
+    InitMultiInstancesRequest<int32_t, int32_t>(&request, servable_name_, "add_cast", 0, instances_count);
+
+  proto::PredictReply reply;
+  auto grpc_status = Dispatch(request, &reply);
+  EXPECT_TRUE(grpc_status.ok());
+  CheckMultiInstanceResult(reply, y_data_list, instances_count);
+  // each batch of the fused stages runs inline once, saving one task queue hop
+  auto &inline_stage_hops = Worker::GetInstance().GetWorkExecutor().inline_stage_hops_;
+  ASSERT_EQ(inline_stage_hops.count("add_cast"), 1);
+  auto &stage_hops = inline_stage_hops["add_cast"];
+  ASSERT_EQ(stage_hops.size(), 3);
+  for (uint64_t stage_index : {2, 3, 5}) {
+    ASSERT_EQ(stage_hops.count(stage_index), 1);
+    EXPECT_GE(stage_hops[stage_index].load(), 1);
+    EXPECT_LE(stage_hops[stage_index].load(), instances_count);
+  }
+}
+
+TEST_F(TestPreprocessPostprocess, test_master_worker_with_parallel_preprocess_success) {
+  Init("test_servable_dir", "test_servable", 1, "test_add.mindir");
+  DeclareServable("test_servable", "test_add.mindir", "mindir", false);
+  ServableRegister::Instance().RegisterInputOutputInfo("test_add.mindir", 2, 1);
+
+  MethodSignature method_signature = InitMethodSig();
+  // two preprocess branches depending on method inputs only run concurrently
+  method_signature.AddStageFunction("stub_preprocess_cast_int32_to_fp32_cpp", {{0, 0}, {0, 1}});
+  method_signature.AddStageFunction("stub_preprocess_cast_int32_to_fp32_cpp", {{0, 0}, {0, 1}});
+  method_signature.AddStageModel(model_file_, {{1, 0}, {2, 1}});
+  method_signature.AddStageFunction("stub_postprocess_cast_fp32_to_int32_cpp", {{3, 0}});
+  method_signature.SetReturn({{4, 0}});
+  ServableRegister::Instance().RegisterMethod(method_signature);
+
+  Status status = StartServable("test_servable_dir", "test_servable", 1);
+  EXPECT_TRUE(status.IsSuccess());
+  proto::PredictRequest request;
+  size_t instances_count = 3;
+  auto y_data_list =
+    InitMultiInstancesRequest<int32_t, int32_t>(&request, servable_name_, "add_cast", 0, instances_count);
+
+  proto::PredictReply reply;
+  auto grpc_status = Dispatch(request, &reply);
+  EXPECT_TRUE(grpc_status.ok());
+  CheckMultiInstanceResult(reply, y_data_list, instances_count);
+}
+
 }  // namespace serving
 }  // namespace mindspore
@@ -0,0 +1,427 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "common/common_test.h"
+#define private public
+#include "worker/task_queue.h"
+#undef private
+#include "worker/stage_function.h"
+
+using std::string;
+using std::vector;
+namespace mindspore {
+namespace serving {
+class TestTaskQueue : public UT::Common {
+ public:
+  TestTaskQueue() = default;
+  void TearDown() override {
+    task_queue_.Stop();
+    UT::Common::TearDown();
+  }
+
+  void StartQueue(uint64_t batch_size, uint64_t preferred_batch_size, uint64_t max_queue_delay_us) {
+    TaskInfo info;
+    info.group_name = "model_subgraph0";
+    info.task_name = info.group_name;
+    info.batch_size = batch_size;
+    info.preferred_batch_size = preferred_batch_size;
+    info.max_queue_delay_us = max_queue_delay_us;
+    auto callback = [this](const std::vector<InstancePtr> &inputs, const std::vector<ResultInstance> &outputs) {
+      for (size_t i = 0; i < inputs.size(); i++) {
+        if (outputs[i].error_msg != SUCCESS) {
+          failed_instances_.push_back(inputs[i]);
+        }
+      }
+    };
+    task_queue_.Start("TestTask", {info}, callback);
+  }
+
+  std::vector<InstancePtr> PushInstances(size_t count, uint32_t priority = 0) {
+    std::vector<InstancePtr> instances;
+    for (size_t i = 0; i < count; i++) {
+      instances.push_back(std::make_shared<Instance>());
+      instances.back()->priority = priority;
+    }
+    task_queue_.PushTask("model_subgraph0", 0, instances);
+    return instances;
+  }
+
+  TaskQueue task_queue_;
+  std::vector<InstancePtr> failed_instances_;
+};
+
+TEST_F(TestTaskQueue, test_pop_without_queue_delay_success) {
+  StartQueue(4, 0, 0);
+  PushInstances(2);
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  ASSERT_FALSE(task_item.has_stopped);
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+}
+
+TEST_F(TestTaskQueue, test_pop_max_batch_size_success) {
+  StartQueue(4, 0, 0);
+  PushInstances(6);
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list.size(), 4);
+  task_queue_.PopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+}
+
+TEST_F(TestTaskQueue, test_pop_preferred_batch_without_wait_success) {
+  StartQueue(8, 4, 10 * 1000 * 1000);  // 10s
+  PushInstances(5);
+  auto start = std::chrono::steady_clock::now();
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  auto cost = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(task_item.instance_list.size(), 5);
+  ASSERT_LT(cost, std::chrono::seconds(1));
+}
+
+TEST_F(TestTaskQueue, test_pop_partial_batch_after_queue_delay_success) {
+  constexpr uint64_t delay_us = 50 * 1000;  // 50ms
+  StartQueue(8, 8, delay_us);
+  PushInstances(2);
+  auto start = std::chrono::steady_clock::now();
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  auto cost = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+  ASSERT_GE(cost, std::chrono::microseconds(delay_us));
+}
+
+TEST_F(TestTaskQueue, test_pop_batch_filled_during_queue_delay_success) {
+  StartQueue(4, 4, 10 * 1000 * 1000);  // 10s
+  PushInstances(1);
+  std::thread push_thread([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    PushInstances(3);
+  });
+  auto start = std::chrono::steady_clock::now();
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  auto cost = std::chrono::steady_clock::now() - start;
+  push_thread.join();
+  ASSERT_EQ(task_item.instance_list.size(), 4);
+  ASSERT_LT(cost, std::chrono::seconds(1));
+}
+
+TEST_F(TestTaskQueue, test_stop_during_queue_delay_success) {
+  StartQueue(4, 4, 10 * 1000 * 1000);  // 10s
+  PushInstances(1);
+  std::thread stop_thread([this]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    task_queue_.Stop();
+  });
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  stop_thread.join();
+  ASSERT_TRUE(task_item.has_stopped);
+}
+
+TEST_F(TestTaskQueue, test_pop_higher_priority_first_success) {
+  StartQueue(4, 0, 0);
+  auto low_instances = PushInstances(3, 0);
+  auto high_instances = PushInstances(2, 1);
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list.size(), 4);
+  // the higher priority fills the batch first, the lower ones fill it up in the order they are pushed
+  std::vector<InstancePtr> expect = {high_instances[0], high_instances[1], low_instances[0], low_instances[1]};
+  ASSERT_EQ(task_item.instance_list, expect);
+  task_queue_.PopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list, std::vector<InstancePtr>{low_instances[2]});
+}
+
+TEST_F(TestTaskQueue, test_queue_delay_of_oldest_lower_priority_instance_success) {
+  constexpr uint64_t delay_us = 100 * 1000;  // 100ms
+  StartQueue(8, 8, delay_us);
+  auto start = std::chrono::steady_clock::now();
+  (void)PushInstances(1, 0);
+  std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+  (void)PushInstances(1, 1);
+  // the wait budget of the older instance of lower priority has run out
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  auto cost = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+  ASSERT_LT(cost, std::chrono::microseconds(delay_us * 9 / 5));
+}
+
+TEST_F(TestTaskQueue, test_drop_expired_instances_when_pop_success) {
+  StartQueue(2, 0, 0);
+  std::vector<InstancePtr> expired_instances;
+  for (size_t i = 0; i < 2; i++) {
+    expired_instances.push_back(std::make_shared<Instance>());
+    expired_instances.back()->deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  }
+  task_queue_.PushTask("model_subgraph0", 0, expired_instances);
+  auto instances = PushInstances(3);
+  // the expired instances take no place in the batch, and are replied as failed
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list, (std::vector<InstancePtr>{instances[0], instances[1]}));
+  ASSERT_EQ(failed_instances_, expired_instances);
+}
+
+TEST_F(TestTaskQueue, test_expired_instances_not_count_toward_preferred_batch_success) {
+  constexpr uint64_t delay_us = 100 * 1000;  // 100ms
+  StartQueue(4, 2, delay_us);
+  auto expired_instance = std::make_shared<Instance>();
+  expired_instance->deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  task_queue_.PushTask("model_subgraph0", 0, {expired_instance});
+  auto start = std::chrono::steady_clock::now();
+  auto instances = PushInstances(1);
+  // one live instance does not reach the preferred batch size 2, it is held until its wait budget runs out
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  auto cost = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(task_item.instance_list, instances);
+  ASSERT_GE(cost, std::chrono::microseconds(delay_us));
+  ASSERT_EQ(failed_instances_, std::vector<InstancePtr>{expired_instance});
+}
+
+TEST_F(TestTaskQueue, test_pop_all_expired_instances_without_wait_success) {
+  StartQueue(4, 4, 10 * 1000 * 1000);  // 10s
+  std::vector<InstancePtr> expired_instances;
+  for (size_t i = 0; i < 2; i++) {
+    expired_instances.push_back(std::make_shared<Instance>());
+    expired_instances.back()->deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  }
+  task_queue_.PushTask("model_subgraph0", 0, expired_instances);
+  uint64_t pending_count = 0;
+  std::thread push_thread([this, &pending_count]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pending_count = task_queue_.pending_instances_count_;
+    PushInstances(4);
+  });
+  // the expired instances are popped and replied without waiting for the wait budget, then the live batch is popped
+  TaskItem task_item;
+  task_queue_.PopTask(&task_item);
+  push_thread.join();
+  ASSERT_EQ(pending_count, 0);
+  ASSERT_EQ(failed_instances_, expired_instances);
+  ASSERT_EQ(task_item.instance_list.size(), 4);
+}
+
+TEST_F(TestTaskQueue, test_multi_consumers_pop_all_instances_success) {
+  StartQueue(4, 0, 0);
+  constexpr size_t consumer_count = 4;
+  std::atomic<size_t> pop_count = 0;
+  std::vector<std::thread> consumers;
+  for (size_t i = 0; i < consumer_count; i++) {
+    consumers.emplace_back([this, &pop_count]() {
+      while (true) {
+        TaskItem task_item;
+        task_queue_.PopTask(&task_item);
+        if (task_item.has_stopped) {
+          return;
+        }
+        ASSERT_LE(task_item.instance_list.size(), 4);
+        pop_count += task_item.instance_list.size();
+      }
+    });
+  }
+  for (size_t i = 0; i < 100; i++) {
+    PushInstances(3);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (pop_count < 300 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  task_queue_.Stop();
+  for (auto &consumer : consumers) {
+    consumer.join();
+  }
+  ASSERT_EQ(pop_count, 300);
+}
+
+// micro benchmark: pushes and pops per second with growing number of producer threads
+TEST_F(TestTaskQueue, DISABLED_test_push_pop_throughput_with_multi_producers) {
+  constexpr size_t push_count_per_producer = 20000;
+  for (size_t producer_count : {1, 2, 4, 8}) {
+    StartQueue(32, 0, 0);
+    auto total = producer_count * push_count_per_producer;
+    size_t pop_count = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (size_t i = 0; i < producer_count; i++) {
+      producers.emplace_back([this]() {
+        for (size_t k = 0; k < push_count_per_producer; k++) {
+          PushInstances(1);
+        }
+      });
+    }
+    while (pop_count < total) {
+      TaskItem task_item;
+      task_queue_.PopTask(&task_item);
+      ASSERT_FALSE(task_item.has_stopped);
+      pop_count += task_item.instance_list.size();
+    }
+    auto cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto &producer : producers) {
+      producer.join();
+    }
+    task_queue_.Stop();
+    ASSERT_EQ(pop_count, total);
+    MSI_LOG_INFO << "Producer count " << producer_count << ", push and pop " << total << " instances cost " << cost
+                 << "s, " << static_cast<uint64_t>(total / cost) << " instances/s";
+  }
+}
+
+class TestPyTaskQueue : public UT::Common {
+ public:
+  TestPyTaskQueue() = default;
+};
+
+TEST_F(TestPyTaskQueue, test_push_results_of_multi_processing_tasks_in_order_success) {
+  PyTaskQueue py_task_queue;
+  MethodStage stage;
+  stage.method_name = "method";
+  stage.stage_index = 1;
+  stage.stage_key = "preprocess";
+  stage.batch_size = 2;
+  std::vector<InstancePtr> result_instances;
+  auto callback = [&result_instances](const std::vector<InstancePtr> &inputs, const std::vector<ResultInstance> &) {
+    result_instances.insert(result_instances.end(), inputs.begin(), inputs.end());
+  };
+  py_task_queue.Start("TestPyTask", {stage}, callback);
+  std::vector<InstancePtr> instances;
+  for (size_t i = 0; i < 4; i++) {
+    instances.push_back(std::make_shared<Instance>());
+  }
+  py_task_queue.PushTask("method", 1, instances);
+  // the second task is popped before the results of the first task are pushed
+  TaskItem task_item;
+  py_task_queue.PyPopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+  py_task_queue.PyPopTask(&task_item);
+  ASSERT_EQ(task_item.instance_list.size(), 2);
+  ASSERT_EQ(py_task_queue.GetHandledTaskInfo().task_name, "preprocess");
+  for (size_t i = 0; i < 4; i++) {
+    py_task_queue.PyPushTaskResult({ResultInstance()});
+  }
+  py_task_queue.Stop();
+  ASSERT_EQ(result_instances, instances);
+}
+
+class TestBatchStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &, const InstanceData &, InstanceData *) override {
+    return INFER_STATUS_LOG_ERROR(FAILED) << "Call should not be invoked";
+  }
+  Status CallBatch(const std::string &, const std::vector<InstanceData> &inputs,
+                   std::vector<ResultInstance> *outputs) override {
+    call_batch_count += 1;
+    outputs->resize(inputs.size());
+    return SUCCESS;
+  }
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+  static std::atomic<uint64_t> call_batch_count;
+};
+std::atomic<uint64_t> TestBatchStageFunc::call_batch_count = 0;
+
+class TestInstanceStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &, const InstanceData &input, InstanceData *) override {
+    if (input.empty()) {
+      return INFER_STATUS_LOG_ERROR(FAILED) << "Input cannot be empty";
+    }
+    return SUCCESS;
+  }
+  size_t GetInputsCount(const std::string &) const override { return 1; }
+  size_t GetOutputsCount(const std::string &) const override { return 1; }
+};
+
+REGISTER_STAGE_FUNCTION(TestBatchStageFunc, "test_batch_stage_func_cpp")
+REGISTER_STAGE_FUNCTION(TestInstanceStageFunc, "test_instance_stage_func_cpp")
+
+class TestCppTaskQueueThreadPool : public UT::Common {
+ public:
+  TestCppTaskQueueThreadPool() = default;
+  void TearDown() override {
+    thread_pool_.Stop();
+    UT::Common::TearDown();
+  }
+  void StartPool(const std::string &func_name, uint64_t batch_size, uint32_t thread_num) {
+    MethodStage stage;
+    stage.method_name = "method";
+    stage.stage_index = 1;
+    stage.stage_key = func_name;
+    stage.batch_size = batch_size;
+    auto callback = [this](const std::vector<InstancePtr> &inputs, const std::vector<ResultInstance> &outputs) {
+      ASSERT_EQ(inputs.size(), outputs.size());
+      std::unique_lock<std::mutex> lock{result_lock_};
+      for (auto &output : outputs) {
+        if (output.error_msg == SUCCESS) {
+          success_count_ += 1;
+        } else {
+          failed_count_ += 1;
+        }
+      }
+      result_cond_.notify_all();
+    };
+    thread_pool_.Start("TestCppTask", {stage}, callback, thread_num);
+  }
+  void WaitResults(uint64_t count) {
+    std::unique_lock<std::mutex> lock{result_lock_};
+    (void)result_cond_.wait_for(lock, std::chrono::seconds(10),
+                                [this, count] { return success_count_ + failed_count_ >= count; });
+  }
+
+  CppTaskQueueThreadPool thread_pool_;
+  std::mutex result_lock_;
+  std::condition_variable result_cond_;
+  uint64_t success_count_ = 0;
+  uint64_t failed_count_ = 0;
+};
+
+TEST_F(TestCppTaskQueueThreadPool, test_call_batch_once_for_batch_success) {
+  TestBatchStageFunc::call_batch_count = 0;
+  StartPool("test_batch_stage_func_cpp", 4, 1);
+  std::vector<InstancePtr> instances;
+  for (size_t i = 0; i < 4; i++) {
+    instances.push_back(std::make_shared<Instance>());
+  }
+  thread_pool_.PushTask("method", 1, instances);
+  WaitResults(4);
+  ASSERT_EQ(success_count_, 4);
+  ASSERT_EQ(TestBatchStageFunc::call_batch_count, 1);
+}
+
+TEST_F(TestCppTaskQueueThreadPool, test_default_call_batch_fail_one_instance_success) {
+  StartPool("test_instance_stage_func_cpp", 4, 4);
+  std::vector<InstancePtr> instances;
+  for (size_t i = 0; i < 3; i++) {
+    auto instance = std::make_shared<Instance>();
+    if (i != 1) {
+      instance->data.push_back(std::make_shared<Tensor>());
+    }
+    instances.push_back(instance);
+  }
+  thread_pool_.PushTask("method", 1, instances);
+  WaitResults(3);
+  ASSERT_EQ(success_count_, 2);
+  ASSERT_EQ(failed_count_, 1);
+}
+}  // namespace serving
+}  // namespace mindspore
@@ -0,0 +1,208 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <limits>
+#include <thread>
+#include "common/common_test.h"
+#include "common/tensor.h"
+#include "common/tensor_buffer_pool.h"
+
+using std::string;
+using std::vector;
+namespace mindspore {
+namespace serving {
+class TestTensorBufferPool : public UT::Common {
+ public:
+  TestTensorBufferPool() = default;
+  void SetUp() override {
+    UT::Common::SetUp();
+    TensorBufferPool::Instance().Clear();
+    TensorBufferPool::Instance().SetMaxCachedBytes(TensorBufferPool::kDefaultMaxCachedBytes);
+  }
+  void TearDown() override {
+    TensorBufferPool::Instance().Clear();
+    TensorBufferPool::Instance().SetMaxCachedBytes(TensorBufferPool::kDefaultMaxCachedBytes);
+    UT::Common::TearDown();
+  }
+};
+
+TEST_F(TestTensorBufferPool, test_alloc_size_class_success) {
+  auto &pool = TensorBufferPool::Instance();
+  size_t capacity = 0;
+  auto buffer = pool.Alloc(1, &capacity);
+  ASSERT_EQ(capacity, 64);
+  pool.Free(buffer, capacity);
+  buffer = pool.Alloc(1000, &capacity);
+  ASSERT_EQ(capacity, 1024);
+  pool.Free(buffer, capacity);
+  // larger than the max size class, not cached
+  auto large_size = (static_cast<size_t>(1) << TensorBufferPool::kMaxClassShift) + 1;
+  buffer = pool.Alloc(large_size, &capacity);
+  ASSERT_EQ(capacity, large_size);
+  pool.Free(buffer, capacity);
+  ASSERT_EQ(pool.GetStats().cached_bytes, 64 + 1024);
+}
+
+TEST_F(TestTensorBufferPool, test_tensor_buffer_reused_success) {
+  auto &pool = TensorBufferPool::Instance();
+  auto stats = pool.GetStats();
+  const uint8_t *first_buffer = nullptr;
+  {
+    Tensor tensor;
+    (void)tensor.resize_data(6 * sizeof(float));
+    first_buffer = tensor.data();
+  }
+  // 24 bytes in size class of 64 bytes
+  ASSERT_EQ(pool.GetStats().cached_bytes, stats.cached_bytes + 64);
+  Tensor tensor;
+  (void)tensor.resize_data(5 * sizeof(float));
+  // the buffer released by the same thread is reused
+  ASSERT_EQ(tensor.data(), first_buffer);
+  auto new_stats = pool.GetStats();
+  ASSERT_EQ(new_stats.alloc_count - stats.alloc_count, 2);
+  ASSERT_EQ(new_stats.hit_count - stats.hit_count, 1);
+  ASSERT_GE(new_stats.cached_high_water_bytes, 64);
+}
+
+TEST_F(TestTensorBufferPool, test_tensor_resize_keep_data_success) {
+  std::vector<int32_t> values = {1, 2, 3};
+  Tensor tensor(kMSI_Int32, {3}, values.data(), values.size() * sizeof(int32_t));
+  (void)tensor.resize_data(100 * sizeof(int32_t));
+  auto data = reinterpret_cast<const int32_t *>(tensor.data());
+  ASSERT_EQ(tensor.data_size(), 100 * sizeof(int32_t));
+  ASSERT_EQ(data[0], 1);
+  ASSERT_EQ(data[2], 3);
+  ASSERT_EQ(data[3], 0);
+  ASSERT_EQ(data[99], 0);
+  (void)tensor.resize_data(sizeof(int32_t));
+  (void)tensor.resize_data(2 * sizeof(int32_t));
+  data = reinterpret_cast<const int32_t *>(tensor.data());
+  ASSERT_EQ(data[0], 1);
+  ASSERT_EQ(data[1], 0);
+
+  Tensor copy_tensor = tensor;
+  ASSERT_NE(copy_tensor.data(), tensor.data());
+  ASSERT_EQ(copy_tensor.data_size(), tensor.data_size());
+  ASSERT_EQ(reinterpret_cast<const int32_t *>(copy_tensor.data())[0], 1);
+}
+
+TEST_F(TestTensorBufferPool, test_tensor_move_take_buffer_success) {
+  std::vector<int32_t> values = {1, 2, 3};
+  Tensor tensor(kMSI_Int32, {3}, values.data(), values.size() * sizeof(int32_t));
+  auto data = tensor.data();
+  auto alloc_count = TensorBufferPool::Instance().GetStats().alloc_count;
+  Tensor move_tensor(std::move(tensor));
+  ASSERT_EQ(move_tensor.data(), data);
+  ASSERT_EQ(move_tensor.data_size(), values.size() * sizeof(int32_t));
+  ASSERT_EQ(move_tensor.shape(), std::vector<int64_t>{3});
+  ASSERT_EQ(tensor.data(), nullptr);
+  ASSERT_EQ(tensor.data_size(), 0);
+
+  Tensor assign_tensor(kMSI_Int32, {1}, values.data(), sizeof(int32_t));
+  assign_tensor = std::move(move_tensor);
+  ASSERT_EQ(assign_tensor.data(), data);
+  ASSERT_EQ(reinterpret_cast<const int32_t *>(assign_tensor.data())[2], 3);
+  ASSERT_EQ(move_tensor.data(), nullptr);
+  // only the buffer of the tensor assigned to is allocated, the moves copy nothing
+  ASSERT_EQ(TensorBufferPool::Instance().GetStats().alloc_count, alloc_count + 1);
+  // the moved-from tensor can be reused
+  (void)move_tensor.resize_data(sizeof(int32_t));
+  ASSERT_EQ(move_tensor.data_size(), sizeof(int32_t));
+}
+
+TEST_F(TestTensorBufferPool, test_tensor_resize_no_fill_keep_data_success) {
+  std::vector<int32_t> values = {1, 2, 3};
+  Tensor tensor(kMSI_Int32, {3}, values.data(), values.size() * sizeof(int32_t));
+  auto old_data = tensor.data();
+  (void)tensor.resize_data_no_fill(4 * sizeof(int32_t));
+  ASSERT_EQ(tensor.data(), old_data);
+  ASSERT_EQ(tensor.data_size(), 4 * sizeof(int32_t));
+  (void)tensor.resize_data_no_fill(1000 * sizeof(int32_t));
+  auto data = reinterpret_cast<const int32_t *>(tensor.data());
+  ASSERT_EQ(tensor.data_size(), 1000 * sizeof(int32_t));
+  ASSERT_EQ(data[0], 1);
+  ASSERT_EQ(data[2], 3);
+}
+
+TEST_F(TestTensorBufferPool, test_tensor_resize_malloc_failed) {
+  std::vector<int32_t> values = {1, 2, 3};
+  Tensor tensor(kMSI_Int32, {3}, values.data(), values.size() * sizeof(int32_t));
+  auto old_data = tensor.data();
+  // the failure is returned, and the tensor keeps its data
+  ASSERT_FALSE(tensor.resize_data(std::numeric_limits<size_t>::max() / 2));
+  ASSERT_FALSE(tensor.resize_data_no_fill(std::numeric_limits<size_t>::max() / 2));
+  ASSERT_EQ(tensor.data(), old_data);
+  ASSERT_EQ(tensor.data_size(), values.size() * sizeof(int32_t));
+  ASSERT_EQ(reinterpret_cast<const int32_t *>(tensor.data())[2], 3);
+  ASSERT_FALSE(tensor.set_data(values.data(), std::numeric_limits<size_t>::max() / 2));
+}
+
+TEST_F(TestTensorBufferPool, test_max_cached_bytes_success) {
+  auto &pool = TensorBufferPool::Instance();
+  pool.SetMaxCachedBytes(4096);
+  std::vector<uint8_t *> buffers;
+  size_t capacity = 0;
+  for (size_t i = 0; i < 3; i++) {
+    buffers.push_back(pool.Alloc(2048, &capacity));
+  }
+  for (auto buffer : buffers) {
+    pool.Free(buffer, capacity);
+  }
+  auto stats = pool.GetStats();
+  ASSERT_EQ(stats.cached_bytes, 4096);
+  ASSERT_EQ(stats.drop_count, 1);
+}
+
+TEST_F(TestTensorBufferPool, test_buffers_of_exited_thread_reused_success) {
+  auto &pool = TensorBufferPool::Instance();
+  size_t capacity = 0;
+  uint8_t *buffer = nullptr;
+  std::thread thread([&pool, &buffer, &capacity]() {
+    buffer = pool.Alloc(512, &capacity);
+    pool.Free(buffer, capacity);
+  });
+  thread.join();
+  // the thread cache is returned to the shared lists when the thread exits
+  auto hit_count = pool.GetStats().hit_count;
+  size_t new_capacity = 0;
+  auto new_buffer = pool.Alloc(512, &new_capacity);
+  ASSERT_EQ(new_buffer, buffer);
+  ASSERT_EQ(pool.GetStats().hit_count, hit_count + 1);
+  pool.Free(new_buffer, new_capacity);
+}
+
+// micro benchmark: create and release output tensors of stage functions, with and without the cached buffers
+TEST_F(TestTensorBufferPool, DISABLED_test_tensor_alloc_benchmark) {
+  auto &pool = TensorBufferPool::Instance();
+  constexpr size_t loop_count = 100000;
+  for (uint64_t max_cached_bytes : {static_cast<uint64_t>(0), TensorBufferPool::kDefaultMaxCachedBytes}) {
+    pool.SetMaxCachedBytes(max_cached_bytes);
+    for (size_t data_size : {256, 64 * 1024}) {
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < loop_count; i++) {
+        auto tensor = std::make_shared<Tensor>();
+        (void)tensor->resize_data(data_size);
+      }
+      auto cost = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+      MSI_LOG_INFO << "Max cached bytes " << max_cached_bytes << ", data size " << data_size << ", cost "
+                   << cost / loop_count << "us per tensor";
+    }
+    pool.Clear();
+  }
+}
+}  // namespace serving
+}  // namespace mindspore
@@ -0,0 +1,230 @@
+/**
+ * Copyright 2021 Huawei Technologies Co., Ltd
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "common/common_test.h"
+#include "worker/work_executor.h"
+#include "worker/servable_register.h"
+#include "worker/stage_function.h"
+
+using std::string;
+using std::vector;
+namespace mindspore {
+namespace serving {
+class TestIdentityStageFunc : public CppStageFunctionBase {
+ public:
+  Status Call(const std::string &func_name, const InstanceData &input, InstanceData *output) override {
+    *output = input;
+    return SUCCESS;
+  }
+  size_t GetInputsCount(const std::string &func_name) const override { return 1; }
+  size_t GetOutputsCount(const std::string &func_name) const override { return 1; }
+};
+
+REGISTER_STAGE_FUNCTION(TestIdentityStageFunc, "test_identity_stage_func_cpp")
+
+class TestWorkExecutor : public UT::Common {
+ public:
+  TestWorkExecutor() = default;
+  void SetUp() override {
+    UT::Common::SetUp();
+    MethodSignature method_signature;
+    method_signature.servable_name = "test_servable";
+    method_signature.method_name = "identity";
+    method_signature.inputs = {"x"};
+    method_signature.outputs = {"y"};
+    method_signature.AddStageFunction("test_identity_stage_func_cpp", {{0, 0}});
+    method_signature.SetReturn({{1, 0}});
+    ASSERT_EQ(ServableRegister::Instance().RegisterMethod(method_signature), SUCCESS);
+    executor_ = std::make_shared<WorkExecutor>();
+    ASSERT_EQ(executor_->Init({}), SUCCESS);
+  }
+  void TearDown() override {
+    executor_->Stop();
+    executor_ = nullptr;
+    UT::Common::TearDown();
+  }
+
+  static std::vector<InstanceData> CreateInputs(size_t instances_count, int32_t value) {
+    std::vector<InstanceData> inputs;
+    for (size_t i = 0; i < instances_count; i++) {
+      auto tensor = std::make_shared<Tensor>(kMSI_Int32, std::vector<int64_t>{1}, nullptr, sizeof(int32_t));
+      reinterpret_cast<int32_t *>(tensor->mutable_data())[0] = value + static_cast<int32_t>(i);
+      inputs.push_back({tensor});
+    }
+    return inputs;
+  }
+
+  // send requests from multi threads, each request is finished exactly once
+  double RunConcurrentRequests(size_t thread_count, size_t request_count_per_thread, size_t instances_count) {
+    std::atomic<size_t> finished_count = 0;
+    std::atomic<size_t> error_count = 0;
+    RequestSpec request_spec;
+    request_spec.servable_name = "test_servable";
+    request_spec.method_name = "identity";
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; i++) {
+      threads.emplace_back([&, i]() {
+        for (size_t k = 0; k < request_count_per_thread; k++) {
+          auto value = static_cast<int32_t>(i * request_count_per_thread + k);
+          auto callback = [&finished_count, &error_count, value](const std::vector<InstancePtr> &instances) {
+            for (size_t index = 0; index < instances.size(); index++) {
+              auto &instance = instances[index];
+              if (instance->error_msg != SUCCESS || instance->data.size() != 1 ||
+                  reinterpret_cast<const int32_t *>(instance->data[0]->data())[0] !=
+                    value + static_cast<int32_t>(index)) {
+                error_count++;
+              }
+            }
+            finished_count++;
+          };
+          auto status = executor_->Work(request_spec, CreateInputs(instances_count, value), callback);
+          if (status != SUCCESS) {
+            error_count++;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto total = thread_count * request_count_per_thread;
+    while (finished_count < total && std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    auto cost = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(finished_count, total);
+    EXPECT_EQ(error_count, 0);
+    return cost;
+  }
+
+  std::shared_ptr<WorkExecutor> executor_;
+};
+
+TEST_F(TestWorkExecutor, test_concurrent_requests_finished_once_success) {
+  (void)RunConcurrentRequests(4, 200, 3);
+}
+
+TEST_F(TestWorkExecutor, test_clear_running_requests_success) {
+  std::mutex lock;
+  std::condition_variable cond;
+  size_t finished_count = 0;
+  RequestSpec request_spec;
+  request_spec.servable_name = "test_servable";
+  request_spec.method_name = "identity";
+  constexpr size_t request_count = 100;
+  for (size_t i = 0; i < request_count; i++) {
+    auto callback = [&lock, &cond, &finished_count](const std::vector<InstancePtr> &) {
+      std::unique_lock<std::mutex> finished_lock(lock);
+      finished_count++;
+      cond.notify_all();
+    };
+    ASSERT_EQ(executor_->Work(request_spec, CreateInputs(2, 0), callback), SUCCESS);
+  }
+  executor_->ClearInstances(Status(WORKER_UNAVAILABLE, "Servable stopped"));
+  // the requests finished by the stage threads and the cleared requests are all finished once
+  std::unique_lock<std::mutex> finished_lock(lock);
+  ASSERT_TRUE(cond.wait_for(finished_lock, std::chrono::seconds(10),
+                            [&finished_count]() { return finished_count >= request_count; }));
+  // no request is finished again
+  finished_lock.unlock();
+  executor_->Stop();
+  finished_lock.lock();
+  ASSERT_EQ(finished_count, request_count);
+}
+
+TEST_F(TestWorkExecutor, test_drop_expired_request_before_stage_success) {
+  RequestSpec request_spec;
+  request_spec.servable_name = "test_servable";
+  request_spec.method_name = "identity";
+  request_spec.deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  std::atomic<size_t> finished_count = 0;
+  std::atomic<size_t> expired_count = 0;
+  auto callback = [&finished_count, &expired_count](const std::vector<InstancePtr> &instances) {
+    for (auto &instance : instances) {
+      if (instance->error_msg == DEADLINE_EXCEEDED) {
+        expired_count++;
+      }
+    }
+    finished_count++;
+  };
+  ASSERT_EQ(executor_->Work(request_spec, CreateInputs(3, 0), callback), SUCCESS);
+  auto start = std::chrono::steady_clock::now();
+  while (finished_count < 1 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(finished_count, 1);
+  ASSERT_EQ(expired_count, 3);
+}
+
+TEST_F(TestWorkExecutor, test_instances_reused_without_allocation_success) {
+  // warm up the pools
+  (void)RunConcurrentRequests(4, 100, 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto session_stats = WorkExecutor::GetInferSessionPool().GetStats();
+  auto instance_stats = GetInstancePool().GetStats();
+  (void)RunConcurrentRequests(1, 200, 3);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto new_session_stats = WorkExecutor::GetInferSessionPool().GetStats();
+  auto new_instance_stats = GetInstancePool().GetStats();
+  ASSERT_EQ(new_session_stats.acquire_count - session_stats.acquire_count, 200);
+  ASSERT_EQ(new_instance_stats.acquire_count - instance_stats.acquire_count, 600);
+  ASSERT_EQ(new_session_stats.alloc_count, session_stats.alloc_count);
+  ASSERT_EQ(new_instance_stats.alloc_count, instance_stats.alloc_count);
+}
+
+TEST_F(TestWorkExecutor, test_object_pool_recycle_success) {
+  ObjectPool<Instance> pool(1);
+  auto instance = pool.Acquire();
+  instance->user_id = 1;
+  instance->stage_data_list.resize(3);
+  instance = nullptr;
+  auto stats = pool.GetStats();
+  ASSERT_EQ(stats.alloc_count, 2);  // object and control block
+  instance = pool.Acquire();
+  ASSERT_EQ(instance->user_id, 0);
+  ASSERT_EQ(instance->stage_data_list.size(), 3);
+  instance = nullptr;
+  std::vector<InstancePtr> instances;
+  for (size_t i = 0; i < ObjectPoolBase::kShardCount + 2; i++) {
+    instances.push_back(pool.Acquire());
+  }
+  stats = pool.GetStats();
+  ASSERT_EQ(stats.acquire_count, ObjectPoolBase::kShardCount + 4);
+  ASSERT_EQ(stats.reuse_count, 2);
+  instances.clear();
+  // one free object is kept in every shard
+  ASSERT_EQ(pool.GetStats().drop_count, 2);
+}
+
+// many small requests replied concurrently by the stage threads, growing number of client threads, every request
+// gets its own reply once and takes one session
+TEST_F(TestWorkExecutor, test_small_requests_with_multi_clients_finished_once_success) {
+  constexpr size_t request_count_per_thread = 1000;
+  for (size_t thread_count : {1, 2, 4, 8}) {
+    auto session_stats = WorkExecutor::GetInferSessionPool().GetStats();
+    (void)RunConcurrentRequests(thread_count, request_count_per_thread, 1);
+    auto new_session_stats = WorkExecutor::GetInferSessionPool().GetStats();
+    ASSERT_EQ(new_session_stats.acquire_count - session_stats.acquire_count, thread_count * request_count_per_thread);
+  }
+}
+}  // namespace serving
+}  // namespace mindspore
@@ -462,3 +462,97 @@ def predict(x1, x2):
     except RuntimeError as e:
         assert "has models declared by declare_model, but parameter 'device_ids' of ServableStartConfig is not set in" \
                " Serving startup script when the MindSpore or Lite inference package not support CPU" in str(e)
+
+
+@serving_test
+def test_model_context_replica_num_with_thread_affinity_core_list_serving_server_success():
+    """
+    Feature: Model replicas
+    Description: Test two model replicas splitting the thread affinity cores
+    Expectation: Serving server work well.
+    """
+    servable_content = r"""
+import numpy as np
+from mindspore_serving.server import register
+from mindspore_serving.server.register import Context
+
+context = Context(thread_affinity_core_list=[0, 1, 2, 3])
+model = register.declare_model(model_file="tensor_add.mindir", model_format="MindIR", with_batch_dim=False,
+                               context=context, replica_num=2)
+
+@register.register_method(output_names="y")
+def predict(x1, x2):
+    y = register.add_stage(model, x1, x2, outputs_count=1)
+    return y
+    """
+    base = start_serving_server(servable_content)
+    # Client
+    x1 = np.array([[1.1, 2.2], [3.3, 4.4]], np.float32)
+    x2 = np.array([[5.5, 6.6], [7.7, 8.8]], np.float32)
+    y = x1 + x2
+    instances = [{"x1": x1, "x2": x2}] * 4
+
+    client = create_client("localhost:5500", base.servable_name, "predict")
+    result = client.infer(instances)
+    print("result", result)
+    for item in result:
+        assert (item["y"] == y).all()
+
+
+@serving_test
+def test_model_context_replica_num_invalid_failed():
+    """
+    Feature: Model replicas
+    Description: Test replica_num 0
+    Expectation: Serving server startup failed.
+    """
+    servable_content = r"""
+import numpy as np
+from mindspore_serving.server import register
+
+model = register.declare_model(model_file="tensor_add.mindir", model_format="MindIR", with_batch_dim=False,
+                               replica_num=0)
+
+@register.register_method(output_names="y")
+def predict(x1, x2):
+    y = register.add_stage(model, x1, x2, outputs_count=1)
+    return y
+    """
+    try:
+        start_serving_server(servable_content)
+        assert False
+    except RuntimeError as e:
+        assert "Parameter 'replica_num' should be >= 1" in str(e)
+
+
+@serving_test
+def test_model_context_input_buffer_num_serving_server_success():
+    """
+    Feature: Batch assembly pipeline
+    Description: Test two input buffer sets, batch assembly overlaps with execution
+    Expectation: Serving server work well.
+    """
+    servable_content = r"""
+import numpy as np
+from mindspore_serving.server import register
+
+model = register.declare_model(model_file="tensor_add.mindir", model_format="MindIR", with_batch_dim=False,
+                               input_buffer_num=2)
+
+@register.register_method(output_names="y")
+def predict(x1, x2):
+    y = register.add_stage(model, x1, x2, outputs_count=1)
+    return y
+    """
+    base = start_serving_server(servable_content)
+    # Client
+    x1 = np.array([[1.1, 2.2], [3.3, 4.4]], np.float32)
+    x2 = np.array([[5.5, 6.6], [7.7, 8.8]], np.float32)
+    y = x1 + x2
+    instances = [{"x1": x1, "x2": x2}] * 4
+
+    client = create_client("localhost:5500", base.servable_name, "predict")
+    result = client.infer(instances)
+    print("result", result)
+    for item in result:
+        assert (item["y"] == y).all()
@@ -13,6 +13,8 @@
 # limitations under the License.
 # ============================================================================
 
+import os
+
 import numpy as np
 
 from common import serving_test, create_client
@@ -1357,3 +1359,99 @@ def add_common(x1, x2):
     result = client.infer(instances)
     print(result)
     assert len(result) == instance_count
+
+
+@serving_test
+def test_stage_function_py_stage_process_success():
+    """
+    Feature: test servable_config.py stage
+    Description: Python stage functions run in helper processes, inputs and outputs pass through shared memory
+    Expectation: Serving server work well, results are returned in the order of instances.
+    """
+    servable_content = r"""
+import os
+import numpy as np
+from mindspore_serving.server import register
+model = register.declare_model(model_file="tensor_add.mindir", model_format="MindIR", with_batch_dim=True)
+register.set_py_stage_process_num(2)
+
+def preprocess(x1, x2):
+    return x1 + 1, x2 + 1
+
+def postprocess(y):
+    return y * 2, "pid" + str(os.getpid()), b"bytes"
+
+@register.register_method(output_names=["y", "pid", "text"])
+def add_common(x1, x2):
+    x1, x2 = register.add_stage(preprocess, x1, x2, outputs_count=2)
+    y = register.add_stage(model, x1, x2, outputs_count=1)
+    y, pid, text = register.add_stage(postprocess, y, outputs_count=3)
+    return y, pid, text
+"""
+    base = start_serving_server(servable_content)
+    # Client
+    instance_count = 20
+
+    instances = []
+    y_data_list = []
+    for i in range(instance_count):
+        x1 = np.asarray([[1.1], [3.3]]).astype(np.float32) * (i + 1)
+        x2 = np.asarray([[5.5], [7.7]]).astype(np.float32) * (i + 1)
+        y_data_list.append((x1 + x2 + 2) * 2)
+        instances.append({"x1": x1, "x2": x2})
+
+    client = create_client("localhost:5500", base.servable_name, "add_common")
+    result = client.infer(instances)
+    print(result)
+    assert len(result) == instance_count
+    for i in range(instance_count):
+        assert is_float_equal(result[i]["y"], y_data_list[i])
+        assert result[i]["pid"] != f"pid{os.getpid()}"
+        assert result[i]["text"] == b"bytes"
+
+
+@serving_test
+def test_stage_function_py_stage_process_one_instance_failed():
+    """
+    Feature: test servable_config.py stage
+    Description: Python stage function run in helper processes raise exception for one instance
+    Expectation: Only the instance raising exception failed.
+    """
+    servable_content = r"""
+import numpy as np
+from mindspore_serving.server import register
+model = register.declare_model(model_file="tensor_add.mindir", model_format="MindIR", with_batch_dim=True)
+register.set_py_stage_process_num(2)
+
+def preprocess(instances):
+    for instance in instances:
+        x1 = instance[0]
+        if x1[0][0] > 3:
+            raise RuntimeError("invalid x1")
+        yield x1
+
+@register.register_method(output_names=["y"])
+def add_common(x1, x2):
+    x1 = register.add_stage(preprocess, x1, outputs_count=1, batch_size=4, tag="Preprocess")
+    y = register.add_stage(model, x1, x2, outputs_count=1)
+    return y
+"""
+    base = start_serving_server(servable_content)
+    # Client
+    instance_count = 3
+
+    instances = []
+    y_data_list = []
+    for i in range(instance_count):
+        x1 = np.asarray([[1.1], [3.3]]).astype(np.float32) * (i + 1)
+        x2 = np.asarray([[5.5], [7.7]]).astype(np.float32) * (i + 1)
+        y_data_list.append(x1 + x2)
+        instances.append({"x1": x1, "x2": x2})
+
+    client = create_client("localhost:5500", base.servable_name, "add_common")
+    result = client.infer(instances)
+    print(result)
+    assert len(result) == instance_count
+    assert is_float_equal(result[0]["y"], y_data_list[0])
+    assert is_float_equal(result[1]["y"], y_data_list[1])
+    assert "Preprocess Failed" in str(result[2]["error"])